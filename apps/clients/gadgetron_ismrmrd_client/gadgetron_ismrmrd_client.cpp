@@ -30,9 +30,13 @@
 #include <iostream>
 #include <exception>
 #include <map>
+#include <deque>
 #include <thread>
 #include <chrono>
 #include <condition_variable>
+#include <functional>
+#include <future>
+#include <limits>
 
 #include "NHLBICompression.h"
 #include "GadgetronTimer.h"
@@ -186,6 +190,8 @@ size_t compress_zfp_precision(float* in, size_t samples, size_t coils, unsigned
 
 namespace po = boost::program_options;
 using boost::asio::ip::tcp;
+/// A TCP or Unix domain socket
+using Socket = boost::asio::generic::stream_protocol::socket;
 
 
 enum GadgetronMessageID {
@@ -272,13 +278,13 @@ public:
     /**
     Function must be implemented to read a specific message.
     */
-    virtual void read(tcp::socket* s) = 0;
+    virtual void read(Socket* s) = 0;
 
 };
 
 class GadgetronClientResponseReader : public GadgetronClientMessageReader
 {
-    void read(tcp::socket *stream) override {
+    void read(Socket *stream) override {
 
         uint64_t correlation_id = 0;
         uint64_t response_length = 0;
@@ -308,7 +314,7 @@ public:
     
   }
 
-  virtual void read(tcp::socket* stream)
+  virtual void read(Socket* stream)
   {
     size_t recv_count = 0;
     
@@ -353,7 +359,7 @@ public:
     
   }
 
-  virtual void read(tcp::socket* stream)
+  virtual void read(Socket* stream)
   {
     size_t recv_count = 0;
     
@@ -414,7 +420,7 @@ public:
     } 
 
     template <typename T> 
-    void read_data_attrib(tcp::socket* stream, const ISMRMRD::ImageHeader& h, ISMRMRD::Image<T>& im)
+    void read_data_attrib(Socket* stream, const ISMRMRD::ImageHeader& h, ISMRMRD::Image<T>& im)
     {
         im.setHead(h);
 
@@ -456,7 +462,7 @@ public:
         }
     }
 
-    virtual void read(tcp::socket* stream) 
+    virtual void read(Socket* stream) 
     {
         //Read the image headerfrom the socket
         ISMRMRD::ImageHeader h;
@@ -841,7 +847,7 @@ public:
     } 
 
     template <typename T>
-    void read_data_attrib(tcp::socket* stream, const ISMRMRD::ImageHeader& h, ISMRMRD::Image<T>& im)
+    void read_data_attrib(Socket* stream, const ISMRMRD::ImageHeader& h, ISMRMRD::Image<T>& im)
     {
         im.setHead(h);
 
@@ -929,7 +935,7 @@ public:
         outfileData.close();
     }
 
-    virtual void read(tcp::socket* stream) 
+    virtual void read(Socket* stream) 
     {
         //Read the image headerfrom the socket
         ISMRMRD::ImageHeader h;
@@ -1006,7 +1012,7 @@ public:
 
     virtual ~GadgetronClientBlobMessageReader() {}
 
-    virtual void read(tcp::socket* socket) 
+    virtual void read(Socket* socket) 
     {
 
         // MUST READ 32-bits
@@ -1083,6 +1089,185 @@ protected:
 
 };
 
+/**
+ * A message serialized for sending, with the byte counts reported in the transmission statistics.
+ */
+struct GadgetronClientMessage
+{
+    std::string bytes;
+    double header_bytes = 0;
+    double uncompressed_bytes = 0;
+    double compressed_bytes = 0;
+};
+
+template <typename T>
+void append_bytes(std::string& bytes, const T* data, size_t count)
+{
+    bytes.append(reinterpret_cast<const char*>(data), sizeof(T)*count);
+}
+
+GadgetronClientMessage serialize_ismrmrd_acquisition_header(const ISMRMRD::AcquisitionHeader& h, const ISMRMRD::Acquisition& acq)
+{
+    GadgetronClientMessage message;
+
+    GadgetMessageIdentifier id;
+    id.id = GADGET_MESSAGE_ISMRMRD_ACQUISITION;
+
+    unsigned long trajectory_elements = h.trajectory_dimensions*h.number_of_samples;
+
+    append_bytes(message.bytes, &id, 1);
+    append_bytes(message.bytes, &h, 1);
+    if (trajectory_elements) {
+        append_bytes(message.bytes, acq.getTrajPtr(), trajectory_elements);
+    }
+
+    message.header_bytes = message.bytes.size();
+    return message;
+}
+
+void append_compressed_data(GadgetronClientMessage& message, const char* compressed, size_t compressed_size, unsigned long data_elements)
+{
+    uint32_t bs = (uint32_t)compressed_size;
+    append_bytes(message.bytes, &bs, 1);
+    append_bytes(message.bytes, compressed, compressed_size);
+
+    message.compressed_bytes = compressed_size;
+    message.uncompressed_bytes = data_elements*2*sizeof(float);
+}
+
+float local_compression_tolerance(const ISMRMRD::Acquisition& acq, float compression_tolerance, const NoiseStatistics& stat)
+{
+    float local_tolerance = compression_tolerance;
+    float sigma = stat.sigma_min; //We use the minimum sigma of all channels to "cap" the error
+    if (stat.status && sigma > 0 && stat.noise_dwell_time_us && acq.getHead().sample_time_us) {
+        local_tolerance = local_tolerance*stat.sigma_min*acq.getHead().sample_time_us*std::sqrt(stat.noise_dwell_time_us/acq.getHead().sample_time_us);
+    }
+    return local_tolerance;
+}
+
+GadgetronClientMessage serialize_ismrmrd_acquisition(const ISMRMRD::Acquisition& acq)
+{
+    GadgetronClientMessage message = serialize_ismrmrd_acquisition_header(acq.getHead(), acq);
+
+    unsigned long data_elements = acq.getHead().active_channels*acq.getHead().number_of_samples;
+
+    if (data_elements) {
+        append_bytes(message.bytes, (const float*)acq.getDataPtr(), 2*data_elements);
+        message.uncompressed_bytes = 2*sizeof(float)*data_elements;
+    }
+
+    return message;
+}
+
+GadgetronClientMessage serialize_ismrmrd_compressed_acquisition(const ISMRMRD::Acquisition& acq, float tolerance, unsigned int compression_precision)
+{
+    ISMRMRD::AcquisitionHeader h = acq.getHead(); //We will make a copy because we will be setting some flags
+    h.setFlag(ISMRMRD::ISMRMRD_ACQ_COMPRESSION2);
+
+    GadgetronClientMessage message = serialize_ismrmrd_acquisition_header(h, acq);
+
+    unsigned long data_elements = acq.getHead().active_channels*acq.getHead().number_of_samples;
+
+    if (data_elements) {
+        std::vector<float> input_data((const float*)acq.getDataPtr(), (const float*)acq.getDataPtr() + data_elements*2);
+
+        std::unique_ptr<CompressedFloatBuffer> comp_buffer(CompressedFloatBuffer::createCompressedBuffer());
+        if (compression_precision > 0) {
+            comp_buffer->compress(input_data, tolerance, compression_precision);
+        } else {
+            comp_buffer->compress(input_data, tolerance);
+        }
+        std::vector<uint8_t> serialized_buffer = comp_buffer->serialize();
+
+        append_compressed_data(message, (const char*)serialized_buffer.data(), serialized_buffer.size(), data_elements);
+    }
+
+    return message;
+}
+
+GadgetronClientMessage serialize_ismrmrd_compressed_acquisition_precision(const ISMRMRD::Acquisition& acq, unsigned int compression_precision)
+{
+    return serialize_ismrmrd_compressed_acquisition(acq, -1.0, compression_precision);
+}
+
+GadgetronClientMessage serialize_ismrmrd_compressed_acquisition_tolerance(const ISMRMRD::Acquisition& acq, float compression_tolerance, const NoiseStatistics& stat)
+{
+    return serialize_ismrmrd_compressed_acquisition(acq, local_compression_tolerance(acq, compression_tolerance, stat), 0);
+}
+
+#if defined GADGETRON_COMPRESSION_ZFP
+template <class COMPRESS>
+GadgetronClientMessage serialize_ismrmrd_zfp_compressed_acquisition(const ISMRMRD::Acquisition& acq, COMPRESS compress)
+{
+    ISMRMRD::AcquisitionHeader h = acq.getHead(); //We will make a copy because we will be setting some flags
+    h.setFlag(ISMRMRD::ISMRMRD_ACQ_COMPRESSION1);
+
+    GadgetronClientMessage message = serialize_ismrmrd_acquisition_header(h, acq);
+
+    unsigned long data_elements = acq.getHead().active_channels*acq.getHead().number_of_samples;
+
+    if (data_elements) {
+        std::vector<char> comp_buffer(4*sizeof(float)*data_elements);
+        size_t compressed_size = 0;
+        try {
+            compressed_size = compress((float*)acq.getDataPtr(), acq.getHead().number_of_samples*2, acq.getHead().active_channels,
+                                       comp_buffer.data(), comp_buffer.size());
+        } catch (...) {
+            std::cout << "Compression failure caught" << std::endl;
+            throw;
+        }
+
+        append_compressed_data(message, comp_buffer.data(), compressed_size, data_elements);
+    }
+
+    return message;
+}
+#endif //GADGETRON_COMPRESSION_ZFP
+
+GadgetronClientMessage serialize_ismrmrd_zfp_compressed_acquisition_precision(const ISMRMRD::Acquisition& acq, unsigned int compression_precision)
+{
+#if defined GADGETRON_COMPRESSION_ZFP
+    return serialize_ismrmrd_zfp_compressed_acquisition(acq, [&](float* in, size_t samples, size_t coils, char* buffer, size_t buf_size) {
+        return compress_zfp_precision(in, samples, coils, compression_precision, buffer, buf_size);
+    });
+#else //GADGETRON_COMPRESSION_ZFP
+    throw GadgetronClientException("Attempting to do ZFP compression, but ZFP not available");
+#endif //GADGETRON_COMPRESSION_ZFP
+}
+
+GadgetronClientMessage serialize_ismrmrd_zfp_compressed_acquisition_tolerance(const ISMRMRD::Acquisition& acq, float compression_tolerance, const NoiseStatistics& stat)
+{
+#if defined GADGETRON_COMPRESSION_ZFP
+    float local_tolerance = local_compression_tolerance(acq, compression_tolerance, stat);
+    return serialize_ismrmrd_zfp_compressed_acquisition(acq, [&](float* in, size_t samples, size_t coils, char* buffer, size_t buf_size) {
+        return compress_zfp_tolerance(in, samples, coils, local_tolerance, buffer, buf_size);
+    });
+#else //GADGETRON_COMPRESSION_ZFP
+    throw GadgetronClientException("Attempting to do ZFP compression, but ZFP not available");
+#endif //GADGETRON_COMPRESSION_ZFP
+}
+
+GadgetronClientMessage serialize_ismrmrd_waveform(const ISMRMRD::Waveform& wav)
+{
+    GadgetronClientMessage message;
+
+    GadgetMessageIdentifier id;
+    id.id = GADGET_MESSAGE_ISMRMRD_WAVEFORM;
+
+    append_bytes(message.bytes, &id, 1);
+    append_bytes(message.bytes, &wav.head, 1);
+
+    unsigned long data_elements = wav.head.channels*wav.head.number_of_samples;
+
+    if (data_elements)
+    {
+        append_bytes(message.bytes, wav.begin_data(), data_elements);
+    }
+
+    message.header_bytes = message.bytes.size();
+    return message;
+}
+
 class GadgetronClientConnector
 {
 
@@ -1093,6 +1278,7 @@ public:
         , uncompressed_bytes_sent_(0)
         , compressed_bytes_sent_(0)
         , header_bytes_sent_(0)
+        , images_received_(0)
     {
 
     }
@@ -1101,8 +1287,11 @@ public:
     {
         if (socket_) {
             socket_->close();
-            delete socket_;
         }
+        if (reader_thread_.joinable()) {
+            reader_thread_.join();
+        }
+        delete socket_;
     }
 
     double compression_ratio()
@@ -1151,24 +1340,41 @@ public:
             } else {
                 r->read(socket_);
             }
+
+            if (id.id == GADGET_MESSAGE_ISMRMRD_IMAGE || id.id == GADGET_MESSAGE_DICOM_WITHNAME) {
+                images_received_++;
+                last_image_ = std::chrono::steady_clock::now();
+            }
         }
     }
 
     void wait() {
         reader_thread_.join();
+        if (reader_error_) {
+            std::rethrow_exception(reader_error_);
+        }
     }
 
+    /// A hostname of "unix" connects to the Unix domain socket at the path given as port.
     void connect(std::string hostname, std::string port)
     {
-        tcp::resolver resolver(io_service);
-        // numeric_service flag is required to send data if the Linux machine has no internet connection (in this case the loopback device is the only network device with an address).
-        // https://stackoverflow.com/questions/5971242/how-does-boost-asios-hostname-resolution-work-on-linux-is-it-possible-to-use-n
-        // https://www.boost.org/doc/libs/1_65_0/doc/html/boost_asio/reference/ip__basic_resolver_query.html
-        tcp::resolver::query query(tcp::v4(), hostname.c_str(), port.c_str(), boost::asio::ip::resolver_query_base::numeric_service);
-        tcp::resolver::iterator endpoint_iterator = resolver.resolve(query);
-        tcp::resolver::iterator end;
-
-        socket_ = new tcp::socket(io_service);
+        std::vector<Socket::endpoint_type> endpoints;
+        if (hostname == "unix") {
+            endpoints.emplace_back(boost::asio::local::stream_protocol::endpoint(port));
+        } else {
+            tcp::resolver resolver(io_service);
+            // numeric_service flag is required to send data if the Linux machine has no internet connection (in this case the loopback device is the only network device with an address).
+            // https://stackoverflow.com/questions/5971242/how-does-boost-asios-hostname-resolution-work-on-linux-is-it-possible-to-use-n
+            // https://www.boost.org/doc/libs/1_65_0/doc/html/boost_asio/reference/ip__basic_resolver_query.html
+            tcp::resolver::query query(tcp::v4(), hostname.c_str(), port.c_str(), boost::asio::ip::resolver_query_base::numeric_service);
+            tcp::resolver::iterator endpoint_iterator = resolver.resolve(query);
+            tcp::resolver::iterator end;
+            for (; endpoint_iterator != end; ++endpoint_iterator) endpoints.emplace_back(endpoint_iterator->endpoint());
+        }
+        auto endpoint_iterator = endpoints.begin();
+        auto end = endpoints.end();
+
+        socket_ = new Socket(io_service);
         if (!socket_) {
             throw GadgetronClientException("Unable to create socket.");
         }
@@ -1199,7 +1405,15 @@ public:
         if (error)
             throw GadgetronClientException("Error connecting using socket.");
 
-        reader_thread_ = std::thread([&](){this->read_task();});
+        connected_ = last_image_ = std::chrono::steady_clock::now();
+
+        reader_thread_ = std::thread([&](){
+                try {
+                    this->read_task();
+                } catch (...) {
+                    reader_error_ = std::current_exception();
+                }
+            });
     }
 
     void send_gadgetron_close() { 
@@ -1279,261 +1493,29 @@ public:
         header_bytes_sent_ += boost::asio::write(*socket_, boost::asio::buffer(xml_string.c_str(), conf.script_length));
     }
 
-    void send_ismrmrd_acquisition(ISMRMRD::Acquisition& acq) 
+    void send(const GadgetronClientMessage& message)
     {
         if (!socket_) {
             throw GadgetronClientException("Invalid socket.");
         }
 
-        GadgetMessageIdentifier id;
-        id.id = GADGET_MESSAGE_ISMRMRD_ACQUISITION;;
-
-        header_bytes_sent_ += boost::asio::write(*socket_, boost::asio::buffer(&id, sizeof(GadgetMessageIdentifier)));
-        header_bytes_sent_ += boost::asio::write(*socket_, boost::asio::buffer(&acq.getHead(), sizeof(ISMRMRD::AcquisitionHeader)));
-
-        unsigned long trajectory_elements = acq.getHead().trajectory_dimensions*acq.getHead().number_of_samples;
-        unsigned long data_elements = acq.getHead().active_channels*acq.getHead().number_of_samples;
-
-        if (trajectory_elements) {
-            header_bytes_sent_ += boost::asio::write(*socket_, boost::asio::buffer(&acq.getTrajPtr()[0], sizeof(float)*trajectory_elements));
-        }
-
+        boost::asio::write(*socket_, boost::asio::buffer(message.bytes));
 
-        if (data_elements) {
-            uncompressed_bytes_sent_ +=boost::asio::write(*socket_, boost::asio::buffer(&acq.getDataPtr()[0], 2*sizeof(float)*data_elements));
-        }
+        header_bytes_sent_ += message.header_bytes;
+        uncompressed_bytes_sent_ += message.uncompressed_bytes;
+        compressed_bytes_sent_ += message.compressed_bytes;
     }
 
-
-    void send_ismrmrd_compressed_acquisition_precision(ISMRMRD::Acquisition& acq, unsigned int compression_precision) 
+    /// Images (and DICOM images) received so far
+    size_t images_received() const
     {
-        if (!socket_) {
-            throw GadgetronClientException("Invalid socket.");
-        }
-
-        GadgetMessageIdentifier id;
-        id.id = GADGET_MESSAGE_ISMRMRD_ACQUISITION;
-
-        ISMRMRD::AcquisitionHeader h = acq.getHead(); //We will make a copy because we will be setting some flags
-        h.setFlag(ISMRMRD::ISMRMRD_ACQ_COMPRESSION2);
-
-        header_bytes_sent_ += boost::asio::write(*socket_, boost::asio::buffer(&id, sizeof(GadgetMessageIdentifier)));
-        header_bytes_sent_ += boost::asio::write(*socket_, boost::asio::buffer(&h, sizeof(ISMRMRD::AcquisitionHeader)));
-
-        unsigned long trajectory_elements = acq.getHead().trajectory_dimensions*acq.getHead().number_of_samples;
-        unsigned long data_elements = acq.getHead().active_channels*acq.getHead().number_of_samples;
-
-        if (trajectory_elements) {
-            header_bytes_sent_ += boost::asio::write(*socket_, boost::asio::buffer(&acq.getTrajPtr()[0], sizeof(float)*trajectory_elements));
-        }
-
-
-        if (data_elements) {
-            std::vector<float> input_data((float*)&acq.getDataPtr()[0], (float*)&acq.getDataPtr()[0] + acq.getHead().active_channels*acq.getHead().number_of_samples*2);
-
-            std::unique_ptr<CompressedFloatBuffer> comp_buffer(CompressedFloatBuffer::createCompressedBuffer());
-            comp_buffer->compress(input_data, -1.0, compression_precision);
-            std::vector<uint8_t> serialized_buffer = comp_buffer->serialize();
- 
-            compressed_bytes_sent_ += serialized_buffer.size();
-            uncompressed_bytes_sent_ += data_elements*2*sizeof(float);
-                            
-            uint32_t bs = (uint32_t)serialized_buffer.size();
-            boost::asio::write(*socket_, boost::asio::buffer(&bs, sizeof(uint32_t)));
-            boost::asio::write(*socket_, boost::asio::buffer(&serialized_buffer[0], serialized_buffer.size()));
-        }
-        
+        return images_received_;
     }
 
-
-    void send_ismrmrd_compressed_acquisition_tolerance(ISMRMRD::Acquisition& acq, float compression_tolerance, NoiseStatistics& stat) 
+    /// Seconds from connecting to the last image received
+    double time_to_last_image() const
     {
-        if (!socket_) {
-            throw GadgetronClientException("Invalid socket.");
-        }
-
-        GadgetMessageIdentifier id;
-        id.id = GADGET_MESSAGE_ISMRMRD_ACQUISITION;
-
-        ISMRMRD::AcquisitionHeader h = acq.getHead(); //We will make a copy because we will be setting some flags
-        h.setFlag(ISMRMRD::ISMRMRD_ACQ_COMPRESSION2);
-
-        header_bytes_sent_ += boost::asio::write(*socket_, boost::asio::buffer(&id, sizeof(GadgetMessageIdentifier)));
-        header_bytes_sent_ += boost::asio::write(*socket_, boost::asio::buffer(&h, sizeof(ISMRMRD::AcquisitionHeader)));
-
-        unsigned long trajectory_elements = acq.getHead().trajectory_dimensions*acq.getHead().number_of_samples;
-        unsigned long data_elements = acq.getHead().active_channels*acq.getHead().number_of_samples;
-
-        if (trajectory_elements) {
-            header_bytes_sent_ += boost::asio::write(*socket_, boost::asio::buffer(&acq.getTrajPtr()[0], sizeof(float)*trajectory_elements));
-        }
-
-
-        if (data_elements) {
-            std::vector<float> input_data((float*)&acq.getDataPtr()[0], (float*)&acq.getDataPtr()[0] + acq.getHead().active_channels* acq.getHead().number_of_samples*2);
-
-            float local_tolerance = compression_tolerance;
-            float sigma = stat.sigma_min; //We use the minimum sigma of all channels to "cap" the error
-            if (stat.status && sigma > 0 && stat.noise_dwell_time_us && acq.getHead().sample_time_us) {
-                local_tolerance = local_tolerance*stat.sigma_min*acq.getHead().sample_time_us*std::sqrt(stat.noise_dwell_time_us/acq.getHead().sample_time_us);
-            }
-
-            std::unique_ptr<CompressedFloatBuffer> comp_buffer(CompressedFloatBuffer::createCompressedBuffer());
-            comp_buffer->compress(input_data, local_tolerance);
-            std::vector<uint8_t> serialized_buffer = comp_buffer->serialize();
-
-            compressed_bytes_sent_ += serialized_buffer.size();
-            uncompressed_bytes_sent_ += data_elements*2*sizeof(float);
-
-            uint32_t bs = (uint32_t)serialized_buffer.size();
-            boost::asio::write(*socket_, boost::asio::buffer(&bs, sizeof(uint32_t)));
-            boost::asio::write(*socket_, boost::asio::buffer(&serialized_buffer[0], serialized_buffer.size()));
-        }
-    }
-
-    void send_ismrmrd_zfp_compressed_acquisition_precision(ISMRMRD::Acquisition& acq, unsigned int compression_precision) 
-    {
-
-#if defined GADGETRON_COMPRESSION_ZFP
-        if (!socket_) {
-            throw GadgetronClientException("Invalid socket.");
-        }
-
-        GadgetMessageIdentifier id;
-        //TODO: switch data type
-        id.id = GADGET_MESSAGE_ISMRMRD_ACQUISITION;
-
-        ISMRMRD::AcquisitionHeader h = acq.getHead(); //We will make a copy because we will be setting some flags
-        h.setFlag(ISMRMRD::ISMRMRD_ACQ_COMPRESSION1);
-
-        header_bytes_sent_ += boost::asio::write(*socket_, boost::asio::buffer(&id, sizeof(GadgetMessageIdentifier)));
-        header_bytes_sent_ += boost::asio::write(*socket_, boost::asio::buffer(&h, sizeof(ISMRMRD::AcquisitionHeader)));
-
-        unsigned long trajectory_elements = acq.getHead().trajectory_dimensions*acq.getHead().number_of_samples;
-        unsigned long data_elements = acq.getHead().active_channels*acq.getHead().number_of_samples;
-
-        if (trajectory_elements) {
-            header_bytes_sent_ += boost::asio::write(*socket_, boost::asio::buffer(&acq.getTrajPtr()[0], sizeof(float)*trajectory_elements));
-        }
-
-
-        if (data_elements) {
-            size_t comp_buffer_size = 4*sizeof(float)*data_elements;
-            char* comp_buffer = new char[comp_buffer_size];
-            size_t compressed_size = 0;
-            try {
-                compressed_size = compress_zfp_precision((float*)&acq.getDataPtr()[0],
-                                                         acq.getHead().number_of_samples*2, acq.getHead().active_channels,
-                                                         compression_precision, comp_buffer, comp_buffer_size);
-
-                compressed_bytes_sent_ += compressed_size;
-                uncompressed_bytes_sent_ += data_elements*2*sizeof(float);
-                float compression_ratio = (1.0*data_elements*2*sizeof(float))/(float)compressed_size;
-                //std::cout << "Compression ratio: " << compression_ratio << std::endl;
-                
-            } catch (...) {
-                delete [] comp_buffer;
-                std::cout << "Compression failure caught" << std::endl;
-                throw;
-            }
-
-
-            //TODO: Write compressed buffer
-            uint32_t bs = (uint32_t)compressed_size;
-            boost::asio::write(*socket_, boost::asio::buffer(&bs, sizeof(uint32_t)));
-            boost::asio::write(*socket_, boost::asio::buffer(comp_buffer, compressed_size));
-
-            delete [] comp_buffer;
-        }
-
-#else //GADGETRON_COMPRESSION_ZFP
-        throw GadgetronClientException("Attempting to do ZFP compression, but ZFP not available");
-#endif //GADGETRON_COMPRESSION_ZFP
-    }
-
-    void send_ismrmrd_zfp_compressed_acquisition_tolerance(ISMRMRD::Acquisition& acq, float compression_tolerance, NoiseStatistics& stat) 
-    {
-#if defined GADGETRON_COMPRESSION_ZFP
-        if (!socket_) {
-            throw GadgetronClientException("Invalid socket.");
-        }
-
-        GadgetMessageIdentifier id;
-        //TODO: switch data type
-        id.id = GADGET_MESSAGE_ISMRMRD_ACQUISITION;
-
-        ISMRMRD::AcquisitionHeader h = acq.getHead(); //We will make a copy because we will be setting some flags
-        h.setFlag(ISMRMRD::ISMRMRD_ACQ_COMPRESSION1);
-
-        header_bytes_sent_ += boost::asio::write(*socket_, boost::asio::buffer(&id, sizeof(GadgetMessageIdentifier)));
-        header_bytes_sent_ += boost::asio::write(*socket_, boost::asio::buffer(&h, sizeof(ISMRMRD::AcquisitionHeader)));
-
-        unsigned long trajectory_elements = acq.getHead().trajectory_dimensions*acq.getHead().number_of_samples;
-        unsigned long data_elements = acq.getHead().active_channels*acq.getHead().number_of_samples;
-
-        if (trajectory_elements) {
-            header_bytes_sent_ += boost::asio::write(*socket_, boost::asio::buffer(&acq.getTrajPtr()[0], sizeof(float)*trajectory_elements));
-        }
-
-        float local_tolerance = compression_tolerance;
-        float sigma = stat.sigma_min; //We use the minimum sigma of all channels to "cap" the error
-        if (stat.status && sigma > 0 && stat.noise_dwell_time_us && acq.getHead().sample_time_us) {
-            local_tolerance = local_tolerance*stat.sigma_min*acq.getHead().sample_time_us*std::sqrt(stat.noise_dwell_time_us/acq.getHead().sample_time_us);
-        }
-
-        if (data_elements) {
-            size_t comp_buffer_size = 4*sizeof(float)*data_elements;
-            char* comp_buffer = new char[comp_buffer_size];
-            size_t compressed_size = 0;
-            try {
-                compressed_size = compress_zfp_tolerance((float*)&acq.getDataPtr()[0],
-                                                         acq.getHead().number_of_samples*2, acq.getHead().active_channels,
-                                                         local_tolerance, comp_buffer, comp_buffer_size);
-
-                compressed_bytes_sent_ += compressed_size;
-                uncompressed_bytes_sent_ += data_elements*2*sizeof(float);
-                float compression_ratio = (1.0*data_elements*2*sizeof(float))/(float)compressed_size;
-                //std::cout << "Compression ratio: " << compression_ratio << std::endl;
-                
-            } catch (...) {
-                delete [] comp_buffer;
-                std::cout << "Compression failure caught" << std::endl;
-                throw;
-            }
-
-
-            //TODO: Write compressed buffer
-            uint32_t bs = (uint32_t)compressed_size;
-            boost::asio::write(*socket_, boost::asio::buffer(&bs, sizeof(uint32_t)));
-            boost::asio::write(*socket_, boost::asio::buffer(comp_buffer, compressed_size));
-
-            delete [] comp_buffer;
-        }
-#else //GADGETRON_COMPRESSION_ZFP
-        throw GadgetronClientException("Attempting to do ZFP compression, but ZFP not available");
-#endif //GADGETRON_COMPRESSION_ZFP
-
-    }
-
-    void send_ismrmrd_waveform(ISMRMRD::Waveform& wav)
-    {
-        if (!socket_)
-        {
-            throw GadgetronClientException("Invalid socket.");
-        }
-
-        GadgetMessageIdentifier id;
-        id.id = GADGET_MESSAGE_ISMRMRD_WAVEFORM;;
-
-        header_bytes_sent_ += boost::asio::write(*socket_, boost::asio::buffer(&id, sizeof(GadgetMessageIdentifier)));
-        header_bytes_sent_ += boost::asio::write(*socket_, boost::asio::buffer(&wav.head, sizeof(ISMRMRD::ISMRMRD_WaveformHeader)));
-
-        unsigned long data_elements = wav.head.channels*wav.head.number_of_samples;
-
-        if (data_elements)
-        {
-            header_bytes_sent_ += boost::asio::write(*socket_, boost::asio::buffer(wav.begin_data(), sizeof(uint32_t)*data_elements));
-        }
+        return std::chrono::duration<double>(last_image_ - connected_).count();
     }
 
     void register_reader(unsigned short slot, std::shared_ptr<GadgetronClientMessageReader> r) {
@@ -1557,13 +1539,17 @@ protected:
     }
 
     boost::asio::io_service io_service;
-    tcp::socket* socket_;
+    Socket* socket_;
     std::thread reader_thread_;
+    std::exception_ptr reader_error_;
     maptype readers_;
     unsigned int timeout_ms_;
     double header_bytes_sent_;
     double uncompressed_bytes_sent_;
     double compressed_bytes_sent_;
+    size_t images_received_;
+    std::chrono::steady_clock::time_point connected_;
+    std::chrono::steady_clock::time_point last_image_;
 };
 
 
@@ -1581,7 +1567,7 @@ public:
     
   }
 
-  virtual void read(tcp::socket* stream)
+  virtual void read(Socket* stream)
   {
     size_t recv_count = 0;
     
@@ -1664,38 +1650,322 @@ NoiseStatistics get_noise_statistics(std::string dependency_name, std::string ho
     return stat;
 }
 
-void send_ismrmrd_acq(GadgetronClientConnector& con, ISMRMRD::Acquisition& acq_tmp, 
-    unsigned int compression_precision, bool use_zfp_compression, float compression_tolerance, NoiseStatistics& noise_stats)
+/**
+ * Queue between the stages of the sending pipeline. Push blocks while the queue is full; once the queue is closed,
+ * push fails, and pop fails as soon as the queue is empty.
+ */
+template <class T>
+class GadgetronClientQueue
 {
-    try
+public:
+    explicit GadgetronClientQueue(size_t capacity)
+        : capacity_(capacity)
+        , closed_(false)
     {
-        if (compression_precision > 0)
-        {
-            if (use_zfp_compression) {
-                con.send_ismrmrd_zfp_compressed_acquisition_precision(acq_tmp, compression_precision);
-            }
-            else {
-                con.send_ismrmrd_compressed_acquisition_precision(acq_tmp, compression_precision);
+    }
+
+    bool push(T item)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        changed_.wait(lock, [&]() { return closed_ || items_.size() < capacity_; });
+        if (closed_) return false;
+
+        items_.push_back(std::move(item));
+        changed_.notify_all();
+        return true;
+    }
+
+    bool pop(T& item)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        changed_.wait(lock, [&]() { return closed_ || !items_.empty(); });
+        if (items_.empty()) return false;
+
+        item = std::move(items_.front());
+        items_.pop_front();
+        changed_.notify_all();
+        return true;
+    }
+
+    void close()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        changed_.notify_all();
+    }
+
+protected:
+    size_t capacity_;
+    bool closed_;
+    std::deque<T> items_;
+    std::mutex mutex_;
+    std::condition_variable changed_;
+};
+
+/**
+ * Threads serializing (and compressing) acquisitions for every connection of the client.
+ */
+class GadgetronClientEncoderPool
+{
+public:
+    explicit GadgetronClientEncoderPool(size_t threads)
+        : tasks_(std::numeric_limits<size_t>::max())
+    {
+        for (size_t n = 0; n < std::max<size_t>(threads, 1); n++) {
+            threads_.emplace_back([this]() {
+                std::packaged_task<GadgetronClientMessage()> task;
+                while (tasks_.pop(task)) task();
+            });
+        }
+    }
+
+    ~GadgetronClientEncoderPool()
+    {
+        tasks_.close();
+        for (auto& t : threads_) t.join();
+    }
+
+    std::future<GadgetronClientMessage> submit(std::function<GadgetronClientMessage()> encode)
+    {
+        std::packaged_task<GadgetronClientMessage()> task(std::move(encode));
+        auto message = task.get_future();
+        tasks_.push(std::move(task));
+        return message;
+    }
+
+protected:
+    GadgetronClientQueue<std::packaged_task<GadgetronClientMessage()>> tasks_;
+    std::vector<std::thread> threads_;
+};
+
+struct GadgetronClientReplaySettings
+{
+    /// Replay at this many times the recorded scanner timing; 0 sends as fast as possible
+    double speed = 0;
+    /// Duration of one tick of the acquisition and waveform time stamps
+    double time_stamp_tick_ms = 2.5;
+    /// Messages read and encoded ahead of the socket writer
+    size_t prefetch = 256;
+    bool verbose = false;
+};
+
+/**
+ * Sends the acquisitions and waveforms of a dataset on a connection, in time stamp order. A reader thread reads
+ * ahead of the socket, the encoder pool compresses acquisitions in parallel, and the thread calling 'run' writes
+ * the messages in order, paced by their time stamps when replaying at scanner timing.
+ */
+class GadgetronClientSender
+{
+public:
+    typedef std::function<GadgetronClientMessage(const ISMRMRD::Acquisition&)> AcquisitionEncoder;
+
+    GadgetronClientSender(GadgetronClientConnector& con, std::shared_ptr<ISMRMRD::Dataset> dataset,
+                          GadgetronClientEncoderPool& encoders, AcquisitionEncoder encode, GadgetronClientReplaySettings settings)
+        : con_(con)
+        , dataset_(dataset)
+        , encoders_(encoders)
+        , encode_(encode)
+        , settings_(settings)
+        , queue_(std::max<size_t>(settings.prefetch, 1))
+    {
+    }
+
+    void run()
+    {
+        std::exception_ptr reader_error;
+        std::thread reader([&]() {
+            try {
+                this->read_task();
+            } catch (...) {
+                reader_error = std::current_exception();
             }
+            queue_.close();
+        });
+
+        try {
+            this->write_task();
+        } catch (...) {
+            queue_.close();
+            reader.join();
+            throw;
+        }
+
+        reader.join();
+        if (reader_error) std::rethrow_exception(reader_error);
+    }
+
+protected:
+    struct Pending
+    {
+        uint32_t time_stamp;
+        std::string description;
+        std::future<GadgetronClientMessage> message;
+    };
+
+    void read_task()
+    {
+        uint32_t acquisitions = 0;
+        uint32_t waveforms = 0;
+        {
+            std::lock_guard<std::mutex> scoped_lock(mtx);
+            acquisitions = dataset_->getNumberOfAcquisitions();
+            waveforms = dataset_->getNumberOfWaveforms();
         }
-        else if (compression_tolerance > 0.0)
+
+        if (settings_.verbose)
+        {
+            std::cout << "Find " << acquisitions << " ismrmrd acquisitions" << std::endl;
+            std::cout << "Find " << waveforms << " ismrmrd waveforms" << std::endl;
+        }
+
+        auto acq = std::make_shared<ISMRMRD::Acquisition>();
+        ISMRMRD::Waveform wav;
+
+        uint32_t i(0), j(0); // i : index over the acquisition; j : index over the waveform
+
+        if (i < acquisitions) read_acquisition(i, *acq);
+        if (j < waveforms) read_waveform(j, wav);
+
+        // Waveforms go first only if they are strictly older than the next acquisition
+        while (i < acquisitions || j < waveforms)
         {
-            if (use_zfp_compression) {
-                con.send_ismrmrd_zfp_compressed_acquisition_tolerance(acq_tmp, compression_tolerance, noise_stats);
+            bool send_waveform = j < waveforms && (i == acquisitions || wav.head.time_stamp < acq->getHead().acquisition_time_stamp);
+
+            Pending pending;
+            if (send_waveform)
+            {
+                pending.time_stamp = wav.head.time_stamp;
+                pending.message = ready(serialize_ismrmrd_waveform(wav));
+
+                if (settings_.verbose)
+                {
+                    std::stringstream description;
+                    description << "--> Send out ismrmrd waveform : " << j << " - " << wav.head.scan_counter
+                        << " - " << wav.head.time_stamp
+                        << " - " << wav.head.channels
+                        << " - " << wav.head.number_of_samples
+                        << " - " << wav.head.waveform_id;
+                    pending.description = description.str();
+                }
+
+                if (++j < waveforms) read_waveform(j, wav);
             }
-            else {
-                con.send_ismrmrd_compressed_acquisition_tolerance(acq_tmp, compression_tolerance, noise_stats);
+            else
+            {
+                pending.time_stamp = acq->getHead().acquisition_time_stamp;
+                auto encode = encode_;
+                pending.message = encoders_.submit([encode, acq]() { return encode(*acq); });
+
+                if (settings_.verbose)
+                {
+                    std::stringstream description;
+                    description << "==> Send out ismrmrd acq : " << i << " - " << acq->getHead().scan_counter << " - " << acq->getHead().acquisition_time_stamp;
+                    pending.description = description.str();
+                }
+
+                acq = std::make_shared<ISMRMRD::Acquisition>();
+                if (++i < acquisitions) read_acquisition(i, *acq);
             }
+
+            if (!queue_.push(std::move(pending))) return;
         }
-        else
+    }
+
+    void write_task()
+    {
+        typedef std::chrono::steady_clock Clock;
+
+        bool first = true;
+        uint32_t first_time_stamp = 0;
+        Clock::time_point start;
+
+        Pending pending;
+        while (queue_.pop(pending))
         {
-            con.send_ismrmrd_acquisition(acq_tmp);
+            GadgetronClientMessage message = pending.message.get();
+
+            if (first)
+            {
+                first = false;
+                first_time_stamp = pending.time_stamp;
+                start = Clock::now();
+            }
+
+            if (settings_.speed > 0)
+            {
+                double elapsed_ms = (double)((int64_t)pending.time_stamp - (int64_t)first_time_stamp) * settings_.time_stamp_tick_ms / settings_.speed;
+                if (elapsed_ms > 0) {
+                    std::this_thread::sleep_until(start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(elapsed_ms)));
+                }
+            }
+
+            con_.send(message);
+
+            if (settings_.verbose) std::cout << pending.description << std::endl;
         }
     }
-    catch(...)
+
+    void read_acquisition(uint32_t i, ISMRMRD::Acquisition& acq)
     {
-        throw GadgetronClientException("send_ismrmrd_acq failed ... ");
+        std::lock_guard<std::mutex> scoped_lock(mtx);
+        dataset_->readAcquisition(i, acq);
     }
+
+    void read_waveform(uint32_t j, ISMRMRD::Waveform& wav)
+    {
+        std::lock_guard<std::mutex> scoped_lock(mtx);
+        dataset_->readWaveform(j, wav);
+    }
+
+    static std::future<GadgetronClientMessage> ready(GadgetronClientMessage message)
+    {
+        std::promise<GadgetronClientMessage> promise;
+        promise.set_value(std::move(message));
+        return promise.get_future();
+    }
+
+    GadgetronClientConnector& con_;
+    std::shared_ptr<ISMRMRD::Dataset> dataset_;
+    GadgetronClientEncoderPool& encoders_;
+    AcquisitionEncoder encode_;
+    GadgetronClientReplaySettings settings_;
+    GadgetronClientQueue<Pending> queue_;
+};
+
+GadgetronClientSender::AcquisitionEncoder make_acquisition_encoder(unsigned int compression_precision, bool use_zfp_compression,
+                                                                   float compression_tolerance, NoiseStatistics noise_stats)
+{
+    return [=](const ISMRMRD::Acquisition& acq) {
+        try
+        {
+            if (compression_precision > 0)
+            {
+                if (use_zfp_compression) {
+                    return serialize_ismrmrd_zfp_compressed_acquisition_precision(acq, compression_precision);
+                }
+                else {
+                    return serialize_ismrmrd_compressed_acquisition_precision(acq, compression_precision);
+                }
+            }
+            else if (compression_tolerance > 0.0)
+            {
+                if (use_zfp_compression) {
+                    return serialize_ismrmrd_zfp_compressed_acquisition_tolerance(acq, compression_tolerance, noise_stats);
+                }
+                else {
+                    return serialize_ismrmrd_compressed_acquisition_tolerance(acq, compression_tolerance, noise_stats);
+                }
+            }
+            else
+            {
+                return serialize_ismrmrd_acquisition(acq);
+            }
+        }
+        catch(...)
+        {
+            throw GadgetronClientException("Encoding ismrmrd acquisition failed ... ");
+        }
+    };
 }
 
 int main(int argc, char **argv)
@@ -1718,7 +1988,9 @@ int main(int argc, char **argv)
     float compression_tolerance = 0.0;
     bool use_zfp_compression = false;
     bool verbose = false;
-    Gadgetron::GadgetronTimer timer(false);
+    unsigned int connections = 1;
+    unsigned int compression_threads = 1;
+    GadgetronClientReplaySettings replay;
 
     po::options_description desc("Allowed options");
 
@@ -1728,7 +2000,7 @@ int main(int argc, char **argv)
         ("verbose,v", "Verbose mode")
         ("info,Q", po::value<std::string>(), "Query Gadgetron information")
         ("port,p", po::value<std::string>(&port)->default_value("9002"), "Port")
-        ("address,a", po::value<std::string>(&host_name)->default_value("localhost"), "Address (hostname) of Gadgetron host")
+        ("address,a", po::value<std::string>(&host_name)->default_value("localhost"), "Address (hostname) of Gadgetron host; 'unix' connects to the Unix domain socket at the path given as port")
         ("filename,f", po::value<std::string>(&in_filename), "Input file")
         ("outfile,o", po::value<std::string>(&out_filename)->default_value("out.h5"), "Output file")
         ("in-group,g", po::value<std::string>(&hdf5_in_group)->default_value("/dataset"), "Input data group")
@@ -1740,6 +2012,11 @@ int main(int argc, char **argv)
         ("outformat,F", po::value<std::string>(&out_fileformat)->default_value("h5"), "Out format, h5 for hdf5 and hdr for analyze image")
         ("precision,P", po::value<unsigned int>(&compression_precision)->default_value(0), "Compression precision (bits)")
         ("tolerance,T", po::value<float>(&compression_tolerance)->default_value(0.0), "Compression tolerance (fraction of sigma, if no noise stats, assume sigma 1)")
+        ("connections,N", po::value<unsigned int>(&connections)->default_value(1), "Concurrent connections, each sending the whole input file")
+        ("speed,s", po::value<double>(&replay.speed)->default_value(0), "Replay at this multiple of the recorded scanner timing; 0 sends as fast as possible")
+        ("tick", po::value<double>(&replay.time_stamp_tick_ms)->default_value(2.5), "Duration of one acquisition time stamp tick [ms]")
+        ("prefetch", po::value<size_t>(&replay.prefetch)->default_value(256), "Messages read and compressed ahead of sending, per connection")
+        ("compression-threads", po::value<unsigned int>(&compression_threads)->default_value(std::max(1u, std::thread::hardware_concurrency())), "Threads compressing acquisitions")
 #if defined GADGETRON_COMPRESSION_ZFP
         ("ZFP,Z", po::value<bool>(&use_zfp_compression)->default_value(false), "Use ZFP library for compression");
 #endif //GADGETRON_COMPRESSION_ZFP
@@ -1767,6 +2044,11 @@ int main(int argc, char **argv)
     if (vm.count("verbose")) {
         verbose = true;
     }
+    replay.verbose = verbose;
+
+    if (connections < 1 || vm.count("query") || vm.count("info")) {
+        connections = 1;
+    }
 
     if (vm.count("config-local")) {
         std::ifstream t(config_file_local.c_str());
@@ -1812,6 +2094,12 @@ int main(int argc, char **argv)
       std::cout << "  -- loop            :      " << loops << std::endl;
       std::cout << "  -- hdf5 file out   :      " << out_filename << std::endl;
       std::cout << "  -- hdf5 group out  :      " << hdf5_out_group << std::endl;
+      if (connections > 1) {
+        std::cout << "  -- connections     :      " << connections << std::endl;
+      }
+      if (replay.speed > 0) {
+        std::cout << "  -- replay speed    :      " << replay.speed << "x" << std::endl;
+      }
     }
 
 
@@ -1847,26 +2135,41 @@ int main(int argc, char **argv)
         }
     }
 
-    GadgetronClientConnector con;
-    con.set_timeout(timeout_ms);
+    GadgetronClientEncoderPool encoders(compression_threads);
+    auto encode = make_acquisition_encoder(compression_precision, use_zfp_compression, compression_tolerance, noise_stats);
 
-    if ( out_fileformat == "hdr" )
-    {
-        con.register_reader(GADGET_MESSAGE_ISMRMRD_IMAGE, std::shared_ptr<GadgetronClientMessageReader>(new GadgetronClientAnalyzeImageMessageReader(hdf5_out_group)));
-    }
-    else
+    struct ConnectionReport
     {
-        con.register_reader(GADGET_MESSAGE_ISMRMRD_IMAGE, std::shared_ptr<GadgetronClientMessageReader>(new GadgetronClientImageMessageReader(out_filename, hdf5_out_group)));
-    }
+        double transmission_time_s = 0;
+        double transmitted_mb = 0;
+        size_t images = 0;
+        double time_to_last_image_s = 0;
+    };
 
-    con.register_reader(GADGET_MESSAGE_DICOM_WITHNAME, std::shared_ptr<GadgetronClientMessageReader>(new GadgetronClientBlobMessageReader(std::string(hdf5_out_group), std::string("dcm"))));
+    auto run_connection = [&](unsigned int n) {
+        // Every connection after the first writes its images to a group of its own
+        std::string out_group = hdf5_out_group;
+        if (n > 0) out_group += "_" + std::to_string(n);
 
-    con.register_reader(GADGET_MESSAGE_DEPENDENCY_QUERY, std::shared_ptr<GadgetronClientMessageReader>(new GadgetronClientDependencyQueryReader(std::string(out_filename))));
-    con.register_reader(GADGET_MESSAGE_TEXT, std::shared_ptr<GadgetronClientMessageReader>(new GadgetronClientTextReader()));
-    con.register_reader(7, std::shared_ptr<GadgetronClientResponseReader>(new GadgetronClientResponseReader()));
+        GadgetronClientConnector con;
+        con.set_timeout(timeout_ms);
 
-    try
-    {
+        if ( out_fileformat == "hdr" )
+        {
+            con.register_reader(GADGET_MESSAGE_ISMRMRD_IMAGE, std::shared_ptr<GadgetronClientMessageReader>(new GadgetronClientAnalyzeImageMessageReader(out_group)));
+        }
+        else
+        {
+            con.register_reader(GADGET_MESSAGE_ISMRMRD_IMAGE, std::shared_ptr<GadgetronClientMessageReader>(new GadgetronClientImageMessageReader(out_filename, out_group)));
+        }
+
+        con.register_reader(GADGET_MESSAGE_DICOM_WITHNAME, std::shared_ptr<GadgetronClientMessageReader>(new GadgetronClientBlobMessageReader(std::string(out_group), std::string("dcm"))));
+
+        con.register_reader(GADGET_MESSAGE_DEPENDENCY_QUERY, std::shared_ptr<GadgetronClientMessageReader>(new GadgetronClientDependencyQueryReader(std::string(out_filename))));
+        con.register_reader(GADGET_MESSAGE_TEXT, std::shared_ptr<GadgetronClientMessageReader>(new GadgetronClientTextReader()));
+        con.register_reader(7, std::shared_ptr<GadgetronClientResponseReader>(new GadgetronClientResponseReader()));
+
+        Gadgetron::GadgetronTimer timer(false);
         timer.start();
         con.connect(host_name,port);
 
@@ -1886,159 +2189,83 @@ int main(int argc, char **argv)
         {
             con.send_gadgetron_parameters(xml_config);
 
-            uint32_t acquisitions = 0;
-            {
-                mtx.lock();
-                acquisitions = ismrmrd_dataset->getNumberOfAcquisitions();
-                mtx.unlock();
-            }
+            GadgetronClientSender sender(con, ismrmrd_dataset, encoders, encode, replay);
+            sender.run();
+        }
 
-            uint32_t waveforms = 0;
-            {
-                mtx.lock();
-                waveforms = ismrmrd_dataset->getNumberOfWaveforms();
-                mtx.unlock();
+        ConnectionReport report;
+        report.transmission_time_s = timer.stop()/1e6;
+        report.transmitted_mb = con.get_bytes_transmitted()/(1024*1024);
+
+        if (connections == 1)
+        {
+            if (compression_precision > 0 || compression_tolerance > 0.0) {
+                std::cout << "Compression ratio: " << con.compression_ratio() << std::endl;
             }
 
-            if(verbose)
-            {
-                std::cout << "Find " << acquisitions << " ismrmrd acquisitions" << std::endl;
-                std::cout << "Find " << waveforms << " ismrmrd waveforms" << std::endl;
+            if (verbose) {
+                std::cout << "Time sending: " << report.transmission_time_s << "s" << std::endl;
+                std::cout << "Data sent: " << report.transmitted_mb << "MB" << std::endl;
+                std::cout << "Transmission rate: " << report.transmitted_mb/report.transmission_time_s << "MB/s" << std::endl;
             }
+        }
 
-            ISMRMRD::Acquisition acq_tmp;
-            ISMRMRD::Waveform wav_tmp;
+        con.send_gadgetron_close();
+        con.wait();
 
-            uint32_t i(0), j(0); // i : index over the acquisition; j : index over the waveform
+        report.images = con.images_received();
+        report.time_to_last_image_s = con.time_to_last_image();
+        return report;
+    };
 
-            if(waveforms>0)
-            {
-                {
-                    std::lock_guard<std::mutex> scoped_lock(mtx);
-                    ismrmrd_dataset->readAcquisition(i, acq_tmp);
-                }
+    if (connections == 1)
+    {
+        try
+        {
+            run_connection(0);
+        }
+        catch (std::exception& ex)
+        {
+            std::cerr << "Error caught: " << ex.what() << std::endl;
+            return -1;
+        }
 
-                {
-                    std::lock_guard<std::mutex> scoped_lock(mtx);
-                    ismrmrd_dataset->readWaveform(j, wav_tmp);
-                }
+        return 0;
+    }
 
-                while(i<acquisitions && j<waveforms)
-                {
-                    while(wav_tmp.head.time_stamp < acq_tmp.getHead().acquisition_time_stamp)
-                    {
-                        con.send_ismrmrd_waveform(wav_tmp);
-
-                        if (verbose)
-                        {
-                            std::cout << "--> Send out ismrmrd waveform : " << j << " - " << wav_tmp.head.scan_counter 
-                                << " - " << wav_tmp.head.time_stamp 
-                                << " - " << wav_tmp.head.channels
-                                << " - " << wav_tmp.head.number_of_samples
-                                << " - " << wav_tmp.head.waveform_id
-                                << std::endl;
-                        }
-
-                        j++;
-
-                        if(j<waveforms)
-                        {
-                            std::lock_guard<std::mutex> scoped_lock(mtx);
-                            ismrmrd_dataset->readWaveform(j, wav_tmp);
-                        }
-                        else
-                        {
-                            break;
-                        }
-                    }
-
-                    while (acq_tmp.getHead().acquisition_time_stamp <= wav_tmp.head.time_stamp)
-                    {
-                        send_ismrmrd_acq(con, acq_tmp, compression_precision, use_zfp_compression, compression_tolerance, noise_stats);
-
-                        if (verbose)
-                        {
-                            std::cout << "==> Send out ismrmrd acq : " << i << " - " << acq_tmp.getHead().scan_counter << " - " << acq_tmp.getHead().acquisition_time_stamp << std::endl;
-                        }
-
-                        i++;
-
-                        if(i<acquisitions)
-                        {
-                            std::lock_guard<std::mutex> scoped_lock(mtx);
-                            ismrmrd_dataset->readAcquisition(i, acq_tmp);
-                        }
-                        else
-                        {
-                            break;
-                        }
-                    }
-
-                    if(j==waveforms && i<acquisitions)
-                    {
-                        send_ismrmrd_acq(con, acq_tmp, compression_precision, use_zfp_compression, compression_tolerance, noise_stats);
-
-                        for (uint32_t ia=i+1; ia<acquisitions; ia++)
-                        {
-                            {
-                                std::lock_guard<std::mutex> scoped_lock(mtx);
-                                ismrmrd_dataset->readAcquisition(ia, acq_tmp);
-                            }
-
-                            send_ismrmrd_acq(con, acq_tmp, compression_precision, use_zfp_compression, compression_tolerance, noise_stats);
-                        }
-                    }
-
-                    if (i==acquisitions && j<waveforms)
-                    {
-                        con.send_ismrmrd_waveform(wav_tmp);
-
-                        for (uint32_t iw = j + 1; iw<waveforms; iw++)
-                        {
-                            {
-                                std::lock_guard<std::mutex> scoped_lock(mtx);
-                                ismrmrd_dataset->readWaveform(iw, wav_tmp);
-                            }
-
-                            con.send_ismrmrd_waveform(wav_tmp);
-                        }
-                    }
-                }
+    std::vector<ConnectionReport> reports(connections);
+    std::vector<std::string> errors(connections);
+    std::vector<std::thread> threads;
+    for (unsigned int n = 0; n < connections; n++)
+    {
+        threads.emplace_back([&, n]() {
+            try
+            {
+                reports[n] = run_connection(n);
             }
-            else
+            catch (std::exception& ex)
             {
-                for (i=0; i<acquisitions; i++)
-                {
-                    {
-                        std::lock_guard<std::mutex> scoped_lock(mtx);
-                        ismrmrd_dataset->readAcquisition(i, acq_tmp);
-                    }
-
-                    send_ismrmrd_acq(con, acq_tmp, compression_precision, use_zfp_compression, compression_tolerance, noise_stats);
-                }
+                errors[n] = ex.what();
             }
-        }
-
-        if (compression_precision > 0 || compression_tolerance > 0.0) {
-            std::cout << "Compression ratio: " << con.compression_ratio() << std::endl;
-        }
+        });
+    }
+    for (auto& t : threads) t.join();
 
-        if (verbose) {
-            double transmission_time_s = timer.stop()/1e6;
-            double transmitted_mb = con.get_bytes_transmitted()/(1024*1024);
-            std::cout << "Time sending: " << transmission_time_s << "s" << std::endl;
-            std::cout << "Data sent: " << transmitted_mb << "MB" << std::endl;
-            std::cout << "Transmission rate: " << transmitted_mb/transmission_time_s << "MB/s" << std::endl;
+    int status = 0;
+    for (unsigned int n = 0; n < connections; n++)
+    {
+        if (!errors[n].empty())
+        {
+            std::cerr << "Connection " << n << ": error caught: " << errors[n] << std::endl;
+            status = -1;
+            continue;
         }
 
-        con.send_gadgetron_close();
-        con.wait();
-    }
-    catch (std::exception& ex)
-    {
-        std::cerr << "Error caught: " << ex.what() << std::endl;
-        return -1;
+        const ConnectionReport& r = reports[n];
+        std::cout << "Connection " << n << ": sent " << r.transmitted_mb << "MB in " << r.transmission_time_s << "s ("
+            << r.transmitted_mb/r.transmission_time_s << "MB/s); " << r.images << " images, last image after "
+            << r.time_to_last_image_s << "s" << std::endl;
     }
 
-    return 0;
+    return status;
 }
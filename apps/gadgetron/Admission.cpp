@@ -0,0 +1,415 @@
+#include "Admission.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <thread>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
+#include <pugixml.hpp>
+
+#include "hoNDArray_memory.h"
+#include "log.h"
+
+#ifndef _WIN32
+#include <cerrno>
+#include <climits>
+#include <sched.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <linux/futex.h>
+#endif
+
+using namespace Gadgetron::Server::Admission;
+
+namespace {
+
+    constexpr const char *class_parameter = "GadgetronConnectionClass";
+
+    /// Queued connections are woken when a connection starts or finishes. They check anyway at this interval, to
+    /// notice connections that died without releasing their place, and memory freed by running connections.
+    constexpr auto recheck_interval = std::chrono::seconds(1);
+
+    constexpr size_t max_entries = 4096;
+
+    /// A queued or running connection. Entries live in memory shared with forked processes, so every connection
+    /// of the server sees every other.
+    struct Entry {
+        std::atomic<int64_t> pid;
+        std::atomic<int32_t> connection_class;
+        std::atomic<int32_t> priority;
+        std::atomic<uint64_t> ticket;
+        std::atomic<bool> running;
+    };
+
+    struct Queue {
+        std::atomic<int64_t> lock;
+        std::atomic<uint64_t> next_ticket;
+        std::atomic<size_t> used;
+        /// Bumped when a connection starts or finishes; queued connections wait for it to change (a futex on Linux).
+        std::atomic<uint32_t> changes;
+        Entry entries[max_entries];
+    };
+
+    Settings settings;
+    Queue *queue = nullptr;
+    thread_local bool client_connection = false;
+
+    int64_t current_pid() {
+#ifdef _WIN32
+        return 1;
+#else
+        return getpid();
+#endif
+    }
+
+    bool alive(int64_t pid) {
+#ifdef _WIN32
+        return true;
+#else
+        return kill(pid_t(pid), 0) == 0 || errno != ESRCH;
+#endif
+    }
+
+    Queue *create_queue() {
+#ifndef _WIN32
+        void *memory = mmap(nullptr, sizeof(Queue), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (memory != MAP_FAILED) return new(memory) Queue();
+#endif
+        return new Queue();
+    }
+
+    /// Held while the queue is inspected or changed. A process dying while holding it does not block the rest.
+    class QueueLock {
+    public:
+        QueueLock() {
+            auto pid = current_pid();
+            while (true) {
+                int64_t holder = 0;
+                if (queue->lock.compare_exchange_weak(holder, pid)) return;
+                if (holder != 0 && holder != pid && !alive(holder) && queue->lock.compare_exchange_strong(holder, pid)) return;
+                std::this_thread::yield();
+            }
+        }
+
+        ~QueueLock() { queue->lock = 0; }
+    };
+
+    /// Wakes the queued connections of every process sharing the queue.
+    void notify_queued() {
+        queue->changes++;
+#ifdef __linux__
+        syscall(SYS_futex, &queue->changes, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#endif
+    }
+
+    /// Waits for the queue to change from 'seen', or for the recheck interval to pass.
+    void wait_for_change(uint32_t seen) {
+#ifdef __linux__
+        auto seconds = std::chrono::duration_cast<std::chrono::seconds>(recheck_interval);
+        timespec timeout{ time_t(seconds.count()), 0 };
+        syscall(SYS_futex, &queue->changes, FUTEX_WAIT, seen, &timeout, nullptr, 0);
+#else
+        auto deadline = std::chrono::steady_clock::now() + recheck_interval;
+        while (queue->changes == seen && std::chrono::steady_clock::now() < deadline)
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+#endif
+    }
+
+    bool in_use(const Entry &entry) {
+        auto pid = entry.pid.load();
+        return pid != 0 && alive(pid);
+    }
+
+    size_t enqueue(int32_t connection_class, int32_t priority) {
+        QueueLock lock;
+        auto pid = current_pid();
+
+        for (size_t i = 0; i < max_entries; i++) {
+            auto &entry = queue->entries[i];
+            auto holder = entry.pid.load();
+            if (holder != 0 && alive(holder)) continue;
+
+            entry.pid = pid;
+            entry.connection_class = connection_class;
+            entry.priority = priority;
+            entry.ticket = queue->next_ticket++;
+            entry.running = false;
+
+            if (queue->used < i + 1) queue->used = i + 1;
+            return i;
+        }
+        throw std::runtime_error("Too many connections queued; connection refused.");
+    }
+
+    bool ahead_of(const Entry &a, const Entry &b) {
+        return a.priority > b.priority || (a.priority == b.priority && a.ticket < b.ticket);
+    }
+
+    /// Starts the connection of the entry if no connection queued ahead of it could start instead.
+    bool try_start(size_t index) {
+        QueueLock lock;
+        auto &mine = queue->entries[index];
+
+        std::vector<size_t> running(settings.classes.size(), 0);
+        size_t total = 0;
+        for (size_t i = 0; i < queue->used; i++) {
+            auto &entry = queue->entries[i];
+            if (!in_use(entry) || !entry.running) continue;
+            total++;
+            if (entry.connection_class >= 0) running[entry.connection_class]++;
+        }
+
+        // While the connections running hold more than the server memory budget, no more start. The first one
+        // always may, so memory held outside connections does not stall the server.
+        const bool over_budget = total && Gadgetron::MappedMemory::server_over_budget();
+
+        auto may_run = [&](const Entry &entry) {
+            if (over_budget) return false;
+            if (settings.max_connections && total >= settings.max_connections) return false;
+            if (entry.connection_class < 0) return true;
+            auto limit = settings.classes[entry.connection_class].max_concurrent;
+            return !limit || running[entry.connection_class] < limit;
+        };
+
+        if (!may_run(mine)) return false;
+        for (size_t i = 0; i < queue->used; i++) {
+            auto &entry = queue->entries[i];
+            if (i == index || !in_use(entry) || entry.running) continue;
+            if (ahead_of(entry, mine) && may_run(entry)) return false;
+        }
+
+        mine.running = true;
+        return true;
+    }
+
+    bool try_run(size_t index) {
+        if (!try_start(index)) return false;
+        // Connections queued behind one that started may now be the first that can run.
+        notify_queued();
+        return true;
+    }
+
+    void write_file(const boost::filesystem::path &filename, const std::string &value) {
+        std::ofstream file(filename.string());
+        file << value;
+        file.close();
+        if (!file) throw std::runtime_error("Could not write '" + value + "' to " + filename.string());
+    }
+
+    void place_in_cgroup(const ConnectionClass &connection_class) {
+        auto group = settings.cgroup_root / connection_class.name;
+        boost::filesystem::create_directories(group);
+
+        if (connection_class.cpu_weight)
+            write_file(group / "cpu.weight", std::to_string(connection_class.cpu_weight));
+        if (connection_class.memory_limit_MB)
+            write_file(group / "memory.max", std::to_string(connection_class.memory_limit_MB << 20));
+
+        write_file(group / "cgroup.procs", std::to_string(current_pid()));
+    }
+
+    /// Threads started by the connection from here on inherit the niceness and affinity of the calling thread.
+    void apply(const ConnectionClass &connection_class) {
+#ifndef _WIN32
+        if (connection_class.nice) {
+            if (setpriority(PRIO_PROCESS, id_t(syscall(SYS_gettid)), *connection_class.nice) != 0)
+                GWARN_STREAM("Could not set niceness " << *connection_class.nice << " of connection class "
+                             << connection_class.name << ": " << std::strerror(errno));
+        }
+
+        if (!connection_class.cpus.empty()) {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            for (auto cpu : connection_class.cpus) CPU_SET(cpu, &cpus);
+            if (sched_setaffinity(0, sizeof(cpus), &cpus) != 0)
+                GWARN_STREAM("Could not set CPU affinity of connection class " << connection_class.name
+                             << ": " << std::strerror(errno));
+        }
+
+        if (!settings.processes) return;
+
+        if (connection_class.memory_budget_MB) {
+            auto budget = Gadgetron::MappedMemory::budget();
+            budget.connection_bytes = connection_class.memory_budget_MB << 20;
+            Gadgetron::MappedMemory::set_budget(budget);
+        }
+
+        if (!settings.cgroup_root.empty()) {
+            try {
+                place_in_cgroup(connection_class);
+            }
+            catch (const std::exception &e) {
+                GWARN_STREAM("Could not place connection in cgroup of class " << connection_class.name
+                             << ": " << e.what());
+            }
+        }
+#endif
+    }
+
+    const ConnectionClass *find_class(const std::string &name) {
+        for (auto &connection_class : settings.classes) {
+            if (connection_class.name == name) return &connection_class;
+        }
+        return nullptr;
+    }
+}
+
+namespace Gadgetron::Server::Admission {
+
+    std::vector<unsigned int> parse_cpus(const std::string &cpus) {
+        std::vector<unsigned int> result;
+
+        std::vector<std::string> ranges;
+        boost::split(ranges, cpus, boost::is_any_of(","));
+        for (auto &range : ranges) {
+            boost::trim(range);
+            if (range.empty()) continue;
+
+            auto dash = range.find('-');
+            auto first = unsigned(std::stoul(range.substr(0, dash)));
+            auto last = dash == std::string::npos ? first : unsigned(std::stoul(range.substr(dash + 1)));
+            if (last < first) throw std::runtime_error("Invalid CPU range: " + range);
+
+            for (auto cpu = first; cpu <= last; cpu++) result.push_back(cpu);
+        }
+        return result;
+    }
+
+    std::vector<ConnectionClass> parse_classes(std::istream &stream) {
+        pugi::xml_document document;
+        auto result = document.load(stream);
+        if (!result) throw std::runtime_error("Failed to parse connection classes: " + std::string(result.description()));
+
+        std::vector<ConnectionClass> classes;
+        for (auto node : document.child("connectionClasses").children("class")) {
+            ConnectionClass connection_class;
+
+            connection_class.name = node.child_value("name");
+            if (connection_class.name.empty()) throw std::runtime_error("Connection class without a name.");
+
+            connection_class.priority = node.child("priority").text().as_int(0);
+            connection_class.max_concurrent = node.child("maxConcurrent").text().as_ullong(0);
+            if (node.child("nice")) connection_class.nice = node.child("nice").text().as_int(0);
+            connection_class.cpus = parse_cpus(node.child_value("cpus"));
+            connection_class.cpu_weight = node.child("cpuWeight").text().as_ullong(0);
+            connection_class.memory_budget_MB = node.child("memoryBudget").text().as_ullong(0);
+            connection_class.memory_limit_MB = node.child("memoryLimit").text().as_ullong(0);
+
+            for (auto config : node.children("config")) connection_class.configs.emplace_back(config.child_value());
+
+            classes.push_back(std::move(connection_class));
+        }
+        return classes;
+    }
+
+    std::vector<ConnectionClass> load_classes(const boost::filesystem::path &filename) {
+        std::ifstream file(filename.string());
+        if (!file) throw std::runtime_error("Could not open connection classes file " + filename.string());
+        return parse_classes(file);
+    }
+
+    void configure(Settings new_settings) {
+        settings = std::move(new_settings);
+        auto limited = !settings.classes.empty() || settings.max_connections || settings.server_memory_budget;
+        if (!queue && limited) queue = create_queue();
+
+        for (auto &connection_class : settings.classes) {
+            GINFO_STREAM("Connection class " << connection_class.name << ": priority " << connection_class.priority
+                         << ", at most " << connection_class.max_concurrent << " concurrent (0 for no limit).");
+        }
+
+        if (!settings.cgroup_root.empty()) {
+            try {
+                boost::filesystem::create_directories(settings.cgroup_root);
+                write_file(settings.cgroup_root / "cgroup.subtree_control", "+cpu +memory");
+            }
+            catch (const std::exception &e) {
+                GWARN_STREAM("Could not enable cgroup controllers below " << settings.cgroup_root.string()
+                             << ": " << e.what());
+            }
+        }
+    }
+
+    void mark_client_connection() {
+        client_connection = true;
+    }
+
+    const ConnectionClass *select(const std::string &config_name, const ISMRMRD::IsmrmrdHeader *header) {
+        if (header && header->userParameters) {
+            for (auto &parameter : header->userParameters->userParameterString) {
+                if (parameter.name != class_parameter) continue;
+                if (auto connection_class = find_class(parameter.value)) return connection_class;
+                GWARN_STREAM("Unknown connection class requested: " << parameter.value);
+            }
+        }
+
+        for (auto &connection_class : settings.classes) {
+            auto &configs = connection_class.configs;
+            if (std::find(configs.begin(), configs.end(), config_name) != configs.end()) return &connection_class;
+        }
+
+        return find_class("default");
+    }
+
+    std::unique_ptr<Admitted> admit(const std::string &config_name, const ISMRMRD::IsmrmrdHeader *header) {
+        if (!queue || !client_connection) return nullptr;
+        client_connection = false;
+
+        auto connection_class = select(config_name, header);
+        auto name = connection_class ? connection_class->name : std::string("unrestricted");
+        auto index = connection_class ? int32_t(connection_class - settings.classes.data()) : -1;
+
+        auto entry = enqueue(index, connection_class ? connection_class->priority : 0);
+        auto admitted = std::make_unique<Admitted>(entry);
+
+        if (!try_run(entry)) {
+            GINFO_STREAM("Connection of class " << name << " queued; too many connections running, or the server "
+                         "memory budget exceeded (" << (Gadgetron::MappedMemory::server_allocated_bytes() >> 20)
+                         << " MiB held).");
+            auto queued = std::chrono::steady_clock::now();
+            while (true) {
+                auto seen = queue->changes.load();
+                if (try_run(entry)) break;
+                wait_for_change(seen);
+            }
+            GINFO_STREAM("Connection of class " << name << " admitted after "
+                         << std::chrono::duration<double>(std::chrono::steady_clock::now() - queued).count() << "s.");
+        }
+
+        if (connection_class) apply(*connection_class);
+        return admitted;
+    }
+
+    size_t queued() {
+        if (!queue) return 0;
+
+        QueueLock lock;
+        size_t count = 0;
+        for (size_t i = 0; i < queue->used; i++) {
+            auto &entry = queue->entries[i];
+            if (in_use(entry) && !entry.running) count++;
+        }
+        return count;
+    }
+
+    Admitted::Admitted(size_t entry) : entry(entry) {}
+
+    Admitted::~Admitted() {
+        auto &mine = queue->entries[entry];
+        mine.running = false;
+        mine.pid = 0;
+        notify_queued();
+    }
+}
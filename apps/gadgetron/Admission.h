@@ -0,0 +1,105 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem/path.hpp>
+#include <ismrmrd/xml.h>
+
+#include "Types.h"
+
+/**
+ * Admission control of client connections. Each connection belongs to a connection class, selected by the
+ * 'GadgetronConnectionClass' user parameter string of its ISMRMRD header, or else by the name of its config: the
+ * file name, or for a config sent as a string, the names of its gadgets joined by '+' (e.g. 'Noise+Remove+FFT').
+ * A class limits how many of its connections run at once; over the limit (or the server wide limit, or while the
+ * server holds more than its memory budget), connections wait in a queue, served by class priority and then by
+ * arrival. Once admitted, a connection runs with the
+ * scheduling priority, CPU affinity, cgroup and memory budget of its class.
+ *
+ * Classes are read from an XML file:
+ *
+ *  <connectionClasses>
+ *      <class>
+ *          <name>live</name>
+ *          <priority>10</priority>             Queued connections of higher priority are admitted first.
+ *          <maxConcurrent>4</maxConcurrent>    Connections of the class running at once; 0 for no limit.
+ *          <nice>-5</nice>                     Scheduling niceness of the connection's threads.
+ *          <cpus>0-7,16</cpus>                 CPUs the connection's threads run on; all if not given.
+ *          <cpuWeight>1000</cpuWeight>         cgroup cpu.weight (1-10000, default 100) of the class.
+ *          <memoryBudget>8192</memoryBudget>   MiB of arrays a connection holds before spilling to disk.
+ *          <memoryLimit>16384</memoryLimit>    MiB the class cgroup may use at most (memory.max).
+ *          <config>Generic_Cartesian_Grappa.xml</config>   Configs selecting the class; any number.
+ *      </class>
+ *  </connectionClasses>
+ *
+ * Connections not selecting a class belong to the class named 'default', if there is one, and are otherwise
+ * unrestricted. The cgroup settings and memory budget need a process per connection; they are ignored when
+ * connections are handled by threads.
+ */
+namespace Gadgetron::Server::Admission {
+
+    struct ConnectionClass {
+        std::string name;
+        int priority = 0;
+        size_t max_concurrent = 0;
+        Core::optional<int> nice;
+        std::vector<unsigned int> cpus;
+        size_t cpu_weight = 0;
+        size_t memory_budget_MB = 0;
+        size_t memory_limit_MB = 0;
+        std::vector<std::string> configs;
+    };
+
+    std::vector<ConnectionClass> load_classes(const boost::filesystem::path &filename);
+    std::vector<ConnectionClass> parse_classes(std::istream &stream);
+
+    /// Parses CPU lists such as "0-3,8,10-11"
+    std::vector<unsigned int> parse_cpus(const std::string &cpus);
+
+    struct Settings {
+        std::vector<ConnectionClass> classes;
+        /// Client connections running at once, across classes; 0 for no limit
+        size_t max_connections = 0;
+        /// If not empty, connections are placed in a cgroup (v2) per class below this directory
+        boost::filesystem::path cgroup_root;
+        /// Whether connections run in processes of their own
+        bool processes = false;
+        /// Whether a server memory budget is set; no connections start while the running ones hold more
+        bool server_memory_budget = false;
+    };
+
+    /// Must be called by the server before it handles any connection; processes forked after share the queue.
+    void configure(Settings settings);
+
+    /// Marks the calling thread as the main thread of a client connection. Connections the server makes to itself
+    /// (e.g. in-process workers) are not subject to admission, as they are already part of an admitted connection.
+    void mark_client_connection();
+
+    /// The class a connection belongs to; nullptr for unrestricted connections
+    const ConnectionClass *select(const std::string &config_name, const ISMRMRD::IsmrmrdHeader *header);
+
+    /// A connection's place among the running connections; released as it is destroyed
+    class Admitted {
+    public:
+        explicit Admitted(size_t entry);
+        ~Admitted();
+
+        Admitted(const Admitted &) = delete;
+        Admitted &operator=(const Admitted &) = delete;
+
+    private:
+        const size_t entry;
+    };
+
+    /**
+     * Waits until the connection may run, then applies the resources of its class to the calling thread (and
+     * process). Returns nullptr right away if admission is not configured, or the calling thread is not the main
+     * thread of a client connection.
+     */
+    std::unique_ptr<Admitted> admit(const std::string &config_name, const ISMRMRD::IsmrmrdHeader *header);
+
+    /// Client connections waiting to be admitted, in every process of the server
+    size_t queued();
+}
@@ -1,7 +1,10 @@
 #include "Connection.h"
 #include <iostream>
 #include <memory>
+#include <mutex>
+#include <set>
 
+#include "Admission.h"
 #include "Context.h"
 
 #include "connection/Core.h"
@@ -23,12 +26,28 @@ namespace Gadgetron::Server::Connection {
             const std::string& storage_address,
             std::unique_ptr<std::iostream> stream
     ) {
-        auto thread = std::thread(handle_connection, std::move(stream), paths, args, storage_address);
+        auto thread = std::thread([=](std::unique_ptr<std::iostream> stream) {
+            Admission::mark_client_connection();
+            handle_connection(std::move(stream), paths, args, storage_address);
+        }, std::move(stream));
         thread.detach();
     }
 
+    std::vector<long> connection_processes() {
+        return {};
+    }
+
+    bool connections_in_processes() {
+        return false;
+    }
+
 #else
 
+    namespace {
+        std::mutex children_mutex;
+        std::set<long> children;
+    }
+
     void handle(
             const Gadgetron::Core::StreamContext::Paths& paths,
             const Gadgetron::Core::StreamContext::Args& args,
@@ -37,13 +56,33 @@ namespace Gadgetron::Server::Connection {
     ) {
         auto pid = fork();
         if (pid == 0) {
+            Admission::mark_client_connection();
             handle_connection(std::move(stream), paths, args, storage_address);
             std::quick_exit(0);
         }
-        auto listen_for_close = [](auto pid) {int status; waitpid(pid,&status,0);};
+
+        {
+            std::lock_guard<std::mutex> guard(children_mutex);
+            children.insert(pid);
+        }
+
+        auto listen_for_close = [](auto pid) {
+            int status; waitpid(pid,&status,0);
+            std::lock_guard<std::mutex> guard(children_mutex);
+            children.erase(pid);
+        };
         std::thread t(listen_for_close,pid);
         t.detach();
     }
 
+    std::vector<long> connection_processes() {
+        std::lock_guard<std::mutex> guard(children_mutex);
+        return std::vector<long>(children.begin(), children.end());
+    }
+
+    bool connections_in_processes() {
+        return true;
+    }
+
 #endif
 }
@@ -2,6 +2,7 @@
 
 #include <memory>
 #include <iostream>
+#include <vector>
 
 #include "Context.h"
 
@@ -12,4 +13,10 @@ namespace Gadgetron::Server::Connection {
             const std::string& storage,
             std::unique_ptr<std::iostream> stream
     );
+
+    /// Process ids of connections currently handled in child processes; empty if connections are handled by threads
+    std::vector<long> connection_processes();
+
+    /// Whether connections are handled in child processes of their own
+    bool connections_in_processes();
 }
@@ -3,9 +3,15 @@
 
 #include <Context.h>
 
+#include <signal.h>
+#include <sys/un.h>
+#include <unistd.h>
+
 #include "log.h"
+#include "hoNDArray_memory.h"
 
 #include "Server.h"
+#include "Admission.h"
 #include "Connection.h"
 #include "connection/SocketStreamBuf.h"
 #include "system_info.h"
@@ -13,6 +19,42 @@
 using namespace boost::filesystem;
 using namespace Gadgetron::Server;
 
+namespace {
+
+    /// Path of the Unix domain socket, unlinked when the server is stopped by a signal.
+    char unix_socket_path[sizeof(sockaddr_un::sun_path)] = {};
+    pid_t server_pid = 0;
+
+    void unlink_unix_socket(int signal) {
+        // Connections forked from the server inherit the handler, but the socket belongs to the server.
+        if (getpid() == server_pid) unlink(unix_socket_path);
+        raise(signal);
+    }
+
+    void unlink_unix_socket_on_shutdown(const path &socket_path) {
+        socket_path.string().copy(unix_socket_path, sizeof(unix_socket_path) - 1);
+        server_pid = getpid();
+
+        struct sigaction action = {};
+        action.sa_handler = unlink_unix_socket;
+        action.sa_flags = SA_RESETHAND;
+        sigemptyset(&action.sa_mask);
+        for (auto signal : {SIGINT, SIGTERM, SIGHUP}) sigaction(signal, &action, nullptr);
+    }
+
+    /// Accepts connections for as long as the executor runs, handing each socket to 'handle_socket'.
+    template<class Acceptor, class F>
+    void accept_connections(Acceptor &acceptor, F handle_socket) {
+        acceptor.async_accept([&acceptor, handle_socket](const boost::system::error_code &error, auto socket) {
+            if (error) {
+                GERROR_STREAM("Failed to accept connection: " << error.message());
+            } else {
+                handle_socket(std::move(socket));
+            }
+            accept_connections(acceptor, handle_socket);
+        });
+    }
+}
 
 Server::Server(
         const boost::program_options::variables_map &args,
@@ -31,12 +73,69 @@ Server::Server(
 
     acceptor.set_option(boost::asio::socket_base::reuse_address(true));
 
-    while(true) {
-        auto socket = std::make_unique<boost::asio::ip::tcp::socket>(executor);
-        acceptor.accept(*socket);
+    // Connections forked from here on share the memory accounting, so the server sees what each holds.
+    auto budget = Gadgetron::MappedMemory::budget();
+    if (args.count("memory_budget")) budget.connection_bytes = args["memory_budget"].as<size_t>() << 20;
+    if (args.count("server_memory_budget")) budget.server_bytes = args["server_memory_budget"].as<size_t>() << 20;
+    Gadgetron::MappedMemory::set_budget(budget);
 
-        GINFO_STREAM("Accepted connection from: " << socket->remote_endpoint().address());
+    // Likewise, connections forked from here on share the admission queue, which also holds connections back while
+    // the server is over its memory budget.
+    Admission::Settings admission{
+        args.count("connection_classes") ? Admission::load_classes(args["connection_classes"].as<path>())
+                                         : std::vector<Admission::ConnectionClass>{},
+        args["max_connections"].as<size_t>(),
+        args.count("cgroup_root") ? args["cgroup_root"].as<path>() : path{},
+        Connection::connections_in_processes(),
+        budget.server_bytes != 0
+    };
+    Admission::configure(admission);
 
-        Connection::handle(paths, args, storage_address, Gadgetron::Connection::stream_from_socket(std::move(socket)));
+    // A connection handled in its own process has a single socket, and input and output threads already; shared I/O
+    // threads would add threads without sharing them.
+    auto io_threads = args["io_threads"].as<size_t>();
+    if (!io_threads) io_threads = 2;
+    Gadgetron::Connection::set_io_threads(Connection::connections_in_processes() ? 0 : io_threads);
+    Gadgetron::Connection::SocketSettings settings{
+        args["tcp_nodelay"].as<bool>(),
+        args["socket_buffer_size"].as<size_t>() << 10
+    };
+
+    accept_connections(acceptor, [&](boost::asio::ip::tcp::socket socket) {
+        GINFO_STREAM("Accepted connection from: " << socket.remote_endpoint().address());
+        Gadgetron::Connection::configure_socket(socket, settings);
+
+        Connection::handle(paths, args, storage_address, Gadgetron::Connection::stream_from_socket(
+                std::make_unique<boost::asio::ip::tcp::socket>(std::move(socket))));
+    });
+
+    std::unique_ptr<boost::asio::local::stream_protocol::acceptor> unix_acceptor;
+    if (args.count("unix_socket")) {
+        auto socket_path = args["unix_socket"].as<path>();
+
+        // A socket left by a server that was killed is replaced; anything else at the path is not ours to remove.
+        boost::system::error_code ignored;
+        if (status(socket_path, ignored).type() == socket_file) {
+            remove(socket_path);
+        } else if (exists(socket_path, ignored)) {
+            throw std::runtime_error("Cannot listen on " + socket_path.string() + "; it exists, and is not a socket.");
+        }
+
+        unix_acceptor = std::make_unique<boost::asio::local::stream_protocol::acceptor>(
+                executor, boost::asio::local::stream_protocol::endpoint(socket_path.string()));
+        GINFO_STREAM("Listening for connections on Unix domain socket: " << socket_path.string());
+        unlink_unix_socket_on_shutdown(socket_path);
+
+        accept_connections(*unix_acceptor, [&](boost::asio::local::stream_protocol::socket socket) {
+            GINFO_STREAM("Accepted connection on Unix domain socket.");
+
+            Connection::handle(paths, args, storage_address, Gadgetron::Connection::stream_from_socket(
+                    std::make_unique<boost::asio::local::stream_protocol::socket>(std::move(socket))));
+        });
+    }
+
+    while(true) {
+        executor.run();
+        executor.restart();
     }
 }
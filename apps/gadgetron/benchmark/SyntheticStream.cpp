@@ -0,0 +1,312 @@
+#include "SyntheticStream.h"
+
+#include <cmath>
+#include <random>
+#include <stdexcept>
+
+#include "TrajectoryParameters.h"
+
+namespace {
+    using namespace Gadgetron;
+    using namespace Gadgetron::Server::Benchmark;
+
+    constexpr double pi = 3.14159265358979323846;
+    constexpr float fov_mm = 256.0f;
+
+    struct Blob {
+        double x, y, sigma, amplitude;
+    };
+
+    // Positions and widths in units of the field of view, centered on 0.
+    const std::vector<Blob> phantom = {
+        {  0.00,  0.00, 0.180, 1.0 },
+        { -0.12,  0.08, 0.050, 0.8 },
+        {  0.14,  0.10, 0.040, 0.6 },
+        {  0.05, -0.15, 0.060, 0.9 },
+        { -0.10, -0.10, 0.030, 0.5 },
+        {  0.20, -0.05, 0.020, 0.7 },
+    };
+
+    /// A blob multiplied by the sensitivity of one coil, which is again a Gaussian.
+    struct Component {
+        double x, y, weight, decay;
+    };
+
+    std::vector<std::vector<Component>> coil_components(size_t channels) {
+        constexpr double coil_width = 0.35;
+        constexpr double coil_radius = 0.45;
+        const double tau2 = coil_width * coil_width;
+
+        std::vector<std::vector<Component>> coils(channels);
+        for (size_t c = 0; c < channels; c++) {
+            double angle = 2 * pi * double(c) / double(channels);
+            double px = coil_radius * std::cos(angle), py = coil_radius * std::sin(angle);
+
+            for (auto& blob : phantom) {
+                double s2 = blob.sigma * blob.sigma;
+                double combined = s2 * tau2 / (s2 + tau2);
+                double distance2 = (blob.x - px) * (blob.x - px) + (blob.y - py) * (blob.y - py);
+
+                coils[c].push_back(Component{
+                    (blob.x * tau2 + px * s2) / (s2 + tau2),
+                    (blob.y * tau2 + py * s2) / (s2 + tau2),
+                    blob.amplitude * std::exp(-distance2 / (2 * (s2 + tau2))) * 2 * pi * combined,
+                    2 * pi * pi * combined
+                });
+            }
+        }
+        return coils;
+    }
+
+    /// k in cycles per field of view
+    std::complex<float> evaluate(const std::vector<Component>& components, double kx, double ky) {
+        std::complex<double> value = 0;
+        for (auto& c : components) {
+            double magnitude = c.weight * std::exp(-c.decay * (kx * kx + ky * ky));
+            value += std::polar(magnitude, -2 * pi * (kx * c.x + ky * c.y));
+        }
+        return std::complex<float>(value);
+    }
+
+    ISMRMRD::IsmrmrdHeader make_header(const Parameters& p, ISMRMRD::TrajectoryType trajectory,
+        ISMRMRD::MatrixSize encoded, size_t encoding_steps) {
+
+        ISMRMRD::IsmrmrdHeader header;
+        header.experimentalConditions.H1resonanceFrequency_Hz = 63500000;
+
+        ISMRMRD::AcquisitionSystemInformation system;
+        system.receiverChannels = (unsigned short)p.channels;
+        system.systemFieldStrength_T = 1.5f;
+        header.acquisitionSystemInformation = system;
+
+        ISMRMRD::MeasurementInformation measurement;
+        measurement.measurementID = "synthetic_" + to_string(p.trajectory);
+        measurement.patientPosition = "HFS";
+        header.measurementInformation = measurement;
+
+        ISMRMRD::SequenceParameters sequence;
+        sequence.TR = std::vector<float>{ 5.0f };
+        sequence.TE = std::vector<float>{ 2.0f };
+        header.sequenceParameters = sequence;
+
+        ISMRMRD::Encoding encoding;
+        encoding.trajectory = trajectory;
+        encoding.encodedSpace.matrixSize = encoded;
+        encoding.encodedSpace.fieldOfView_mm.x = fov_mm * encoded.x / p.matrix;
+        encoding.encodedSpace.fieldOfView_mm.y = fov_mm;
+        encoding.encodedSpace.fieldOfView_mm.z = 5.0f;
+        encoding.reconSpace.matrixSize = ISMRMRD::MatrixSize((unsigned short)p.matrix, (unsigned short)p.matrix, 1);
+        encoding.reconSpace.fieldOfView_mm.x = fov_mm;
+        encoding.reconSpace.fieldOfView_mm.y = fov_mm;
+        encoding.reconSpace.fieldOfView_mm.z = 5.0f;
+
+        auto& limits = encoding.encodingLimits;
+        limits.kspace_encoding_step_0 = ISMRMRD::Limit(0, encoded.x - 1, encoded.x / 2);
+        limits.kspace_encoding_step_1 = ISMRMRD::Limit(0, (unsigned short)(encoding_steps - 1),
+            trajectory == ISMRMRD::TrajectoryType::CARTESIAN ? (unsigned short)(encoding_steps / 2) : 0);
+        limits.kspace_encoding_step_2 = ISMRMRD::Limit(0, 0, 0);
+        limits.average = ISMRMRD::Limit(0, 0, 0);
+        limits.slice = ISMRMRD::Limit(0, 0, 0);
+        limits.contrast = ISMRMRD::Limit(0, 0, 0);
+        limits.phase = ISMRMRD::Limit(0, 0, 0);
+        limits.repetition = ISMRMRD::Limit(0, (unsigned short)(p.repetitions - 1), 0);
+        limits.set = ISMRMRD::Limit(0, 0, 0);
+        limits.segment = ISMRMRD::Limit(0, 0, 0);
+
+        ISMRMRD::ParallelImaging parallel;
+        parallel.accelerationFactor.kspace_encoding_step_1 = (unsigned short)p.acceleration;
+        parallel.accelerationFactor.kspace_encoding_step_2 = 1;
+        parallel.calibrationMode = std::string(p.acceleration > 1 ? "embedded" : "other");
+        encoding.parallelImaging = parallel;
+
+        header.encoding.push_back(encoding);
+        return header;
+    }
+
+    ISMRMRD::AcquisitionHeader acquisition_header(const Parameters& p, size_t samples, size_t step,
+        uint16_t trajectory_dimensions) {
+
+        ISMRMRD::AcquisitionHeader header;
+        header.number_of_samples = (uint16_t)samples;
+        header.available_channels = (uint16_t)p.channels;
+        header.active_channels = (uint16_t)p.channels;
+        header.trajectory_dimensions = trajectory_dimensions;
+        header.sample_time_us = 2.0f;
+        header.idx.kspace_encode_step_1 = (uint16_t)step;
+        header.read_dir[0] = 1.0f;
+        header.phase_dir[1] = 1.0f;
+        header.slice_dir[2] = 1.0f;
+        return header;
+    }
+
+    void add_noise(hoNDArray<std::complex<float>>& data, float level, std::mt19937& generator) {
+        std::normal_distribution<float> distribution(0.0f, level);
+        for (auto& value : data) value += std::complex<float>(distribution(generator), distribution(generator));
+    }
+
+    SyntheticStream make_cartesian(const Parameters& p) {
+        const size_t samples = 2 * p.matrix; // Readout oversampling
+        const size_t lines = p.matrix;
+        const size_t acs_start = (lines - std::min(p.acs_lines, lines)) / 2;
+        const size_t acs_end = acs_start + std::min(p.acs_lines, lines);
+
+        SyntheticStream stream;
+        stream.repetitions = p.repetitions;
+        stream.header = make_header(p, ISMRMRD::TrajectoryType::CARTESIAN,
+            ISMRMRD::MatrixSize((unsigned short)samples, (unsigned short)lines, 1), lines);
+
+        auto coils = coil_components(p.channels);
+        std::mt19937 generator(p.seed);
+
+        for (size_t line = 0; line < lines; line++) {
+            bool imaging = line % p.acceleration == 0;
+            bool calibration = line >= acs_start && line < acs_end && p.acceleration > 1;
+            if (!imaging && !calibration) continue;
+
+            auto header = acquisition_header(p, samples, line, 0);
+            header.center_sample = (uint16_t)(samples / 2);
+            if (calibration) {
+                header.setFlag(imaging ? ISMRMRD::ISMRMRD_ACQ_IS_PARALLEL_CALIBRATION_AND_IMAGING
+                                       : ISMRMRD::ISMRMRD_ACQ_IS_PARALLEL_CALIBRATION);
+            }
+
+            hoNDArray<std::complex<float>> data(samples, p.channels);
+            double ky = double(line) - double(lines / 2);
+            for (size_t c = 0; c < p.channels; c++)
+                for (size_t s = 0; s < samples; s++)
+                    data(s, c) = evaluate(coils[c], (double(s) - double(samples / 2)) / 2, ky);
+
+            add_noise(data, p.noise, generator);
+            stream.repetition.emplace_back(header, std::move(data), Core::none);
+        }
+        return stream;
+    }
+
+    SyntheticStream make_radial(const Parameters& p) {
+        const size_t samples = 2 * p.matrix;
+        const size_t profiles = std::max<size_t>(1, size_t(std::round(double(p.matrix) * pi / 2 / double(p.acceleration))));
+
+        SyntheticStream stream;
+        stream.repetitions = p.repetitions;
+        stream.header = make_header(p, ISMRMRD::TrajectoryType::RADIAL,
+            ISMRMRD::MatrixSize((unsigned short)p.matrix, (unsigned short)p.matrix, 1), profiles);
+
+        auto coils = coil_components(p.channels);
+        std::mt19937 generator(p.seed);
+
+        for (size_t profile = 0; profile < profiles; profile++) {
+            auto header = acquisition_header(p, samples, profile, 2);
+            header.center_sample = (uint16_t)(samples / 2);
+
+            double angle = pi * double(profile) / double(profiles);
+            hoNDArray<float> trajectory(2, samples);
+            for (size_t s = 0; s < samples; s++) {
+                double r = (double(s) - double(samples / 2)) / double(samples);
+                trajectory(0, s) = float(r * std::cos(angle));
+                trajectory(1, s) = float(r * std::sin(angle));
+            }
+
+            hoNDArray<std::complex<float>> data(samples, p.channels);
+            for (size_t c = 0; c < p.channels; c++)
+                for (size_t s = 0; s < samples; s++)
+                    data(s, c) = evaluate(coils[c], trajectory(0, s) * p.matrix, trajectory(1, s) * p.matrix);
+
+            add_noise(data, p.noise, generator);
+            stream.repetition.emplace_back(header, std::move(data), std::move(trajectory));
+        }
+        return stream;
+    }
+
+    SyntheticStream make_spiral(const Parameters& p) {
+        const size_t interleaves = std::max<size_t>(1, p.matrix / 16);
+        const double fov_cm = fov_mm / 10.0;
+
+        SyntheticStream stream;
+        stream.repetitions = p.repetitions;
+        stream.header = make_header(p, ISMRMRD::TrajectoryType::SPIRAL,
+            ISMRMRD::MatrixSize((unsigned short)p.matrix, (unsigned short)p.matrix, 1), interleaves);
+
+        // The spiral gadgets derive the trajectory from this description; the samples are computed the same way.
+        ISMRMRD::TrajectoryDescription description;
+        description.identifier = "HargreavesVDS2000";
+        description.userParameterLong = {
+            { "interleaves", long(interleaves) }, { "fov_coefficients", 1 }, { "SamplingTime_ns", 2000 } };
+        description.userParameterDouble = {
+            { "MaxGradient_G_per_cm", 2.4 }, { "MaxSlewRate_G_per_cm_per_s", 14414.4 },
+            { "FOVCoeff_1_cm", fov_cm }, { "krmax_per_cm", double(p.matrix) / (2 * fov_cm) } };
+        stream.header.encoding[0].trajectoryDescription = description;
+
+        auto probe = acquisition_header(p, 65535, 0, 0);
+        auto trajectories = Spiral::TrajectoryParameters(stream.header).calculate_trajectories_and_weight(probe).first;
+        const size_t samples = trajectories.get_size(0);
+
+        auto coils = coil_components(p.channels);
+        std::mt19937 generator(p.seed);
+
+        for (size_t interleave = 0; interleave < interleaves; interleave += p.acceleration) {
+            auto header = acquisition_header(p, samples, interleave, 0);
+
+            hoNDArray<std::complex<float>> data(samples, p.channels);
+            for (size_t c = 0; c < p.channels; c++) {
+                for (size_t s = 0; s < samples; s++) {
+                    auto k = trajectories(s, interleave);
+                    data(s, c) = evaluate(coils[c], k[0] * p.matrix, k[1] * p.matrix);
+                }
+            }
+
+            add_noise(data, p.noise, generator);
+            stream.repetition.emplace_back(header, std::move(data), Core::none);
+        }
+        return stream;
+    }
+}
+
+namespace Gadgetron::Server::Benchmark {
+
+    Trajectory trajectory_from_string(const std::string& name) {
+        if (name == "cartesian") return Trajectory::cartesian;
+        if (name == "radial") return Trajectory::radial;
+        if (name == "spiral") return Trajectory::spiral;
+        throw std::runtime_error("Unknown trajectory: " + name + ". Expected cartesian, radial or spiral.");
+    }
+
+    std::string to_string(Trajectory trajectory) {
+        switch (trajectory) {
+        case Trajectory::cartesian: return "cartesian";
+        case Trajectory::radial: return "radial";
+        default: return "spiral";
+        }
+    }
+
+    ISMRMRD::AcquisitionHeader SyntheticStream::header_of(size_t rep, size_t i) const {
+        auto header = std::get<ISMRMRD::AcquisitionHeader>(repetition[i]);
+        header.idx.repetition = (uint16_t)rep;
+        header.scan_counter = uint32_t(rep * repetition.size() + i);
+        header.acquisition_time_stamp = header.scan_counter * 2; // 2.5 ms ticks at TR = 5 ms
+
+        if (i == 0) {
+            header.setFlag(ISMRMRD::ISMRMRD_ACQ_FIRST_IN_SLICE);
+            header.setFlag(ISMRMRD::ISMRMRD_ACQ_FIRST_IN_ENCODE_STEP1);
+            header.setFlag(ISMRMRD::ISMRMRD_ACQ_FIRST_IN_REPETITION);
+        }
+        if (i + 1 == repetition.size()) {
+            header.setFlag(ISMRMRD::ISMRMRD_ACQ_LAST_IN_SLICE);
+            header.setFlag(ISMRMRD::ISMRMRD_ACQ_LAST_IN_ENCODE_STEP1);
+            header.setFlag(ISMRMRD::ISMRMRD_ACQ_LAST_IN_REPETITION);
+            if (rep + 1 == repetitions) header.setFlag(ISMRMRD::ISMRMRD_ACQ_LAST_IN_MEASUREMENT);
+        }
+        return header;
+    }
+
+    SyntheticStream make_stream(const Parameters& parameters) {
+        if (parameters.acceleration == 0 || parameters.matrix < 16 || parameters.channels == 0 || parameters.repetitions == 0)
+            throw std::runtime_error("Synthetic stream needs a matrix of at least 16, and non-zero channels, "
+                                     "acceleration and repetitions.");
+
+        switch (parameters.trajectory) {
+        case Trajectory::cartesian: return make_cartesian(parameters);
+        case Trajectory::radial: return make_radial(parameters);
+        default: return make_spiral(parameters);
+        }
+    }
+}
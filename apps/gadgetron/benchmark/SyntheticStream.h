@@ -0,0 +1,48 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <ismrmrd/xml.h>
+
+#include "Types.h"
+
+namespace Gadgetron::Server::Benchmark {
+
+    enum class Trajectory { cartesian, radial, spiral };
+
+    Trajectory trajectory_from_string(const std::string& name);
+    std::string to_string(Trajectory trajectory);
+
+    struct Parameters {
+        Trajectory trajectory = Trajectory::cartesian;
+        size_t matrix         = 256;
+        size_t channels       = 16;
+        /// Cartesian: phase encoding undersampling; radial: fewer profiles; spiral: fewer interleaves
+        size_t acceleration = 2;
+        /// Fully sampled central lines, Cartesian only
+        size_t acs_lines   = 24;
+        size_t repetitions = 10;
+        float noise        = 0.01f;
+        unsigned int seed  = 42;
+    };
+
+    /**
+     * A reproducible acquisition stream of a phantom made of Gaussian blobs, seen through Gaussian coil sensitivities.
+     * Both have closed form Fourier transforms, so k-space is evaluated exactly at every sample position,
+     * Cartesian or not.
+     *
+     * Every repetition carries the same data; only the encoding counters and flags differ.
+     */
+    struct SyntheticStream {
+        ISMRMRD::IsmrmrdHeader header;
+        std::vector<Core::Acquisition> repetition;
+        size_t repetitions;
+
+        /// Acquisition number i of repetition rep, with counters and flags set for its place in the stream
+        ISMRMRD::AcquisitionHeader header_of(size_t rep, size_t i) const;
+        size_t size() const { return repetition.size() * repetitions; }
+    };
+
+    SyntheticStream make_stream(const Parameters& parameters);
+}
@@ -0,0 +1,383 @@
+#include <boost/asio.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <thread>
+
+#include <nlohmann/json.hpp>
+
+#include "log.h"
+#include "gadgetron_paths.h"
+#include "initialization.h"
+#include "storage.h"
+#include "Metrics.h"
+#include "MessageID.h"
+#include "io/primitives.h"
+#include "readers/ImageReader.h"
+#include "readers/IsmrmrdImageArrayReader.h"
+
+#include "connection/Core.h"
+#include "connection/SocketStreamBuf.h"
+
+#include "SyntheticStream.h"
+
+using namespace boost::filesystem;
+using namespace boost::program_options;
+using namespace Gadgetron;
+using namespace Gadgetron::Server;
+using namespace Gadgetron::Server::Benchmark;
+
+namespace {
+
+    using clock = std::chrono::steady_clock;
+
+    double seconds_between(clock::time_point start, clock::time_point end) {
+        return std::chrono::duration<double>(end - start).count();
+    }
+
+    std::string default_config(Trajectory trajectory) {
+        switch (trajectory) {
+        case Trajectory::cartesian: return "Generic_Cartesian_Grappa.xml";
+        case Trajectory::radial: return "Generic_CPU_Gridding_Recon.xml";
+        default: return "Generic_Spiral.xml";
+        }
+    }
+
+    /// Prometheus samples by series, e.g. 'gadgetron_node_messages_total{node="Foo"}'
+    std::map<std::string, double> snapshot_metrics() {
+        std::stringstream text;
+        Core::Metrics::write_prometheus(text);
+
+        std::map<std::string, double> samples;
+        std::string line;
+        while (std::getline(text, line)) {
+            if (line.empty() || line[0] == '#') continue;
+            auto space = line.rfind(' ');
+            samples[line.substr(0, space)] = std::stod(line.substr(space + 1));
+        }
+        return samples;
+    }
+
+    nlohmann::json node_statistics(const std::map<std::string, double>& before, const std::map<std::string, double>& after) {
+        const std::string prefix = "gadgetron_node_process_seconds_sum{node=\"";
+
+        auto delta = [&](const std::string& series) {
+            auto a = after.find(series);
+            auto b = before.find(series);
+            return (a == after.end() ? 0.0 : a->second) - (b == before.end() ? 0.0 : b->second);
+        };
+
+        auto nodes = nlohmann::json::object();
+        for (auto& [series, value] : after) {
+            if (series.compare(0, prefix.size(), prefix) != 0) continue;
+            auto node = series.substr(prefix.size(), series.size() - prefix.size() - 2);
+            auto labels = "{node=\"" + node + "\"}";
+
+            auto messages = delta("gadgetron_node_messages_total" + labels);
+            if (messages <= 0) continue;
+
+            auto busy = delta(series);
+            nodes[node] = {
+                { "messages", messages },
+                { "busy_seconds", busy },
+                { "seconds_per_message", busy / messages }
+            };
+        }
+        return nodes;
+    }
+
+    /// Resets the peak resident set size of the process, so that the next peak is that of a single run. Only Linux
+    /// can reset the peak (since 4.0); elsewhere, and on older kernels, no peak is reported.
+    bool reset_peak_resident_bytes() {
+#if defined(__linux__)
+        std::ofstream clear_refs("/proc/self/clear_refs");
+        clear_refs << "5" << std::flush;
+        return bool(clear_refs);
+#else
+        return false;
+#endif
+    }
+
+    std::optional<size_t> peak_resident_bytes() {
+        std::ifstream status("/proc/self/status");
+        std::string line;
+        while (std::getline(status, line)) {
+            if (line.compare(0, 6, "VmHWM:") == 0) return size_t(std::stoull(line.substr(6))) * 1024;
+        }
+        return std::nullopt;
+    }
+
+    void send_configuration(std::ostream& stream, const std::string& config) {
+        if (exists(config)) {
+            std::ifstream file(config);
+            std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            Core::IO::write(stream, Core::MessageID::CONFIG);
+            Core::IO::write_string_to_stream<uint32_t>(stream, content);
+            return;
+        }
+
+        char filename[1024] = {};
+        std::copy_n(config.begin(), std::min<size_t>(config.size(), sizeof(filename) - 1), filename);
+        Core::IO::write(stream, Core::MessageID::FILENAME);
+        stream.write(filename, sizeof(filename));
+    }
+
+    void send_stream(std::ostream& stream, const std::string& config, const SyntheticStream& synthetic) {
+        send_configuration(stream, config);
+
+        std::stringstream header;
+        ISMRMRD::serialize(synthetic.header, header);
+        Core::IO::write(stream, Core::MessageID::HEADER);
+        Core::IO::write_string_to_stream<uint32_t>(stream, header.str());
+
+        for (size_t rep = 0; rep < synthetic.repetitions; rep++) {
+            for (size_t i = 0; i < synthetic.repetition.size(); i++) {
+                auto& [_, data, trajectory] = synthetic.repetition[i];
+                Core::IO::write(stream, Core::MessageID::GADGET_MESSAGE_ISMRMRD_ACQUISITION);
+                Core::IO::write(stream, synthetic.header_of(rep, i));
+                if (trajectory) Core::IO::write(stream, trajectory->get_data_ptr(), trajectory->get_number_of_elements());
+                Core::IO::write(stream, data.get_data_ptr(), data.get_number_of_elements());
+            }
+        }
+
+        Core::IO::write(stream, Core::MessageID::CLOSE);
+        stream.flush();
+    }
+
+    struct Received {
+        size_t images = 0;
+        std::optional<clock::time_point> first_image;
+        std::vector<std::string> errors;
+    };
+
+    Received receive_images(std::istream& stream) {
+        Core::Readers::ImageReader image_reader;
+        Core::Readers::IsmrmrdImageArrayReader image_array_reader;
+
+        Received received;
+        while (true) {
+            auto id = Core::IO::read<uint16_t>(stream);
+            switch (id) {
+            case Core::MessageID::GADGET_MESSAGE_ISMRMRD_IMAGE:
+                image_reader.read(stream);
+                break;
+            case Core::MessageID::GADGET_MESSAGE_ISMRMRD_IMAGE_ARRAY:
+                image_array_reader.read(stream);
+                break;
+            case Core::MessageID::TEXT:
+                received.errors.push_back(Core::IO::read_string_from_stream<uint32_t>(stream));
+                continue;
+            case Core::MessageID::CLOSE:
+                return received;
+            default:
+                throw std::runtime_error("Unexpected message id from server: " + std::to_string(id));
+            }
+            if (!received.first_image) received.first_image = clock::now();
+            received.images++;
+        }
+    }
+
+    /**
+     * One connection over loopback TCP, handled in this process the way the server handles a connection. The stream
+     * goes through the same socket, reader and writer code as a real client, so protocol overhead is included.
+     */
+    nlohmann::json run_once(const Core::StreamContext::Paths& paths, const variables_map& args,
+        const std::string& storage_address, const std::string& config, const SyntheticStream& synthetic) {
+
+        using boost::asio::ip::tcp;
+
+        boost::asio::io_context executor;
+        tcp::acceptor acceptor(executor, tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+
+        auto client_socket = std::make_unique<tcp::socket>(executor);
+        auto server_socket = std::make_unique<tcp::socket>(executor);
+        client_socket->connect(acceptor.local_endpoint());
+        acceptor.accept(*server_socket);
+
+        auto client = Gadgetron::Connection::stream_from_socket(std::move(client_socket));
+        auto server = Gadgetron::Connection::stream_from_socket(std::move(server_socket));
+        client->exceptions(std::istream::failbit | std::istream::badbit | std::istream::eofbit);
+
+        auto metrics_before = snapshot_metrics();
+        auto peak_reset = reset_peak_resident_bytes();
+        auto start = clock::now();
+
+        std::thread connection(Server::Connection::handle_connection, std::move(server), paths, args, storage_address);
+        std::thread sender([&]() { send_stream(*client, config, synthetic); });
+
+        auto received = receive_images(*client);
+        auto end = clock::now();
+
+        sender.join();
+        connection.join();
+
+        auto total = seconds_between(start, end);
+        nlohmann::json result = {
+            { "total_seconds", total },
+            { "acquisitions_per_second", double(synthetic.size()) / total },
+            { "images", received.images },
+            { "errors", received.errors },
+            { "nodes", node_statistics(metrics_before, snapshot_metrics()) }
+        };
+        auto peak = peak_reset ? peak_resident_bytes() : std::nullopt;
+        result["peak_resident_bytes"] = peak ? nlohmann::json(*peak) : nlohmann::json();
+        result["time_to_first_image_seconds"] =
+            received.first_image ? nlohmann::json(seconds_between(start, *received.first_image)) : nlohmann::json();
+        return result;
+    }
+
+    double median(std::vector<double> values) {
+        std::sort(values.begin(), values.end());
+        auto n = values.size();
+        return n % 2 ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2;
+    }
+}
+
+int main(int argc, char* argv[]) {
+
+    options_description benchmark_options("Allowed options:");
+    benchmark_options.add_options()
+            ("help", "Prints this help message.")
+            ("dir,W",
+                value<path>()->default_value(default_working_folder()),
+                "Set the Gadgetron working directory.")
+            ("home,G",
+                value<path>()->default_value(default_gadgetron_home()),
+                "Set the Gadgetron home directory.")
+            ("config,c",
+                value<std::string>(),
+                "Reconstruction configuration; a file, or the name of a configuration installed with the Gadgetron. "
+                "Defaults to a generic reconstruction matching the trajectory.")
+            ("output,o",
+                value<path>(),
+                "Write the results (JSON) to this file rather than to standard output.")
+            ("trace_dir",
+                value<path>(),
+                "Write a Chrome trace (JSON) of each run to this directory.");
+
+    options_description stream_options("Synthetic stream options");
+    stream_options.add_options()
+            ("trajectory,t", value<std::string>()->default_value("cartesian"), "One of cartesian, radial or spiral.")
+            ("matrix,m", value<size_t>()->default_value(256), "Reconstructed matrix size.")
+            ("channels,C", value<size_t>()->default_value(16), "Number of receive channels.")
+            ("acceleration,a", value<size_t>()->default_value(2), "Undersampling factor.")
+            ("acs_lines", value<size_t>()->default_value(24), "Fully sampled calibration lines (Cartesian only).")
+            ("repetitions,r", value<size_t>()->default_value(10), "Repetitions in each run.")
+            ("noise", value<float>()->default_value(0.01f), "Standard deviation of the added noise.")
+            ("seed", value<unsigned int>()->default_value(42), "Seed of the noise generator.")
+            ("runs,n", value<size_t>()->default_value(5), "Number of measured runs.")
+            ("warmup", value<size_t>()->default_value(1), "Number of runs before measuring.");
+
+    options_description storage_options("Storage options");
+    storage_options.add_options()
+            ("storage_address,E",
+                value<std::string>(),
+                "External address of a storage server. If not provided, a storage server will be started.")
+            ("storage_port,s",
+                value<unsigned short>()->default_value(9112),
+                "Port on which to run the storage server.")
+            ("database_dir,D",
+                value<path>()->default_value(default_database_folder()),
+                "Directory in which to store the storage server database.")
+            ("storage_dir,S",
+                value<path>()->default_value(default_storage_folder()),
+                "Directory in which to store data blobs.");
+
+    options_description desc;
+    desc
+        .add(benchmark_options)
+        .add(stream_options)
+        .add(storage_options);
+
+    variables_map args;
+    store(parse_command_line(argc, argv, desc), args);
+    notify(args);
+
+    try {
+        if (args.count("help")) {
+            std::cout << desc << std::endl;
+            return 0;
+        }
+
+        check_environment_variables();
+        configure_blas_libraries();
+        set_locale();
+
+        Parameters parameters;
+        parameters.trajectory   = trajectory_from_string(args["trajectory"].as<std::string>());
+        parameters.matrix       = args["matrix"].as<size_t>();
+        parameters.channels     = args["channels"].as<size_t>();
+        parameters.acceleration = args["acceleration"].as<size_t>();
+        parameters.acs_lines    = args["acs_lines"].as<size_t>();
+        parameters.repetitions  = args["repetitions"].as<size_t>();
+        parameters.noise        = args["noise"].as<float>();
+        parameters.seed         = args["seed"].as<unsigned int>();
+
+        auto config = args.count("config") ? args["config"].as<std::string>() : default_config(parameters.trajectory);
+
+        create_directories(args["dir"].as<path>());
+        auto [storage_address, storage_server] = Server::ensure_storage_server(args);
+        Core::Metrics::enable();
+
+        Core::StreamContext::Paths paths{ args["home"].as<path>(), args["dir"].as<path>() };
+
+        GINFO_STREAM("Generating synthetic " << to_string(parameters.trajectory) << " stream");
+        auto synthetic = make_stream(parameters);
+
+        for (size_t i = 0; i < args["warmup"].as<size_t>(); i++)
+            run_once(paths, args, storage_address, config, synthetic);
+
+        std::vector<nlohmann::json> runs;
+        std::vector<double> totals, first_images;
+        for (size_t i = 0; i < args["runs"].as<size_t>(); i++) {
+            auto run = run_once(paths, args, storage_address, config, synthetic);
+            GINFO_STREAM("Run " << i << ": " << run["total_seconds"].get<double>() << " s");
+
+            totals.push_back(run["total_seconds"]);
+            if (!run["time_to_first_image_seconds"].is_null()) first_images.push_back(run["time_to_first_image_seconds"]);
+            runs.push_back(std::move(run));
+        }
+
+        nlohmann::json summary = {
+            { "median_total_seconds", totals.empty() ? 0.0 : median(totals) },
+            { "median_time_to_first_image_seconds", first_images.empty() ? 0.0 : median(first_images) },
+            { "median_acquisitions_per_second", totals.empty() ? 0.0 : double(synthetic.size()) / median(totals) }
+        };
+
+        nlohmann::json report = {
+            { "config", config },
+            { "stream", {
+                { "trajectory", to_string(parameters.trajectory) },
+                { "matrix", parameters.matrix },
+                { "channels", parameters.channels },
+                { "acceleration", parameters.acceleration },
+                { "acs_lines", parameters.acs_lines },
+                { "repetitions", parameters.repetitions },
+                { "acquisitions", synthetic.size() },
+                { "seed", parameters.seed }
+            }},
+            { "summary", summary },
+            { "runs", runs }
+        };
+
+        if (args.count("output")) {
+            std::ofstream file(args["output"].as<path>().string());
+            file << report.dump(2) << std::endl;
+        } else {
+            std::cout << report.dump(2) << std::endl;
+        }
+    }
+    catch (std::exception& e) {
+        GERROR_STREAM(e.what() << std::endl);
+        return 1;
+    }
+
+    return 0;
+}
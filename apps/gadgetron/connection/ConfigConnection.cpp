@@ -46,34 +46,47 @@ namespace {
         return std::string(buffer.data());
     }
 
+    /// Configs sent as strings have no file name; they are known by the names of their gadgets, joined by '+'.
+    std::string name_of(const Config &config) {
+        std::string name;
+        for (auto &node : config.stream.nodes) {
+            if (auto gadget = std::get_if<Config::Gadget>(&node)) {
+                name += (name.empty() ? "" : "+") + Config::name(*gadget);
+            }
+        }
+        return name;
+    }
+
     class ConfigHandler : public Handler {
     public:
-        explicit ConfigHandler(std::function<void(Config)> callback)
+        explicit ConfigHandler(std::function<void(Config, std::string)> callback)
         : callback(std::move(callback)) {}
 
-        void handle_callback(std::istream &config_stream) {
-
-            callback(parse_config(config_stream));
+        void handle_callback(std::istream &config_stream, std::string name = {}) {
+            auto config = parse_config(config_stream);
+            if (name.empty()) name = name_of(config);
+            callback(std::move(config), std::move(name));
         }
 
     private:
-        std::function<void(Config)> callback;
+        std::function<void(Config, std::string)> callback;
     };
 
     class ConfigReferenceHandler : public ConfigHandler {
     public:
         ConfigReferenceHandler(
-                std::function<void(Config)> &&callback,
+                std::function<void(Config, std::string)> &&callback,
                 const StreamContext::Paths &paths
         ) : ConfigHandler(callback), paths(paths) {}
 
         void handle(std::istream &stream, Gadgetron::Core::OutputChannel&) override {
-            boost::filesystem::path filename = paths.gadgetron_home / GADGETRON_CONFIG_PATH / read_filename_from_stream(stream);
+            auto name = read_filename_from_stream(stream);
+            boost::filesystem::path filename = paths.gadgetron_home / GADGETRON_CONFIG_PATH / name;
 
             GDEBUG_STREAM("Reading config file: " << filename);
 
             auto config_stream = open_and_verify_config(filename.string());
-            handle_callback(*config_stream);
+            handle_callback(*config_stream, name);
         }
 
     private:
@@ -82,7 +95,7 @@ namespace {
 
     class ConfigStringHandler : public ConfigHandler {
     public:
-        explicit ConfigStringHandler(std::function<void(Config)> &&callback)
+        explicit ConfigStringHandler(std::function<void(Config, std::string)> &&callback)
         : ConfigHandler(callback) {}
 
         void handle(std::istream &stream, Gadgetron::Core::OutputChannel& ) override {
@@ -94,6 +107,7 @@ namespace {
     class ConfigStreamContext {
     public:
         Gadgetron::Core::optional<Config> config;
+        std::string config_name;
         const StreamContext::Paths paths;
     };
 
@@ -103,8 +117,9 @@ namespace {
     ) {
         std::map<uint16_t, std::unique_ptr<Handler>> handlers{};
 
-        auto config_callback = [=, &context](Config config) {
+        auto config_callback = [=, &context](Config config, std::string name) {
             context.config = config;
+            context.config_name = std::move(name);
             close();
         };
 
@@ -132,6 +147,7 @@ namespace Gadgetron::Server::Connection::ConfigConnection {
 
         ConfigStreamContext context{
             Core::none,
+            {},
             paths
         };
 
@@ -155,7 +171,8 @@ namespace Gadgetron::Server::Connection::ConfigConnection {
         output_thread.join();
 
         if (context.config) {
-            HeaderConnection::process(stream, paths, args, sessions_address, context.config.value(), error_handler);
+            HeaderConnection::process(
+                    stream, paths, args, sessions_address, context.config.value(), context.config_name, error_handler);
         }
     }
 }
\ No newline at end of file
@@ -1,7 +1,12 @@
 
 #include "Core.h"
 
+#include <ctime>
+#include <fstream>
+#include <boost/filesystem.hpp>
+
 #include "ConfigConnection.h"
+#include "Metrics.h"
 #include "Writers.h"
 
 namespace {
@@ -39,6 +44,33 @@ namespace {
     };
 
 
+    uint32_t start_trace(const StreamContext::Args &args) {
+        if (!args.count("trace_dir")) return 0;
+
+        Gadgetron::Trace::enable();
+        auto session = Gadgetron::Trace::new_session();
+        Gadgetron::Trace::set_session(session);
+        return session;
+    }
+
+    void write_trace(const StreamContext::Args &args, uint32_t session) {
+        try {
+            auto folder = args["trace_dir"].as<boost::filesystem::path>();
+            boost::filesystem::create_directories(folder);
+
+            auto filename = folder / boost::filesystem::unique_path(
+                    "gadgetron_trace_" + std::to_string(std::time(nullptr)) + "_%%%%%%.json"
+            );
+
+            std::ofstream file(filename.string());
+            Gadgetron::Trace::write_chrome_trace(file, session);
+            GINFO_STREAM("Connection trace written to " << filename.string());
+        }
+        catch (const std::exception &e) {
+            GERROR_STREAM("Failed to write connection trace: " << e.what());
+        }
+    }
+
     void send_close(std::iostream &stream) {
         uint16_t close = 4;
         stream.write(reinterpret_cast<char *>(&close), sizeof(close));
@@ -59,6 +91,12 @@ namespace Gadgetron::Server::Connection {
         stream->exceptions(std::istream::failbit | std::istream::badbit | std::istream::eofbit);
         ErrorSender sender;
 
+        auto trace_session = start_trace(args);
+
+        static auto connections = Core::Metrics::counter("gadgetron_connections_total", "Connections handled.");
+        connections.increment();
+        Core::Metrics::GaugeGuard active{Core::Metrics::gauge("gadgetron_connections_active", "Connections currently open.")};
+
         ErrorHandler error_handler(sender, "Connection Main Thread");
 
         error_handler.handle([&]() {
@@ -74,6 +112,8 @@ namespace Gadgetron::Server::Connection {
         }
         catch (...) {}
 
+        if (trace_session) write_trace(args, trace_session);
+
         GINFO_STREAM("Connection state: [FINISHED]");
     }
 
@@ -4,11 +4,16 @@
 #include <memory>
 #include <functional>
 
+#include <boost/core/demangle.hpp>
+
 
 #include "io/primitives.h"
 #include "Writer.h"
+#include "WriterDispatch.h"
 #include "Channel.h"
 #include "Context.h"
+#include "Metrics.h"
+#include "trace.h"
 
 namespace Gadgetron::Server::Connection {
 
@@ -68,8 +73,10 @@ namespace Gadgetron::Server::Connection {
 
         template<class F, class... ARGS>
         std::thread run(F fn, ARGS &&... args) {
+            // Threads started on behalf of a connection trace into the session of that connection.
             return std::thread(
-                    []( auto handler, auto fn, auto &&... iargs) {
+                    [session = Trace::current_session()]( auto handler, auto fn, auto &&... iargs) {
+                        Trace::set_session(session);
                         handler.handle(fn, std::forward<ARGS>(iargs)...);
                     },
                     *this,
@@ -105,14 +112,26 @@ namespace Gadgetron::Server::Connection {
 
         auto writers = writer_factory();
 
+        std::vector<const char *> trace_names{};
+        std::vector<Core::Metrics::Counter> write_counts{};
+        for (auto &writer : writers) {
+            auto name = boost::core::demangle(typeid(*writer).name());
+            trace_names.push_back(Trace::intern("write " + name));
+            write_counts.push_back(Core::Metrics::counter(
+                    "gadgetron_messages_written_total", "Messages written to clients.", {{"writer", name}}
+            ));
+        }
+
+        Core::WriterDispatch dispatch{writers};
+
         for (auto message : messages) {
 
-            auto writer = std::find_if(writers.begin(), writers.end(),
-                                       [&](auto &writer) { return writer->accepts(message); }
-            );
+            auto index = dispatch.find(message);
 
-            if (writer != writers.end()) {
-                (*writer)->write(stream, std::move(message));
+            if (index != Core::WriterDispatch::none) {
+                Trace::Scope scope(trace_names[index], "io");
+                dispatch[index].write(stream, std::move(message));
+                write_counts[index].increment();
             }
         }
     }
@@ -5,6 +5,7 @@
 #include <iostream>
 
 #include "storage.h"
+#include "Admission.h"
 #include "Handlers.h"
 #include "StreamConnection.h"
 #include "VoidConnection.h"
@@ -79,6 +80,7 @@ namespace Gadgetron::Server::Connection::HeaderConnection {
             const Core::StreamContext::Args &args,
             const Core::StreamContext::StorageAddress& storage_address,
             const Config &config,
+            const std::string &config_name,
             ErrorHandler &error_handler
     ) {
         GINFO_STREAM("Connection state: [HEADER]");
@@ -107,13 +109,16 @@ namespace Gadgetron::Server::Connection::HeaderConnection {
         input_thread.join();
         output_thread.join();
 
+        // Once the config and header are known, the connection waits its turn to run with its connection class.
+        auto admitted = Admission::admit(config_name, context.header ? &context.header.value() : nullptr);
+
         auto header = context.header.value_or(Header());
         StreamContext stream_context{
             header,
             paths,
             args,
             storage_address,
-            setup_storage_spaces(storage_address, header)
+            setup_storage_spaces(storage_address, header, args)
         };
 
         auto process = context.header ? StreamConnection::process : VoidConnection::process;
@@ -12,6 +12,7 @@ namespace Gadgetron::Server::Connection::HeaderConnection {
             const Core::StreamContext::Args &args,
             const Core::StreamContext::StorageAddress& address,
             const Config &config,
+            const std::string &config_name,
             ErrorHandler &error_handler
     );
 }
@@ -0,0 +1,140 @@
+#include "MemoryStream.h"
+
+#include "io/primitives.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+    /// Bytes queued in either direction before writers wait for the reader.
+    constexpr size_t capacity = size_t(16) << 20;
+    /// Small writes are appended to the latest chunk, until it reaches this size.
+    constexpr size_t chunk_size = size_t(64) << 10;
+
+    /// One direction of a stream pair.
+    class Pipe {
+    public:
+        void write(const std::vector<Gadgetron::Core::IO::GatherTransport::Buffer> &buffers) {
+            size_t bytes = 0;
+            for (auto &buffer : buffers) bytes += buffer.bytes;
+
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&]() { return reader_closed || queued < capacity; });
+            if (reader_closed) throw std::runtime_error("In-process stream closed by peer.");
+
+            if (chunks.empty() || chunks.back().size() + bytes > chunk_size) {
+                chunks.emplace_back();
+                chunks.back().reserve(std::max(bytes, chunk_size));
+            }
+
+            auto &chunk = chunks.back();
+            for (auto &buffer : buffers) chunk.insert(chunk.end(), buffer.data, buffer.data + buffer.bytes);
+            queued += bytes;
+            changed.notify_all();
+        }
+
+        /// Takes the next chunk; false once the writer is gone and everything written has been read.
+        bool read(std::vector<char> &chunk) {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&]() { return writer_closed || !chunks.empty(); });
+            if (chunks.empty()) return false;
+
+            chunk = std::move(chunks.front());
+            chunks.pop_front();
+            queued -= chunk.size();
+            changed.notify_all();
+            return true;
+        }
+
+        void close_reader() {
+            std::lock_guard<std::mutex> guard(mutex);
+            reader_closed = true;
+            chunks.clear();
+            changed.notify_all();
+        }
+
+        void close_writer() {
+            std::lock_guard<std::mutex> guard(mutex);
+            writer_closed = true;
+            changed.notify_all();
+        }
+
+    private:
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::deque<std::vector<char>> chunks;
+        size_t queued = 0;
+        bool reader_closed = false;
+        bool writer_closed = false;
+    };
+
+    class MemoryStreamBuf : public std::streambuf {
+    public:
+        MemoryStreamBuf(std::shared_ptr<Pipe> inbound, std::shared_ptr<Pipe> outbound)
+            : inbound(std::move(inbound)), outbound(std::move(outbound)) {}
+
+        ~MemoryStreamBuf() override {
+            inbound->close_reader();
+            outbound->close_writer();
+        }
+
+        void write_gather(const std::vector<Gadgetron::Core::IO::GatherTransport::Buffer> &buffers) {
+            outbound->write(buffers);
+        }
+
+    protected:
+        std::streamsize xsputn(const char_type *data, std::streamsize length) override {
+            outbound->write({{data, size_t(length)}});
+            return length;
+        }
+
+        int overflow(int ch) override {
+            if (ch != traits_type::eof()) {
+                auto c = traits_type::to_char_type(ch);
+                xsputn(&c, 1);
+            }
+            return traits_type::not_eof(ch);
+        }
+
+        int underflow() override {
+            if (this->gptr() < this->egptr()) return traits_type::to_int_type(*this->gptr());
+            if (!inbound->read(input)) return traits_type::eof();
+
+            this->setg(input.data(), input.data(), input.data() + input.size());
+            return traits_type::to_int_type(*this->gptr());
+        }
+
+    private:
+        std::shared_ptr<Pipe> inbound;
+        std::shared_ptr<Pipe> outbound;
+        std::vector<char> input;
+    };
+
+    class MemoryStream : public std::iostream, public Gadgetron::Core::IO::GatherTransport {
+    public:
+        MemoryStream(std::shared_ptr<Pipe> inbound, std::shared_ptr<Pipe> outbound)
+            : std::iostream(nullptr), buffer(std::move(inbound), std::move(outbound)) {
+            this->rdbuf(&buffer);
+        }
+
+        void write_gather(const std::vector<Buffer> &buffers) override {
+            buffer.write_gather(buffers);
+        }
+
+    private:
+        MemoryStreamBuf buffer;
+    };
+}
+
+std::pair<std::unique_ptr<std::iostream>, std::unique_ptr<std::iostream>> Gadgetron::Connection::memory_stream_pair() {
+    auto forward  = std::make_shared<Pipe>();
+    auto backward = std::make_shared<Pipe>();
+
+    return {
+        std::make_unique<MemoryStream>(backward, forward),
+        std::make_unique<MemoryStream>(forward, backward)
+    };
+}
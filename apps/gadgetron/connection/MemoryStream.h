@@ -0,0 +1,13 @@
+#pragma once
+#include <iostream>
+#include <memory>
+#include <utility>
+
+namespace Gadgetron::Connection {
+
+    /**
+     * Two connected streams in the same process; whatever is written to one is read from the other. Data written is
+     * handed over in chunks, without going through the kernel. Destroying a stream ends the input of its peer.
+     */
+    std::pair<std::unique_ptr<std::iostream>, std::unique_ptr<std::iostream>> memory_stream_pair();
+}
@@ -5,23 +5,69 @@
 #include "SocketStreamBuf.h"
 
 #include "Types.h"
+#include "io/primitives.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 #include <boost/asio.hpp>
 namespace {
     using boost::asio::ip::tcp;
+    using Socket = boost::asio::generic::stream_protocol::socket;
+
+    /// Reads start at this size, and grow (up to the maximum) while the socket keeps filling them.
+    constexpr size_t minimum_buffer_size = size_t(64) << 10;
+    constexpr size_t maximum_buffer_size = size_t(4) << 20;
+    /// Single characters are collected here, and passed on with the next write or flush.
+    constexpr size_t put_area_size = size_t(4) << 10;
+
+    std::atomic<size_t> io_threads{ 2 };
 
-    std::unique_ptr<tcp::socket> connect_socket(
+    /// Threads doing the socket I/O of every stream in the process. They are started on first use, so a connection
+    /// handled in a forked process would start its own; those use blocking streams instead (see set_io_threads).
+    boost::asio::io_context& io_context() {
+        static auto context = []() {
+            auto context = new boost::asio::io_context();
+            // Never released; the threads run for the life of the process.
+            new boost::asio::executor_work_guard<boost::asio::io_context::executor_type>(context->get_executor());
+            for (size_t i = 0; i < io_threads; i++) {
+                std::thread([context]() { context->run(); }).detach();
+            }
+            return context;
+        }();
+        return *context;
+    }
+
+    std::unique_ptr<Socket> connect_socket(
         const std::string& host, const std::string& service, boost::asio::io_service& context) {
+        if (host == Gadgetron::Connection::unix_socket_host) {
+            boost::asio::local::stream_protocol::socket socket{ context };
+            socket.connect(boost::asio::local::stream_protocol::endpoint(service));
+            return std::make_unique<Socket>(std::move(socket));
+        }
+
         tcp::resolver resolver{ context };
         auto endpoint = *resolver.resolve(tcp::resolver::query(host, service));
-        auto socket   = std::make_unique<tcp::socket>(context);
-        socket->connect(endpoint);
-        return std::move(socket);
+        tcp::socket socket{ context };
+        socket.connect(endpoint);
+        return std::make_unique<Socket>(std::move(socket));
     }
 
+    /**
+     * Stream buffer doing its socket I/O asynchronously on the shared I/O threads. The next read is always in flight
+     * while the previous one is parsed, and writes are queued and coalesced: whatever is written while a write is in
+     * flight goes out with the next one. Large writes are sent straight from the caller's memory.
+     *
+     * Without I/O threads, the stream is blocking: reads and writes go to the socket on the thread calling them.
+     */
     class SocketStreamBuf : public std::streambuf {
     public:
-        explicit SocketStreamBuf(std::unique_ptr<boost::asio::ip::tcp::socket> socket, size_t buffer_size = 1024);
+        explicit SocketStreamBuf(std::unique_ptr<Socket> socket);
+        ~SocketStreamBuf() override;
+
+        void write_gather(const std::vector<Gadgetron::Core::IO::GatherTransport::Buffer>& buffers);
 
     protected:
         std::streamsize xsputn(const char_type* data, std::streamsize length) override;
@@ -31,49 +77,275 @@ namespace {
         int overflow(int ch = traits_type::eof()) override;
 
     private:
-        std::unique_ptr<boost::asio::ip::tcp::socket> socket;
-        std::vector<char> input_buffer;
-        std::vector<char> output_buffer;
+        using Strand = boost::asio::strand<boost::asio::io_context::executor_type>;
+
+        void start();
+        void start_read(std::unique_lock<std::mutex>& lock);
+        void start_write(std::unique_lock<std::mutex>& lock, std::vector<boost::asio::const_buffer> direct = {});
+        void append(std::unique_lock<std::mutex>& lock, const char* data, size_t bytes);
+        void write_direct(std::unique_lock<std::mutex>& lock, std::vector<boost::asio::const_buffer> buffers);
+        void flush_put_area(std::unique_lock<std::mutex>& lock);
+        void check_write_error() const;
+
+        int underflow_blocking();
+        void write_blocking(std::unique_lock<std::mutex>& lock, const std::vector<boost::asio::const_buffer>& buffers);
+
+        const bool blocking;
+        std::unique_ptr<Socket> socket;
+        std::unique_ptr<Strand> strand;
+        std::once_flag started;
 
-        /* Other members */
+        std::mutex mutex;
+        std::condition_variable changed;
+
+        std::vector<char> input;
+        std::vector<char> incoming;
+        size_t incoming_bytes = 0;
+        size_t read_size      = minimum_buffer_size;
+        bool reading          = false;
+        bool read_done        = false;
+        boost::system::error_code read_error;
+
+        std::vector<char> output;
+        std::vector<char> pending;
+        std::vector<char> writing;
+        size_t writes_started   = 0;
+        size_t writes_completed = 0;
+        boost::system::error_code write_error;
     };
 
-    int SocketStreamBuf::sync() {
-        return this->overflow() != traits_type::eof() ? 0 : -1;
+    SocketStreamBuf::SocketStreamBuf(std::unique_ptr<Socket> socket)
+        : blocking(io_threads == 0), socket(std::move(socket)), output(put_area_size) {
+        this->setg(nullptr, nullptr, nullptr);
+        this->setp(output.data(), output.data() + output.size());
+    }
+
+    SocketStreamBuf::~SocketStreamBuf() {
+        if (blocking) {
+            try { sync(); } catch (...) {}
+
+            boost::system::error_code ignored;
+            socket->shutdown(Socket::shutdown_both, ignored);
+            socket->close(ignored);
+            return;
+        }
+
+        if (!strand && this->pptr() == this->pbase()) return;
+        start();
+
+        try { sync(); } catch (...) {}
+
+        std::unique_lock<std::mutex> lock(mutex);
+        bool closed = false;
+        boost::asio::post(*strand, [&]() {
+            boost::system::error_code ignored;
+            socket->shutdown(Socket::shutdown_both, ignored);
+            socket->close(ignored);
+
+            std::lock_guard<std::mutex> guard(mutex);
+            closed = true;
+            changed.notify_all();
+        });
+        changed.wait(lock, [&]() { return closed && !reading && writes_completed == writes_started; });
     }
+
+    void SocketStreamBuf::start() {
+        if (blocking) return;
+        std::call_once(started, [&]() {
+            // The socket moves to the I/O threads on first use; not when the stream is made, which may be before a fork.
+            auto protocol = socket->local_endpoint().protocol();
+            auto native   = socket->release();
+            socket        = std::make_unique<Socket>(io_context(), protocol, native);
+            strand        = std::make_unique<Strand>(boost::asio::make_strand(io_context()));
+        });
+    }
+
+    void SocketStreamBuf::start_read(std::unique_lock<std::mutex>&) {
+        incoming.resize(read_size);
+        reading   = true;
+        read_done = false;
+
+        boost::asio::post(*strand, [this]() {
+            socket->async_read_some(boost::asio::buffer(incoming.data(), incoming.size()),
+                boost::asio::bind_executor(*strand, [this](const boost::system::error_code& error, size_t bytes) {
+                    std::lock_guard<std::mutex> guard(mutex);
+                    incoming_bytes = bytes;
+                    read_error     = error;
+                    reading        = false;
+                    read_done      = true;
+                    changed.notify_all();
+                }));
+        });
+    }
+
     int SocketStreamBuf::underflow() {
+        if (this->gptr() < this->egptr()) return traits_type::to_int_type(*this->gptr());
+        if (blocking) return underflow_blocking();
+        start();
 
-        auto elements_read = socket->read_some(boost::asio::buffer(this->eback(), input_buffer.size()));
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!reading && !read_done) start_read(lock);
+        changed.wait(lock, [&]() { return read_done; });
 
-        this->setg(this->eback(), this->eback(), this->eback() + elements_read);
+        if (read_error) {
+            if (read_error == boost::asio::error::eof) return traits_type::eof();
+            throw boost::system::system_error(read_error);
+        }
+
+        std::swap(input, incoming);
+        auto bytes = incoming_bytes;
+        if (bytes == input.size()) read_size = std::min(read_size * 2, maximum_buffer_size);
+
+        start_read(lock);
+
+        this->setg(input.data(), input.data(), input.data() + bytes);
         return traits_type::to_int_type(*this->gptr());
     }
-    int SocketStreamBuf::overflow(int ch) {
-        if (this->pptr() != this->pbase()) {
-            boost::asio::write(*socket, boost::asio::buffer(this->pbase(), std::distance(this->pbase(), this->pptr())));
-            this->setp(this->pbase(), this->epptr());
+
+    int SocketStreamBuf::underflow_blocking() {
+        // Reads run on the reading thread, beside writes on other threads; the mutex only guards the writes.
+        input.resize(read_size);
+
+        boost::system::error_code error;
+        auto bytes = socket->read_some(boost::asio::buffer(input.data(), input.size()), error);
+        if (error) {
+            if (error == boost::asio::error::eof) return traits_type::eof();
+            throw boost::system::system_error(error);
         }
-        if (ch != traits_type::eof()) {
-            this->sputc(ch);
+        if (bytes == input.size()) read_size = std::min(read_size * 2, maximum_buffer_size);
+
+        this->setg(input.data(), input.data(), input.data() + bytes);
+        return traits_type::to_int_type(*this->gptr());
+    }
+
+    void SocketStreamBuf::write_blocking(
+        std::unique_lock<std::mutex>&, const std::vector<boost::asio::const_buffer>& buffers) {
+        check_write_error();
+
+        boost::system::error_code error;
+        boost::asio::write(*socket, buffers, error);
+        if (error) write_error = error;
+        check_write_error();
+    }
+
+    void SocketStreamBuf::check_write_error() const {
+        if (write_error) throw boost::system::system_error(write_error);
+    }
+
+    void SocketStreamBuf::start_write(
+        std::unique_lock<std::mutex>&, std::vector<boost::asio::const_buffer> direct) {
+
+        std::swap(pending, writing);
+        pending.clear();
+        writes_started++;
+
+        std::vector<boost::asio::const_buffer> buffers{ boost::asio::buffer(writing) };
+        buffers.insert(buffers.end(), direct.begin(), direct.end());
+
+        boost::asio::post(*strand, [this, buffers = std::move(buffers)]() {
+            boost::asio::async_write(*socket, buffers,
+                boost::asio::bind_executor(*strand, [this](const boost::system::error_code& error, size_t) {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    writes_completed++;
+                    if (error && !write_error) write_error = error;
+                    if (!write_error && !pending.empty()) start_write(lock);
+                    changed.notify_all();
+                }));
+        });
+    }
+
+    void SocketStreamBuf::append(std::unique_lock<std::mutex>& lock, const char* data, size_t bytes) {
+        if (blocking) return write_blocking(lock, { boost::asio::buffer(data, bytes) });
+
+        while (bytes) {
+            changed.wait(lock, [&]() { return write_error || pending.size() < maximum_buffer_size; });
+            check_write_error();
+
+            auto chunk = std::min(bytes, maximum_buffer_size - pending.size());
+            pending.insert(pending.end(), data, data + chunk);
+            data += chunk;
+            bytes -= chunk;
+
+            if (writes_completed == writes_started) start_write(lock);
         }
+    }
 
-        return 0;
+    void SocketStreamBuf::write_direct(std::unique_lock<std::mutex>& lock, std::vector<boost::asio::const_buffer> buffers) {
+        if (blocking) return write_blocking(lock, buffers);
+
+        changed.wait(lock, [&]() { return write_error || writes_completed == writes_started; });
+        check_write_error();
+
+        start_write(lock, std::move(buffers));
+        auto write = writes_started;
+
+        // The buffers belong to the caller; they must be written before we return.
+        changed.wait(lock, [&]() { return write_error || writes_completed >= write; });
+        check_write_error();
+    }
+
+    void SocketStreamBuf::flush_put_area(std::unique_lock<std::mutex>& lock) {
+        if (this->pptr() == this->pbase()) return;
+        append(lock, this->pbase(), this->pptr() - this->pbase());
+        this->setp(output.data(), output.data() + output.size());
     }
 
     std::streamsize SocketStreamBuf::xsputn(const char* data, std::streamsize length) {
-        this->overflow();
-        return boost::asio::write(*socket, boost::asio::buffer(data, length));
+        start();
+        std::unique_lock<std::mutex> lock(mutex);
+        flush_put_area(lock);
+
+        if (size_t(length) >= minimum_buffer_size) {
+            write_direct(lock, { boost::asio::buffer(data, length) });
+        } else {
+            append(lock, data, length);
+        }
+        return length;
+    }
+
+    void SocketStreamBuf::write_gather(const std::vector<Gadgetron::Core::IO::GatherTransport::Buffer>& buffers) {
+        start();
+        std::unique_lock<std::mutex> lock(mutex);
+        flush_put_area(lock);
+
+        size_t bytes = 0;
+        for (auto& buffer : buffers) bytes += buffer.bytes;
+
+        if (bytes < minimum_buffer_size && !blocking) {
+            for (auto& buffer : buffers) append(lock, buffer.data, buffer.bytes);
+            return;
+        }
+
+        std::vector<boost::asio::const_buffer> gathered;
+        gathered.reserve(buffers.size());
+        for (auto& buffer : buffers) gathered.emplace_back(buffer.data, buffer.bytes);
+        write_direct(lock, std::move(gathered));
     }
-    SocketStreamBuf::SocketStreamBuf(std::unique_ptr<boost::asio::ip::tcp::socket> socket, size_t buffer_size)
-        : socket(std::move(socket)), input_buffer(buffer_size), output_buffer(buffer_size) {
-        this->setg(input_buffer.data(), input_buffer.data() + buffer_size, input_buffer.data() + buffer_size);
-        this->setp(output_buffer.data(), output_buffer.data() + buffer_size);
+
+    int SocketStreamBuf::overflow(int ch) {
+        start();
+        std::unique_lock<std::mutex> lock(mutex);
+        flush_put_area(lock);
+
+        if (ch != traits_type::eof()) {
+            *this->pptr() = traits_type::to_char_type(ch);
+            this->pbump(1);
+        }
+        return traits_type::not_eof(ch);
+    }
+
+    int SocketStreamBuf::sync() {
+        if (this->pptr() != this->pbase()) start();
+        std::unique_lock<std::mutex> lock(mutex);
+        flush_put_area(lock);
+        changed.wait(lock, [&]() { return write_error || (writes_completed == writes_started && pending.empty()); });
+        return write_error ? -1 : 0;
     }
 
     using namespace Gadgetron::Connection;
-    class SocketStream : public std::iostream {
+    class SocketStream : public std::iostream, public Gadgetron::Core::IO::GatherTransport {
     public:
-        explicit SocketStream(std::unique_ptr<boost::asio::ip::tcp::socket> socket)
+        explicit SocketStream(std::unique_ptr<Socket> socket)
             : std::iostream(new SocketStreamBuf(std::move(socket))) {
             buffer = std::unique_ptr<SocketStreamBuf>(static_cast<SocketStreamBuf*>(this->rdbuf()));
         }
@@ -86,6 +358,10 @@ namespace {
 
         ~SocketStream() override = default;
 
+        void write_gather(const std::vector<Buffer>& buffers) override {
+            buffer->write_gather(buffers);
+        }
+
     private:
         std::shared_ptr<boost::asio::io_service> io_service;
         std::unique_ptr<SocketStreamBuf> buffer;
@@ -95,10 +371,27 @@ namespace {
 
 std::unique_ptr<std::iostream> Gadgetron::Connection::stream_from_socket(
     std::unique_ptr<boost::asio::ip::tcp::socket> socket) {
-    return std::make_unique<SocketStream>(std::move(socket));
+    return std::make_unique<SocketStream>(std::make_unique<Socket>(std::move(*socket)));
+}
+
+std::unique_ptr<std::iostream> Gadgetron::Connection::stream_from_socket(
+    std::unique_ptr<boost::asio::local::stream_protocol::socket> socket) {
+    return std::make_unique<SocketStream>(std::make_unique<Socket>(std::move(*socket)));
 }
 
 std::unique_ptr<std::iostream> Gadgetron::Connection::remote_stream(
     const std::string& host, const std::string& service) {
     return std::make_unique<SocketStream>(host, service);
 }
+
+void Gadgetron::Connection::configure_socket(boost::asio::ip::tcp::socket& socket, const SocketSettings& settings) {
+    socket.set_option(tcp::no_delay(settings.no_delay));
+    if (settings.buffer_size) {
+        socket.set_option(boost::asio::socket_base::receive_buffer_size(int(settings.buffer_size)));
+        socket.set_option(boost::asio::socket_base::send_buffer_size(int(settings.buffer_size)));
+    }
+}
+
+void Gadgetron::Connection::set_io_threads(size_t threads) {
+    io_threads = threads;
+}
@@ -1,10 +1,32 @@
-
 #pragma once
 #include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
 #include <iostream>
 
 namespace Gadgetron::Connection {
 
+    struct SocketSettings {
+        bool no_delay = true;
+        /// Kernel send and receive buffer size, in bytes; zero leaves the system default
+        size_t buffer_size = 0;
+    };
+
+    /**
+     * Socket streams do their I/O on a small set of threads shared by every stream in the process, rather than on
+     * the threads reading and writing the stream. Messages are still decoded on the threads reading the stream, as
+     * readers parse from a std::istream.
+     */
     std::unique_ptr<std::iostream> stream_from_socket(std::unique_ptr<boost::asio::ip::tcp::socket> socket);
+    std::unique_ptr<std::iostream> stream_from_socket(std::unique_ptr<boost::asio::local::stream_protocol::socket> socket);
+
+    /// Host naming a Unix domain socket; the service is then the path of the socket.
+    constexpr const char *unix_socket_host = "unix";
+
     std::unique_ptr<std::iostream> remote_stream(const std::string & host, const std::string& service);
-}
\ No newline at end of file
+
+    void configure_socket(boost::asio::ip::tcp::socket& socket, const SocketSettings& settings);
+
+    /// Number of shared I/O threads; takes effect if set before the first socket stream is used. Zero starts none,
+    /// and streams made then do blocking I/O on the threads reading and writing them.
+    void set_io_threads(size_t threads);
+}
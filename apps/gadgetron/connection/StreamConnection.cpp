@@ -1,6 +1,8 @@
 
 #include <memory>
 
+#include <boost/core/demangle.hpp>
+
 #include "StreamConnection.h"
 
 #include "Handlers.h"
@@ -12,6 +14,7 @@
 #include "Channel.h"
 #include "Context.h"
 #include "MessageID.h"
+#include "trace.h"
 
 static constexpr const char* CONFIG_ERROR =  "Received second config file. Only one allowed.";
 static constexpr const char* HEADER_ERROR = "Received second ISMRMRD header. Only one allowed.";
@@ -27,13 +30,20 @@ namespace {
     class ReaderHandler : public Handler {
     public:
         ReaderHandler(std::unique_ptr<Reader> &&reader)
-                : reader(std::move(reader)) {}
+                : reader(std::move(reader)),
+                  trace_name(Gadgetron::Trace::intern("read " + boost::core::demangle(typeid(*this->reader).name()))),
+                  read_count(Metrics::counter("gadgetron_messages_read_total", "Messages read from clients.",
+                          {{"reader", boost::core::demangle(typeid(*this->reader).name())}})) {}
 
         void handle(std::istream &stream, OutputChannel &channel) override {
+            Gadgetron::Trace::Scope scope(trace_name, "io");
             channel.push_message(reader->read(stream));
+            read_count.increment();
         }
 
         std::unique_ptr<Reader> reader;
+        const char *trace_name;
+        Metrics::Counter read_count;
         std::shared_ptr<MessageChannel> channel;
     };
 
@@ -76,8 +86,8 @@ namespace Gadgetron::Server::Connection::StreamConnection {
 
         Loader loader{context};
 
-        auto ichannel = make_channel<MessageChannel>();
-        auto ochannel = make_channel<MessageChannel>();
+        auto ichannel = make_channel<MessageChannel>("input");
+        auto ochannel = make_channel<MessageChannel>("output");
 
         auto readers = loader.load_readers(config);
         auto writers = loader.load_writers(config);
@@ -146,6 +146,8 @@ namespace {
         static pugi::xml_node add_node(const Config::External &external, pugi::xml_node &node) {
 
             auto external_node = node.append_child("external");
+            if (external.transport == Config::External::Transport::shared_memory)
+                external_node.append_attribute("transport").set_value("shared_memory");
 
             add_readers(external.readers, external_node);
             add_writers(external.writers, external_node);
@@ -174,6 +176,15 @@ namespace {
             return parallel_node;
         }
 
+        static pugi::xml_node add_node(const Config::OrderedParallel& ordered, pugi::xml_node& node){
+            auto ordered_node = node.append_child("orderedparallel");
+            ordered_node.append_attribute("workers").set_value((long long unsigned int)ordered.workers);
+            ordered_node.append_attribute("window").set_value((long long unsigned int)ordered.window);
+            if (ordered.distributor) add_node(*ordered.distributor, ordered_node);
+            add_node(ordered.stream, ordered_node);
+            return ordered_node;
+        }
+
         static pugi::xml_node add_node(const Config::PureStream& stream, pugi::xml_node& node){
             auto purestream_node = node.append_child("purestream");
             for (auto& gadget : stream.gadgets){
@@ -484,6 +495,7 @@ namespace {
             node_parsers["distributed"] = [&](const pugi::xml_node &n) { return this->parse_distributed(n); };
             node_parsers["parallelprocess"] = [&](const pugi::xml_node &n) { return this->parse_parallelprocess(n); };
             node_parsers["puredistributed"] = [&](const pugi::xml_node &n) { return this->parse_puredistributed(n); };
+            node_parsers["orderedparallel"] = [&](const pugi::xml_node &n) { return this->parse_orderedparallel(n); };
         }
 
         std::unordered_map<std::string, std::function<Config::Node(const pugi::xml_node &)>> node_parsers;
@@ -502,12 +514,21 @@ namespace {
 
         Config::External parse_external(const pugi::xml_node &external_node) {
 
-            return Config::External{
+            auto external = Config::External{
                 parse_action(external_node),
                 parse_action_configuration(external_node),
                 parse_readers(external_node.child("readers")),
                 parse_writers(external_node.child("writers"))
             };
+            external.transport = parse_transport(external_node);
+            return external;
+        }
+
+        static Config::External::Transport parse_transport(const pugi::xml_node &external_node) {
+            std::string transport = external_node.attribute("transport").value();
+            if (transport.empty() || transport == "stream") return Config::External::Transport::stream;
+            if (transport == "shared_memory") return Config::External::Transport::shared_memory;
+            throw ConfigNodeError("Unknown transport '" + transport + "' for external node", external_node);
         }
 
         Config::Distributed parse_distributed(const pugi::xml_node &distributed_node) {
@@ -547,6 +568,22 @@ namespace {
             return {readers,writers,purestream};
         }
 
+        static size_t parse_count(const pugi::xml_node &node, const char *name) {
+            std::string value = node.attribute(name).value();
+            return value.empty() ? 0 : std::stoul(value);
+        }
+
+        Config::OrderedParallel parse_orderedparallel(const pugi::xml_node &ordered_node) {
+            Config::OrderedParallel ordered{};
+            ordered.workers = parse_count(ordered_node, "workers");
+            ordered.window = parse_count(ordered_node, "window");
+            if (ordered_node.child("distributor")) {
+                ordered.distributor = parse_node<Config::Distributor>(ordered_node.child("distributor"));
+            }
+            ordered.stream = parse_stream(ordered_node.child("stream"));
+            return ordered;
+        }
+
         static optional<std::string> parse_target(std::string s) {
             if (s.empty()) return none;
             return s;
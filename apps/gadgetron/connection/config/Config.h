@@ -16,7 +16,8 @@ namespace Gadgetron::Server::Connection {
         struct Distributed;
         struct ParallelProcess;
         struct PureDistributed;
-        using Node = Core::variant<Gadget, External, Parallel, Distributed, ParallelProcess, PureDistributed>;
+        struct OrderedParallel;
+        using Node = Core::variant<Gadget, External, Parallel, Distributed, ParallelProcess, PureDistributed, OrderedParallel>;
 
         template<class CONFIG>
         static std::string name(CONFIG config) {
@@ -70,6 +71,10 @@ namespace Gadgetron::Server::Connection {
 
             std::vector<Reader> readers;
             std::vector<Writer> writers;
+
+            /// Array payloads go through shared memory rather than the socket, if the peer agrees
+            enum class Transport { stream, shared_memory };
+            Transport transport = Transport::stream;
         };
 
         struct Branch : Gadget { using Gadget::Gadget;};
@@ -101,6 +106,15 @@ namespace Gadgetron::Server::Connection {
             Stream stream;
         };
 
+        struct OrderedParallel {
+            /// Number of local workers, each with its own copy of the stream; 0 means one per core
+            size_t workers = 0;
+            /// Maximal number of inputs in flight; 0 means twice the number of workers
+            size_t window = 0;
+            Core::optional<Distributor> distributor;
+            Stream stream;
+        };
+
         std::vector<Reader> readers;
         std::vector<Writer> writers;
         Stream stream;
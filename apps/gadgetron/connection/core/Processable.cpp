@@ -1,5 +1,8 @@
 #include "Processable.h"
 
+#include "Metrics.h"
+#include "trace.h"
+
 
 std::thread Gadgetron::Server::Connection::Processable::process_async(
     std::shared_ptr<Processable> processable,
@@ -11,6 +14,10 @@ std::thread Gadgetron::Server::Connection::Processable::process_async(
 
     return nested_handler.run(
         [=](auto input, auto output, auto error_handler) {
+          Trace::set_thread_name(processable->name());
+          Core::Metrics::GaugeGuard active{Core::Metrics::gauge(
+              "gadgetron_node_active", "Running instances of the node.", {{"node", processable->name()}}
+          )};
           processable->process(std::move(input), std::move(output), error_handler);
         },
         std::move(input),
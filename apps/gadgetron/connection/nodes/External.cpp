@@ -2,6 +2,7 @@
 
 #include "common/Closer.h"
 #include "common/ExternalChannel.h"
+#include "common/SharedMemory.h"
 
 #include "connection/SocketStreamBuf.h"
 #include "connection/config/Config.h"
@@ -60,7 +61,7 @@ namespace Gadgetron::Server::Connection::Nodes {
     std::shared_ptr<ExternalChannel> External::open_connection(Config::Connect connect, const StreamContext &context) {
         GINFO_STREAM("Connecting to external module on address: " << connect.address << ":" << connect.port);
         return std::make_shared<ExternalChannel>(
-                Gadgetron::Connection::remote_stream(connect.address, connect.port),
+                negotiate_transport(Gadgetron::Connection::remote_stream(connect.address, connect.port)),
                 serialization,
                 configuration
         );
@@ -93,7 +94,7 @@ namespace Gadgetron::Server::Connection::Nodes {
 
         GINFO_STREAM("Connected to external module '" << execute.name << "' on port: " << port);
 
-        auto stream = Gadgetron::Connection::stream_from_socket(std::move(socket));
+        auto stream = negotiate_transport(Gadgetron::Connection::stream_from_socket(std::move(socket)));
         auto external_channel = std::make_shared<ExternalChannel>(
                 std::move(stream),
                 serialization,
@@ -103,6 +104,11 @@ namespace Gadgetron::Server::Connection::Nodes {
         return external_channel;
     }
 
+    std::unique_ptr<std::iostream> External::negotiate_transport(std::unique_ptr<std::iostream> stream) {
+        if (transport != Config::External::Transport::shared_memory) return stream;
+        return negotiate_shared_memory(std::move(stream));
+    }
+
     std::shared_ptr<ExternalChannel> External::open_external_channel(
             const Config::External &config,
             const StreamContext &context
@@ -124,7 +130,8 @@ namespace Gadgetron::Server::Connection::Nodes {
         configuration(std::make_shared<Configuration>(
                 context,
                 config
-        )) {
+        )),
+        transport(config.transport) {
         channel = std::async(
                 std::launch::async,
                 [=](auto config, auto context) { return open_external_channel(config, context); },
@@ -40,12 +40,14 @@ namespace Gadgetron::Server::Connection::Nodes {
         std::shared_ptr<ExternalChannel> open_connection(Config::Execute, const Core::StreamContext &);
         std::shared_ptr<ExternalChannel> open_connection(Config::Connect, const Core::StreamContext &);
         std::shared_ptr<ExternalChannel> open_external_channel(const Config::External &, const Core::StreamContext &);
+        std::unique_ptr<std::iostream> negotiate_transport(std::unique_ptr<std::iostream> stream);
 
         void monitor_child(std::shared_ptr<boost::process::child>, std::shared_ptr<boost::asio::ip::tcp::acceptor>);
 
         std::future<std::shared_ptr<ExternalChannel>> channel;
         std::shared_ptr<Serialization> serialization;
         std::shared_ptr<Configuration> configuration;
+        const Config::External::Transport transport;
 
         boost::asio::io_service io_service;
 
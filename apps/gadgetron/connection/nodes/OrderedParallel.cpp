@@ -0,0 +1,164 @@
+#include "OrderedParallel.h"
+
+#include <algorithm>
+#include <mutex>
+#include <thread>
+
+#include "connection/Loader.h"
+
+#include "common/Sequencer.h"
+
+namespace {
+    using namespace Gadgetron::Core;
+    using namespace Gadgetron::Core::Distributed;
+    using namespace Gadgetron::Server::Connection;
+    using namespace Gadgetron::Server::Connection::Nodes;
+
+    struct Worker {
+        explicit Worker(OutputChannel input) : input(std::move(input)) {}
+
+        std::mutex mutex;
+        OutputChannel input;
+    };
+
+    /**
+     * The channels handed to the distributor. A message pushed here is numbered and sent to the worker, followed by
+     * its marker. Without a worker (the bypass), the message is its own result.
+     */
+    class SequencedChannel : public Channel {
+    public:
+        SequencedChannel(Sequencer &sequencer, std::shared_ptr<Worker> worker)
+            : sequencer(sequencer), worker(std::move(worker)) {}
+
+    protected:
+        void push_message(Message message) override {
+            if (!worker) {
+                auto sequence = sequencer.acquire();
+                std::vector<Message> results;
+                results.push_back(std::move(message));
+                sequencer.complete(sequence, std::move(results));
+                return;
+            }
+
+            std::lock_guard<std::mutex> guard(worker->mutex);
+            auto sequence = sequencer.acquire();
+            worker->input.push_message(std::move(message));
+            worker->input.push(SequenceMarker{sequence});
+        }
+
+        // The distributor only pushes; the worker input closes once every channel bound to it is gone.
+        Message pop() override { throw ChannelClosed(); }
+        optional<Message> try_pop() override { return none; }
+        void close() override {}
+
+    private:
+        Sequencer &sequencer;
+        const std::shared_ptr<Worker> worker;
+    };
+
+    OutputChannel make_sequenced_channel(Sequencer &sequencer, std::shared_ptr<Worker> worker) {
+        return std::move(make_channel<SequencedChannel>(sequencer, std::move(worker)).output);
+    }
+
+    class ChannelCreatorImpl : public ChannelCreator {
+    public:
+        ChannelCreatorImpl(Sequencer &sequencer, std::vector<std::shared_ptr<Worker>> workers)
+            : sequencer(sequencer), workers(std::move(workers)) {}
+
+        OutputChannel create() override {
+            auto worker = workers[next++ % workers.size()];
+            return make_sequenced_channel(sequencer, std::move(worker));
+        }
+
+    private:
+        Sequencer &sequencer;
+        std::vector<std::shared_ptr<Worker>> workers;
+        size_t next = 0;
+    };
+
+    std::unique_ptr<Distributor> load_distributor(
+            Loader &loader,
+            const Context &context,
+            const optional<Config::Distributor> &conf
+    ) {
+        if (!conf) return nullptr;
+        auto factory = loader.load_factory<Loader::generic_factory<Distributor>>(
+                "distributor_factory_export_", conf->classname, conf->dll);
+        return factory(context, conf->properties);
+    }
+
+    size_t worker_count(size_t workers) {
+        return workers ? workers : std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+}
+
+namespace Gadgetron::Server::Connection::Nodes {
+
+    OrderedParallel::OrderedParallel(
+            const Config::OrderedParallel &config,
+            const Core::StreamContext &context,
+            Loader &loader
+    ) : distributor(load_distributor(loader, context, config.distributor)),
+        window(config.window ? config.window : 2 * worker_count(config.workers)) {
+        for (size_t i = 0; i < worker_count(config.workers); i++) {
+            streams.push_back(std::make_shared<Stream>(config.stream, context, loader));
+        }
+    }
+
+    void OrderedParallel::process(
+            Core::GenericInputChannel input,
+            Core::OutputChannel output,
+            ErrorHandler &error_handler
+    ) {
+        ErrorHandler nested_handler{error_handler, name()};
+        Sequencer sequencer{std::move(output), window};
+
+        std::vector<std::shared_ptr<Worker>> workers;
+        std::vector<std::thread> threads;
+        std::vector<std::vector<Message>> leftovers(streams.size());
+
+        for (size_t i = 0; i < streams.size(); i++) {
+            auto worker_input = make_channel<MessageChannel>(streams[i]->name());
+            auto worker_output = make_channel<MessageChannel>();
+
+            workers.push_back(std::make_shared<Worker>(std::move(worker_input.output)));
+            threads.push_back(Processable::process_async(
+                    streams[i],
+                    std::move(worker_input.input),
+                    std::move(worker_output.output),
+                    nested_handler
+            ));
+            threads.push_back(nested_handler.run(
+                    [&, i](auto worker_output) {
+                        leftovers[i] = collect_sequenced(std::move(worker_output), sequencer);
+                        sequencer.unbound();
+                    },
+                    std::move(worker_output.input)
+            ));
+        }
+
+        // The workers' inputs close as the creator and the channels it made go out of scope.
+        nested_handler.handle([&]() {
+            auto bypass = make_sequenced_channel(sequencer, nullptr);
+            auto creator = ChannelCreatorImpl{sequencer, std::move(workers)};
+
+            if (distributor) {
+                distributor->process(std::move(input), creator, std::move(bypass));
+            } else {
+                for (auto message : input) creator.create().push_message(std::move(message));
+            }
+        });
+
+        for (auto &thread : threads) thread.join();
+
+        sequencer.flush();
+        for (auto &messages : leftovers) {
+            for (auto &message : messages) sequencer.output.push_message(std::move(message));
+        }
+    }
+
+    const std::string &OrderedParallel::name() {
+        static const std::string n = "OrderedParallel";
+        return n;
+    }
+}
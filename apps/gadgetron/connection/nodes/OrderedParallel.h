@@ -0,0 +1,51 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "distributed/Distributor.h"
+
+#include "connection/Loader.h"
+#include "connection/config/Config.h"
+#include "connection/core/Processable.h"
+
+#include "Channel.h"
+#include "Context.h"
+#include "Stream.h"
+
+namespace Gadgetron::Server::Connection::Nodes {
+
+    /**
+     * Runs a stream on several local workers, each with its own instance of every gadget, and emits the results in
+     * the order their inputs arrived - as if the stream had run serially.
+     *
+     * The distributor decides which worker sees a message. Each channel it creates is bound to one worker, round
+     * robin, so data it keys together (e.g. a slice) always meets the same gadget state. Without a distributor, each
+     * message goes to the next worker. Messages passed to the bypass keep their place in the output order.
+     *
+     * At most 'window' inputs are in flight. Once the window is full, the distributor blocks until the results of the
+     * oldest input have been emitted.
+     *
+     * Every input is followed through its worker by a marker, which tells the node that the results of the input are
+     * complete. The gadgets of the stream must therefore pass on messages they do not handle, as Gadget1 and
+     * ChannelGadget do. A gadget holding data back (e.g. an accumulator) is fine; its output is emitted in the
+     * place of the input that released it.
+     */
+    class OrderedParallel : public Processable {
+    public:
+        OrderedParallel(const Config::OrderedParallel &, const Core::StreamContext &, Loader &);
+
+        void process(
+                Core::GenericInputChannel input,
+                Core::OutputChannel output,
+                ErrorHandler &error_handler
+        ) override;
+
+        const std::string &name() override;
+
+    private:
+        std::unique_ptr<Core::Distributed::Distributor> distributor;
+        std::vector<std::shared_ptr<Stream>> streams;
+        const size_t window;
+    };
+}
@@ -30,6 +30,12 @@ namespace Gadgetron::Server::Connection::Nodes {
             OutputChannel output,
             ErrorHandler& error_handler
     ) {
+        if (workers == 1) {
+            // Nothing to overlap; skip the pool and the queue.
+            for (auto message : input) output.push_message(pureStream.process_function(std::move(message)));
+            return;
+        }
+
         Queue queue;
 
         auto input_thread = error_handler.run(
@@ -49,11 +55,16 @@ namespace Gadgetron::Server::Connection::Nodes {
             const Config::ParallelProcess& conf,
             const Context& context,
             Loader& loader
-    ) : pureStream{ conf.stream, context, loader }, workers{ conf.workers } {}
+    ) : workers{ conf.workers }, pureStream{ conf.stream, context, loader }, name_{ "ParallelProcess" } {}
+
+    ParallelProcess::ParallelProcess(
+            std::vector<std::unique_ptr<GenericPureGadget>> gadgets,
+            size_t workers,
+            std::string name
+    ) : workers{ workers }, pureStream{ std::move(gadgets) }, name_{ std::move(name) } {}
 
     const std::string& ParallelProcess::name() {
-        const static std::string n = "ParallelProcess";
-        return n;
+        return name_;
     }
 }
 
@@ -10,6 +10,10 @@ namespace Gadgetron::Server::Connection::Nodes {
 
     public:
         ParallelProcess(const Config::ParallelProcess& conf, const Core::Context& context, Loader& loader);
+
+        /// Runs already loaded pure gadgets, in order, as a single node; see Stream.
+        ParallelProcess(std::vector<std::unique_ptr<Core::GenericPureGadget>> gadgets, size_t workers, std::string name);
+
         void process(Core::GenericInputChannel input, Core::OutputChannel output, ErrorHandler& error_handler) override;
         const std::string& name() override;
     private:
@@ -21,5 +25,6 @@ namespace Gadgetron::Server::Connection::Nodes {
 
         const size_t workers;
         const PureStream pureStream;
+        const std::string name_;
     };
 }
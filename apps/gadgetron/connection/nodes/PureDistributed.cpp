@@ -56,6 +56,18 @@ namespace {
     }
 }
 
+namespace {
+
+    Pool::Settings pool_settings(const StreamContext &context) {
+        Pool::Settings settings;
+        if (context.args.count("worker_rediscovery_interval"))
+            settings.rediscovery_interval = std::chrono::seconds(context.args["worker_rediscovery_interval"].as<unsigned int>());
+        if (context.args.count("straggler_factor"))
+            settings.straggler_factor = context.args["straggler_factor"].as<double>();
+        return settings;
+    }
+}
+
 namespace Gadgetron::Server::Connection::Nodes {
 
 
@@ -63,7 +75,7 @@ namespace Gadgetron::Server::Connection::Nodes {
 
         auto closer = make_closer(jobs);
 
-        auto workers = Pool(finish_connecting_to_peers(std::move(pending_workers)));
+        auto workers = Pool(finish_connecting_to_peers(std::move(pending_workers)), serialization, configuration, settings);
 
         for (auto message : input) {
             jobs->push(workers.push(std::move(message)));
@@ -106,7 +118,8 @@ namespace Gadgetron::Server::Connection::Nodes {
         configuration(std::make_shared<Configuration>(
                 context,
                 config
-        )) {
+        )),
+        settings(pool_settings(context)) {
         pending_workers = begin_connecting_to_peers(std::async(discover_peers), serialization, configuration);
     }
 
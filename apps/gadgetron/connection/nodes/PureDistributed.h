@@ -47,5 +47,6 @@ namespace Gadgetron::Server::Connection::Nodes {
         std::shared_ptr<Configuration> configuration;
 
         std::list<std::future<std::unique_ptr<Worker>>> pending_workers;
+        const Pool::Settings settings;
     };
 }
@@ -8,6 +8,7 @@ namespace Gadgetron::Server::Connection::Nodes {
     class PureStream {
     public:
         PureStream(const Config::PureStream&, const Core::Context&, Loader&);
+        explicit PureStream(std::vector<std::unique_ptr<Core::GenericPureGadget>> pure_gadgets);
         Core::Message process_function(Core::Message) const;
 
     private:
@@ -3,6 +3,7 @@
 #include "Distributed.h"
 #include "External.h"
 #include "Parallel.h"
+#include "OrderedParallel.h"
 #include "ParallelProcess.h"
 #include "PureDistributed.h"
 #include "connection/core/Processable.h"
@@ -10,6 +11,7 @@
 #include "connection/Loader.h"
 
 #include "Node.h"
+#include "PureGadget.h"
 
 namespace {
     using namespace Gadgetron::Core;
@@ -29,31 +31,10 @@ namespace {
         return visit([](auto& ac){return print_action(ac);}, action);
     }
 
-    class NodeProcessable : public Processable {
-    public:
-        NodeProcessable(std::function<std::unique_ptr<Node>()> factory, std::string name) : factory(std::move(factory)), name_(std::move(name)) {}
-
-        void process(GenericInputChannel input,
-                OutputChannel output,
-                ErrorHandler &
-        ) override {
-            auto node = factory();
-            node->process(input, output);
-        }
-
-        const std::string& name() override {
-            return name_;
-        }
-
-    private:
-        std::function<std::unique_ptr<Node>()> factory;
-        const std::string name_;
-    };
-
     std::shared_ptr<Processable> load_node(const Config::Gadget &conf, const StreamContext &context, Loader &loader) {
         auto factory = loader.load_factory<Loader::generic_factory<Node>>("gadget_factory_export_", conf.classname,
                                                                           conf.dll);
-        return std::make_shared<NodeProcessable>(
+        return std::make_shared<GadgetNode>(
             [=]() {
                 GDEBUG("Loading Gadget %s of class %s from %s\n", conf.name.c_str(), conf.classname.c_str(), conf.dll.c_str());
                 return factory(context, conf.properties);
@@ -86,6 +67,11 @@ namespace {
         GDEBUG("Loading PureDistributed block\n");
         return std::make_shared<Nodes::PureDistributed>(conf,context,loader);
     }
+
+    std::shared_ptr<Processable> load_node(const Config::OrderedParallel &conf, const StreamContext &context, Loader &loader) {
+        GDEBUG("Loading OrderedParallel block with %zu workers\n", conf.workers);
+        return std::make_shared<Nodes::OrderedParallel>(conf, context, loader);
+    }
 }
 
 namespace Gadgetron::Server::Connection::Nodes {
@@ -96,8 +82,15 @@ namespace Gadgetron::Server::Connection::Nodes {
                     Core::visit([&](auto n) { return load_node(n, context, loader); }, node_config)
             );
         }
+
+        auto fuse = context.args.count("fuse_pure_gadgets") && context.args["fuse_pure_gadgets"].as<bool>();
+        auto workers = context.args.count("pure_gadget_workers") ? context.args["pure_gadget_workers"].as<size_t>() : 1;
+        if (fuse) nodes = fuse_pure_gadgets(std::move(nodes), workers);
     }
 
+    Stream::Stream(std::string key, std::vector<std::shared_ptr<Processable>> nodes)
+        : key(std::move(key)), nodes(std::move(nodes)) {}
+
     void Stream::process(GenericInputChannel input,
             OutputChannel output,
             ErrorHandler &error_handler
@@ -109,7 +102,7 @@ namespace Gadgetron::Server::Connection::Nodes {
         std::vector<OutputChannel> output_channels{};
 
         for (auto i = 0; i < nodes.size()-1; i++) {
-            auto channel = make_channel<MessageChannel>();
+            auto channel = make_channel<MessageChannel>(nodes[i+1]->name());
             input_channels.emplace_back(std::move(channel.input));
             output_channels.emplace_back(std::move(channel.output));
         }
@@ -134,6 +127,64 @@ namespace Gadgetron::Server::Connection::Nodes {
     }
 
     bool Stream::empty() const { return nodes.empty(); }
+
+    GadgetNode::GadgetNode(std::function<std::unique_ptr<Node>()> factory, std::string name)
+        : factory(std::move(factory)), name_(std::move(name)) {}
+
+    void GadgetNode::process(GenericInputChannel input, OutputChannel output, ErrorHandler &) {
+        auto node = loaded ? std::move(loaded) : factory();
+        node->process(input, output);
+    }
+
+    const std::string &GadgetNode::name() {
+        return name_;
+    }
+
+    bool GadgetNode::pure() {
+        if (!loaded) loaded = factory();
+        return dynamic_cast<GenericPureGadget *>(loaded.get()) != nullptr;
+    }
+
+    std::unique_ptr<GenericPureGadget> GadgetNode::take_pure_gadget() {
+        return std::unique_ptr<GenericPureGadget>(static_cast<GenericPureGadget *>(loaded.release()));
+    }
+
+    std::vector<std::shared_ptr<Processable>> fuse_pure_gadgets(
+            std::vector<std::shared_ptr<Processable>> nodes,
+            size_t workers
+    ) {
+        std::vector<std::shared_ptr<Processable>> fused;
+        std::vector<std::shared_ptr<GadgetNode>> run;
+
+        auto end_run = [&]() {
+            if (run.size() > 1 || (run.size() == 1 && workers != 1)) {
+                std::string name;
+                std::vector<std::unique_ptr<GenericPureGadget>> gadgets;
+                for (auto &node : run) {
+                    name += (name.empty() ? "" : "+") + node->name();
+                    gadgets.push_back(node->take_pure_gadget());
+                }
+                GDEBUG_STREAM("Fusing pure gadgets " << name);
+                fused.push_back(std::make_shared<ParallelProcess>(std::move(gadgets), workers, name));
+            } else {
+                fused.insert(fused.end(), run.begin(), run.end());
+            }
+            run.clear();
+        };
+
+        for (auto &node : nodes) {
+            auto gadget = std::dynamic_pointer_cast<GadgetNode>(node);
+            if (gadget && gadget->pure()) {
+                run.push_back(std::move(gadget));
+                continue;
+            }
+            end_run();
+            fused.push_back(std::move(node));
+        }
+        end_run();
+
+        return fused;
+    }
 }
 
 const std::string &Gadgetron::Server::Connection::Nodes::Stream::name() {
@@ -10,6 +10,8 @@
 
 #include "Channel.h"
 #include "Context.h"
+#include "Node.h"
+#include "PureGadget.h"
 
 namespace Gadgetron::Server::Connection {
     class Loader;
@@ -21,6 +23,7 @@ namespace Gadgetron::Server::Connection::Nodes {
     public:
         const std::string key;
         Stream(const Config::Stream &, const Core::StreamContext &, Loader &);
+        Stream(std::string key, std::vector<std::shared_ptr<Processable>> nodes);
 
         void process(
                 Core::GenericInputChannel input,
@@ -34,4 +37,38 @@ namespace Gadgetron::Server::Connection::Nodes {
     private:
         std::vector<std::shared_ptr<Processable>> nodes;
     };
+
+    /**
+     * A gadget in a stream. The gadget is built on its node thread when the stream starts, unless fusion has built it
+     * already; see fuse_pure_gadgets.
+     */
+    class GadgetNode : public Processable {
+    public:
+        GadgetNode(std::function<std::unique_ptr<Core::Node>()> factory, std::string name);
+
+        void process(Core::GenericInputChannel input, Core::OutputChannel output, ErrorHandler &) override;
+        const std::string &name() override;
+
+        /// Builds the gadget now, to find out whether it is a pure gadget.
+        bool pure();
+        std::unique_ptr<Core::GenericPureGadget> take_pure_gadget();
+
+    private:
+        std::function<std::unique_ptr<Core::Node>()> factory;
+        std::unique_ptr<Core::Node> loaded;
+        const std::string name_;
+    };
+
+    /**
+     * Replaces each run of adjacent pure gadgets with a single node, which passes every message through the whole run
+     * before taking the next. This saves a thread and a channel hop per gadget. With more than one worker, messages
+     * are processed concurrently, and leave the node in the order they arrived.
+     *
+     * Gadgets are built here rather than when the stream starts, as only a built gadget knows whether it is pure.
+     * This builds every gadget of the stream one after another, so fusion is opt-in (--fuse_pure_gadgets).
+     */
+    std::vector<std::shared_ptr<Processable>> fuse_pure_gadgets(
+            std::vector<std::shared_ptr<Processable>> nodes,
+            size_t workers
+    );
 }
@@ -1,11 +1,14 @@
 #include "External.h"
 
 #include <memory>
+#include <thread>
 
 #include <boost/asio.hpp>
 
 #include "system_info.h"
 
+#include "connection/Core.h"
+#include "connection/MemoryStream.h"
 #include "connection/SocketStreamBuf.h"
 #include "log.h"
 
@@ -24,15 +27,24 @@ namespace {
 namespace {
     using namespace Gadgetron::Server::Connection::Nodes;
 
-    Remote as_remote(Local, const std::shared_ptr<Configuration> &configuration) {
-        return Remote {
-                "localhost",
-                std::to_string(configuration->context.args["port"].as<unsigned short>())
-        };
+    /// The local worker is a connection handled in this process, on a stream pair; no sockets are involved.
+    std::unique_ptr<std::iostream> connect_to(Local, const std::shared_ptr<Configuration> &configuration) {
+        auto streams = Gadgetron::Connection::memory_stream_pair();
+        const auto &context = configuration->context;
+
+        std::thread(
+                Gadgetron::Server::Connection::handle_connection,
+                std::move(streams.second),
+                context.paths,
+                context.args,
+                context.storage_address
+        ).detach();
+
+        return std::move(streams.first);
     }
 
-    Remote as_remote(Remote remote, const std::shared_ptr<Configuration> &) {
-        return remote;
+    std::unique_ptr<std::iostream> connect_to(const Remote &remote, const std::shared_ptr<Configuration> &) {
+        return connect(remote);
     }
 }
 
@@ -77,6 +89,6 @@ namespace Gadgetron::Server::Connection::Nodes {
     }
 
     std::unique_ptr<std::iostream> connect(const Address &address, std::shared_ptr<Configuration> configuration) {
-        return connect(Core::visit([&](auto address) { return as_remote(address, configuration); }, address));
+        return Core::visit([&](auto address) { return connect_to(address, configuration); }, address);
     }
 }
@@ -17,6 +17,7 @@ namespace Gadgetron::Server::Connection::Nodes {
     };
 
     struct Local  {};
+    /// An address of "unix" is a Unix domain socket; the port is then the path of the socket.
     struct Remote { std::string address, port; };
 
     using  Address = Core::variant<Remote, Local>;
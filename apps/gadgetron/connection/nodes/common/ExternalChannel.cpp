@@ -11,6 +11,7 @@ namespace Gadgetron::Server::Connection::Nodes {
 
     class ExternalChannel::Outbound::Closed : public ExternalChannel::Outbound {
         void push(Core::Message message) override { throw Core::ChannelClosed(); }
+        void write(const std::string &) override { throw Core::ChannelClosed(); }
         void close() override {}
     };
 
@@ -28,6 +29,11 @@ namespace Gadgetron::Server::Connection::Nodes {
             channel->serialization->write(*channel->stream, std::move(message));
         }
 
+        void write(const std::string &bytes) override {
+            std::lock_guard<std::mutex> guard{channel->mutex};
+            channel->stream->write(bytes.data(), bytes.size());
+        }
+
         void close() override {
             std::lock_guard<std::mutex> guard{channel->mutex};
             channel->serialization->close(*channel->stream);
@@ -95,6 +101,10 @@ namespace Gadgetron::Server::Connection::Nodes {
         outbound->push(std::move(message));
     }
 
+    void ExternalChannel::push_serialized(const std::string &bytes) {
+        outbound->write(bytes);
+    }
+
     void ExternalChannel::close() {
         outbound->close();
     }
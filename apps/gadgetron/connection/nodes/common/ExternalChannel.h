@@ -30,6 +30,8 @@ namespace Gadgetron::Server::Connection::Nodes {
 
         Core::Message pop();
         void push_message(Core::Message message);
+        /// Writes a message already serialized with the channel's serialization
+        void push_serialized(const std::string &bytes);
         void close();
         bool accepts(const Core::Message& message);
 
@@ -43,6 +45,7 @@ namespace Gadgetron::Server::Connection::Nodes {
         public:
             virtual ~Outbound() = default;
             virtual void push(Core::Message message) = 0;
+            virtual void write(const std::string &bytes) = 0;
             virtual void close() = 0;
 
             class Open; class Closed;
@@ -0,0 +1,52 @@
+#include "Sequencer.h"
+
+namespace Gadgetron::Server::Connection::Nodes {
+
+    Sequencer::Sequencer(Core::OutputChannel output, size_t window) : output(std::move(output)), window(window) {}
+
+    size_t Sequencer::acquire() {
+        std::unique_lock<std::mutex> lock(mutex);
+        window_open.wait(lock, [&]() { return !bounded || next_sequence - next_emit < window; });
+        return next_sequence++;
+    }
+
+    void Sequencer::complete(size_t sequence, std::vector<Core::Message> results) {
+        std::lock_guard<std::mutex> guard(mutex);
+        completed.emplace(sequence, std::move(results));
+
+        while (!completed.empty() && completed.begin()->first == next_emit) {
+            for (auto &message : completed.begin()->second) output.push_message(std::move(message));
+            completed.erase(completed.begin());
+            next_emit++;
+        }
+        window_open.notify_all();
+    }
+
+    void Sequencer::unbound() {
+        std::lock_guard<std::mutex> guard(mutex);
+        bounded = false;
+        window_open.notify_all();
+    }
+
+    void Sequencer::flush() {
+        std::lock_guard<std::mutex> guard(mutex);
+        for (auto &entry : completed) {
+            for (auto &message : entry.second) output.push_message(std::move(message));
+        }
+        completed.clear();
+    }
+
+    std::vector<Core::Message> collect_sequenced(Core::GenericInputChannel worker_output, Sequencer &sequencer) {
+        std::vector<Core::Message> results;
+        for (auto message : worker_output) {
+            if (Core::convertible_to<SequenceMarker>(message)) {
+                auto marker = Core::force_unpack<SequenceMarker>(std::move(message));
+                sequencer.complete(marker.sequence, std::move(results));
+                results.clear();
+                continue;
+            }
+            results.push_back(std::move(message));
+        }
+        return results;
+    }
+}
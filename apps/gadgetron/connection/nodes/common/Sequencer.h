@@ -0,0 +1,57 @@
+#pragma once
+
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "Channel.h"
+#include "Message.h"
+
+namespace Gadgetron::Server::Connection::Nodes {
+
+    /// Follows an input through its worker; all results of the input are ahead of it.
+    struct SequenceMarker {
+        size_t sequence;
+    };
+
+    /**
+     * Numbers the inputs of an OrderedParallel node, and emits the results of each input once all earlier inputs
+     * have been emitted. At most 'window' inputs are numbered but not yet emitted.
+     */
+    class Sequencer {
+    public:
+        Sequencer(Core::OutputChannel output, size_t window);
+
+        /// Blocks while the window is full.
+        size_t acquire();
+
+        void complete(size_t sequence, std::vector<Core::Message> results);
+
+        /// A worker has stopped, so some inputs may never complete. Stop waiting for them.
+        void unbound();
+
+        /// Emits whatever is still held, in order, once every worker has stopped.
+        void flush();
+
+        Core::OutputChannel output;
+
+    private:
+        std::mutex mutex;
+        std::condition_variable window_open;
+
+        const size_t window;
+        bool bounded = true;
+
+        size_t next_sequence = 0;
+        size_t next_emit = 0;
+        std::map<size_t, std::vector<Core::Message>> completed;
+    };
+
+    /**
+     * Collects the output of a worker, and hands it to the sequencer input by input: everything up to a marker is
+     * the result of the marker's input. Returns what follows the last marker, which was released as the worker shut
+     * down.
+     */
+    std::vector<Core::Message> collect_sequenced(Core::GenericInputChannel worker_output, Sequencer &sequencer);
+}
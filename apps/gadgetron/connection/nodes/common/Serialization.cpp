@@ -13,20 +13,16 @@ namespace Gadgetron::Server::Connection::Nodes {
     Serialization::Serialization(
             Readers readers,
             Writers writers
-    ) : readers(std::move(readers)), writers(std::move(writers)) {}
+    ) : readers(std::move(readers)), writers(std::move(writers)), dispatch(this->writers) {}
 
     void Serialization::write(std::iostream &stream, Core::Message message) const {
 
-        auto writer = std::find_if(
-                writers.begin(),
-                writers.end(),
-                [&](auto& writer) { return writer->accepts(message); }
-        );
+        auto index = dispatch.find(message);
 
-        if (writer == writers.end())
+        if (index == WriterDispatch::none)
             throw std::runtime_error("Could not find appropriate writer for message.");
 
-        (*writer)->write(stream, std::move(message));
+        dispatch[index].write(stream, std::move(message));
     }
 
     Core::Message Serialization::read(
@@ -35,25 +31,36 @@ namespace Gadgetron::Server::Connection::Nodes {
             std::function<void(std::string message)> on_error
     ) const {
 
-        auto id = IO::read<uint16_t>(stream);
-        auto illegal_message = [&](auto &) {
-            throw std::runtime_error("Received illegal message id from external peer: " + std::to_string(id));
-        };
-
-        const std::map<uint16_t, std::function<void(std::iostream &)>> handlers{
-                {FILENAME,  illegal_message},
-                {CONFIG,    illegal_message},
-                {HEADER,    illegal_message},
-                {CLOSE,     [&](auto &) { on_close(); }},
-                {TEXT,      illegal_message},
-                {QUERY,     illegal_message},
-                {RESPONSE,  illegal_message},
-                {ERROR,     [&](auto &stream) { on_error(IO::read_string_from_stream<uint64_t>(stream)); }}
-        };
-
-        for (; handlers.count(id); id = IO::read<uint16_t>(stream)) handlers.at(id)(stream);
-        if (!readers.count(id)) illegal_message(stream);
-        return readers.at(id)->read(stream);
+        while (true) {
+            auto id = IO::read<uint16_t>(stream);
+            auto illegal_message = [&]() {
+                return std::runtime_error("Received illegal message id from external peer: " + std::to_string(id));
+            };
+
+            switch (id) {
+                case CLOSE:
+                    on_close();
+                    continue;
+                case ERROR:
+                    on_error(IO::read_string_from_stream<uint64_t>(stream));
+                    continue;
+                case FILENAME:
+                case CONFIG:
+                case HEADER:
+                case TEXT:
+                case QUERY:
+                case RESPONSE:
+                case SHARED_MEMORY:
+                    throw illegal_message();
+                default:
+                    break;
+            }
+
+            auto reader = readers.find(id);
+            if (reader == readers.end()) throw illegal_message();
+
+            return reader->second->read(stream);
+        }
     }
 
     void Serialization::close(std::iostream &stream) const {
@@ -61,12 +68,6 @@ namespace Gadgetron::Server::Connection::Nodes {
     }
 
     bool Serialization::accepts(const Message &message) {
-        auto writer = std::find_if(
-                writers.begin(),
-                writers.end(),
-                [&](auto& writer) { return writer->accepts(message); }
-        );
-        if (writer == writers.end()) return false;
-        return true;
+        return dispatch.accepts(message);
     }
 }
\ No newline at end of file
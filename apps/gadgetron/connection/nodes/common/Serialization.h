@@ -6,6 +6,7 @@
 
 #include "Reader.h"
 #include "Writer.h"
+#include "WriterDispatch.h"
 
 namespace Gadgetron::Server::Connection::Nodes {
 
@@ -28,5 +29,6 @@ namespace Gadgetron::Server::Connection::Nodes {
     private:
         const Readers readers;
         const Writers writers;
+        const Core::WriterDispatch dispatch;
     };
 }
\ No newline at end of file
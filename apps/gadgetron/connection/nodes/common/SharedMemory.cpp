@@ -0,0 +1,236 @@
+#include "SharedMemory.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <random>
+
+#include "log.h"
+#include "MessageID.h"
+
+#if !(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace Gadgetron::Core;
+
+namespace {
+
+    constexpr uint32_t version = 1;
+    constexpr uint64_t inline_payload = std::numeric_limits<uint64_t>::max();
+    constexpr uint64_t alignment = 64;
+    constexpr uint64_t header_size = 4096;
+    constexpr uint64_t ring_capacity = uint64_t(128) << 20;
+    constexpr uint64_t threshold = 64 * 1024;
+
+    static_assert(threshold >= IO::BulkTransport::minimum_threshold, "Smaller payloads are never offered to the transport.");
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "Rings shared between processes must be lock free.");
+
+    struct alignas(64) Ring {
+        std::atomic<uint64_t> head;
+        std::atomic<uint64_t> tail;
+        uint64_t offset;
+        uint64_t capacity;
+    };
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t reserved;
+        uint64_t size;
+        Ring rings[2];
+    };
+
+    static_assert(offsetof(Header, size) == 16 && offsetof(Header, rings) == 64 && sizeof(Ring) == 64,
+                  "The segment layout is part of the external protocol.");
+
+    enum Direction { outbound = 0, inbound = 1 };
+
+    uint64_t aligned(uint64_t bytes) {
+        return (bytes + alignment - 1) / alignment * alignment;
+    }
+
+    class Segment {
+    public:
+        Segment(const Segment &) = delete;
+        Segment &operator=(const Segment &) = delete;
+
+        static std::unique_ptr<Segment> create();
+
+        ~Segment() {
+            unlink();
+#if !(_WIN32)
+            munmap(memory, size);
+#endif
+        }
+
+        void unlink() {
+#if !(_WIN32)
+            if (!linked) return;
+            shm_unlink(name.c_str());
+            linked = false;
+#endif
+        }
+
+        Header &header() { return *reinterpret_cast<Header *>(memory); }
+        Ring &ring(Direction direction) { return header().rings[direction]; }
+        // The layout is taken from the constants it was created with; the peer can write to the header.
+        char *data(Direction direction, uint64_t position) {
+            return static_cast<char *>(memory) + header_size + direction * ring_capacity + position % ring_capacity;
+        }
+
+        const std::string name;
+        const uint64_t size;
+
+    private:
+        Segment(std::string name, uint64_t size, void *memory) : name(std::move(name)), size(size), memory(memory) {}
+
+        void *memory;
+        bool linked = true;
+    };
+
+#if !(_WIN32)
+    /**
+     * Sizes the shared memory object, and allocates its pages up front where the platform can. A segment that is only
+     * truncated to size is sparse; if /dev/shm is smaller than the segment (64 MB in a default Docker container),
+     * writing past the space left raises SIGBUS instead of failing here.
+     */
+    bool reserve(int fd, uint64_t size) {
+#if defined(__linux__)
+        return posix_fallocate(fd, 0, off_t(size)) == 0;
+#else
+        return ftruncate(fd, off_t(size)) == 0;
+#endif
+    }
+#endif
+
+    std::unique_ptr<Segment> Segment::create() {
+#if !(_WIN32)
+        std::random_device random;
+        auto name = "/gadgetron-" + std::to_string(getpid()) + "-" + std::to_string(random());
+        uint64_t size = header_size + 2 * ring_capacity;
+
+        int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0) return nullptr;
+
+        void *memory = MAP_FAILED;
+        if (reserve(fd, size))
+            memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+
+        if (memory == MAP_FAILED) {
+            shm_unlink(name.c_str());
+            return nullptr;
+        }
+
+        auto header = new (memory) Header{};
+        std::memcpy(header->magic, "GTSHMEM", 8);
+        header->version = version;
+        header->size = size;
+        for (int direction : { outbound, inbound }) {
+            auto &ring = header->rings[direction];
+            ring.offset = header_size + direction * ring_capacity;
+            ring.capacity = ring_capacity;
+        }
+
+        return std::unique_ptr<Segment>(new Segment(std::move(name), size, memory));
+#else
+        return nullptr;
+#endif
+    }
+
+    class SharedMemoryStream : public std::iostream, public IO::BulkTransport {
+    public:
+        SharedMemoryStream(std::unique_ptr<std::iostream> stream, std::unique_ptr<Segment> segment)
+            : std::iostream(stream->rdbuf()), stream(std::move(stream)), segment(std::move(segment)) {
+            exceptions(this->stream->exceptions());
+        }
+
+        size_t threshold() const override { return ::threshold; }
+
+        void write_bulk(const char *data, size_t bytes) override {
+            auto &ring = segment->ring(outbound);
+            auto size = aligned(bytes);
+
+            auto position = ring.head.load(std::memory_order_relaxed);
+            auto offset = position % ring_capacity;
+            if (offset + size > ring_capacity) position += ring_capacity - offset;
+
+            if (size > ring_capacity || position + size - ring.tail.load(std::memory_order_acquire) > ring_capacity) {
+                IO::write(static_cast<std::ostream &>(*this), inline_payload);
+                this->write(data, bytes);
+                return;
+            }
+
+            std::memcpy(segment->data(outbound, position), data, bytes);
+            ring.head.store(position + size, std::memory_order_release);
+            IO::write(static_cast<std::ostream &>(*this), position);
+        }
+
+        void read_bulk(char *data, size_t bytes) override {
+            auto position = IO::read<uint64_t>(*this);
+            if (position == inline_payload) {
+                this->read(data, bytes);
+                return;
+            }
+
+            // The block has to lie in [tail, head): written by the peer, and not yet released by us.
+            auto &ring = segment->ring(inbound);
+            auto tail = ring.tail.load(std::memory_order_relaxed);
+            auto head = ring.head.load(std::memory_order_acquire);
+            auto size = aligned(bytes);
+
+            if (bytes > ring_capacity || head < tail || position < tail || position > head || size > head - position ||
+                position % ring_capacity + bytes > ring_capacity)
+                throw std::runtime_error("External peer sent a shared memory block outside the ring.");
+
+            std::memcpy(data, segment->data(inbound, position), bytes);
+            ring.tail.store(position + size, std::memory_order_release);
+        }
+
+    private:
+        std::unique_ptr<std::iostream> stream;
+        std::unique_ptr<Segment> segment;
+    };
+}
+
+namespace Gadgetron::Server::Connection::Nodes {
+
+    std::unique_ptr<std::iostream> negotiate_shared_memory(std::unique_ptr<std::iostream> stream) {
+
+        auto segment = Segment::create();
+        if (!segment) {
+            GWARN_STREAM("Unable to create shared memory segment; external node will use the stream transport.");
+            return stream;
+        }
+
+        IO::write(*stream, SHARED_MEMORY);
+        IO::write(*stream, version);
+        IO::write_string_to_stream<uint32_t>(*stream, segment->name);
+        IO::write(*stream, segment->size);
+        IO::write(*stream, threshold);
+        stream->flush();
+
+        auto id = IO::read<uint16_t>(*stream);
+        if (id == ERROR)
+            throw std::runtime_error("External peer rejected the shared memory transport: " +
+                                     IO::read_string_from_stream<uint64_t>(*stream));
+        if (id != SHARED_MEMORY)
+            throw std::runtime_error("Expected shared memory answer from external peer; received message id " +
+                                     std::to_string(id));
+
+        auto accepted = IO::read<uint32_t>(*stream);
+        segment->unlink();
+
+        if (!accepted) {
+            GINFO_STREAM("External peer declined the shared memory transport; using the stream transport.");
+            return stream;
+        }
+
+        GDEBUG_STREAM("External node uses shared memory segment " << segment->name);
+        return std::make_unique<SharedMemoryStream>(std::move(stream), std::move(segment));
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <iostream>
+#include <memory>
+
+#include "io/primitives.h"
+
+namespace Gadgetron::Server::Connection::Nodes {
+
+    /**
+     * Shared memory data plane for external nodes on the same host.
+     *
+     * Handshake, sent by the Gadgetron before the configuration when the external node asks for
+     * transport="shared_memory":
+     *
+     *     uint16 SHARED_MEMORY, uint32 version (1), uint32 name length, name, uint64 segment size, uint64 threshold
+     *
+     * The peer maps the POSIX shared memory object with the given name, and answers:
+     *
+     *     uint16 SHARED_MEMORY, uint32 accepted (0 or 1)
+     *
+     * The name is unlinked once the answer arrives. If the peer declines, or the segment could not be created, the
+     * connection continues with the stream protocol as before.
+     *
+     * Segment layout (little endian, offsets in bytes):
+     *
+     *     0   char[8]  magic "GTSHMEM"
+     *     8   uint32   version
+     *     16  uint64   segment size
+     *     64  ring     Gadgetron to peer
+     *     128 ring     peer to Gadgetron
+     *
+     * A ring is { uint64 head, uint64 tail, uint64 offset, uint64 capacity }. Head and tail are monotonic byte
+     * counters; the producer advances head, the consumer advances tail. Blocks are 64 byte aligned and never wrap; a
+     * block that would cross the end of the ring starts at the beginning of the next lap instead.
+     *
+     * With the transport accepted, every contiguous payload of at least 'threshold' bytes (the data of arrays, images
+     * and acquisitions) is replaced on the stream by a uint64 descriptor. All-ones means the payload follows inline,
+     * as before; this is used whenever the ring is full. Anything else is the position p of the block in the ring;
+     * the payload is at offset + p % capacity. The consumer releases the block by storing p + aligned size in tail.
+     * Blocks must be released in order; a peer may keep a block mapped (as a NumPy view, say) until it is done with it.
+     */
+    std::unique_ptr<std::iostream> negotiate_shared_memory(std::unique_ptr<std::iostream> stream);
+}
@@ -1,6 +1,9 @@
-
 #include "Pool.h"
 
+#include <cmath>
+#include <limits>
+#include <sstream>
+
 #include "connection/nodes/common/Discovery.h"
 
 #include "log.h"
@@ -12,52 +15,329 @@ using namespace Gadgetron;
 
 namespace {
 
-    bool compare_load(const std::unique_ptr<Worker> &a, const std::unique_ptr<Worker> &b) {
-        return a->current_load() < b->current_load();
+    /// How often the dispatcher looks for stragglers and new workers, when nothing else wakes it.
+    constexpr auto tick = std::chrono::milliseconds(100);
+
+    std::string label(const Address &address) {
+        std::stringstream stream; stream << address;
+        return stream.str();
     }
 
-    std::unique_ptr<Worker> &select_best_worker(std::list<std::unique_ptr<Worker>> &workers) {
-        return *std::min_element(workers.begin(), workers.end(), compare_load);
+    Worker::Payload serialize(const Serialization &serialization, Message message) {
+        std::stringstream stream;
+        serialization.write(stream, std::move(message));
+        return std::make_shared<const std::string>(stream.str());
     }
 
-    Message send_to_best_worker(
-            Message message,
-            std::shared_ptr<std::list<std::unique_ptr<Worker>>> workers,
-            size_t retries
+    Pool::Connector remote_workers(
+            std::shared_ptr<Serialization> serialization,
+            std::shared_ptr<Configuration> configuration
     ) {
+        return {
+            discover_remote_peers,
+            [=](Address address) { return std::make_unique<Worker>(std::move(address), serialization, configuration); }
+        };
+    }
+}
+
+namespace Gadgetron::Server::Connection::Nodes {
+
+    struct Pool::Job {
+        Worker::Payload payload;
+        std::promise<Message> response;
+
+        bool done = false;
+        size_t failures = 0;
+
+        /// Workers running the job; more than one once it has been sent again as a straggler.
+        std::vector<Worker *> workers;
+        Clock::time_point started;
+        double predicted = 0;
+    };
+
+    Pool::Pool(
+            std::list<std::unique_ptr<Worker>> workers,
+            std::shared_ptr<Serialization> serialization,
+            std::shared_ptr<Configuration> configuration,
+            Settings settings
+    ) : Pool(std::move(workers), serialization, remote_workers(serialization, std::move(configuration)), settings) {}
+
+    Pool::Pool(
+            std::list<std::unique_ptr<Worker>> workers,
+            std::shared_ptr<Serialization> serialization,
+            Connector connector,
+            Settings settings
+    ) : serialization(std::move(serialization)),
+        connector(std::move(connector)),
+        settings(settings),
+        workers(std::move(workers)),
+        next_discovery(Clock::now() + settings.rediscovery_interval) {
+
+        for (auto &worker : this->workers) addresses.insert(label(worker->address));
+        dispatcher = std::thread([this]() { dispatch(); });
+    }
+
+    Pool::~Pool() {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&]() { return outstanding == 0; });
+            stopping = true;
+            changed.notify_all();
+        }
+        dispatcher.join();
+
+        // Workers finish their inbound threads as they are destroyed; these may still call back into the pool.
+        std::list<std::unique_ptr<Worker>> remaining;
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            remaining.swap(workers);
+        }
+    }
+
+    std::future<Message> Pool::push(Message message) {
+        auto job = std::make_shared<Job>();
+        job->payload = serialize(*serialization, std::move(message));
+        auto future = job->response.get_future();
+
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [&]() { return outstanding < capacity(); });
+
+        queue.push_back(std::move(job));
+        outstanding++;
+        changed.notify_all();
+
+        return future;
+    }
+
+    size_t Pool::capacity() const {
+        return settings.jobs_queued_per_worker * std::max<size_t>(workers.size(), 1);
+    }
+
+    void Pool::dispatch() {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        while (!stopping) {
+            std::list<std::unique_ptr<Worker>> retired;
+            maintain_workers(retired);
+            if (!retired.empty()) {
+                lock.unlock(); retired.clear(); lock.lock();
+                continue;
+            }
+
+            if (send_next_job(lock) || speculate(lock)) continue;
+
+            changed.wait_for(lock, tick);
+        }
+    }
+
+    Worker *Pool::best_worker(size_t bytes, const std::vector<Worker *> &excluded, bool idle) const {
+
+        // Until a worker has completed a job, assume it is as fast as the fastest measured worker. New workers are
+        // then tried right away, and measured.
+        auto default_rate = std::numeric_limits<double>::infinity();
+        for (auto &worker : workers) {
+            if (auto rate = worker->rate()) default_rate = std::min(default_rate, *rate);
+        }
+        if (std::isinf(default_rate)) default_rate = 0;
+
+        Worker *best = nullptr;
+        auto best_completion = std::numeric_limits<double>::infinity();
+        size_t best_pending = 0;
+
+        for (auto &worker : workers) {
+            if (worker->closed()) continue;
+            if (std::find(excluded.begin(), excluded.end(), worker.get()) != excluded.end()) continue;
+
+            auto pending = worker->pending();
+            if (idle && pending) continue;
+
+            auto completion = worker->predicted_completion(bytes, default_rate);
+            if (!best || completion < best_completion || (completion == best_completion && pending < best_pending)) {
+                best = worker.get();
+                best_completion = completion;
+                best_pending = pending;
+            }
+        }
+
+        // If the best worker has enough jobs already, the job waits for it rather than going to a slower worker.
+        if (best && best_pending >= settings.jobs_per_worker) return nullptr;
+        return best;
+    }
 
-        if (!retries) throw std::runtime_error("Multiple workers failed processing job; aborting.");
+    bool Pool::send_next_job(std::unique_lock<std::mutex> &lock) {
+        if (queue.empty()) return false;
 
-        auto &worker = select_best_worker(*workers);
+        auto job = queue.front();
+        auto worker = best_worker(job->payload->size(), {}, false);
+        if (!worker) return false;
 
+        queue.pop_front();
+        running.push_back(job);
+
+        job->started = Clock::now();
+        job->predicted = worker->predicted_completion(job->payload->size(), 0);
+        job->workers.push_back(worker);
+
+        lock.unlock();
+        send(job, worker);
+        lock.lock();
+        return true;
+    }
+
+    bool Pool::speculate(std::unique_lock<std::mutex> &lock) {
+        if (settings.straggler_factor <= 0 || !queue.empty()) return false;
+
+        auto now = Clock::now();
+        for (auto &job : running) {
+            if (job->done || job->workers.size() != 1) continue;
+
+            auto running_for = std::chrono::duration<double>(now - job->started).count();
+            auto patience = std::max(
+                    settings.straggler_factor * job->predicted,
+                    std::chrono::duration<double>(settings.minimum_straggler_time).count()
+            );
+            if (running_for < patience) continue;
+
+            auto worker = best_worker(job->payload->size(), job->workers, true);
+            if (!worker) return false;
+
+            GDEBUG_STREAM("Job running for " << running_for << "s on worker " << job->workers.front()->address
+                          << "; sending it to worker " << worker->address << " as well.");
+            job->workers.push_back(worker);
+
+            auto speculative = job;
+            lock.unlock();
+            send(std::move(speculative), worker);
+            lock.lock();
+            return true;
+        }
+        return false;
+    }
+
+    void Pool::send(std::shared_ptr<Job> job, Worker *worker) {
         try {
-            auto response = worker->push(message.clone());
-            GDEBUG_STREAM("Pushed message; waiting for response from worker " << worker->address);
-            auto response_message = response.get();
-            GDEBUG_STREAM("Response gotten from worker " << worker->address);
-            return std::move(response_message);
+            worker->push(job->payload, Worker::Callbacks{
+                    [=](Message message) { completed(job, worker, std::move(message)); },
+                    [=](std::exception_ptr error) { failed(job, worker, error); }
+            });
         }
+        catch (const std::exception &) {
+            failed(job, worker, std::current_exception());
+        }
+    }
+
+    void Pool::completed(const std::shared_ptr<Job> &job, Worker *worker, Message message) {
+        std::lock_guard<std::mutex> guard(mutex);
+
+        auto &assigned = job->workers;
+        assigned.erase(std::remove(assigned.begin(), assigned.end(), worker), assigned.end());
+        if (job->done) return;
+
+        job->response.set_value(std::move(message));
+        finish(job);
+    }
+
+    void Pool::failed(const std::shared_ptr<Job> &job, Worker *worker, std::exception_ptr error) {
+        std::lock_guard<std::mutex> guard(mutex);
+
+        // Only a worker the job is assigned to can fail it.
+        auto &assigned = job->workers;
+        auto assignment = std::find(assigned.begin(), assigned.end(), worker);
+        if (assignment == assigned.end()) return;
+        assigned.erase(assignment);
+
+        // Another worker may still complete it.
+        if (job->done || !assigned.empty()) return;
+
+        try { std::rethrow_exception(error); }
         catch (const std::exception &e) {
             GWARN_STREAM("Worker " << worker->address << " failed processing job. The job will be retried. [" << e.what() << "]");
-            return send_to_best_worker(std::move(message), std::move(workers), retries - 1);
         }
+
+        if (++job->failures >= settings.retries) {
+            job->response.set_exception(std::make_exception_ptr(
+                    std::runtime_error("Multiple workers failed processing job; aborting.")));
+            finish(job);
+            return;
+        }
+
+        running.remove(job);
+        queue.push_front(job);
+        changed.notify_all();
     }
-}
 
-namespace Gadgetron::Server::Connection::Nodes {
+    void Pool::finish(const std::shared_ptr<Job> &job) {
+        job->done = true;
+        running.remove(job);
+        outstanding--;
+        changed.notify_all();
+    }
 
-    Pool::Pool(
-            std::list<std::unique_ptr<Worker>> workers
-    ) : workers(std::make_shared<std::list<std::unique_ptr<Worker>>>(std::move(workers))) {}
+    void Pool::maintain_workers(std::list<std::unique_ptr<Worker>> &retired) {
 
-    std::future<Message> Pool::push(Message message) {
-        return std::async(
-                std::launch::async,
-                send_to_best_worker,
-                std::move(message),
-                workers,
-                3
-        );
+        for (auto it = connecting.begin(); it != connecting.end();) {
+            if (it->wait_for(std::chrono::seconds(0)) != std::future_status::ready) { ++it; continue; }
+            try {
+                auto worker = it->get();
+                GINFO_STREAM("Worker " << worker->address << " joined.");
+                workers.push_back(std::move(worker));
+                changed.notify_all();
+            }
+            catch (const std::exception &e) {
+                GWARN_STREAM("Failed connecting to worker with error: " << e.what());
+            }
+            it = connecting.erase(it);
+        }
+
+        // Addresses are dropped once their connection fails or closes; if the worker comes back, it is found again.
+        std::set<std::string> live;
+        for (auto it = workers.begin(); it != workers.end();) {
+            if ((*it)->closed() && !(*it)->pending()) {
+                GINFO_STREAM("Worker " << (*it)->address << " left.");
+                retired.push_back(std::move(*it));
+                it = workers.erase(it);
+                continue;
+            }
+            live.insert(label((*it)->address));
+            ++it;
+        }
+        if (connecting.empty()) addresses = live;
+
+        // With every worker gone, look for new ones once before giving up on the jobs waiting.
+        auto stranded = workers.empty() && connecting.empty() && !discovery.valid() && !queue.empty();
+        if (stranded && !searched_for_workers) {
+            searched_for_workers = true;
+            next_discovery = Clock::now();
+            stranded = false;
+        }
+        if (!workers.empty()) searched_for_workers = false;
+
+        discover_workers();
+
+        if (stranded) {
+            while (!queue.empty()) {
+                auto job = queue.front(); queue.pop_front();
+                job->response.set_exception(std::make_exception_ptr(
+                        std::runtime_error("No workers available; cannot distribute work.")));
+                finish(job);
+            }
+        }
     }
-}
 
+    void Pool::discover_workers() {
+        if (!discovery.valid()) {
+            if (settings.rediscovery_interval.count() == 0 && !searched_for_workers) return;
+            if (Clock::now() < next_discovery) return;
+            discovery = std::async(std::launch::async, connector.discover);
+            next_discovery = Clock::now() + settings.rediscovery_interval;
+            return;
+        }
+
+        if (discovery.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return;
+
+        for (auto &address : discovery.get()) {
+            if (!addresses.insert(label(address)).second) continue;
+            connecting.emplace_back(std::async(std::launch::async, connector.connect, address));
+        }
+    }
+}
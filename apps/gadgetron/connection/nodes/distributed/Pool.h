@@ -1,6 +1,12 @@
 #pragma once
 
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <deque>
 #include <mutex>
+#include <set>
+#include <thread>
 #include <vector>
 #include <memory>
 #include <future>
@@ -15,12 +21,96 @@
 
 namespace Gadgetron::Server::Connection::Nodes {
 
+    /**
+     * Sends each job to the worker predicted to complete it first, based on the size of the job and the rate each
+     * worker has been measured to work at. A single dispatcher thread hands out the jobs, and each worker sends its
+     * jobs on a thread of its own. A worker is given a few jobs ahead of its responses, and the rest wait in the pool,
+     * until it is clear which worker will be free first.
+     *
+     * A job taking much longer than predicted is sent to an idle worker as well, and the first response is used.
+     * A job lost to a failed worker is sent again, up to 'retries' times.
+     *
+     * Workers are discovered again at an interval; new workers are connected and put to work as they appear, and
+     * workers that close their connection are dropped.
+     */
     class Pool {
     public:
-        explicit Pool(std::list<std::unique_ptr<Worker>> workers);
+        struct Settings {
+            /// Jobs sent to a worker ahead of its responses, hiding the round trip
+            size_t jobs_per_worker = 2;
+            /// Jobs queued or running, per worker, before push blocks
+            size_t jobs_queued_per_worker = 4;
+            /// A job running this many times longer than predicted is sent to an idle worker as well; 0 disables
+            double straggler_factor = 3.0;
+            /// A job is never considered a straggler before it has run this long
+            std::chrono::milliseconds minimum_straggler_time = std::chrono::seconds(1);
+            /// Interval between worker discoveries; 0 disables rediscovery
+            std::chrono::seconds rediscovery_interval = std::chrono::seconds(30);
+            size_t retries = 3;
+        };
+
+        /// Finds the addresses of workers, and connects to them.
+        struct Connector {
+            std::function<std::vector<Address>()> discover;
+            std::function<std::unique_ptr<Worker>(Address)> connect;
+        };
+
+        Pool(
+                std::list<std::unique_ptr<Worker>> workers,
+                std::shared_ptr<Serialization> serialization,
+                std::shared_ptr<Configuration> configuration,
+                Settings settings
+        );
+
+        Pool(
+                std::list<std::unique_ptr<Worker>> workers,
+                std::shared_ptr<Serialization> serialization,
+                Connector connector,
+                Settings settings
+        );
+
+        /// Waits for every job pushed to complete or fail.
+        ~Pool();
+
+        /// Blocks while the pool is full.
         std::future<Core::Message> push(Core::Message message);
 
     private:
-        std::shared_ptr<std::list<std::unique_ptr<Worker>>> workers;
+        using Clock = std::chrono::steady_clock;
+        struct Job;
+
+        void dispatch();
+        void send(std::shared_ptr<Job> job, Worker *worker);
+        bool send_next_job(std::unique_lock<std::mutex> &lock);
+        bool speculate(std::unique_lock<std::mutex> &lock);
+        void maintain_workers(std::list<std::unique_ptr<Worker>> &retired);
+        void discover_workers();
+        Worker *best_worker(size_t bytes, const std::vector<Worker *> &excluded, bool idle) const;
+        size_t capacity() const;
+
+        void completed(const std::shared_ptr<Job> &job, Worker *worker, Core::Message message);
+        void failed(const std::shared_ptr<Job> &job, Worker *worker, std::exception_ptr error);
+        void finish(const std::shared_ptr<Job> &job);
+
+        const std::shared_ptr<Serialization> serialization;
+        const Connector connector;
+        const Settings settings;
+
+        std::mutex mutex;
+        std::condition_variable changed;
+
+        std::list<std::unique_ptr<Worker>> workers;
+        std::list<std::future<std::unique_ptr<Worker>>> connecting;
+        std::set<std::string> addresses;
+        std::future<std::vector<Address>> discovery;
+        Clock::time_point next_discovery;
+        bool searched_for_workers = false;
+
+        std::deque<std::shared_ptr<Job>> queue;
+        std::list<std::shared_ptr<Job>> running;
+        size_t outstanding = 0;
+        bool stopping = false;
+
+        std::thread dispatcher;
     };
-}
\ No newline at end of file
+}
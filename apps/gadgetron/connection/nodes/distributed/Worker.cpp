@@ -1,8 +1,11 @@
 
 #include "Worker.h"
 
+#include <algorithm>
 #include <chrono>
 #include <future>
+#include <limits>
+#include <sstream>
 
 #include "connection/nodes/common/External.h"
 #include "connection/nodes/common/ExternalChannel.h"
@@ -14,19 +17,22 @@ using namespace Gadgetron::Server::Connection::Nodes;
 
 namespace {
 
-    template<class T>
-    std::chrono::milliseconds time_since(std::chrono::time_point<T> instance) {
-        return std::chrono::duration_cast<std::chrono::milliseconds>(
-                std::chrono::steady_clock::now() - instance
-        );
+    using Clock = std::chrono::steady_clock;
+
+    double seconds_since(Clock::time_point instance) {
+        return std::chrono::duration<double>(Clock::now() - instance).count();
     }
+
+    /// Weight of the latest job in the measured rate.
+    constexpr double rate_smoothing = 0.3;
 }
 
 namespace Gadgetron::Server::Connection::Nodes {
 
     struct Worker::Job {
-        std::chrono::time_point<std::chrono::steady_clock> start;
-        std::promise<Core::Message> response;
+        Clock::time_point start;
+        size_t bytes;
+        Callbacks callbacks;
     };
 
     struct Module {
@@ -38,44 +44,47 @@ namespace Gadgetron::Server::Connection::Nodes {
     struct Worker::PushModule : public Module {
         using Module::Module;
 
-        virtual std::future<Message> push(Message message) {
+        virtual void push(Payload payload, Callbacks callbacks) {
             GDEBUG_STREAM("Pushing message to remote worker " << worker.address);
 
-            Job job {
-                    std::chrono::steady_clock::now(),
-                    std::promise<Message>()
-            };
+            worker.jobs.push_back(Job{Clock::now(), payload->size(), std::move(callbacks)});
+            worker.bytes_in_flight += payload->size();
+            worker.jobs_in_flight.add(1);
 
-            auto future = job.response.get_future();
-            worker.channel->push_message(std::move(message));
-            worker.jobs.push_back(std::move(job));
-            return future;
+            worker.outbound.push_back(std::move(payload));
+            worker.outbound_changed.notify_one();
         };
     };
 
     struct Worker::LoadModule : public Module {
         using Module::Module;
 
-        virtual long long current_load() {
-            auto current_job_duration_estimate = std::max(
-                    worker.timing.latest.count(),
-                    time_since(worker.jobs.front().start).count()
-            );
+        virtual double predicted_completion(size_t bytes, double default_rate) {
+            auto rate = worker.timing.seconds_per_byte.value_or(default_rate);
+            if (worker.jobs.empty()) return rate * bytes;
 
-            return current_job_duration_estimate * worker.jobs.size();
+            // The job at the front has been running since it was sent, or since the job before it completed.
+            auto &front = worker.jobs.front();
+            auto running = seconds_since(std::max(front.start, worker.timing.latest_completion));
+            auto front_remaining = std::max(0.0, rate * front.bytes - running);
+
+            return front_remaining + rate * (worker.bytes_in_flight - front.bytes + bytes);
         };
+
+        virtual bool closed() { return false; }
     };
 
     struct Worker::ClosedPushModule : public Worker::PushModule {
         using Worker::PushModule::PushModule;
-        std::future<Message> push(Message message) override {
+        void push(Payload, Callbacks) override {
             throw std::runtime_error("Cannot push message to closed/failed worker.");
         }
     };
 
     struct Worker::ClosedLoadModule : public Worker::LoadModule {
         using Worker::LoadModule::LoadModule;
-        long long current_load() override { return std::numeric_limits<long long>::max(); }
+        double predicted_completion(size_t, double) override { return std::numeric_limits<double>::infinity(); }
+        bool closed() override { return true; }
     };
 }
 
@@ -83,6 +92,13 @@ namespace Gadgetron::Server::Connection::Nodes {
 namespace Gadgetron::Server::Connection::Nodes {
 
     Worker::~Worker() {
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            stopping = true;
+        }
+        outbound_changed.notify_one();
+        outbound_thread.join();
+
         channel->close();
         inbound_thread.join();
     }
@@ -91,29 +107,59 @@ namespace Gadgetron::Server::Connection::Nodes {
             Address address,
             std::shared_ptr<Serialization> serialization,
             std::shared_ptr<Configuration> configuration
-    ) : address(std::move(address)) {
-        GDEBUG_STREAM("Creating worker " << this->address);
-
-        channel = std::make_unique<ExternalChannel>(
-                connect(this->address, configuration),
+    ) : Worker(address, std::make_unique<ExternalChannel>(
+                connect(address, configuration),
                 std::move(serialization),
                 std::move(configuration)
-        );
+        )) {}
+
+    Worker::Worker(Address address, std::unique_ptr<ExternalChannel> channel)
+        : address(std::move(address)), channel(std::move(channel)) {
+        GDEBUG_STREAM("Creating worker " << this->address);
+
+        std::stringstream label; label << this->address;
+        jobs_in_flight = Metrics::gauge("gadgetron_worker_jobs_in_flight",
+                "Messages sent to the remote worker awaiting a response.", {{"worker", label.str()}});
+        jobs_completed = Metrics::counter("gadgetron_worker_jobs_total",
+                "Messages processed by the remote worker.", {{"worker", label.str()}});
+        jobs_failed = Metrics::counter("gadgetron_worker_jobs_failed_total",
+                "Messages lost to a failed remote worker.", {{"worker", label.str()}});
+        job_latency = Metrics::histogram("gadgetron_worker_job_seconds",
+                "Round trip time of messages processed by the remote worker.", {{"worker", label.str()}});
+        throughput = Metrics::gauge("gadgetron_worker_throughput_bytes",
+                "Measured rate at which the remote worker processes messages, in bytes per second.",
+                {{"worker", label.str()}});
 
         load_module = std::make_unique<LoadModule>(*this);
         push_module = std::make_unique<PushModule>(*this);
 
         inbound_thread = std::thread([=]() { handle_inbound_messages(); });
+        outbound_thread = std::thread([=]() { handle_outbound_messages(); });
     }
 
-    long long Worker::current_load() const {
+    double Worker::predicted_completion(size_t bytes, double default_rate) const {
         std::lock_guard<std::mutex> guard(mutex);
-        return load_module->current_load();
+        return load_module->predicted_completion(bytes, default_rate);
     }
 
-    std::future<Message> Worker::push(Message message) {
+    optional<double> Worker::rate() const {
         std::lock_guard<std::mutex> guard(mutex);
-        return push_module->push(std::move(message));
+        return timing.seconds_per_byte;
+    }
+
+    size_t Worker::pending() const {
+        std::lock_guard<std::mutex> guard(mutex);
+        return jobs.size();
+    }
+
+    bool Worker::closed() const {
+        std::lock_guard<std::mutex> guard(mutex);
+        return load_module->closed();
+    }
+
+    void Worker::push(Payload payload, Callbacks callbacks) {
+        std::lock_guard<std::mutex> guard(mutex);
+        push_module->push(std::move(payload), std::move(callbacks));
     }
 
     void Worker::close() {
@@ -122,38 +168,85 @@ namespace Gadgetron::Server::Connection::Nodes {
     }
 
     void Worker::handle_inbound_messages() {
+        std::exception_ptr error;
         try {
             while(true) process_inbound_message(channel->pop());
         }
-        catch (const ChannelClosed &) {}
+        catch (const ChannelClosed &) {
+            error = std::make_exception_ptr(std::runtime_error("Worker closed the connection with jobs pending."));
+        }
         catch (const std::exception &e) {
             GWARN_STREAM("Worker " << address << " failed: " << e.what());
-            fail_pending_messages(std::current_exception());
+            error = std::current_exception();
+        }
+        fail_pending_messages(error);
+    }
+
+    void Worker::handle_outbound_messages() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            outbound_changed.wait(lock, [&]() { return stopping || !outbound.empty(); });
+            if (stopping) return;
+
+            auto payload = std::move(outbound.front()); outbound.pop_front();
+
+            // Jobs are matched to responses in the order they were sent, so this is the only thread writing. Writing
+            // outside the lock lets the inbound thread keep reading responses while a large payload is sent.
+            lock.unlock();
+            try {
+                channel->push_serialized(*payload);
+            }
+            catch (const std::exception &e) {
+                GWARN_STREAM("Failed sending job to worker " << address << ": " << e.what());
+
+                // A partly written payload leaves the connection unusable.
+                channel->close();
+                fail_pending_messages(std::current_exception());
+            }
+            lock.lock();
         }
-        switch_to_closed_modules();
     }
 
     void Worker::process_inbound_message(Core::Message message) {
         GDEBUG_STREAM("Received message from remote worker " << address);
 
-        std::lock_guard<std::mutex> guard(mutex);
+        std::unique_lock<std::mutex> lock(mutex);
 
         auto job = std::move(jobs.front()); jobs.pop_front();
-        timing.latest = time_since(job.start);
-        job.response.set_value(std::move(message));
+        bytes_in_flight -= job.bytes;
+
+        auto service_time = seconds_since(std::max(job.start, timing.latest_completion));
+        auto sample = service_time / std::max<size_t>(job.bytes, 1);
+        timing.seconds_per_byte = timing.seconds_per_byte
+                ? (1.0 - rate_smoothing) * *timing.seconds_per_byte + rate_smoothing * sample
+                : sample;
+        timing.latest_completion = Clock::now();
+
+        jobs_in_flight.add(-1);
+        jobs_completed.increment();
+        job_latency.observe(seconds_since(job.start));
+        throughput.set(*timing.seconds_per_byte > 0 ? int64_t(1.0 / *timing.seconds_per_byte) : 0);
+
+        // The callback may take locks of its own; never hold ours while calling it.
+        lock.unlock();
+        job.callbacks.completed(std::move(message));
     }
 
     void Worker::fail_pending_messages(const std::exception_ptr &e) {
-        std::lock_guard<std::mutex> guard(mutex);
-
-        for (auto &job : jobs) {
-            job.response.set_exception(e);
+        std::list<Job> failed;
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            // Closed first, so no job can be pushed after the pending ones are failed.
+            load_module = std::make_unique<ClosedLoadModule>(*this);
+            push_module = std::make_unique<ClosedPushModule>(*this);
+
+            failed.swap(jobs);
+            outbound.clear();
+            bytes_in_flight = 0;
+            jobs_in_flight.add(-int64_t(failed.size()));
+            jobs_failed.increment(failed.size());
         }
-    }
 
-    void Worker::switch_to_closed_modules() {
-        std::lock_guard<std::mutex> guard(mutex);
-        load_module = std::make_unique<ClosedLoadModule>(*this);
-        push_module = std::make_unique<ClosedPushModule>(*this);
+        for (auto &job : failed) job.callbacks.failed(e);
     }
 }
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <memory>
 #include <future>
 
@@ -11,6 +14,7 @@
 #include "connection/nodes/common/Discovery.h"
 
 #include "Message.h"
+#include "Metrics.h"
 
 namespace Gadgetron::Server::Connection::Nodes {
 
@@ -18,6 +22,15 @@ namespace Gadgetron::Server::Connection::Nodes {
     public:
         const Address address;
 
+        /// A message serialized for the workers. It is kept until the job completes, so it can be sent again.
+        using Payload = std::shared_ptr<const std::string>;
+
+        /// Exactly one is called for every job pushed, from the thread reading the worker's responses.
+        struct Callbacks {
+            std::function<void(Core::Message)> completed;
+            std::function<void(std::exception_ptr)> failed;
+        };
+
         ~Worker();
         Worker(
                 Address address,
@@ -25,29 +38,59 @@ namespace Gadgetron::Server::Connection::Nodes {
                 std::shared_ptr<Configuration> configuration
         );
 
-        std::future<Core::Message> push(Core::Message message);
-        long long current_load() const;
+        /// A worker on a channel that is already connected and configured.
+        Worker(Address address, std::unique_ptr<ExternalChannel> channel);
+
+        /// Queues the job; the worker's own thread sends it. Throws if the worker is closed, and its callbacks are then
+        /// never called. A job that cannot be sent fails through its callbacks.
+        void push(Payload payload, Callbacks callbacks);
+
+        /// Seconds until a job of the given size would complete, if it was pushed now. The worker processes its jobs
+        /// in order, at a rate measured from the jobs it completed (an EWMA, in seconds per byte). Until the first
+        /// job completes, 'default_rate' is assumed.
+        double predicted_completion(size_t bytes, double default_rate) const;
+
+        /// Measured seconds per byte, or none if no job has completed yet.
+        Core::optional<double> rate() const;
+
+        /// Jobs pushed and not yet answered
+        size_t pending() const;
+        bool closed() const;
         void close();
 
     private:
         mutable std::mutex mutex;
 
         std::thread inbound_thread;
+        std::thread outbound_thread;
+
+        /// Payloads waiting to be sent, in the order their jobs were pushed.
+        std::deque<Payload> outbound;
+        std::condition_variable outbound_changed;
+        bool stopping = false;
 
         struct Timing {
-            std::chrono::milliseconds latest = std::chrono::seconds(5);
+            Core::optional<double> seconds_per_byte;
+            std::chrono::steady_clock::time_point latest_completion;
         } timing;
 
         struct Job;
         std::list<Job> jobs;
+        size_t bytes_in_flight = 0;
+
+        Core::Metrics::Gauge jobs_in_flight;
+        Core::Metrics::Counter jobs_completed;
+        Core::Metrics::Counter jobs_failed;
+        Core::Metrics::Histogram job_latency;
+        Core::Metrics::Gauge throughput;
         std::unique_ptr<ExternalChannel> channel;
 
         struct PushModule; struct LoadModule; struct ClosedPushModule; struct ClosedLoadModule;
         std::unique_ptr<PushModule> push_module;
         std::unique_ptr<LoadModule> load_module;
-        void switch_to_closed_modules();
 
         void handle_inbound_messages();
+        void handle_outbound_messages();
         void process_inbound_message(Core::Message message);
         void fail_pending_messages(const std::exception_ptr &e);
     };
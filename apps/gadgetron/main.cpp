@@ -8,6 +8,8 @@
 #include "gadgetron_paths.h"
 #include "initialization.h"
 #include "storage.h"
+#include "metrics.h"
+#include "Metrics.h"
 
 #include "system_info.h"
 #include "gadgetron_config.h"
@@ -32,7 +34,62 @@ int main(int argc, char *argv[]) {
                 "Set the Gadgetron home directory.")
             ("port,p",
                 value<unsigned short>()->default_value(9002),
-                "Listen for incoming connections on this port.");
+                "Listen for incoming connections on this port.")
+            ("unix_socket",
+                value<path>(),
+                "Also listen for incoming connections on a Unix domain socket at this path. "
+                "Clients and workers on this machine connect to it with the address 'unix', and the path as port.")
+            ("io_threads",
+                value<size_t>()->default_value(0),
+                "Threads doing the socket I/O of connections that share the server process; zero picks two. "
+                "A connection handled in its own process does its socket I/O on its own threads.")
+            ("tcp_nodelay",
+                value<bool>()->default_value(true),
+                "Send small messages to clients right away, rather than waiting to coalesce them (TCP_NODELAY).")
+            ("socket_buffer_size",
+                value<size_t>()->default_value(0),
+                "Kernel send and receive buffer size of client sockets, in KiB. Zero leaves the system default.")
+            ("memory_budget",
+                value<size_t>(),
+                "Array memory a connection may hold, in MiB. Over budget, buffering gadgets spill to disk. "
+                "Defaults to GADGETRON_MEMORY_BUDGET_MB; zero or unset for no budget.")
+            ("server_memory_budget",
+                value<size_t>(),
+                "Array memory all connections together may hold, in MiB. Over budget, buffering gadgets spill to "
+                "disk, and new connections wait. Defaults to GADGETRON_SERVER_MEMORY_BUDGET_MB; zero or unset for "
+                "no budget.")
+            ("connection_classes",
+                value<path>(),
+                "XML file of connection classes, with priorities, limits and resources. Connections select a class "
+                "with the 'GadgetronConnectionClass' header user parameter, or by their config name.")
+            ("max_connections",
+                value<size_t>()->default_value(0),
+                "Client connections running at once; more wait in a queue, served by class priority. "
+                "Zero for no limit.")
+            ("cgroup_root",
+                value<path>(),
+                "Place connections in a cgroup (v2) per connection class below this directory, to apply the CPU "
+                "weight and memory limit of the class.")
+            ("trace_dir",
+                value<path>(),
+                "Record node, channel and reader/writer timings, and write a Chrome trace (JSON) "
+                "of each connection to this directory.")
+            ("fuse_pure_gadgets",
+                value<bool>()->default_value(false),
+                "Run adjacent pure gadgets in a stream as a single node. Gadgets are then loaded "
+                "while the stream is built, rather than on their own threads.")
+            ("pure_gadget_workers",
+                value<size_t>()->default_value(1),
+                "Threads processing messages concurrently in each run of fused pure gadgets. "
+                "Output order is preserved. Zero uses one thread per core.")
+            ("worker_rediscovery_interval",
+                value<unsigned int>()->default_value(30),
+                "Seconds between discoveries of remote workers for distributed nodes. Workers that joined since "
+                "are put to work. Zero disables rediscovery.")
+            ("straggler_factor",
+                value<double>()->default_value(3.0),
+                "A distributed job running this many times longer than predicted is sent to an idle worker as "
+                "well, and the first response is used. Zero disables this.");
 
     options_description storage_options("Storage options");
     storage_options.add_options()
@@ -48,12 +105,34 @@ int main(int argc, char *argv[]) {
                 "Directory in which to store the storage server database.")
             ("storage_dir,S",
                 value<path>()->default_value(default_storage_folder()),
-                "Directory in which to store data blobs.");
+                "Directory in which to store data blobs.")
+            ("storage_cache_dir",
+                value<path>()->default_value(default_working_folder() / "storage_cache"),
+                "Directory of the local cache of stored items, shared by all connections.")
+            ("storage_cache_size",
+                value<size_t>()->default_value(0),
+                "Size of the local storage cache on disk, in MiB. Items are written to the storage server in the "
+                "background, and latest items may be served from the cache for up to --storage_cache_max_age "
+                "seconds. Zero (the default) disables the cache.")
+            ("storage_cache_max_age",
+                value<unsigned int>()->default_value(3600),
+                "Seconds a cached item is served before it is read from the storage server again.");
+
+    options_description metrics_options("Metrics options");
+    metrics_options.add_options()
+            ("metrics_port",
+                value<unsigned short>(),
+                "Serve server, node and worker metrics in the Prometheus text format over HTTP on this port. "
+                "Metrics are not served if no port is provided.")
+            ("metrics_address",
+                value<std::string>()->default_value("127.0.0.1"),
+                "Address on which to serve metrics.");
 
     options_description desc;
     desc
         .add(gadgetron_options)
-        .add(storage_options);
+        .add(storage_options)
+        .add(metrics_options);
 
     variables_map args;
     store(parse_command_line(argc, argv, desc), args);
@@ -82,6 +161,10 @@ int main(int argc, char *argv[]) {
 
         auto [storage_address, storage_server] = ensure_storage_server(args);
 
+        // The metrics table must be shared with connection processes, so it is mapped before the first fork.
+        if (args.count("metrics_port")) Gadgetron::Core::Metrics::enable();
+        start_metrics_server(args);
+
         Server server(args, storage_address);
         server.serve();
     }
@@ -0,0 +1,149 @@
+#include "metrics.h"
+
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <thread>
+
+#include <boost/asio.hpp>
+
+#include "Connection.h"
+#include "Metrics.h"
+#include "log.h"
+
+#if !(_WIN32)
+#include <unistd.h>
+#endif
+
+using namespace boost::asio;
+
+namespace {
+
+    // Resident memory from /proc/<pid>/statm; zero where that is unavailable.
+    long long resident_bytes(const std::string& pid) {
+#if !(_WIN32)
+        std::ifstream statm("/proc/" + pid + "/statm");
+        long long size = 0, resident = 0;
+        if (statm >> size >> resident) return resident * sysconf(_SC_PAGESIZE);
+#endif
+        return 0;
+    }
+
+    void write_memory_metrics(std::ostream& stream) {
+        stream << "# HELP gadgetron_process_resident_bytes Resident memory of the server process.\n"
+               << "# TYPE gadgetron_process_resident_bytes gauge\n"
+               << "gadgetron_process_resident_bytes " << resident_bytes("self") << "\n";
+
+        auto processes = Gadgetron::Server::Connection::connection_processes();
+        if (processes.empty()) return;
+
+        stream << "# HELP gadgetron_connection_resident_bytes Resident memory of each connection process.\n"
+               << "# TYPE gadgetron_connection_resident_bytes gauge\n";
+        for (auto pid : processes) {
+            stream << "gadgetron_connection_resident_bytes{pid=\"" << pid << "\"} "
+                   << resident_bytes(std::to_string(pid)) << "\n";
+        }
+    }
+
+    /// A client has this long to send its request and take the response; stalled clients are disconnected.
+    constexpr auto request_timeout = std::chrono::seconds(5);
+    constexpr size_t max_request_bytes = 64 * 1024;
+
+    std::string response() {
+        std::stringstream body;
+        Gadgetron::Core::Metrics::write_prometheus(body);
+        write_memory_metrics(body);
+        auto content = body.str();
+
+        std::stringstream response;
+        response << "HTTP/1.1 200 OK\r\n"
+                 << "Content-Type: text/plain; version=0.0.4\r\n"
+                 << "Content-Length: " << content.size() << "\r\n"
+                 << "Connection: close\r\n\r\n"
+                 << content;
+        return response.str();
+    }
+
+    /// Requests are served asynchronously, so one slow client does not hold up the others.
+    class Session : public std::enable_shared_from_this<Session> {
+    public:
+        explicit Session(ip::tcp::socket socket)
+            : socket(std::move(socket)), timer(this->socket.get_executor()), request(max_request_bytes) {}
+
+        void start() {
+            auto self = shared_from_this();
+
+            timer.expires_after(request_timeout);
+            timer.async_wait([self](const boost::system::error_code& error) {
+                if (error) return;
+                GDEBUG_STREAM("Metrics request timed out.");
+                boost::system::error_code ignored;
+                self->socket.close(ignored);
+            });
+
+            async_read_until(socket, request, "\r\n\r\n", [self](const boost::system::error_code& error, size_t) {
+                if (error) {
+                    GDEBUG_STREAM("Failed to read metrics request: " << error.message());
+                    self->timer.cancel();
+                    return;
+                }
+
+                self->content = response();
+                async_write(self->socket, buffer(self->content), [self](const boost::system::error_code& error, size_t) {
+                    if (error) GDEBUG_STREAM("Failed to serve metrics request: " << error.message());
+                    self->timer.cancel();
+                    boost::system::error_code ignored;
+                    self->socket.shutdown(ip::tcp::socket::shutdown_both, ignored);
+                });
+            });
+        }
+
+    private:
+        ip::tcp::socket socket;
+        steady_timer timer;
+        streambuf request;
+        std::string content;
+    };
+
+    void accept(ip::tcp::acceptor& acceptor) {
+        acceptor.async_accept([&acceptor](const boost::system::error_code& error, ip::tcp::socket socket) {
+            if (error) {
+                GDEBUG_STREAM("Failed to accept metrics connection: " << error.message());
+            } else {
+                std::make_shared<Session>(std::move(socket))->start();
+            }
+            accept(acceptor);
+        });
+    }
+
+    void serve(ip::tcp::endpoint endpoint) {
+        io_context executor;
+        ip::tcp::acceptor acceptor(executor, endpoint);
+
+        accept(acceptor);
+        executor.run();
+    }
+}
+
+namespace Gadgetron::Server {
+
+    void start_metrics_server(const boost::program_options::variables_map& args) {
+        if (!args.count("metrics_port")) return;
+
+        ip::tcp::endpoint endpoint(
+            ip::make_address(args["metrics_address"].as<std::string>()),
+            args["metrics_port"].as<unsigned short>()
+        );
+
+        GINFO_STREAM("Serving metrics on " << endpoint);
+
+        std::thread([=]() {
+            try {
+                serve(endpoint);
+            } catch (const std::exception& e) {
+                GERROR_STREAM("Metrics server failed: " << e.what());
+            }
+        }).detach();
+    }
+}
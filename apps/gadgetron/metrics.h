@@ -0,0 +1,10 @@
+#pragma once
+
+#include <boost/program_options.hpp>
+
+namespace Gadgetron::Server {
+
+    /// Starts a background thread serving the metrics registry in the Prometheus text format over HTTP,
+    /// if a metrics port is configured. Every request is answered with the current metrics, whatever its path.
+    void start_metrics_server(const boost::program_options::variables_map& args);
+}
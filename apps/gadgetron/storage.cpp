@@ -1,4 +1,7 @@
 
+#include <algorithm>
+#include <map>
+#include <mutex>
 #include <optional>
 #include <regex>
 #include <string>
@@ -14,6 +17,7 @@
 
 #include "IsmrmrdContextVariables.h"
 #include "Process.h"
+#include "StorageCache.h"
 #include "gadgetron_paths.h"
 #include "log.h"
 
@@ -80,8 +84,38 @@ std::tuple<std::string, std::optional<boost::process::child>> ensure_storage_ser
     return {uri, std::move(process)};
 }
 
-StorageSpaces setup_storage_spaces(const std::string& address, const ISMRMRD::IsmrmrdHeader& header) {
-    auto client = std::make_shared<StorageClient>(address);
+namespace {
+// The memory tier is per process; the disk tier is what carries items between connection processes.
+constexpr size_t storage_cache_memory_capacity = size_t(256) << 20;
+
+std::shared_ptr<StorageCache> storage_cache(const std::string& address, const variables_map& args) {
+    if (!args.count("storage_cache_size") || args["storage_cache_size"].as<size_t>() == 0) {
+        return nullptr;
+    }
+
+    static std::mutex mutex;
+    static std::map<std::pair<path, std::string>, std::shared_ptr<StorageCache>> caches;
+
+    auto directory = args["storage_cache_dir"].as<path>();
+    std::lock_guard<std::mutex> guard(mutex);
+    auto& cache = caches[{directory, address}];
+    if (!cache) {
+        auto disk_capacity = args["storage_cache_size"].as<size_t>() << 20;
+        cache = std::make_shared<StorageCache>(directory, disk_capacity,
+                                               std::min(disk_capacity, storage_cache_memory_capacity),
+                                               std::chrono::seconds(args["storage_cache_max_age"].as<unsigned int>()),
+                                               address);
+    }
+    return cache;
+}
+} // namespace
+
+StorageSpaces setup_storage_spaces(const std::string& address, const ISMRMRD::IsmrmrdHeader& header,
+                                   const variables_map& args) {
+    std::shared_ptr<StorageClient> client = std::make_shared<StorageClient>(address);
+    if (auto cache = storage_cache(address, args)) {
+        client = std::make_shared<CachingStorageClient>(client, cache);
+    }
     IsmrmrdContextVariables variables(header);
     auto ttl = std::chrono::hours(48);
 
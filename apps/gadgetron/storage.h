@@ -13,5 +13,6 @@ namespace Gadgetron::Server {
 std::tuple<std::string, std::optional<boost::process::child>>
 ensure_storage_server(const boost::program_options::variables_map& args);
 
-StorageSpaces setup_storage_spaces(const std::string& address, const ISMRMRD::IsmrmrdHeader& header);
+StorageSpaces setup_storage_spaces(const std::string& address, const ISMRMRD::IsmrmrdHeader& header,
+                                   const boost::program_options::variables_map& args = {});
 } // namespace Gadgetron::Server
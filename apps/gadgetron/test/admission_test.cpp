@@ -0,0 +1,162 @@
+#include "../Admission.h"
+
+#include <gtest/gtest.h>
+
+#include "hoNDArray.h"
+
+#include <chrono>
+#include <future>
+#include <sstream>
+#include <thread>
+
+using namespace Gadgetron::Server;
+
+namespace {
+    const std::string classes_xml = R"(
+        <connectionClasses>
+            <class>
+                <name>live</name>
+                <priority>10</priority>
+                <maxConcurrent>1</maxConcurrent>
+                <nice>0</nice>
+                <cpus>0-2, 5</cpus>
+                <config>live.xml</config>
+            </class>
+            <class>
+                <name>default</name>
+                <maxConcurrent>1</maxConcurrent>
+                <memoryBudget>512</memoryBudget>
+            </class>
+        </connectionClasses>
+    )";
+
+    std::vector<Admission::ConnectionClass> classes() {
+        std::stringstream stream(classes_xml);
+        return Admission::parse_classes(stream);
+    }
+
+    /// Admits a client connection on a thread of its own; the future is ready once it is admitted.
+    std::future<std::unique_ptr<Admission::Admitted>> admit_async(const std::string &config) {
+        return std::async(std::launch::async, [config]() {
+            Admission::mark_client_connection();
+            return Admission::admit(config, nullptr);
+        });
+    }
+
+    void wait_until_queued(size_t connections) {
+        while (Admission::queued() < connections) std::this_thread::yield();
+    }
+}
+
+TEST(AdmissionTest, parse_cpus) {
+    EXPECT_EQ(Admission::parse_cpus("0-3,8"), std::vector<unsigned int>({0, 1, 2, 3, 8}));
+    EXPECT_EQ(Admission::parse_cpus(" 4 "), std::vector<unsigned int>({4}));
+    EXPECT_TRUE(Admission::parse_cpus("").empty());
+    EXPECT_THROW(Admission::parse_cpus("3-1"), std::runtime_error);
+}
+
+TEST(AdmissionTest, parse_classes) {
+    auto parsed = classes();
+    ASSERT_EQ(parsed.size(), 2);
+
+    EXPECT_EQ(parsed[0].name, "live");
+    EXPECT_EQ(parsed[0].priority, 10);
+    EXPECT_EQ(parsed[0].max_concurrent, 1);
+    ASSERT_TRUE(parsed[0].nice);
+    EXPECT_EQ(*parsed[0].nice, 0);
+    EXPECT_EQ(parsed[0].cpus, std::vector<unsigned int>({0, 1, 2, 5}));
+    EXPECT_EQ(parsed[0].configs, std::vector<std::string>({"live.xml"}));
+
+    EXPECT_EQ(parsed[1].name, "default");
+    EXPECT_FALSE(parsed[1].nice);
+    EXPECT_EQ(parsed[1].memory_budget_MB, 512);
+}
+
+TEST(AdmissionTest, select) {
+    Admission::configure({classes()});
+
+    EXPECT_EQ(Admission::select("live.xml", nullptr)->name, "live");
+    EXPECT_EQ(Admission::select("offline.xml", nullptr)->name, "default");
+
+    ISMRMRD::IsmrmrdHeader header;
+    ISMRMRD::UserParameters parameters;
+    parameters.userParameterString.push_back(ISMRMRD::UserParameterString{"GadgetronConnectionClass", "live"});
+    header.userParameters = parameters;
+    EXPECT_EQ(Admission::select("offline.xml", &header)->name, "live");
+
+    Admission::configure({});
+    EXPECT_EQ(Admission::select("offline.xml", nullptr), nullptr);
+}
+
+TEST(AdmissionTest, unmarked_threads_are_not_queued) {
+    Admission::configure({classes()});
+    auto first = Admission::admit("live.xml", nullptr);
+    auto second = Admission::admit("live.xml", nullptr);
+    EXPECT_EQ(first, nullptr);
+    EXPECT_EQ(second, nullptr);
+}
+
+TEST(AdmissionTest, queued_by_priority) {
+    Admission::configure({classes(), 1});
+
+    auto running = admit_async("offline.xml").get();
+    ASSERT_NE(running, nullptr);
+
+    auto offline = admit_async("offline.xml");
+    wait_until_queued(1);
+    auto live = admit_async("live.xml");
+    wait_until_queued(2);
+
+    EXPECT_EQ(offline.wait_for(std::chrono::seconds(0)), std::future_status::timeout);
+    EXPECT_EQ(live.wait_for(std::chrono::seconds(0)), std::future_status::timeout);
+    running.reset();
+
+    // The live connection arrived last, but goes first; the offline one runs once it is done.
+    ASSERT_EQ(live.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    auto admitted = live.get();
+    EXPECT_EQ(offline.wait_for(std::chrono::seconds(0)), std::future_status::timeout);
+    EXPECT_EQ(Admission::queued(), 1u);
+
+    admitted.reset();
+    EXPECT_NE(offline.get(), nullptr);
+}
+
+TEST(AdmissionTest, queued_connections_start_as_soon_as_a_place_is_released) {
+    Admission::configure({classes(), 1});
+
+    auto running = admit_async("offline.xml").get();
+    auto queued = admit_async("offline.xml");
+    wait_until_queued(1);
+
+    // Well within the interval at which queued connections check anyway; only a wakeup is this quick.
+    auto released = std::chrono::steady_clock::now();
+    running.reset();
+    ASSERT_EQ(queued.wait_for(std::chrono::milliseconds(500)), std::future_status::ready);
+    EXPECT_NE(queued.get(), nullptr);
+    EXPECT_LT(std::chrono::steady_clock::now() - released, std::chrono::milliseconds(500));
+}
+
+TEST(AdmissionTest, held_back_while_over_the_server_memory_budget) {
+    auto previous = Gadgetron::MappedMemory::budget();
+    Gadgetron::MappedMemory::Budget budget;
+    budget.server_bytes = Gadgetron::MappedMemory::server_allocated_bytes() + (1u << 20);
+    Gadgetron::MappedMemory::set_budget(budget);
+
+    Admission::Settings settings;
+    settings.server_memory_budget = true;
+    Admission::configure(settings);
+
+    // Over budget, the first connection still runs; the server would otherwise never start one.
+    auto held = std::make_unique<Gadgetron::hoNDArray<float>>(1024, 1024);
+    auto running = admit_async("offline.xml").get();
+    ASSERT_NE(running, nullptr);
+
+    auto second = admit_async("offline.xml");
+    EXPECT_EQ(second.wait_for(std::chrono::milliseconds(100)), std::future_status::timeout);
+
+    held.reset();
+    EXPECT_NE(second.get(), nullptr);
+
+    Gadgetron::MappedMemory::set_budget(previous);
+    Admission::configure({});
+}
@@ -0,0 +1,52 @@
+#include "../connection/MemoryStream.h"
+
+#include "io/primitives.h"
+
+#include <gtest/gtest.h>
+#include <random>
+#include <thread>
+
+using namespace Gadgetron;
+
+TEST(MemoryStreamTest, round_trip_test) {
+    auto [client, server] = Connection::memory_stream_pair();
+
+    for (uint64_t i = 0; i < 1000; i++) Core::IO::write(*client, i);
+    for (uint64_t i = 0; i < 1000; i++) ASSERT_EQ(Core::IO::read<uint64_t>(*server), i);
+
+    Core::IO::write(*server, uint16_t(42));
+    ASSERT_EQ(Core::IO::read<uint16_t>(*client), 42);
+}
+
+TEST(MemoryStreamTest, large_write_test) {
+    auto [client, server] = Connection::memory_stream_pair();
+
+    auto data = std::vector<char>(40u << 20);
+    std::mt19937_64 engine;
+    std::uniform_int_distribution<int> distribution(-128, 127);
+    for (auto& d : data) d = char(distribution(engine));
+
+    auto thread = std::thread([&, &client = client]() {
+        client->write(data.data(), data.size() / 2);
+        Core::IO::write_gather(*client, { { data.data() + data.size() / 2, data.size() / 2 } });
+    });
+
+    auto data2 = std::vector<char>(data.size());
+    server->read(data2.data(), data2.size());
+    thread.join();
+
+    ASSERT_EQ(data, data2);
+}
+
+TEST(MemoryStreamTest, close_test) {
+    auto [client, server] = Connection::memory_stream_pair();
+
+    client->write("Albatros", 8);
+    client.reset();
+
+    auto data = std::vector<char>(9);
+    server->read(data.data(), data.size());
+
+    ASSERT_TRUE(server->eof());
+    ASSERT_EQ(server->gcount(), 8);
+}
@@ -0,0 +1,287 @@
+#include "../connection/MemoryStream.h"
+#include "../connection/nodes/distributed/Pool.h"
+#include "../connection/nodes/distributed/Worker.h"
+
+#include "io/primitives.h"
+#include "MessageID.h"
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace Gadgetron::Core;
+using namespace Gadgetron::Server::Connection::Nodes;
+
+namespace {
+
+    struct Number {
+        uint64_t value;
+    };
+
+    constexpr uint16_t number_slot = 1100;
+
+    class NumberReader : public Reader {
+    public:
+        Message read(std::istream &stream) override { return Message(Number{IO::read<uint64_t>(stream)}); }
+        uint16_t slot() override { return number_slot; }
+    };
+
+    class NumberWriter : public TypedWriter<Number> {
+    protected:
+        void serialize(std::ostream &stream, const Number &number) override {
+            IO::write(stream, number_slot);
+            IO::write(stream, number.value);
+        }
+    };
+
+    std::shared_ptr<Serialization> number_serialization() {
+        Serialization::Readers readers;
+        readers.emplace(number_slot, std::make_unique<NumberReader>());
+        Serialization::Writers writers;
+        writers.push_back(std::make_unique<NumberWriter>());
+        return std::make_shared<Serialization>(std::move(readers), std::move(writers));
+    }
+
+    /// What a remote worker answers to a number; none drops the connection instead.
+    using Behaviour = std::function<optional<uint64_t>(uint64_t)>;
+
+    uint64_t twice(uint64_t value) { return 2 * value; }
+
+    /**
+     * Remote workers served in process, over memory streams. Each runs until the Gadgetron closes its connection, or
+     * its behaviour drops it.
+     */
+    class RemoteWorkers {
+    public:
+        const std::shared_ptr<Serialization> serialization = number_serialization();
+
+        ~RemoteWorkers() {
+            for (auto &thread : threads) thread.join();
+        }
+
+        /// The remote worker reads nothing before 'started' is ready, if given.
+        std::unique_ptr<Worker> connect(std::string name, Behaviour behaviour, std::shared_future<void> started = {}) {
+            auto [client, server] = Gadgetron::Connection::memory_stream_pair();
+            client->exceptions(std::istream::failbit | std::istream::eofbit);
+
+            threads.emplace_back([stream = std::move(server), behaviour, started]() mutable {
+                if (started.valid()) started.wait();
+                serve(std::move(stream), behaviour);
+            });
+
+            return std::make_unique<Worker>(
+                    Remote{std::move(name), "9002"},
+                    std::make_unique<ExternalChannel>(std::move(client), serialization)
+            );
+        }
+
+    private:
+        static void serve(std::unique_ptr<std::iostream> stream, const Behaviour &behaviour) {
+            while (true) {
+                auto id = IO::read<uint16_t>(*stream);
+                if (!*stream) return;
+                if (id == CLOSE) {
+                    IO::write(*stream, CLOSE);
+                    return;
+                }
+
+                auto response = behaviour(IO::read<uint64_t>(*stream));
+                if (!response) return;
+
+                IO::write(*stream, number_slot);
+                IO::write(*stream, *response);
+                stream->flush();
+            }
+        }
+
+        std::vector<std::thread> threads;
+    };
+
+    Pool::Settings quick_settings() {
+        Pool::Settings settings;
+        settings.minimum_straggler_time = std::chrono::milliseconds(50);
+        return settings;
+    }
+
+    Pool::Connector no_discovery() {
+        return {
+            []() { return std::vector<Address>{}; },
+            [](Address) -> std::unique_ptr<Worker> { throw std::runtime_error("No workers to connect to."); }
+        };
+    }
+
+    uint64_t result(std::future<Message> &future) {
+        EXPECT_EQ(future.wait_for(std::chrono::seconds(10)), std::future_status::ready);
+        return force_unpack<Number>(future.get()).value;
+    }
+}
+
+TEST(PoolTest, jobs_are_completed_by_the_workers) {
+    RemoteWorkers remote;
+    std::list<std::unique_ptr<Worker>> workers;
+    workers.push_back(remote.connect("first", twice));
+    workers.push_back(remote.connect("second", twice));
+
+    Pool pool(std::move(workers), remote.serialization, no_discovery(), quick_settings());
+
+    std::vector<std::future<Message>> futures;
+    for (uint64_t i = 0; i < 20; i++) futures.push_back(pool.push(Message(Number{i})));
+    for (uint64_t i = 0; i < 20; i++) EXPECT_EQ(result(futures[i]), 2 * i);
+}
+
+TEST(PoolTest, straggling_jobs_are_sent_to_an_idle_worker) {
+    RemoteWorkers remote;
+    std::promise<void> release;
+    auto released = release.get_future().share();
+
+    std::atomic<int> slow_jobs{0};
+    std::list<std::unique_ptr<Worker>> workers;
+    workers.push_back(remote.connect("slow", [&, released](uint64_t value) -> optional<uint64_t> {
+        slow_jobs++;
+        released.wait();
+        return value + 1;
+    }));
+    workers.push_back(remote.connect("fast", twice));
+
+    {
+        Pool pool(std::move(workers), remote.serialization, no_discovery(), quick_settings());
+
+        // Workers without a measured rate tie; the first is picked, and holds the job until it is released.
+        auto future = pool.push(Message(Number{21}));
+        EXPECT_EQ(result(future), 42);
+        EXPECT_EQ(slow_jobs, 1);
+
+        release.set_value();
+    }
+}
+
+TEST(PoolTest, jobs_lost_to_a_failed_worker_are_retried) {
+    RemoteWorkers remote;
+    std::list<std::unique_ptr<Worker>> workers;
+    workers.push_back(remote.connect("failing", [](uint64_t) { return optional<uint64_t>{}; }));
+    workers.push_back(remote.connect("working", twice));
+
+    Pool pool(std::move(workers), remote.serialization, no_discovery(), quick_settings());
+
+    std::vector<std::future<Message>> futures;
+    for (uint64_t i = 0; i < 8; i++) futures.push_back(pool.push(Message(Number{i})));
+    for (uint64_t i = 0; i < 8; i++) EXPECT_EQ(result(futures[i]), 2 * i);
+}
+
+TEST(PoolTest, jobs_fail_once_every_worker_has_failed) {
+    RemoteWorkers remote;
+    std::list<std::unique_ptr<Worker>> workers;
+    workers.push_back(remote.connect("first", [](uint64_t) { return optional<uint64_t>{}; }));
+    workers.push_back(remote.connect("second", [](uint64_t) { return optional<uint64_t>{}; }));
+
+    Pool pool(std::move(workers), remote.serialization, no_discovery(), quick_settings());
+
+    auto future = pool.push(Message(Number{1}));
+    ASSERT_EQ(future.wait_for(std::chrono::seconds(10)), std::future_status::ready);
+    EXPECT_THROW(future.get(), std::runtime_error);
+}
+
+TEST(PoolTest, workers_are_discovered_when_none_are_left) {
+    RemoteWorkers remote;
+    std::atomic<int> connections{0};
+
+    Pool::Connector connector{
+            []() { return std::vector<Address>{Remote{"discovered", "9002"}}; },
+            [&](Address) {
+                connections++;
+                return remote.connect("discovered", twice);
+            }
+    };
+
+    Pool pool({}, remote.serialization, connector, quick_settings());
+
+    auto future = pool.push(Message(Number{4}));
+    EXPECT_EQ(result(future), 8);
+    EXPECT_EQ(connections, 1);
+}
+
+TEST(PoolTest, workers_are_rediscovered_at_an_interval) {
+    RemoteWorkers remote;
+    std::promise<void> connected;
+    auto joined = connected.get_future();
+
+    Pool::Connector connector{
+            []() { return std::vector<Address>{Remote{"first", "9002"}, Remote{"second", "9002"}}; },
+            [&](Address) {
+                connected.set_value();
+                return remote.connect("second", twice);
+            }
+    };
+
+    auto settings = quick_settings();
+    settings.rediscovery_interval = std::chrono::seconds(1);
+
+    std::list<std::unique_ptr<Worker>> workers;
+    workers.push_back(remote.connect("first", twice));
+    Pool pool(std::move(workers), remote.serialization, connector, settings);
+
+    // Only the address not already in the pool is connected to.
+    EXPECT_EQ(joined.wait_for(std::chrono::seconds(10)), std::future_status::ready);
+
+    auto future = pool.push(Message(Number{5}));
+    EXPECT_EQ(result(future), 10);
+}
+
+TEST(WorkerTest, jobs_that_cannot_be_sent_fail_once_and_are_not_left_pending) {
+    RemoteWorkers remote;
+    std::promise<void> start;
+
+    // The remote worker is held back, so it cannot answer the close before the push.
+    auto worker = remote.connect("closed", twice, start.get_future().share());
+    worker->close();
+
+    std::atomic<int> completed{0}, failed{0};
+    std::promise<void> failure;
+    Worker::Callbacks count{
+            [&](Message) { completed++; },
+            [&](std::exception_ptr) { if (failed++ == 0) failure.set_value(); }
+    };
+
+    // The push only queues the job; sending it fails on the worker's own thread.
+    worker->push(std::make_shared<const std::string>("payload"), count);
+    ASSERT_EQ(failure.get_future().wait_for(std::chrono::seconds(10)), std::future_status::ready);
+    EXPECT_EQ(worker->pending(), 0);
+    EXPECT_TRUE(worker->closed());
+    EXPECT_ANY_THROW(worker->push(std::make_shared<const std::string>("payload"), count));
+
+    start.set_value();
+    worker.reset();
+    EXPECT_EQ(completed, 0);
+    EXPECT_EQ(failed, 1);
+}
+
+TEST(WorkerTest, jobs_are_answered_in_the_order_they_were_pushed) {
+    RemoteWorkers remote;
+    auto worker = remote.connect("worker", twice);
+
+    std::mutex mutex;
+    std::vector<uint64_t> answers;
+    std::promise<void> done;
+    constexpr uint64_t count = 200;
+
+    for (uint64_t i = 0; i < count; i++) {
+        std::stringstream payload;
+        remote.serialization->write(payload, Message(Number{i}));
+        worker->push(std::make_shared<const std::string>(payload.str()), Worker::Callbacks{
+                [&](Message message) {
+                    std::lock_guard<std::mutex> guard(mutex);
+                    answers.push_back(force_unpack<Number>(std::move(message)).value);
+                    if (answers.size() == count) done.set_value();
+                },
+                [&](std::exception_ptr) { ADD_FAILURE(); }
+        });
+    }
+
+    ASSERT_EQ(done.get_future().wait_for(std::chrono::seconds(10)), std::future_status::ready);
+    for (uint64_t i = 0; i < count; i++) EXPECT_EQ(answers[i], 2 * i);
+}
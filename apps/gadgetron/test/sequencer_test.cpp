@@ -0,0 +1,111 @@
+#include "../connection/nodes/common/Sequencer.h"
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace Gadgetron::Core;
+using namespace Gadgetron::Server::Connection::Nodes;
+
+namespace {
+    std::vector<Message> messages(std::initializer_list<int> values) {
+        std::vector<Message> result;
+        for (auto value : values) result.emplace_back(value);
+        return result;
+    }
+
+    std::vector<int> drain(GenericInputChannel& channel) {
+        std::vector<int> values;
+        while (auto message = channel.try_pop()) values.push_back(force_unpack<int>(std::move(*message)));
+        return values;
+    }
+}
+
+TEST(SequencerTest, results_are_emitted_in_input_order) {
+    auto channel = make_channel<MessageChannel>();
+    Sequencer sequencer{std::move(channel.output), 8};
+
+    for (size_t i = 0; i < 3; i++) ASSERT_EQ(sequencer.acquire(), i);
+
+    sequencer.complete(2, messages({5}));
+    sequencer.complete(1, messages({3, 4}));
+    EXPECT_TRUE(drain(channel.input).empty());
+
+    sequencer.complete(0, messages({1, 2}));
+    EXPECT_EQ(drain(channel.input), std::vector<int>({1, 2, 3, 4, 5}));
+}
+
+TEST(SequencerTest, full_window_blocks_until_the_oldest_input_is_emitted) {
+    auto channel = make_channel<MessageChannel>();
+    Sequencer sequencer{std::move(channel.output), 2};
+    sequencer.acquire();
+    sequencer.acquire();
+
+    std::atomic<bool> acquired{false};
+    std::thread thread([&]() {
+        EXPECT_EQ(sequencer.acquire(), 2);
+        acquired = true;
+    });
+
+    sequencer.complete(1, messages({2}));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(acquired);
+
+    sequencer.complete(0, messages({1}));
+    thread.join();
+    EXPECT_TRUE(acquired);
+    EXPECT_EQ(drain(channel.input), std::vector<int>({1, 2}));
+}
+
+TEST(SequencerTest, unbound_releases_a_full_window) {
+    auto channel = make_channel<MessageChannel>();
+    Sequencer sequencer{std::move(channel.output), 1};
+    sequencer.acquire();
+
+    std::thread thread([&]() { sequencer.acquire(); });
+    sequencer.unbound();
+    thread.join();
+}
+
+TEST(SequencerTest, flush_emits_inputs_after_a_gap_in_order) {
+    auto channel = make_channel<MessageChannel>();
+    Sequencer sequencer{std::move(channel.output), 8};
+    for (size_t i = 0; i < 4; i++) sequencer.acquire();
+
+    sequencer.complete(3, messages({4}));
+    sequencer.complete(1, messages({2}));
+    sequencer.flush();
+    EXPECT_EQ(drain(channel.input), std::vector<int>({2, 4}));
+}
+
+TEST(SequencerTest, worker_output_is_split_at_markers) {
+    auto output = make_channel<MessageChannel>();
+    Sequencer sequencer{std::move(output.output), 8};
+    sequencer.acquire();
+    sequencer.acquire();
+
+    // Two workers: the second finishes its input first, and the first releases a held message as it shuts down.
+    auto first = make_channel<MessageChannel>();
+    first.output.push(1);
+    first.output.push(2);
+    first.output.push(SequenceMarker{0});
+    first.output.push(7);
+
+    auto second = make_channel<MessageChannel>();
+    second.output.push(3);
+    second.output.push(SequenceMarker{1});
+    {
+        auto closing = std::move(second.output);
+    }
+    EXPECT_TRUE(collect_sequenced(std::move(second.input), sequencer).empty());
+    EXPECT_TRUE(drain(output.input).empty());
+
+    {
+        auto closing = std::move(first.output);
+    }
+    auto leftovers = collect_sequenced(std::move(first.input), sequencer);
+    EXPECT_EQ(drain(output.input), std::vector<int>({1, 2, 3}));
+    ASSERT_EQ(leftovers.size(), 1);
+    EXPECT_EQ(force_unpack<int>(std::move(leftovers.front())), 7);
+}
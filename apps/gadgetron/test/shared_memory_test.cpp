@@ -0,0 +1,135 @@
+#include "../connection/SocketStreamBuf.h"
+#include "../connection/nodes/common/SharedMemory.h"
+
+#include <boost/asio.hpp>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <future>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "MessageID.h"
+#include "io/primitives.h"
+
+using tcp = boost::asio::ip::tcp;
+using namespace Gadgetron;
+using namespace Gadgetron::Core;
+
+namespace {
+
+    /// The peer side of the protocol, written against the documented layout rather than the implementation.
+    struct Peer {
+        char *memory = nullptr;
+        uint64_t size = 0;
+
+        uint64_t field(size_t offset) const { return *reinterpret_cast<uint64_t *>(memory + offset); }
+        std::atomic<uint64_t> &atomic(size_t offset) { return *reinterpret_cast<std::atomic<uint64_t> *>(memory + offset); }
+
+        void accept(std::iostream &stream) {
+            ASSERT_EQ(IO::read<uint16_t>(stream), SHARED_MEMORY);
+            ASSERT_EQ(IO::read<uint32_t>(stream), 1u);
+            auto name = IO::read_string_from_stream<uint32_t>(stream);
+            size = IO::read<uint64_t>(stream);
+            IO::read<uint64_t>(stream);
+
+            int fd = shm_open(name.c_str(), O_RDWR, 0);
+            ASSERT_GE(fd, 0);
+            memory = static_cast<char *>(mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0));
+            close(fd);
+            ASSERT_NE(memory, MAP_FAILED);
+            ASSERT_EQ(std::string(memory), "GTSHMEM");
+
+            IO::write(stream, SHARED_MEMORY);
+            IO::write(stream, uint32_t(1));
+            stream.flush();
+        }
+
+        ~Peer() {
+            if (memory) munmap(memory, size);
+        }
+    };
+}
+
+class SharedMemoryTest : public ::testing::Test {
+public:
+    SharedMemoryTest() {
+        tcp::acceptor acceptor(ios, tcp::endpoint(tcp::v4(), 0));
+        auto socket = std::make_unique<tcp::socket>(ios);
+        auto accepted = std::async([&]() { acceptor.accept(*socket); });
+
+        peer_stream = Connection::remote_stream("127.0.0.1", std::to_string(acceptor.local_endpoint().port()));
+        accepted.get();
+
+        auto handshake = std::async([&]() { peer.accept(*peer_stream); });
+        stream = Server::Connection::Nodes::negotiate_shared_memory(Connection::stream_from_socket(std::move(socket)));
+        handshake.get();
+    }
+
+    boost::asio::io_service ios{};
+    std::unique_ptr<std::iostream> peer_stream;
+    std::unique_ptr<std::iostream> stream;
+    Peer peer;
+};
+
+TEST_F(SharedMemoryTest, large_arrays_are_sent_through_the_ring) {
+    hoNDArray<float> array(256, 256);
+    for (size_t i = 0; i < array.size(); i++) array[i] = float(i);
+
+    IO::write(*stream, array);
+    stream->flush();
+
+    auto dimensions = IO::read<std::vector<size_t>>(*peer_stream);
+    ASSERT_EQ(dimensions, (std::vector<size_t>{ 256, 256 }));
+
+    auto position = IO::read<uint64_t>(*peer_stream);
+    ASSERT_NE(position, std::numeric_limits<uint64_t>::max());
+
+    auto offset = peer.field(64 + 16), capacity = peer.field(64 + 24);
+    auto data = reinterpret_cast<float *>(peer.memory + offset + position % capacity);
+    ASSERT_TRUE(std::equal(array.begin(), array.end(), data));
+
+    peer.atomic(64 + 8).store(position + array.get_number_of_bytes());
+}
+
+TEST_F(SharedMemoryTest, small_arrays_stay_inline) {
+    hoNDArray<float> array(16);
+    for (size_t i = 0; i < array.size(); i++) array[i] = float(i);
+
+    IO::write(*stream, array);
+    stream->flush();
+
+    auto received = IO::read<hoNDArray<float>>(*peer_stream);
+    ASSERT_EQ(received, array);
+}
+
+TEST_F(SharedMemoryTest, arrays_are_received_through_the_ring) {
+    hoNDArray<std::complex<float>> array(128, 128);
+    for (size_t i = 0; i < array.size(); i++) array[i] = std::complex<float>(float(i), -float(i));
+
+    auto offset = peer.field(128 + 16), capacity = peer.field(128 + 24);
+    std::memcpy(peer.memory + offset, array.data(), array.get_number_of_bytes());
+    peer.atomic(128).store(array.get_number_of_bytes());
+
+    IO::write(*peer_stream, std::vector<size_t>{ 128, 128 });
+    IO::write(*peer_stream, uint64_t(0));
+    peer_stream->flush();
+
+    auto received = IO::read<hoNDArray<std::complex<float>>>(*stream);
+    ASSERT_EQ(received, array);
+    ASSERT_EQ(peer.atomic(128 + 8).load(), array.get_number_of_bytes());
+}
+
+TEST_F(SharedMemoryTest, blocks_outside_the_written_range_are_rejected) {
+    hoNDArray<float> array(256, 256);
+
+    // Nothing was written to the ring, so any position is past its head.
+    IO::write(*peer_stream, std::vector<size_t>{ 256, 256 });
+    IO::write(*peer_stream, uint64_t(4096));
+    peer_stream->flush();
+
+    EXPECT_ANY_THROW(IO::read<hoNDArray<float>>(*stream));
+    EXPECT_EQ(peer.atomic(128 + 8).load(), 0u);
+}
@@ -3,6 +3,7 @@
 //
 #include "../connection/SocketStreamBuf.h"
 #include <boost/asio.hpp>
+#include <boost/filesystem.hpp>
 #include <gtest/gtest.h>
 #include <random>
 
@@ -11,10 +12,11 @@ using tcp    = boost::asio::ip::tcp;
 using namespace Gadgetron;
 
 
-class SocketTest : public ::testing::Test {
+/// Runs with shared I/O threads, and with none: blocking I/O, as in connections handled in their own process.
+class SocketTest : public ::testing::TestWithParam<size_t> {
 
 public:
-    SocketTest() : ::testing::Test() {
+    SocketTest() {
         auto endpoint = tcp::endpoint(tcp::v6(), 0);
         acceptor = std::make_unique<tcp::acceptor>(tcp::acceptor(ios, endpoint));
 
@@ -25,7 +27,9 @@ public:
             return socket;
         });
 
+        Connection::set_io_threads(GetParam());
         socketstream = Connection::remote_stream("localhost", std::to_string(port));
+        Connection::set_io_threads(2);
 
         server_socket = std::make_unique<tcp::socket>(socketF.get());
     }
@@ -38,7 +42,7 @@ public:
 
 };
 
-TEST_F(SocketTest, read_test) {
+TEST_P(SocketTest, read_test) {
 
     auto data = std::vector<char>(19,42);
     ba::write(*server_socket,ba::buffer(data.data(),data.size()));
@@ -50,7 +54,7 @@ TEST_F(SocketTest, read_test) {
     ASSERT_EQ(data,data2);
 }
 
-TEST_F(SocketTest, write_test) {
+TEST_P(SocketTest, write_test) {
 
     auto data = std::vector<char>(1u << 22,42);
 
@@ -64,7 +68,7 @@ TEST_F(SocketTest, write_test) {
 }
 
 
-TEST_F(SocketTest, stringstream_test) {
+TEST_P(SocketTest, stringstream_test) {
     const std::string name = "Albatros";
     std::stringstream sstream;
     sstream << name;
@@ -81,7 +85,7 @@ TEST_F(SocketTest, stringstream_test) {
 
 
 
-TEST_F(SocketTest, nulltest) {
+TEST_P(SocketTest, nulltest) {
     auto data =  std::vector<char>(1u << 22,0);
     std::mt19937_64 engine;
     std::uniform_int_distribution<char> distribution(0);
@@ -102,3 +106,91 @@ TEST_F(SocketTest, nulltest) {
     thread.join();
 }
 
+
+TEST_P(SocketTest, small_writes_test) {
+    for (uint64_t i = 0; i < 1000; i++) socketstream->write(reinterpret_cast<const char*>(&i), sizeof(i));
+
+    auto data = std::vector<uint64_t>(1000);
+    ba::read(*server_socket, ba::buffer(data.data(), data.size() * sizeof(uint64_t)));
+
+    for (uint64_t i = 0; i < 1000; i++) ASSERT_EQ(data[i], i);
+}
+
+TEST_P(SocketTest, single_characters_test) {
+    // Characters are collected in the put area; they must still go out in order with the writes around them.
+    std::string expected;
+    for (int i = 0; i < 10000; i++) {
+        auto c = char('a' + i % 26);
+        socketstream->put(c);
+        expected.push_back(c);
+        if (i % 1000 == 0) {
+            socketstream->write("|", 1);
+            expected.push_back('|');
+        }
+    }
+    socketstream->flush();
+
+    auto data = std::string(expected.size(), '\0');
+    ba::read(*server_socket, ba::buffer(data.data(), data.size()));
+    ASSERT_EQ(data, expected);
+}
+
+TEST_P(SocketTest, large_read_test) {
+    auto data = std::vector<char>(10u << 20);
+    std::mt19937_64 engine;
+    std::uniform_int_distribution<int> distribution(-128, 127);
+    for (auto& d : data) d = char(distribution(engine));
+
+    auto thread = std::thread([&]() { ba::write(*server_socket, ba::buffer(data.data(), data.size())); });
+
+    auto data2 = std::vector<char>(data.size());
+    size_t position = 0, chunk = 1;
+    while (position < data2.size()) {
+        chunk = std::min(chunk * 3, data2.size() - position);
+        socketstream->read(data2.data() + position, chunk);
+        position += chunk;
+    }
+
+    ASSERT_EQ(data, data2);
+    thread.join();
+}
+
+TEST_P(SocketTest, eof_test) {
+    auto data = std::vector<char>(19, 42);
+    ba::write(*server_socket, ba::buffer(data.data(), data.size()));
+    server_socket->close();
+
+    auto data2 = std::vector<char>(20);
+    socketstream->read(data2.data(), data2.size());
+
+    ASSERT_TRUE(socketstream->eof());
+    ASSERT_EQ(socketstream->gcount(), 19);
+}
+
+INSTANTIATE_TEST_SUITE_P(IOThreads, SocketTest, ::testing::Values(size_t(2), size_t(0)));
+
+TEST(UnixSocketTest, remote_stream_test) {
+    auto path = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string();
+
+    ba::io_service ios{};
+    ba::local::stream_protocol::acceptor acceptor(ios, ba::local::stream_protocol::endpoint(path));
+    auto socketF = std::async([&]() {
+        ba::local::stream_protocol::socket socket{ ios };
+        acceptor.accept(socket);
+        return socket;
+    });
+
+    auto stream = Connection::remote_stream(Connection::unix_socket_host, path);
+    auto server = Connection::stream_from_socket(
+        std::make_unique<ba::local::stream_protocol::socket>(socketF.get()));
+
+    auto data = std::vector<char>(1u << 20, 42);
+    auto thread = std::thread([&]() { stream->write(data.data(), data.size()); });
+
+    auto data2 = std::vector<char>(data.size());
+    server->read(data2.data(), data2.size());
+    thread.join();
+
+    ASSERT_EQ(data, data2);
+    boost::filesystem::remove(path);
+}
@@ -0,0 +1,133 @@
+#include "../connection/nodes/ParallelProcess.h"
+#include "../connection/nodes/Stream.h"
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <thread>
+
+using namespace Gadgetron::Core;
+using namespace Gadgetron::Server::Connection;
+using namespace Gadgetron::Server::Connection::Nodes;
+
+namespace {
+
+    /// Applies value * factor + offset; the gadgets of a chain do not commute, so their order shows in the output.
+    class Affine : public PureGadget<int, int> {
+    public:
+        Affine(int factor, int offset)
+            : PureGadget<int, int>(Context{}, GadgetProperties{}), factor(factor), offset(offset) {}
+
+        int process_function(int value) const override {
+            // Later messages finish first, when processed concurrently.
+            std::this_thread::sleep_for(std::chrono::microseconds(200 * (value % 5)));
+            std::lock_guard<std::mutex> guard(mutex);
+            threads.insert(std::this_thread::get_id());
+            return value * factor + offset;
+        }
+
+        static std::set<std::thread::id> threads;
+        static std::mutex mutex;
+
+    private:
+        const int factor, offset;
+    };
+
+    std::set<std::thread::id> Affine::threads;
+    std::mutex Affine::mutex;
+
+    /// Emits the running sum of its input; not pure, as its output depends on the messages before.
+    class RunningSum : public Node {
+    public:
+        void process(GenericInputChannel &in, OutputChannel &out) override {
+            int sum = 0;
+            for (auto message : in) out.push(sum += force_unpack<int>(std::move(message)));
+        }
+    };
+
+    class Reporter : public ErrorReporter {
+    public:
+        void operator()(const std::string &location, const std::string &message) override {
+            errors.push_back(location + ": " + message);
+        }
+
+        std::vector<std::string> errors;
+    };
+
+    std::shared_ptr<Processable> affine(int factor, int offset) {
+        return std::make_shared<GadgetNode>(
+                [=]() { return std::make_unique<Affine>(factor, offset); },
+                "Affine"
+        );
+    }
+
+    std::shared_ptr<Processable> running_sum() {
+        return std::make_shared<GadgetNode>([]() { return std::make_unique<RunningSum>(); }, "RunningSum");
+    }
+
+    /// Two runs of pure gadgets, separated by one that is not pure.
+    std::vector<std::shared_ptr<Processable>> chain() {
+        return { affine(2, 1), affine(3, -4), running_sum(), affine(-1, 7), affine(5, 0), affine(1, 2) };
+    }
+
+    std::vector<int> run(Processable &node, int count) {
+        auto input = make_channel<MessageChannel>();
+        auto output = make_channel<MessageChannel>();
+
+        for (int i = 0; i < count; i++) input.output.push(i);
+        {
+            auto closing = std::move(input.output);
+        }
+
+        Reporter reporter;
+        ErrorHandler handler{reporter, "test"};
+        node.process(std::move(input.input), std::move(output.output), handler);
+        EXPECT_TRUE(reporter.errors.empty());
+
+        std::vector<int> values;
+        while (auto message = output.input.try_pop()) values.push_back(force_unpack<int>(std::move(*message)));
+        return values;
+    }
+}
+
+TEST(StreamTest, fusing_pure_gadgets_leaves_the_output_unchanged) {
+    Stream unfused{"unfused", chain()};
+    auto expected = run(unfused, 200);
+    ASSERT_EQ(expected.size(), 200u);
+
+    for (size_t workers : {1, 4}) {
+        auto nodes = fuse_pure_gadgets(chain(), workers);
+        ASSERT_EQ(nodes.size(), 3u);
+        EXPECT_EQ(nodes[0]->name(), "Affine+Affine");
+        EXPECT_EQ(nodes[1]->name(), "RunningSum");
+        EXPECT_EQ(nodes[2]->name(), "Affine+Affine+Affine");
+
+        Stream fused{"fused", std::move(nodes)};
+        EXPECT_EQ(run(fused, 200), expected) << "with " << workers << " workers";
+    }
+}
+
+TEST(StreamTest, a_lone_pure_gadget_is_left_alone_with_one_worker) {
+    auto single = fuse_pure_gadgets({ running_sum(), affine(2, 1), running_sum() }, 1);
+    ASSERT_EQ(single.size(), 3u);
+    EXPECT_TRUE(std::dynamic_pointer_cast<GadgetNode>(single[1]));
+
+    auto parallel = fuse_pure_gadgets({ running_sum(), affine(2, 1), running_sum() }, 4);
+    ASSERT_EQ(parallel.size(), 3u);
+    EXPECT_TRUE(std::dynamic_pointer_cast<ParallelProcess>(parallel[1]));
+}
+
+TEST(StreamTest, one_worker_processes_in_the_calling_thread) {
+    std::vector<std::unique_ptr<GenericPureGadget>> gadgets;
+    gadgets.push_back(std::make_unique<Affine>(2, 1));
+    gadgets.push_back(std::make_unique<Affine>(3, -4));
+    ParallelProcess process{std::move(gadgets), 1, "Affine+Affine"};
+
+    Affine::threads.clear();
+    auto values = run(process, 50);
+
+    ASSERT_EQ(values.size(), 50u);
+    for (int i = 0; i < 50; i++) EXPECT_EQ(values[i], (i * 2 + 1) * 3 - 4);
+    EXPECT_EQ(Affine::threads, std::set<std::thread::id>{std::this_thread::get_id()});
+}
@@ -1,5 +1,7 @@
 #include "Channel.h"
 
+#include "trace.h"
+
 namespace Gadgetron::Core {
 
     class Channel::Closer {
@@ -12,16 +14,57 @@ namespace Gadgetron::Core {
         std::shared_ptr<Channel> channel;
     };
 
+    MessageChannel::MessageChannel(const std::string& node)
+        : timed{Metrics::enabled()},
+          depth{Metrics::gauge("gadgetron_node_queue_depth", "Messages waiting for the node.", {{"node", node}})},
+          received{Metrics::counter("gadgetron_node_messages_total", "Messages taken by the node.", {{"node", node}})},
+          process_time{Metrics::histogram("gadgetron_node_process_seconds",
+              "Time the node spends on a message before taking the next.", {{"node", node}})} {}
+
+    MessageChannel::~MessageChannel() {
+        // Messages never taken by the node leave the queue with the channel.
+        depth.add(-int64_t(channel.size()));
+    }
+
     Message MessageChannel::pop() {
-        return channel.pop();
+        const bool tracing = Trace::enabled();
+        if (!tracing && !timed) return std::move(channel.pop().message);
+
+        // The time since the previous pop was spent processing the previous message.
+        auto start = Trace::now();
+        auto previous = last_pop.exchange(0);
+        if (previous) {
+            if (tracing) Trace::record("process", "node", previous, start);
+            process_time.observe(double(start - previous) * 1e-6);
+        }
+
+        auto queued = channel.pop();
+
+        auto end = Trace::now();
+        depth.add(-1);
+        received.increment();
+        if (tracing) Trace::record("dequeue", "channel", start, end, "queued_us", queued.enqueued ? end - queued.enqueued : 0);
+        last_pop = end;
+
+        return std::move(queued.message);
     }
 
     optional<Message> MessageChannel::try_pop() {
-       return channel.try_pop();
+        auto queued = channel.try_pop();
+        if (!queued) return none;
+        depth.add(-1);
+        received.increment();
+        return std::move(queued->message);
     }
 
     void MessageChannel::push_message(Message message) {
-        channel.push(std::move(message));
+        depth.add(1);
+        try {
+            channel.push(QueuedMessage{std::move(message), Trace::enabled() ? Trace::now() : 0});
+        } catch (const ChannelClosed&) {
+            depth.add(-1);
+            throw;
+        }
     }
 
     void MessageChannel::close() {
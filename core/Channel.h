@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <condition_variable>
 #include <list>
 #include <memory>
@@ -7,6 +8,7 @@
 
 #include "MPMCChannel.h"
 #include "Message.h"
+#include "Metrics.h"
 #include "Types.h"
 
 #include "ChannelIterator.h"
@@ -109,6 +111,13 @@ namespace Gadgetron { namespace Core {
         OutputChannel output;
     };
     class MessageChannel : public Channel {
+    public:
+        MessageChannel() = default;
+
+        /// A channel feeding the node with the given name; its depth and throughput are reported as metrics of that node
+        explicit MessageChannel(const std::string& node);
+
+        ~MessageChannel() override;
 
     protected:
         Message pop() override;
@@ -119,7 +128,21 @@ namespace Gadgetron { namespace Core {
 
         void push_message(Message) override;
 
-        MPMCChannel<Message> channel;
+        struct QueuedMessage {
+            Message message;
+            /// Trace::now() at push, or 0 if tracing was disabled
+            uint64_t enqueued;
+        };
+
+        MPMCChannel<QueuedMessage> channel;
+
+        /// Trace::now() when the consumer last received a message, or 0
+        std::atomic<uint64_t> last_pop{0};
+
+        bool timed = false;
+        Metrics::Gauge depth;
+        Metrics::Counter received;
+        Metrics::Histogram process_time;
     };
 
     /***
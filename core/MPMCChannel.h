@@ -20,6 +20,9 @@ namespace Gadgetron::Core {
 
         void close();
 
+        /// Messages currently queued
+        size_t size();
+
     private:
         T pop_impl(std::unique_lock<std::mutex> lock);
         std::list<T> queue;
@@ -76,6 +79,11 @@ namespace Gadgetron::Core {
         cv.notify_all();
     }
 
+    template <class T> size_t MPMCChannel<T>::size() {
+        std::lock_guard<std::mutex> guard(m);
+        return queue.size();
+    }
+
     template <class T> template <class... ARGS> void MPMCChannel<T>::emplace(ARGS&&... args) {
         {
             std::lock_guard<std::mutex> guard(m);
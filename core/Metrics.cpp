@@ -0,0 +1,259 @@
+#include "Metrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <new>
+
+#include "log.h"
+
+#if !(_WIN32)
+#include <cerrno>
+#include <pthread.h>
+#include <sys/mman.h>
+#else
+#include <mutex>
+#endif
+
+namespace Gadgetron::Core::Metrics {
+
+    namespace {
+
+        constexpr size_t max_series = 2048;
+        constexpr size_t max_name   = 96;
+        constexpr size_t max_labels = 224;
+        constexpr size_t max_help   = 160;
+
+        constexpr double buckets[]      = { 0.0001, 0.0005, 0.001, 0.005, 0.01, 0.05, 0.1, 0.5, 1.0, 5.0, 10.0 };
+        constexpr size_t bucket_count   = sizeof(buckets) / sizeof(buckets[0]);
+        // Histogram values: one count per bucket, the +Inf bucket, the total count and the sum in microseconds.
+        constexpr size_t inf_index      = bucket_count;
+        constexpr size_t count_index    = bucket_count + 1;
+        constexpr size_t sum_index      = bucket_count + 2;
+        constexpr size_t value_count    = bucket_count + 3;
+
+        static_assert(std::atomic<int64_t>::is_always_lock_free, "Metrics shared between processes must be lock free.");
+
+        enum Type : int32_t { unused = 0, counter_type, gauge_type, histogram_type };
+
+        struct Series {
+            std::atomic<int32_t> type;
+            char name[max_name];
+            char labels[max_labels];
+            char help[max_help];
+            std::atomic<int64_t> values[value_count];
+        };
+
+        struct Table {
+#if !(_WIN32)
+            pthread_mutex_t mutex;
+#else
+            std::mutex mutex;
+#endif
+            std::atomic<uint32_t> size;
+            Series series[max_series];
+        };
+
+        Table* map_table() {
+            void* memory = nullptr;
+#if !(_WIN32)
+            memory = mmap(nullptr, sizeof(Table), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+            if (memory == MAP_FAILED) {
+                GWARN_STREAM("Unable to map shared metrics table; metrics of connection processes will not be visible.");
+                memory = nullptr;
+            }
+#endif
+            auto table = memory ? new (memory) Table() : new Table();
+#if !(_WIN32)
+            // Robust, so that a connection process dying while registering a metric cannot block the others.
+            pthread_mutexattr_t attributes;
+            pthread_mutexattr_init(&attributes);
+            pthread_mutexattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED);
+            pthread_mutexattr_setrobust(&attributes, PTHREAD_MUTEX_ROBUST);
+            pthread_mutex_init(&table->mutex, &attributes);
+            pthread_mutexattr_destroy(&attributes);
+#endif
+            return table;
+        }
+
+        Table& table() {
+            static Table* table = map_table();
+            return *table;
+        }
+
+        class TableLock {
+        public:
+            explicit TableLock(Table& table) : table(table) {
+#if !(_WIN32)
+                // A series is only published by storing the table size, after it is written. If its owner died, a
+                // half written series is never visible, and is overwritten by the next registration.
+                if (pthread_mutex_lock(&table.mutex) == EOWNERDEAD) pthread_mutex_consistent(&table.mutex);
+#else
+                table.mutex.lock();
+#endif
+            }
+            ~TableLock() {
+#if !(_WIN32)
+                pthread_mutex_unlock(&table.mutex);
+#else
+                table.mutex.unlock();
+#endif
+            }
+            TableLock(const TableLock&) = delete;
+            TableLock& operator=(const TableLock&) = delete;
+
+        private:
+            Table& table;
+        };
+
+        std::atomic<bool> enabled_flag{false};
+
+        std::string escape(const std::string& value) {
+            std::string escaped;
+            for (auto c : value) {
+                if (c == '\\') escaped += "\\\\";
+                else if (c == '"') escaped += "\\\"";
+                else if (c == '\n') escaped += "\\n";
+                else escaped += c;
+            }
+            return escaped;
+        }
+
+        std::string format_labels(const Labels& labels) {
+            std::string formatted;
+            for (auto& label : labels) {
+                if (!formatted.empty()) formatted += ",";
+                formatted += label.first + "=\"" + escape(label.second) + "\"";
+            }
+            return formatted;
+        }
+
+        std::atomic<int64_t>* find_or_register(Type type, const std::string& name, const std::string& help,
+            const Labels& labels) {
+
+            if (!enabled()) return nullptr;
+
+            auto formatted = format_labels(labels);
+            if (name.size() >= max_name || formatted.size() >= max_labels) {
+                GWARN_STREAM("Metric " << name << "{" << formatted << "} is too long and will not be recorded.");
+                return nullptr;
+            }
+
+            auto& t = table();
+            TableLock guard(t);
+
+            auto size = t.size.load(std::memory_order_relaxed);
+            for (uint32_t i = 0; i < size; i++) {
+                auto& series = t.series[i];
+                if (name != series.name || formatted != series.labels) continue;
+                if (series.type.load(std::memory_order_relaxed) != type) {
+                    GWARN_STREAM("Metric " << name << " is registered with a different type.");
+                    return nullptr;
+                }
+                return series.values;
+            }
+
+            if (size == max_series) {
+                GWARN_STREAM("Metrics table is full; metric " << name << " will not be recorded.");
+                return nullptr;
+            }
+
+            auto& series = t.series[size];
+            std::strncpy(series.name, name.c_str(), max_name - 1);
+            std::strncpy(series.labels, formatted.c_str(), max_labels - 1);
+            std::strncpy(series.help, help.c_str(), max_help - 1);
+            series.type.store(type, std::memory_order_relaxed);
+            t.size.store(size + 1, std::memory_order_release);
+
+            return series.values;
+        }
+
+        const char* type_name(int32_t type) {
+            switch (type) {
+            case counter_type: return "counter";
+            case gauge_type: return "gauge";
+            default: return "histogram";
+            }
+        }
+
+        void write_series(std::ostream& stream, const Series& series) {
+            std::string labels = series.labels;
+
+            if (series.type.load(std::memory_order_relaxed) != histogram_type) {
+                stream << series.name;
+                if (!labels.empty()) stream << "{" << labels << "}";
+                stream << " " << series.values[0].load(std::memory_order_relaxed) << "\n";
+                return;
+            }
+
+            auto prefix = labels.empty() ? std::string() : labels + ",";
+
+            int64_t cumulative = 0;
+            for (size_t i = 0; i < bucket_count; i++) {
+                cumulative += series.values[i].load(std::memory_order_relaxed);
+                stream << series.name << "_bucket{" << prefix << "le=\"" << buckets[i] << "\"} " << cumulative << "\n";
+            }
+            cumulative += series.values[inf_index].load(std::memory_order_relaxed);
+            stream << series.name << "_bucket{" << prefix << "le=\"+Inf\"} " << cumulative << "\n";
+
+            auto braced = labels.empty() ? std::string() : "{" + labels + "}";
+            stream << series.name << "_sum" << braced << " "
+                   << double(series.values[sum_index].load(std::memory_order_relaxed)) * 1e-6 << "\n";
+            stream << series.name << "_count" << braced << " "
+                   << series.values[count_index].load(std::memory_order_relaxed) << "\n";
+        }
+    }
+
+    void enable(bool on) {
+        if (on) table();
+        enabled_flag.store(on, std::memory_order_relaxed);
+    }
+
+    bool enabled() {
+        return enabled_flag.load(std::memory_order_relaxed);
+    }
+
+    void Histogram::observe(double seconds) {
+        if (!values) return;
+
+        size_t index = std::lower_bound(std::begin(buckets), std::end(buckets), seconds) - std::begin(buckets);
+        values[index].fetch_add(1, std::memory_order_relaxed);
+        values[count_index].fetch_add(1, std::memory_order_relaxed);
+        values[sum_index].fetch_add(std::llround(seconds * 1e6), std::memory_order_relaxed);
+    }
+
+    Counter counter(const std::string& name, const std::string& help, const Labels& labels) {
+        return Counter(find_or_register(counter_type, name, help, labels));
+    }
+
+    Gauge gauge(const std::string& name, const std::string& help, const Labels& labels) {
+        return Gauge(find_or_register(gauge_type, name, help, labels));
+    }
+
+    Histogram histogram(const std::string& name, const std::string& help, const Labels& labels) {
+        return Histogram(find_or_register(histogram_type, name, help, labels));
+    }
+
+    void write_prometheus(std::ostream& stream) {
+        auto& t = table();
+        auto size = t.size.load(std::memory_order_acquire);
+
+        // Series of the same metric have to be written together, below a single HELP and TYPE line.
+        std::map<std::string, std::vector<const Series*>> families;
+        std::vector<std::string> order;
+        for (uint32_t i = 0; i < size; i++) {
+            auto& series = t.series[i];
+            auto& family = families[series.name];
+            if (family.empty()) order.emplace_back(series.name);
+            family.push_back(&series);
+        }
+
+        for (auto& name : order) {
+            auto& family = families[name];
+            stream << "# HELP " << name << " " << family.front()->help << "\n";
+            stream << "# TYPE " << name << " " << type_name(family.front()->type.load()) << "\n";
+            for (auto series : family) write_series(stream, *series);
+        }
+    }
+}
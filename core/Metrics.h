@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Process-wide metrics (counters, gauges and histograms), written in the Prometheus text format.
+ *
+ * Release builds of the server fork a process per connection. Metric values therefore live in a fixed size table of
+ * shared anonymous memory, which is mapped when metrics are enabled. As long as that happens before the server starts
+ * accepting connections, updates made by connection processes are visible to the server process exposing the metrics.
+ *
+ * Metrics are disabled unless the server serves them. Handles looked up while metrics are disabled discard their
+ * updates, so instrumented code costs a null check.
+ *
+ * Looking up a metric takes a lock; keep the returned handle around. Updating a metric is a single atomic operation.
+ */
+namespace Gadgetron::Core::Metrics {
+
+    using Labels = std::vector<std::pair<std::string, std::string>>;
+
+    /// Enables metrics and maps the shared metrics table. Must be called before forking for the metrics of child
+    /// processes to be visible. Handles looked up before metrics are enabled stay inert.
+    void enable(bool on = true);
+
+    bool enabled();
+
+    class Counter {
+    public:
+        Counter() = default;
+        void increment(uint64_t n = 1) {
+            if (value) value->fetch_add(int64_t(n), std::memory_order_relaxed);
+        }
+
+    private:
+        friend Counter counter(const std::string&, const std::string&, const Labels&);
+        explicit Counter(std::atomic<int64_t>* value) : value(value) {}
+        std::atomic<int64_t>* value = nullptr;
+    };
+
+    class Gauge {
+    public:
+        Gauge() = default;
+        void add(int64_t n) {
+            if (value) value->fetch_add(n, std::memory_order_relaxed);
+        }
+        void set(int64_t n) {
+            if (value) value->store(n, std::memory_order_relaxed);
+        }
+
+    private:
+        friend Gauge gauge(const std::string&, const std::string&, const Labels&);
+        explicit Gauge(std::atomic<int64_t>* value) : value(value) {}
+        std::atomic<int64_t>* value = nullptr;
+    };
+
+    /// Histogram of durations in seconds, with fixed buckets from 100 us to 10 s
+    class Histogram {
+    public:
+        Histogram() = default;
+        void observe(double seconds);
+
+    private:
+        friend Histogram histogram(const std::string&, const std::string&, const Labels&);
+        explicit Histogram(std::atomic<int64_t>* values) : values(values) {}
+        std::atomic<int64_t>* values = nullptr;
+    };
+
+    /// Keeps a gauge incremented for the lifetime of the object, e.g. for the number of active connections
+    class GaugeGuard {
+    public:
+        explicit GaugeGuard(Gauge gauge) : gauge(gauge) { this->gauge.add(1); }
+        ~GaugeGuard() { gauge.add(-1); }
+        GaugeGuard(const GaugeGuard&) = delete;
+        GaugeGuard& operator=(const GaugeGuard&) = delete;
+
+    private:
+        Gauge gauge;
+    };
+
+    /// Returns the metric with the given name and labels, registering it if needed. If metrics are disabled or the
+    /// metrics table is full, the returned handle silently discards updates.
+    Counter counter(const std::string& name, const std::string& help, const Labels& labels = {});
+    Gauge gauge(const std::string& name, const std::string& help, const Labels& labels = {});
+    Histogram histogram(const std::string& name, const std::string& help, const Labels& labels = {});
+
+    /// Writes all registered metrics in the Prometheus text exposition format (version 0.0.4)
+    void write_prometheus(std::ostream& stream);
+}
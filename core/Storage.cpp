@@ -130,9 +130,7 @@ std::shared_ptr<std::istream> StorageClient::get_latest_item(StorageItemTags con
     if (resp.status_code != 200) {
         throw std::runtime_error("Storage server error when getting latest items: " + get_response_error_message(resp));
     }
-    auto stream = std::make_shared<std::stringstream>();
-    stream->str(resp.text);
-    return stream;
+    return std::make_shared<BufferStream>(std::make_shared<const std::string>(std::move(resp.text)));
 }
 
 std::shared_ptr<std::istream> StorageClient::get_item_by_url(const std::string& url) {
@@ -145,9 +143,12 @@ std::shared_ptr<std::istream> StorageClient::get_item_by_url(const std::string&
         throw std::runtime_error("Storage server error when getting item: " + get_response_error_message(resp));
     }
 
-    auto stream = std::make_shared<std::stringstream>();
-    stream->str(resp.text);
-    return stream;
+    return std::make_shared<BufferStream>(std::make_shared<const std::string>(std::move(resp.text)));
+}
+
+BufferStream::BufferStream(std::shared_ptr<const std::string> buffer)
+    : std::istream(nullptr), buffer_(std::move(buffer)), streambuf(buffer_->data(), buffer_->size()) {
+    rdbuf(&streambuf);
 }
 
 StorageItem StorageClient::store_item(StorageItemTags const& tags, std::istream& data,
@@ -158,7 +159,7 @@ StorageItem StorageClient::store_item(StorageItemTags const& tags, std::istream&
     }
 
     std::string s(std::istreambuf_iterator<char>(data), {});
-    cpr::Body body(s);
+    cpr::Body body(std::move(s));
     auto resp = cpr::Post(cpr::Url(base_url + "/v1/blobs/data"), query_parameters, body);
     if (resp.status_code != 201) {
         throw std::runtime_error("Storage server error when storing item: " + get_response_error_message(resp));
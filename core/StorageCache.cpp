@@ -0,0 +1,406 @@
+#include "StorageCache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <stdexcept>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#include <boost/filesystem/operations.hpp>
+
+#include "log.h"
+
+namespace fs = boost::filesystem;
+
+namespace Gadgetron::Storage {
+
+namespace {
+constexpr char magic[8] = {'G', 'T', 'S', 'C', 'A', 'C', 'H', 'E'};
+const std::string entry_extension = ".entry";
+
+std::string cache_key(std::string const& server, StorageItemTags const& tags) {
+    // Tags are matched exactly; a separator that cannot occur in a query parameter keeps the key unambiguous.
+    std::string key = "server=" + server;
+    auto add = [&](std::string const& name, std::string const& value) { key += '\0' + name + '=' + value; };
+
+    add("subject", tags.subject);
+
+    if (tags.device) add("device", *tags.device);
+    if (tags.session) add("session", *tags.session);
+    if (tags.name) add("name", *tags.name);
+
+    std::vector<std::pair<std::string, std::string>> custom_tags(tags.custom_tags.begin(), tags.custom_tags.end());
+    std::sort(custom_tags.begin(), custom_tags.end());
+    for (auto const& [name, value] : custom_tags) add("custom:" + name, value);
+
+    return key;
+}
+
+std::string file_name(std::string const& key) {
+    // FNV-1a; the file name must be the same in every process sharing the cache directory. Collisions are resolved by
+    // the key stored in the file.
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : key) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+
+    std::stringstream name;
+    name << std::hex << std::setw(16) << std::setfill('0') << hash << entry_extension;
+    return name.str();
+}
+
+std::shared_ptr<const std::string> buffer_of(std::istream& stream) {
+    if (auto buffered = dynamic_cast<BufferStream*>(&stream)) {
+        if (buffered->tellg() == 0) {
+            return buffered->buffer();
+        }
+    }
+    return std::make_shared<const std::string>(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+}
+} // namespace
+
+StorageCache::StorageCache(fs::path directory, size_t disk_capacity, size_t memory_capacity,
+                           std::chrono::seconds max_age, std::string server)
+    : directory(std::move(directory)), disk_capacity(disk_capacity), memory_capacity(memory_capacity),
+      max_age(max_age), server(std::move(server)) {
+    if (this->directory.empty()) {
+        return;
+    }
+
+    boost::system::error_code error;
+    fs::create_directories(this->directory, error);
+    if (error) {
+        GWARN_STREAM("Unable to create storage cache directory " << this->directory << ": " << error.message());
+    }
+}
+
+std::shared_ptr<const std::string> StorageCache::find(StorageItemTags const& tags) {
+    auto key = cache_key(server, tags);
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        auto it = index.find(key);
+        if (it != index.end()) {
+            auto entry = it->second;
+            if (entry->expires > Clock::now()) {
+                entries.splice(entries.begin(), entries, entry);
+                return entry->data;
+            }
+            memory_size -= entry->data->size();
+            entries.erase(entry);
+            index.erase(it);
+        }
+    }
+
+    auto entry = read_from_disk(key);
+    if (!entry) {
+        return nullptr;
+    }
+
+    auto data = entry->data;
+    insert_in_memory(std::move(*entry));
+    return data;
+}
+
+void StorageCache::insert(StorageItemTags const& tags, std::shared_ptr<const std::string> data,
+                          std::optional<std::chrono::seconds> time_to_live) {
+    auto age = time_to_live ? std::min(*time_to_live, max_age) : max_age;
+    Entry entry{cache_key(server, tags), std::move(data), Clock::now() + age};
+
+    write_to_disk(entry);
+    insert_in_memory(std::move(entry));
+}
+
+void StorageCache::insert_in_memory(Entry entry) {
+    std::lock_guard<std::mutex> guard(mutex);
+
+    if (auto it = index.find(entry.key); it != index.end()) {
+        memory_size -= it->second->data->size();
+        entries.erase(it->second);
+        index.erase(it);
+    }
+
+    if (entry.data->size() > memory_capacity) {
+        return;
+    }
+
+    memory_size += entry.data->size();
+    entries.push_front(std::move(entry));
+    index[entries.front().key] = entries.begin();
+
+    while (memory_size > memory_capacity) {
+        auto& last = entries.back();
+        memory_size -= last.data->size();
+        index.erase(last.key);
+        entries.pop_back();
+    }
+}
+
+std::optional<StorageCache::Entry> StorageCache::read_from_disk(std::string const& key) {
+    if (directory.empty()) {
+        return {};
+    }
+
+    auto path = directory / file_name(key);
+    std::ifstream file(path.string(), std::ios::binary);
+    if (!file) {
+        return {};
+    }
+
+    char stored_magic[sizeof(magic)];
+    uint64_t expires = 0, key_size = 0;
+    file.read(stored_magic, sizeof(stored_magic));
+    file.read(reinterpret_cast<char*>(&expires), sizeof(expires));
+    file.read(reinterpret_cast<char*>(&key_size), sizeof(key_size));
+    if (!file || std::memcmp(stored_magic, magic, sizeof(magic)) != 0 || key_size != key.size()) {
+        return {};
+    }
+
+    std::string stored_key(key_size, '\0');
+    file.read(stored_key.data(), key_size);
+    if (!file || stored_key != key) {
+        return {};
+    }
+
+    auto expiry = Clock::time_point(std::chrono::seconds(expires));
+    if (expiry <= Clock::now()) {
+        file.close();
+        boost::system::error_code error;
+        fs::remove(path, error);
+        return {};
+    }
+
+    auto start = file.tellg();
+    file.seekg(0, std::ios::end);
+    auto size = size_t(file.tellg() - start);
+    file.seekg(start);
+
+    auto data = std::make_shared<std::string>(size, '\0');
+    file.read(data->data(), size);
+    if (!file) {
+        return {};
+    }
+
+    // Disk entries are evicted in order of modification time; touching an entry on every hit makes that LRU order.
+    boost::system::error_code error;
+    fs::last_write_time(path, std::time(nullptr), error);
+
+    return Entry{key, std::move(data), expiry};
+}
+
+void StorageCache::write_to_disk(Entry const& entry) {
+    if (directory.empty() || entry.data->size() > disk_capacity) {
+        return;
+    }
+
+    // Entries are renamed into place, so processes sharing the directory never read a partially written entry.
+    auto temporary = directory / fs::unique_path("%%%%-%%%%-%%%%-%%%%.tmp");
+    {
+        std::ofstream file(temporary.string(), std::ios::binary);
+        uint64_t expires = std::chrono::duration_cast<std::chrono::seconds>(entry.expires.time_since_epoch()).count();
+        uint64_t key_size = entry.key.size();
+        file.write(magic, sizeof(magic));
+        file.write(reinterpret_cast<const char*>(&expires), sizeof(expires));
+        file.write(reinterpret_cast<const char*>(&key_size), sizeof(key_size));
+        file.write(entry.key.data(), entry.key.size());
+        file.write(entry.data->data(), entry.data->size());
+        if (!file.flush()) {
+            GWARN_STREAM("Unable to write storage cache entry " << temporary);
+            file.close();
+            boost::system::error_code error;
+            fs::remove(temporary, error);
+            return;
+        }
+    }
+
+    boost::system::error_code error;
+    fs::rename(temporary, directory / file_name(entry.key), error);
+    if (error) {
+        GWARN_STREAM("Unable to write storage cache entry: " << error.message());
+        fs::remove(temporary, error);
+        return;
+    }
+
+    evict_from_disk();
+}
+
+void StorageCache::evict_from_disk() {
+    struct File {
+        fs::path path;
+        std::time_t modified;
+        uintmax_t size;
+    };
+
+    std::vector<File> files;
+    uintmax_t total = 0;
+
+    boost::system::error_code error;
+    for (fs::directory_iterator it(directory, error), end; !error && it != end; it.increment(error)) {
+        auto const& path = it->path();
+        if (path.extension() != entry_extension) {
+            continue;
+        }
+
+        boost::system::error_code status;
+        auto size = fs::file_size(path, status);
+        auto modified = fs::last_write_time(path, status);
+        if (status) {
+            continue;
+        }
+
+        files.push_back({path, modified, size});
+        total += size;
+    }
+
+    if (total <= disk_capacity) {
+        return;
+    }
+
+    std::sort(files.begin(), files.end(), [](auto const& a, auto const& b) { return a.modified < b.modified; });
+    for (auto const& file : files) {
+        if (total <= disk_capacity) {
+            break;
+        }
+        if (fs::remove(file.path, error)) {
+            total -= file.size;
+        }
+    }
+}
+
+CachingStorageClient::CachingStorageClient(std::shared_ptr<StorageClient> upstream, std::shared_ptr<StorageCache> cache,
+                                           size_t retries)
+    : upstream(std::move(upstream)), cache(std::move(cache)), retries(retries) {
+    uploader = std::thread([this]() { upload_loop(); });
+}
+
+CachingStorageClient::~CachingStorageClient() {
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        closed = true;
+    }
+    pending_changed.notify_all();
+    uploader.join();
+}
+
+StorageItemList CachingStorageClient::list_items(StorageItemTags const& tags, size_t limit) {
+    return upstream->list_items(tags, limit);
+}
+
+StorageItemList CachingStorageClient::get_next_page_of_items(StorageItemList const& page) {
+    return upstream->get_next_page_of_items(page);
+}
+
+std::shared_ptr<std::istream> CachingStorageClient::get_latest_item(StorageItemTags const& tags) {
+    if (auto data = cache->find(tags)) {
+        return std::make_shared<BufferStream>(std::move(data));
+    }
+
+    auto stream = upstream->get_latest_item(tags);
+    if (!stream) {
+        return {};
+    }
+
+    auto data = buffer_of(*stream);
+    cache->insert(tags, data);
+    return std::make_shared<BufferStream>(std::move(data));
+}
+
+std::shared_ptr<std::istream> CachingStorageClient::get_item_by_url(std::string const& url) {
+    return upstream->get_item_by_url(url);
+}
+
+StorageItem CachingStorageClient::store_item(StorageItemTags const& tags, std::istream& data,
+                                             std::optional<std::chrono::seconds> time_to_live) {
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        throw_if_failed();
+    }
+
+    auto buffer = buffer_of(data);
+    cache->insert(tags, buffer, time_to_live);
+
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        pending.push_back({tags, buffer, time_to_live});
+    }
+    pending_changed.notify_all();
+
+    StorageItem item;
+    item.tags = tags;
+    item.contentType = "application/octet-stream";
+    item.lastModified = std::chrono::system_clock::now();
+    if (time_to_live) {
+        item.expires = item.lastModified + *time_to_live;
+    }
+    return item;
+}
+
+std::optional<std::string> CachingStorageClient::health_check() {
+    return upstream->health_check();
+}
+
+void CachingStorageClient::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    pending_changed.wait(lock, [&]() { return pending.empty() && !uploading; });
+    throw_if_failed();
+}
+
+void CachingStorageClient::throw_if_failed() {
+    if (failure) {
+        std::rethrow_exception(std::exchange(failure, nullptr));
+    }
+}
+
+void CachingStorageClient::upload_loop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        pending_changed.wait(lock, [&]() { return closed || !pending.empty(); });
+        if (pending.empty()) {
+            return;
+        }
+
+        auto next = std::move(pending.front());
+        pending.pop_front();
+        uploading = true;
+
+        lock.unlock();
+        auto error = upload(next);
+        lock.lock();
+
+        // Only the first failure is kept; every one is logged.
+        if (error && !failure) {
+            failure = error;
+        }
+
+        uploading = false;
+        pending_changed.notify_all();
+    }
+}
+
+std::exception_ptr CachingStorageClient::upload(Upload const& upload) {
+    auto delay = std::chrono::milliseconds(100);
+    for (size_t attempt = 0;; attempt++) {
+        try {
+            BufferStream stream(upload.data);
+            upstream->store_item(upload.tags, stream, upload.time_to_live);
+            return nullptr;
+        } catch (std::exception const& e) {
+            if (attempt == retries) {
+                std::stringstream message;
+                message << "Failed to store item " << upload.tags.name.value_or("") << " on the storage server after "
+                        << attempt + 1 << " attempts; it remains in the local cache. " << e.what();
+                GERROR_STREAM(message.str());
+                return std::make_exception_ptr(std::runtime_error(message.str()));
+            }
+            GWARN_STREAM("Failed to store item on the storage server; retrying. " << e.what());
+        }
+        std::this_thread::sleep_for(delay);
+        delay *= 2;
+    }
+}
+} // namespace Gadgetron::Storage
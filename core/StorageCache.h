@@ -0,0 +1,124 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include <boost/filesystem/path.hpp>
+
+#include "StorageSetup.h"
+
+namespace Gadgetron::Storage {
+
+/**
+ * Least recently used cache of storage items, keyed by the storage server they belong to and their exact tags.
+ *
+ * Items live in memory and, if a directory is given, on disk. The disk tier is shared between every process using the
+ * same directory (connections run in their own processes in release builds), so an artifact stored by one scan is
+ * available to the next scan of the same session without a round trip to the storage server. Entries are written
+ * atomically and expire after the item's time to live or the cache's maximum age, whichever is shorter; the maximum
+ * age bounds how stale a cached 'latest' item can be when other clients write to the same server.
+ */
+class StorageCache {
+  public:
+    /** The server address scopes every entry, so servers sharing a cache directory do not see each other's items. */
+    StorageCache(boost::filesystem::path directory, size_t disk_capacity, size_t memory_capacity,
+                 std::chrono::seconds max_age, std::string server = {});
+
+    std::shared_ptr<const std::string> find(StorageItemTags const& tags);
+
+    void insert(StorageItemTags const& tags, std::shared_ptr<const std::string> data,
+                std::optional<std::chrono::seconds> time_to_live = {});
+
+  private:
+    using Clock = std::chrono::system_clock;
+
+    struct Entry {
+        std::string key;
+        std::shared_ptr<const std::string> data;
+        Clock::time_point expires;
+    };
+
+    void insert_in_memory(Entry entry);
+    std::optional<Entry> read_from_disk(std::string const& key);
+    void write_to_disk(Entry const& entry);
+    void evict_from_disk();
+
+    const boost::filesystem::path directory;
+    const size_t disk_capacity;
+    const size_t memory_capacity;
+    const std::chrono::seconds max_age;
+    const std::string server;
+
+    std::mutex mutex;
+    std::list<Entry> entries;
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    size_t memory_size = 0;
+};
+
+/**
+ * Write-through caching client in front of a storage server.
+ *
+ * Latest items are served from the cache when present. Stored items go to the cache immediately, and are uploaded to
+ * the server by a background thread, retrying failed uploads a bounded number of times. An upload that exhausts its
+ * retries is reported by the next call to store_item or flush, which throws without doing anything else. Pending
+ * uploads are flushed when the client is destroyed. Stores return the item as it was submitted; the location assigned by the server is
+ * not known at that point. Listing items and reading items by url always go to the server.
+ */
+class CachingStorageClient : public StorageClient {
+  public:
+    CachingStorageClient(std::shared_ptr<StorageClient> upstream, std::shared_ptr<StorageCache> cache,
+                         size_t retries = 3);
+
+    ~CachingStorageClient() override;
+
+    StorageItemList list_items(StorageItemTags const& tags, size_t limit) override;
+
+    StorageItemList get_next_page_of_items(StorageItemList const& page) override;
+
+    std::shared_ptr<std::istream> get_latest_item(StorageItemTags const& tags) override;
+
+    std::shared_ptr<std::istream> get_item_by_url(std::string const& url) override;
+
+    StorageItem store_item(StorageItemTags const& tags, std::istream& data,
+                           std::optional<std::chrono::seconds> time_to_live = {}) override;
+
+    std::optional<std::string> health_check() override;
+
+    /**
+     * Blocks until every pending upload has either reached the server or exhausted its retries. Throws if an upload
+     * has failed since the last store_item or flush.
+     */
+    void flush();
+
+  private:
+    struct Upload {
+        StorageItemTags tags;
+        std::shared_ptr<const std::string> data;
+        std::optional<std::chrono::seconds> time_to_live;
+    };
+
+    void upload_loop();
+    std::exception_ptr upload(Upload const& upload);
+    void throw_if_failed();
+
+    const std::shared_ptr<StorageClient> upstream;
+    const std::shared_ptr<StorageCache> cache;
+    const size_t retries;
+
+    std::mutex mutex;
+    std::condition_variable pending_changed;
+    std::deque<Upload> pending;
+    bool uploading = false;
+    bool closed = false;
+    std::exception_ptr failure;
+    std::thread uploader;
+};
+} // namespace Gadgetron::Storage
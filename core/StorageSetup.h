@@ -6,6 +6,7 @@
 #include <memory>
 #include <optional>
 #include <ostream>
+#include <string>
 
 #include "IsmrmrdContextVariables.h"
 #include "io/adapt_struct.h"
@@ -13,10 +14,29 @@
 #include "io/primitives.h"
 #include <boost/date_time/posix_time/posix_time_config.hpp>
 #include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/stream.hpp>
+#include <boost/iostreams/stream_buffer.hpp>
 #include <boost/iterator/transform_iterator.hpp>
 
 namespace Gadgetron::Storage {
 
+/**
+ * Stream over an immutable, shared buffer. Items read from the server and from the cache, and items stored through a
+ * StorageSpace, are handed over through these, so they pass between the client, the cache and the reader without
+ * copying.
+ */
+class BufferStream : public std::istream {
+  public:
+    explicit BufferStream(std::shared_ptr<const std::string> buffer);
+
+    std::shared_ptr<const std::string> buffer() const { return buffer_; }
+
+  private:
+    std::shared_ptr<const std::string> buffer_;
+    boost::iostreams::stream_buffer<boost::iostreams::array_source> streambuf;
+};
+
 struct StorageItemTags {
   public:
     class Builder;
@@ -94,6 +114,9 @@ class StorageClient {
 
     virtual std::optional<std::string> health_check();
 
+  protected:
+    StorageClient() = default;
+
   private:
     std::string base_url;
 };
@@ -116,8 +139,13 @@ class StorageSpace {
     template <class T, typename Rep, typename Period>
     void store(const std::string& key, const T& value, std::chrono::duration<Rep, Period> duration) {
         auto tags = get_tag_builder(true).with_name(key).build();
-        std::stringstream stream;
-        Core::IO::write(stream, value);
+        auto buffer = std::make_shared<std::string>();
+        {
+            boost::iostreams::stream<boost::iostreams::back_insert_device<std::string>> serialized(*buffer);
+            Core::IO::write(serialized, value);
+        }
+        // Handed over as a BufferStream, a caching client keeps the buffer rather than copying it.
+        BufferStream stream(std::move(buffer));
         client->store_item(tags, stream, std::chrono::duration_cast<std::chrono::seconds>(duration));
     }
 
@@ -16,6 +16,14 @@ namespace Gadgetron::Core {
 
         virtual bool accepts(const Message &) = 0;
 
+        /**
+         * Whether accepts depends on nothing but the types of the message's chunks, in order. Writers that say so
+         * are asked once per combination of chunk types, and the answer is reused for every later message of the
+         * same types (see WriterDispatch). Writers looking at the values of the chunks must return false; they are
+         * asked about every message.
+         */
+        virtual bool accepts_by_type() const { return false; }
+
         virtual void write(std::ostream &stream, Message message) = 0;
     };
 
@@ -27,6 +35,9 @@ namespace Gadgetron::Core {
 
         bool accepts(const Message &) override;
 
+        /// True; writers overriding accepts to look at the values of the chunks must override this as well.
+        bool accepts_by_type() const override { return true; }
+
         void write(std::ostream &stream, Message message) override;
 
     protected:
@@ -0,0 +1,51 @@
+#include "WriterDispatch.h"
+
+#include <mutex>
+
+namespace Gadgetron::Core {
+
+    MessageSignature signature(const Message &message) {
+        MessageSignature signature;
+        for (auto &chunk : message.messages()) signature.emplace_back(typeid(*chunk));
+        return signature;
+    }
+
+    size_t MessageSignatureHash::operator()(const MessageSignature &signature) const {
+        size_t seed = signature.size();
+        for (auto &type : signature) seed ^= std::hash<std::type_index>{}(type) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        return seed;
+    }
+
+    const WriterDispatch::Route &WriterDispatch::route(const Message &message) const {
+        auto key = signature(message);
+        {
+            std::shared_lock<std::shared_mutex> guard(mutex);
+            auto known = routes.find(key);
+            if (known != routes.end()) return known->second;
+        }
+
+        Route route;
+        for (size_t index = 0; index < writers.size(); index++) {
+            if (!writers[index]->accepts_by_type()) {
+                route.probe.push_back(index);
+                continue;
+            }
+            if (writers[index]->accepts(message)) {
+                route.accepting = index;
+                break;
+            }
+        }
+
+        // Routes are never removed, and references to unordered_map elements survive rehashing.
+        std::unique_lock<std::shared_mutex> guard(mutex);
+        return routes.emplace(std::move(key), std::move(route)).first->second;
+    }
+
+    size_t WriterDispatch::find(const Message &message) const {
+        auto &route = this->route(message);
+        for (auto index : route.probe) {
+            if (writers[index]->accepts(message)) return index;
+        }
+        return route.accepting;
+    }
+}
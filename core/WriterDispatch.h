@@ -0,0 +1,63 @@
+#pragma once
+
+#include <limits>
+#include <shared_mutex>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/container/small_vector.hpp>
+
+#include "Message.h"
+#include "Writer.h"
+
+namespace Gadgetron::Core {
+
+    /// Types of the chunks of a message, in order
+    using MessageSignature = boost::container::small_vector<std::type_index, 4>;
+
+    MessageSignature signature(const Message &message);
+
+    struct MessageSignatureHash {
+        size_t operator()(const MessageSignature &signature) const;
+    };
+
+    /**
+     * Picks the writer for a message. Most writers accept or reject messages on the types of their chunks alone
+     * (Writer::accepts_by_type), so those are probed once for each signature, and the outcome remembered. Later
+     * messages of the same types cost a hash lookup, however many writers there are. Writers that look at the values
+     * of the chunks are asked about every message, if they come before the writer remembered for the signature.
+     *
+     * Writers are tried in order; the first to accept a message gets it. Safe to use from several threads.
+     */
+    class WriterDispatch {
+    public:
+        static constexpr size_t none = std::numeric_limits<size_t>::max();
+
+        template<class WRITERS>
+        explicit WriterDispatch(const WRITERS &writers) {
+            for (auto &writer : writers) this->writers.push_back(&*writer);
+        }
+
+        /// Index of the writer for the message, or WriterDispatch::none if no writer accepts it
+        size_t find(const Message &message) const;
+
+        bool accepts(const Message &message) const { return find(message) != none; }
+
+        Writer &operator[](size_t index) const { return *writers[index]; }
+
+    private:
+        /// For one signature: the writers which have to be asked, followed by the writer accepting by type, if any
+        struct Route {
+            boost::container::small_vector<size_t, 2> probe;
+            size_t accepting = none;
+        };
+
+        const Route &route(const Message &message) const;
+
+        std::vector<Writer *> writers;
+
+        mutable std::shared_mutex mutex;
+        mutable std::unordered_map<MessageSignature, Route, MessageSignatureHash> routes;
+    };
+}
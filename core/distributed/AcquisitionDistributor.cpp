@@ -24,15 +24,15 @@ namespace {
             {"user_6",               [](const Header &header) { return header.idx.user[6]; }},
             {"user_7",               [](const Header &header) { return header.idx.user[7]; }}
     };
-
-    const std::function<uint16_t(const ISMRMRD::AcquisitionHeader&)> &selector_function(const std::string &key) {
-        return function_map.at(key);
-    }
 }
 
 
 namespace Gadgetron::Core::Distributed {
 
+    const std::function<uint16_t(const ISMRMRD::AcquisitionHeader&)> &index_selector(const std::string &dimension) {
+        return function_map.at(dimension);
+    }
+
     void AcquisitionDistributor::process(InputChannel<Acquisition> &input,
             ChannelCreator &creator
     ) {
@@ -50,7 +50,7 @@ namespace Gadgetron::Core::Distributed {
     AcquisitionDistributor::AcquisitionDistributor(
             const Gadgetron::Core::Context &context,
             const Gadgetron::Core::GadgetProperties &props
-    ) : TypedDistributor(props), selector(selector_function(parallel_dimension)) {}
+    ) : TypedDistributor(props), selector(index_selector(parallel_dimension)) {}
 
     GADGETRON_DISTRIBUTOR_EXPORT(AcquisitionDistributor);
 }
\ No newline at end of file
@@ -5,6 +5,10 @@
 #include "Types.h"
 
 namespace Gadgetron::Core::Distributed {
+
+    /// The function reading the named index (e.g. "slice" or "user_0") from an acquisition header
+    const std::function<uint16_t(const ISMRMRD::AcquisitionHeader&)> &index_selector(const std::string &dimension);
+
     class AcquisitionDistributor : public TypedDistributor<Core::Acquisition>  {
 
     public:
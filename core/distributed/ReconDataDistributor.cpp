@@ -0,0 +1,31 @@
+#include <map>
+
+#include "ReconDataDistributor.h"
+#include "AcquisitionDistributor.h"
+
+namespace Gadgetron::Core::Distributed {
+
+    uint16_t ReconDataDistributor::index_of(const IsmrmrdReconData &reconData) const {
+        if (reconData.rbit_.empty() || reconData.rbit_.front().data_.headers_.empty()) return 0;
+        return selector(reconData.rbit_.front().data_.headers_[0]);
+    }
+
+    void ReconDataDistributor::process(InputChannel<IsmrmrdReconData> &input, ChannelCreator &creator) {
+        std::map<uint16_t, OutputChannel> channels{};
+
+        for (IsmrmrdReconData reconData : input) {
+            auto index = index_of(reconData);
+
+            if (!channels.count(index)) channels.emplace(index, creator.create());
+
+            channels.at(index).push(std::move(reconData));
+        }
+    }
+
+    ReconDataDistributor::ReconDataDistributor(
+            const Gadgetron::Core::Context &context,
+            const Gadgetron::Core::GadgetProperties &props
+    ) : TypedDistributor(props), selector(index_selector(parallel_dimension)) {}
+
+    GADGETRON_DISTRIBUTOR_EXPORT(ReconDataDistributor);
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "Context.h"
+#include "Distributor.h"
+
+#include "mri_core_data.h"
+
+namespace Gadgetron::Core::Distributed {
+
+    /**
+     * Distributes buffered data by an encoding index of its first acquisition, so that e.g. every buffer of a slice
+     * reaches the same reconstruction chain, and finds the calibration computed there.
+     */
+    class ReconDataDistributor : public TypedDistributor<IsmrmrdReconData> {
+
+    public:
+        ReconDataDistributor(const Context &context, const GadgetProperties &props);
+
+        void process(InputChannel<IsmrmrdReconData> &input, ChannelCreator &creator) override;
+
+        NODE_PROPERTY(parallel_dimension, std::string, "Dimension that data will be parallelized over", "slice");
+
+    private:
+        uint16_t index_of(const IsmrmrdReconData &reconData) const;
+
+        const std::function<uint16_t(const ISMRMRD::AcquisitionHeader&)> &selector;
+    };
+}
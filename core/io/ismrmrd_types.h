@@ -38,6 +38,10 @@ namespace Gadgetron::Core::IO {
     template<class T>
     inline void write(std::ostream& stream, const Image<T>& img);
 
+    /// The header written ahead of an image; data type, meta size and (if they do not match the data) dimensions corrected.
+    template<class T>
+    inline ISMRMRD::ImageHeader image_header(const ISMRMRD::ImageHeader& header, const hoNDArray<T>& data, uint64_t meta_size);
+
 }
 
 #include "primitives.h"
@@ -55,6 +59,23 @@ void Gadgetron::Core::IO::read(std::istream &stream, Image <T> &img) {
     Gadgetron::Core::IO::read(stream,data.data(),data.size());
 }
 
+template<class T>
+ISMRMRD::ImageHeader Gadgetron::Core::IO::image_header(
+    const ISMRMRD::ImageHeader& header, const hoNDArray<T>& data, uint64_t meta_size) {
+
+    ISMRMRD::ImageHeader corrected_header = header;
+    corrected_header.data_type = ismrmrd_data_type<T>();
+    corrected_header.attribute_string_len = meta_size;
+    auto header_dims = vector_td<uint64_t,3>(corrected_header.matrix_size);
+
+    if ((prod(header_dims)*corrected_header.channels) != data.size()){
+        if (data.dimensions().size() != 4) throw std::runtime_error("Trying to write ISMRMRD Image, but data and header do not match");
+        for (int i =0; i < 3; i++) corrected_header.matrix_size[i] = data.get_size(i);
+        corrected_header.channels = data.get_size(3);
+    }
+    return corrected_header;
+}
+
 template<class T>
 void Gadgetron::Core::IO::write(std::ostream& stream, const Image<T>& img) {
 
@@ -69,22 +90,14 @@ void Gadgetron::Core::IO::write(std::ostream& stream, const Image<T>& img) {
         meta_size = serialized_meta.size() + 1;
     }
 
-    ISMRMRD::ImageHeader corrected_header = header;
-    corrected_header.data_type = ismrmrd_data_type<T>();
-    corrected_header.attribute_string_len = meta_size;
-    auto header_dims = vector_td<uint64_t,3>(corrected_header.matrix_size);
-
-    if ((prod(header_dims)*corrected_header.channels) != data.size()){
-        if (data.dimensions().size() != 4) throw std::runtime_error("Trying to write ISMRMRD Image, but data and header do not match");
-        for (int i =0; i < 3; i++) corrected_header.matrix_size[i] = data.get_size(i);
-        corrected_header.channels = data.get_size(3);
-    }
-
-    IO::write(stream, corrected_header);
-    IO::write(stream, meta_size);
-    stream.write(serialized_meta.c_str(), meta_size);
-    IO::write(stream, data.get_data_ptr(), data.get_number_of_elements());
+    auto corrected_header = image_header(header, data, meta_size);
 
+    IO::write_gather(stream, {
+        { reinterpret_cast<const char*>(&corrected_header), sizeof(corrected_header) },
+        { reinterpret_cast<const char*>(&meta_size), sizeof(meta_size) },
+        { serialized_meta.c_str(), meta_size },
+        { reinterpret_cast<const char*>(data.get_data_ptr()), data.get_number_of_elements() * sizeof(T) }
+    });
 }
 void Gadgetron::Core::IO::write(std::ostream& stream, const ISMRMRD::MetaContainer& meta) {
     std::stringstream meta_stream;
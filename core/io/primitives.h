@@ -12,6 +12,43 @@
 
 namespace Gadgetron::Core::IO {
 
+    /**
+     * Streams able to move large payloads out of band (e.g. through shared memory) derive from this as well as from
+     * std::iostream. Contiguous payloads of at least threshold() bytes read or written through IO are handed to it;
+     * everything else goes through the stream as usual.
+     */
+    class BulkTransport {
+    public:
+        /// Payloads smaller than this are never considered, so ordinary streams pay nothing for small writes.
+        static constexpr size_t minimum_threshold = 4096;
+
+        virtual ~BulkTransport() = default;
+        virtual size_t threshold() const = 0;
+        virtual void write_bulk(const char *data, size_t bytes) = 0;
+        virtual void read_bulk(char *data, size_t bytes) = 0;
+    };
+
+    /// The bulk transport of a stream, or nullptr. Resolved once per stream and thread, rather than per payload.
+    BulkTransport *bulk_transport(std::ios_base &stream);
+
+    /**
+     * Streams able to write several separate buffers with one call (e.g. sockets, with writev) derive from this as well
+     * as from std::ostream. Anything already written to the stream goes out ahead of the buffers.
+     */
+    class GatherTransport {
+    public:
+        struct Buffer {
+            const char *data;
+            size_t bytes;
+        };
+
+        virtual ~GatherTransport() = default;
+        virtual void write_gather(const std::vector<Buffer> &buffers) = 0;
+    };
+
+    /// Writes the buffers in order; as a single gathered write, if the stream supports it.
+    void write_gather(std::ostream &stream, const std::vector<GatherTransport::Buffer> &buffers);
+
     template<class T>
     std::enable_if_t<Gadgetron::Core::is_trivially_copyable_v<T>> read(std::istream &stream, T &t);
 
@@ -4,6 +4,22 @@
 #include <boost/hana/keys.hpp>
 #include <boost/hana/at_key.hpp>
 
+#include <typeinfo>
+
+inline Gadgetron::Core::IO::BulkTransport *Gadgetron::Core::IO::bulk_transport(std::ios_base &stream) {
+    // Keyed by address and dynamic type, so that a stream created where another was destroyed is resolved anew.
+    thread_local const std::ios_base *resolved = nullptr;
+    thread_local const std::type_info *resolved_type = nullptr;
+    thread_local BulkTransport *transport = nullptr;
+
+    if (&stream != resolved || typeid(stream) != *resolved_type) {
+        transport = dynamic_cast<BulkTransport *>(&stream);
+        resolved = &stream;
+        resolved_type = &typeid(stream);
+    }
+    return transport;
+}
+
 template<class T>
 void Gadgetron::Core::IO::write(std::ostream &ostream, const Core::optional<T> &val) {
     IO::write(ostream, bool(val));
@@ -38,7 +54,17 @@ void Gadgetron::Core::IO::write(std::ostream &stream, const T &value) {
 template<class T>
 std::enable_if_t<Gadgetron::Core::is_trivially_copyable_v<T>>
 Gadgetron::Core::IO::write(std::ostream &stream, const T *data, size_t number_of_elements) {
-    stream.write(reinterpret_cast<const char *>(data), number_of_elements * sizeof(T));
+    auto bytes = number_of_elements * sizeof(T);
+    if (bytes >= BulkTransport::minimum_threshold) {
+        auto bulk = bulk_transport(stream);
+        if (bulk && bytes >= bulk->threshold()) return bulk->write_bulk(reinterpret_cast<const char *>(data), bytes);
+    }
+    stream.write(reinterpret_cast<const char *>(data), bytes);
+}
+
+inline void Gadgetron::Core::IO::write_gather(std::ostream &stream, const std::vector<GatherTransport::Buffer> &buffers) {
+    if (auto gather = dynamic_cast<GatherTransport *>(&stream)) return gather->write_gather(buffers);
+    for (auto &buffer : buffers) IO::write(stream, buffer.data, buffer.bytes);
 }
 
 template<class T>
@@ -119,7 +145,12 @@ void Gadgetron::Core::IO::write(std::ostream &stream, const Gadgetron::hoNDArray
 
 template<class T>
 std::enable_if_t<Gadgetron::Core::is_trivially_copyable_v<T>> Gadgetron::Core::IO::read(std::istream &stream, T *data, size_t elements) {
-    stream.read(reinterpret_cast<char *>(data), elements*sizeof(T));
+    auto bytes = elements * sizeof(T);
+    if (bytes >= BulkTransport::minimum_threshold) {
+        auto bulk = bulk_transport(stream);
+        if (bulk && bytes >= bulk->threshold()) return bulk->read_bulk(reinterpret_cast<char *>(data), bytes);
+    }
+    stream.read(reinterpret_cast<char *>(data), bytes);
 }
 
 template<class T>
@@ -0,0 +1,27 @@
+#include "spill.h"
+
+#include <boost/filesystem.hpp>
+
+namespace Gadgetron::Core::IO {
+
+    SpillFile::SpillFile(const std::string &directory) {
+        auto folder = directory.empty() ? boost::filesystem::temp_directory_path() : boost::filesystem::path(directory);
+        path = (folder / boost::filesystem::unique_path("gadgetron_spill_%%%%-%%%%-%%%%-%%%%")).string();
+
+        stream.open(path, std::ios::in | std::ios::out | std::ios::trunc | std::ios::binary);
+        if (!stream) throw std::runtime_error("Could not create spill file " + path);
+
+#ifndef _WIN32
+        boost::system::error_code ignored;
+        boost::filesystem::remove(path, ignored);
+#endif
+    }
+
+    SpillFile::~SpillFile() {
+        stream.close();
+#ifdef _WIN32
+        boost::system::error_code ignored;
+        boost::filesystem::remove(path, ignored);
+#endif
+    }
+}
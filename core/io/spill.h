@@ -0,0 +1,56 @@
+#pragma once
+
+#include "primitives.h"
+
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+namespace Gadgetron::Core::IO {
+
+    /**
+     * Temporary file buffering gadgets spill values to while they are over their memory budget (see
+     * MappedMemory::over_budget). Values are written with IO::write, in the same compact binary format used on the
+     * wire, and are read back by the offset they were written at. The file is removed as soon as it is created (on
+     * Windows, once the SpillFile is destroyed), so nothing is left behind if the process dies.
+     */
+    class SpillFile {
+    public:
+        /// Creates the file in directory; in the system temporary directory if directory is empty
+        explicit SpillFile(const std::string &directory = {});
+        ~SpillFile();
+
+        SpillFile(const SpillFile &) = delete;
+        SpillFile &operator=(const SpillFile &) = delete;
+
+        /// Appends the value, and returns the offset it was written at
+        template<class T>
+        size_t write(const T &value) {
+            auto offset = bytes;
+            stream.seekp(std::streamoff(offset));
+            IO::write(stream, value);
+            stream.flush();
+            if (!stream) throw std::runtime_error("Failed writing to spill file " + path);
+
+            bytes = size_t(stream.tellp());
+            return offset;
+        }
+
+        /// Reads back a value written at offset
+        template<class T>
+        T read(size_t offset) {
+            stream.seekg(std::streamoff(offset));
+            auto value = IO::read<T>(stream);
+            if (!stream) throw std::runtime_error("Failed reading from spill file " + path);
+            return value;
+        }
+
+        /// Bytes written to the file
+        size_t size() const { return bytes; }
+
+    private:
+        std::fstream stream;
+        std::string path;
+        size_t bytes = 0;
+    };
+}
@@ -0,0 +1,87 @@
+#include "ImageArraySplitWriter.h"
+#include "io/ismrmrd_types.h"
+#include "MessageID.h"
+
+#include <cstring>
+#include <deque>
+#include <sstream>
+
+namespace {
+    using namespace Gadgetron;
+    using namespace Gadgetron::Core;
+
+    bool same_meta(const ISMRMRD::MetaContainer& a, const ISMRMRD::MetaContainer& b) {
+        auto it_a = a.begin();
+        auto it_b = b.begin();
+        for (; it_a != a.end() && it_b != b.end(); ++it_a, ++it_b) {
+            if (it_a->first != it_b->first || it_a->second.size() != it_b->second.size()) return false;
+            for (size_t i = 0; i < it_a->second.size(); i++) {
+                if (std::strcmp(it_a->second[i].as_str(), it_b->second[i].as_str()) != 0) return false;
+            }
+        }
+        return it_a == a.end() && it_b == b.end();
+    }
+
+    std::string serialize_meta(const ISMRMRD::MetaContainer& meta) {
+        std::stringstream meta_stream;
+        ISMRMRD::serialize(meta, meta_stream);
+        return meta_stream.str();
+    }
+
+    template<class T>
+    const char* bytes(const T* value) {
+        return reinterpret_cast<const char*>(value);
+    }
+}
+
+void Gadgetron::Core::Writers::ImageArraySplitWriter::serialize(
+    std::ostream& stream, const Gadgetron::IsmrmrdImageArray& image_array) {
+
+    static const uint16_t message_id = GADGET_MESSAGE_ISMRMRD_IMAGE;
+
+    const auto& data = image_array.data_;
+    if (data.get_number_of_elements() == 0) return;
+
+    // 7D, fixed order [X, Y, Z, CHA, N, S, LOC]; frames are contiguous [X, Y, Z, CHA] blocks, in (n, s, loc) order.
+    std::vector<size_t> frame_dims{ data.get_size(0), data.get_size(1), data.get_size(2), data.get_size(3) };
+    size_t frames = data.get_size(4) * data.get_size(5) * data.get_size(6);
+    size_t frame_elements = data.get_number_of_elements() / frames;
+
+    auto frame_shape = hoNDArray<std::complex<float>>(
+        frame_dims, const_cast<std::complex<float>*>(data.get_data_ptr()), false);
+
+    std::vector<ISMRMRD::ImageHeader> headers(frames);
+    std::vector<uint64_t> meta_sizes(frames, 0);
+    std::vector<const std::string*> metas(frames, nullptr);
+    std::deque<std::string> serialized_metas;
+
+    for (size_t frame = 0; frame < frames; frame++) {
+        if (!image_array.meta_.empty()) {
+            const auto& meta = image_array.meta_[frame];
+            if (frame == 0 || !same_meta(image_array.meta_[frame - 1], meta)) {
+                serialized_metas.push_back(serialize_meta(meta));
+            }
+            metas[frame] = &serialized_metas.back();
+            meta_sizes[frame] = metas[frame]->size() + 1;
+        }
+        headers[frame] = IO::image_header(image_array.headers_[frame], frame_shape, meta_sizes[frame]);
+    }
+
+    std::vector<IO::GatherTransport::Buffer> buffers;
+    buffers.reserve(5 * frames);
+
+    for (size_t frame = 0; frame < frames; frame++) {
+        buffers.push_back({ bytes(&message_id), sizeof(message_id) });
+        buffers.push_back({ bytes(&headers[frame]), sizeof(ISMRMRD::ImageHeader) });
+        buffers.push_back({ bytes(&meta_sizes[frame]), sizeof(uint64_t) });
+        if (metas[frame]) buffers.push_back({ metas[frame]->c_str(), meta_sizes[frame] });
+        buffers.push_back({ bytes(data.get_data_ptr() + frame * frame_elements),
+                            frame_elements * sizeof(std::complex<float>) });
+    }
+
+    IO::write_gather(stream, buffers);
+}
+
+namespace Gadgetron::Core::Writers {
+    GADGETRON_WRITER_EXPORT(ImageArraySplitWriter)
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include "Writer.h"
+#include "mri_core_data.h"
+
+
+namespace Gadgetron::Core::Writers {
+
+    /**
+     * Writes an image array as the images ImageArraySplitGadget would split it into, without making them: the headers,
+     * meta and pixel data of every frame are written with a single gathered write, straight from the array.
+     * Consecutive frames with the same meta share its serialization.
+     */
+    class ImageArraySplitWriter : public TypedWriter<IsmrmrdImageArray> {
+    protected:
+        void serialize(std::ostream& stream, const IsmrmrdImageArray& image_array) override;
+    };
+}
@@ -6,6 +6,7 @@
 
 #include "MessageID.h"
 #include "ImageWriter.h"
+#include "WriterDispatch.h"
 
 namespace {
 
@@ -39,24 +40,20 @@ namespace {
         std::make_shared<TypedImageWriter<unsigned int>>(),
         std::make_shared<TypedImageWriter<int>>()
     };
+
+    const WriterDispatch dispatch{writers};
 }
 
 
 namespace Gadgetron::Core::Writers {
 
     bool ImageWriter::accepts(const Message &message) {
-        return std::any_of(writers.begin(), writers.end(),
-                [&](auto &writer) { return writer->accepts(message); }
-        );
+        return dispatch.accepts(message);
     }
 
     void ImageWriter::write(std::ostream &stream, Message message) {
-        for (auto &writer : writers){
-            if (writer->accepts(message)) {
-                writer->write(stream, std::move(message));
-                return;
-            }
-        }
+        auto index = dispatch.find(message);
+        if (index != WriterDispatch::none) dispatch[index].write(stream, std::move(message));
     }
 
     GADGETRON_WRITER_EXPORT(ImageWriter)
@@ -9,6 +9,7 @@ namespace Gadgetron::Core::Writers {
     class ImageWriter : public Writer {
     public:
         bool accepts(const Message &) override;
+        bool accepts_by_type() const override { return true; }
         void write(std::ostream &stream, Message message) override;
     };
 }
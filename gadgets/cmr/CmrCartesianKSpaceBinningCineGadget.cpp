@@ -6,6 +6,9 @@ namespace Gadgetron {
     CmrCartesianKSpaceBinningCineGadget::CmrCartesianKSpaceBinningCineGadget() : BaseClass()
     {
         send_out_multiple_series_by_slice_ = false;
+        incremental_protocol_N_ = 0;
+        incremental_N_ = 0;
+        incremental_slice_ = 0;
     }
 
     CmrCartesianKSpaceBinningCineGadget::~CmrCartesianKSpaceBinningCineGadget()
@@ -43,6 +46,11 @@ namespace Gadgetron {
             }
         }
 
+        if (!h.encoding.empty() && h.encoding[0].encodingLimits.phase)
+        {
+            incremental_protocol_N_ = h.encoding[0].encodingLimits.phase->maximum - h.encoding[0].encodingLimits.phase->minimum + 1;
+        }
+
         // -------------------------------------------------
 
         binning_reconer_.debug_folder_                                   = this->debug_folder_full_path_;
@@ -66,6 +74,8 @@ namespace Gadgetron {
         binning_reconer_.grappa_reg_lamda_                               = this->grappa_reg_lamda.value();
         binning_reconer_.downstream_coil_compression_num_modesKept_      = this->downstream_coil_compression_num_modesKept.value();
         binning_reconer_.downstream_coil_compression_thres_              = this->downstream_coil_compression_thres.value();
+        binning_reconer_.incremental_calibration_frames_                 = this->incremental_calibration_frames.value();
+        binning_reconer_.incremental_provisional_binning_                = this->incremental_provisional_binning.value();
 
         binning_reconer_.kspace_binning_interpolate_heart_beat_images_   = this->kspace_binning_interpolate_heart_beat_images.value();
         binning_reconer_.kspace_binning_navigator_acceptance_window_     = this->kspace_binning_navigator_acceptance_window.value();
@@ -135,94 +145,258 @@ namespace Gadgetron {
             }
         }
 
+        if (incremental_raw_recon.value())
+        {
+            if (recon_bit_->rbit_.size() > 1)
+            {
+                GWARN_STREAM("Incremental raw recon only processes the first encoding space, incoming : " << recon_bit_->rbit_.size());
+            }
+
+            if (recon_bit_->rbit_[0].data_.data_.get_number_of_elements() > 0)
+            {
+                this->add_incremental_frame(recon_bit_->rbit_[0]);
+            }
+
+            m1->release();
+
+            if (perform_timing.value()) { gt_timer_local_.stop(); }
+
+            return GADGET_OK;
+        }
+
         // for every encoding space
         for (size_t e = 0; e < recon_bit_->rbit_.size(); e++)
         {
-            std::stringstream os;
-            os << "_encoding_" << e;
+            this->process_recon_bit(recon_bit_->rbit_[e], e);
+        }
 
-            GDEBUG_CONDITION_STREAM(verbose.value(), "Calling " << process_called_times_ << " , encoding space : " << e);
-            GDEBUG_CONDITION_STREAM(verbose.value(), "======================================================================");
+        m1->release();
 
-            // ---------------------------------------------------------------
-            // export incoming data
+        if (perform_timing.value()) { gt_timer_local_.stop(); }
+
+        return GADGET_OK;
+    }
+
+    void CmrCartesianKSpaceBinningCineGadget::process_recon_bit(IsmrmrdReconBit& recon_bit, size_t e)
+    {
+        std::stringstream os;
+        os << "_encoding_" << e;
 
+        GDEBUG_CONDITION_STREAM(verbose.value(), "Calling " << process_called_times_ << " , encoding space : " << e);
+        GDEBUG_CONDITION_STREAM(verbose.value(), "======================================================================");
+
+        // ---------------------------------------------------------------
+        // export incoming data
+
+        /*if (!debug_folder_full_path_.empty())
+        {
+            gt_exporter_.export_array_complex(recon_bit.data_.data_, debug_folder_full_path_ + "data" + os.str());
+        }
+
+        if (!debug_folder_full_path_.empty() && recon_bit.data_.trajectory_)
+        {
+            if (recon_bit.ref_->trajectory_->get_number_of_elements() > 0)
+            {
+                gt_exporter_.export_array(*(recon_bit.data_.trajectory_), debug_folder_full_path_ + "data_traj" + os.str());
+            }
+        }*/
+
+        // ---------------------------------------------------------------
+
+        if (recon_bit.data_.data_.get_number_of_elements() > 0)
+        {
             /*if (!debug_folder_full_path_.empty())
             {
-                gt_exporter_.export_array_complex(recon_bit_->rbit_[e].data_.data_, debug_folder_full_path_ + "data" + os.str());
+                gt_exporter_.export_array_complex(recon_bit.data_.data_, debug_folder_full_path_ + "data_before_unwrapping" + os.str());
             }
 
-            if (!debug_folder_full_path_.empty() && recon_bit_->rbit_[e].data_.trajectory_)
+            if (!debug_folder_full_path_.empty() && recon_bit.data_.trajectory_)
             {
-                if (recon_bit_->rbit_[e].ref_->trajectory_->get_number_of_elements() > 0)
+                if (recon_bit.data_.trajectory_->get_number_of_elements() > 0)
                 {
-                    gt_exporter_.export_array(*(recon_bit_->rbit_[e].data_.trajectory_), debug_folder_full_path_ + "data_traj" + os.str());
+                    gt_exporter_.export_array(*(recon_bit.data_.trajectory_), debug_folder_full_path_ + "data_before_unwrapping_traj" + os.str());
                 }
             }*/
 
             // ---------------------------------------------------------------
 
-            if (recon_bit_->rbit_[e].data_.data_.get_number_of_elements() > 0)
-            {
-                /*if (!debug_folder_full_path_.empty())
-                {
-                    gt_exporter_.export_array_complex(recon_bit_->rbit_[e].data_.data_, debug_folder_full_path_ + "data_before_unwrapping" + os.str());
-                }
+            if (perform_timing.value()) { gt_timer_.start("CmrCartesianKSpaceBinningCineGadget::perform_binning"); }
+            this->perform_binning(recon_bit, e);
+            if (perform_timing.value()) { gt_timer_.stop(); }
 
-                if (!debug_folder_full_path_.empty() && recon_bit_->rbit_[e].data_.trajectory_)
-                {
-                    if (recon_bit_->rbit_[e].data_.trajectory_->get_number_of_elements() > 0)
-                    {
-                        gt_exporter_.export_array(*(recon_bit_->rbit_[e].data_.trajectory_), debug_folder_full_path_ + "data_before_unwrapping_traj" + os.str());
-                    }
-                }*/
+            // ---------------------------------------------------------------
 
-                // ---------------------------------------------------------------
+            if (perform_timing.value()) { gt_timer_.start("CmrCartesianKSpaceBinningCineGadget::compute_image_header, raw images"); }
+            this->compute_image_header(recon_bit, res_raw_, e);
+            if (perform_timing.value()) { gt_timer_.stop(); }
 
-                if (perform_timing.value()) { gt_timer_.start("CmrCartesianKSpaceBinningCineGadget::perform_binning"); }
-                this->perform_binning(recon_bit_->rbit_[e], e);
-                if (perform_timing.value()) { gt_timer_.stop(); }
+            this->set_time_stamps(res_raw_, acq_time_raw_, cpt_time_raw_);
 
-                // ---------------------------------------------------------------
+            // ---------------------------------------------------------------
+
+            if (!debug_folder_full_path_.empty())
+            {
+                this->gt_exporter_.export_array_complex(res_raw_.data_, debug_folder_full_path_ + "recon_res_raw" + os.str());
+            }
 
-                if (perform_timing.value()) { gt_timer_.start("CmrCartesianKSpaceBinningCineGadget::compute_image_header, raw images"); }
-                this->compute_image_header(recon_bit_->rbit_[e], res_raw_, e);
+            if(this->send_out_raw.value())
+            {
+                if (perform_timing.value()) { gt_timer_.start("CmrCartesianKSpaceBinningCineGadget::send_out_image_array, raw"); }
+                this->send_out_image_array(res_raw_, e, image_series.value() + ((int)e + 1), GADGETRON_IMAGE_REGULAR);
                 if (perform_timing.value()) { gt_timer_.stop(); }
+            }
 
-                this->set_time_stamps(res_raw_, acq_time_raw_, cpt_time_raw_);
+            // ---------------------------------------------------------------
+            this->create_binning_image_headers_from_raw();
+            this->set_time_stamps(res_binning_, acq_time_binning_, cpt_time_binning_);
 
-                // ---------------------------------------------------------------
+            if (!debug_folder_full_path_.empty())
+            {
+                this->gt_exporter_.export_array_complex(res_binning_.data_, debug_folder_full_path_ + "recon_res_binning" + os.str());
+            }
 
-                if (!debug_folder_full_path_.empty())
-                {
-                    this->gt_exporter_.export_array_complex(res_raw_.data_, debug_folder_full_path_ + "recon_res_raw" + os.str());
-                }
+            if (perform_timing.value()) { gt_timer_.start("CmrCartesianKSpaceBinningCineGadget::send_out_image_array, binning"); }
+            this->send_out_image_array(res_binning_, e, image_series.value() + (int)e + 2, GADGETRON_IMAGE_RETRO);
+            if (perform_timing.value()) { gt_timer_.stop(); }
+        }
+    }
 
-                if(this->send_out_raw.value())
-                {
-                    if (perform_timing.value()) { gt_timer_.start("CmrCartesianKSpaceBinningCineGadget::send_out_image_array, raw"); }
-                    this->send_out_image_array(res_raw_, e, image_series.value() + ((int)e + 1), GADGETRON_IMAGE_REGULAR);
-                    if (perform_timing.value()) { gt_timer_.stop(); }
-                }
+    void CmrCartesianKSpaceBinningCineGadget::add_incremental_frame(IsmrmrdReconBit& recon_bit)
+    {
+        try
+        {
+            size_t RO  = recon_bit.data_.data_.get_size(0);
+            size_t E1  = recon_bit.data_.data_.get_size(1);
+            size_t E2  = recon_bit.data_.data_.get_size(2);
+            size_t CHA = recon_bit.data_.data_.get_size(3);
+            size_t N   = recon_bit.data_.data_.get_size(4);
+            size_t S   = recon_bit.data_.data_.get_size(5);
+            size_t SLC = recon_bit.data_.data_.get_size(6);
+
+            GADGET_CHECK_THROW(E2==1);
+            GADGET_CHECK_THROW(SLC==1);
 
-                // ---------------------------------------------------------------
-                this->create_binning_image_headers_from_raw();
-                this->set_time_stamps(res_binning_, acq_time_binning_, cpt_time_binning_);
+            size_t ind = 0;
+            while (ind+1 < recon_bit.data_.headers_.get_number_of_elements() && recon_bit.data_.headers_[ind].measurement_uid==0)
+            {
+                ind++;
+            }
 
-                if (!debug_folder_full_path_.empty())
-                {
-                    this->gt_exporter_.export_array_complex(res_binning_.data_, debug_folder_full_path_ + "recon_res_binning" + os.str());
-                }
+            size_t curr_slc = recon_bit.data_.headers_[ind].idx.slice;
 
-                if (perform_timing.value()) { gt_timer_.start("CmrCartesianKSpaceBinningCineGadget::send_out_image_array, binning"); }
-                this->send_out_image_array(res_binning_, e, image_series.value() + (int)e + 2, GADGETRON_IMAGE_RETRO);
-                if (perform_timing.value()) { gt_timer_.stop(); }
+            // a new slice ends the series of the previous one
+            if (incremental_N_>0 && curr_slc != incremental_slice_)
+            {
+                this->finish_incremental_slice();
             }
+
+            hoNDArray< std::complex<float> >& series = incremental_series_.data_.data_;
+            hoNDArray< ISMRMRD::AcquisitionHeader >& series_headers = incremental_series_.data_.headers_;
+
+            if (incremental_N_==0)
+            {
+                GDEBUG_STREAM("Incremental raw recon, start slice : " << curr_slc);
+
+                incremental_slice_ = curr_slc;
+
+                binning_reconer_.binning_obj_.sampling_ = recon_bit.data_.sampling_;
+                binning_reconer_.binning_obj_.accel_factor_E1_ = acceFactorE1_[0];
+                binning_reconer_.binning_obj_.random_sampling_ = (calib_mode_[0]!=ISMRMRD_embedded 
+                                                                && calib_mode_[0]!=ISMRMRD_interleaved 
+                                                                && calib_mode_[0]!=ISMRMRD_separate 
+                                                                && calib_mode_[0]!=ISMRMRD_noacceleration);
+
+                binning_reconer_.begin_incremental_recon();
+
+                // room for as many frames as the protocol has phases, [RO E1 1 CHA N S 1] and [E1 1 N S 1]
+                size_t room = std::max(incremental_protocol_N_, N);
+                incremental_series_.data_.sampling_ = recon_bit.data_.sampling_;
+                series.create(RO, E1, 1, CHA, room, S, 1);
+                series_headers.create(E1, 1, room, S, 1);
+            }
+
+            GADGET_CHECK_THROW(series.get_size(0)==RO);
+            GADGET_CHECK_THROW(series.get_size(1)==E1);
+            GADGET_CHECK_THROW(series.get_size(3)==CHA);
+            GADGET_CHECK_THROW(series.get_size(5)==S);
+
+            if (incremental_N_+N > series.get_size(4))
+            {
+                GWARN_STREAM("Incremental raw recon, more frames than the protocol has phases : " << incremental_N_+N);
+                resize_dimension(series, 4, 2*(incremental_N_+N));
+                resize_dimension(series_headers, 2, 2*(incremental_N_+N));
+            }
+
+            size_t room = series.get_size(4);
+
+            size_t s;
+            for (s=0; s<S; s++)
+            {
+                memcpy(&series(0, 0, 0, 0, incremental_N_, s, 0), &recon_bit.data_.data_(0, 0, 0, 0, 0, s, 0), sizeof(std::complex<float>)*RO*E1*CHA*N);
+                std::copy(&recon_bit.data_.headers_(0, 0, 0, s, 0), &recon_bit.data_.headers_(0, 0, 0, s, 0) + E1*N, &series_headers(0, 0, incremental_N_, s, 0));
+            }
+
+            // the recon works on the series in place
+            hoNDArray< std::complex<float> > frames(RO, E1, CHA, room, S, series.begin());
+            hoNDArray< ISMRMRD::AcquisitionHeader > headers(E1, room, S, series_headers.begin());
+
+            if (perform_timing.value()) { gt_timer_.start("CmrCartesianKSpaceBinningCineGadget::add_incremental_frame"); }
+            size_t n;
+            for (n=0; n<N; n++)
+            {
+                binning_reconer_.add_incremental_frame(frames, headers, incremental_N_++);
+            }
+            if (perform_timing.value()) { gt_timer_.stop(); }
+        }
+        catch (...)
+        {
+            GADGET_THROW("Errors happened in CmrCartesianKSpaceBinningCineGadget::add_incremental_frame(...) ... ");
         }
+    }
 
-        m1->release();
+    void CmrCartesianKSpaceBinningCineGadget::finish_incremental_slice()
+    {
+        try
+        {
+            if (incremental_N_==0) return;
 
-        if (perform_timing.value()) { gt_timer_local_.stop(); }
+            size_t N = incremental_N_;
+            GDEBUG_STREAM("Incremental raw recon, finish slice : " << incremental_slice_ << " , " << N << " frames");
+
+            IsmrmrdReconBit recon_bit = std::move(incremental_series_);
+            incremental_series_ = IsmrmrdReconBit();
+            incremental_N_ = 0;
+
+            // only if the protocol has more phases than were acquired
+            resize_dimension(recon_bit.data_.data_, 4, N);
+            resize_dimension(recon_bit.data_.headers_, 2, N);
+
+            this->process_recon_bit(recon_bit, 0);
+        }
+        catch (...)
+        {
+            GADGET_THROW("Errors happened in CmrCartesianKSpaceBinningCineGadget::finish_incremental_slice(...) ... ");
+        }
+    }
+
+    int CmrCartesianKSpaceBinningCineGadget::close(unsigned long flags)
+    {
+        GDEBUG_CONDITION_STREAM(true, "CmrCartesianKSpaceBinningCineGadget - close(flags) : " << flags);
+
+        if (BaseClass::close(flags) != GADGET_OK) return GADGET_FAIL;
+
+        if (flags != 0 && incremental_N_>0)
+        {
+            try
+            {
+                this->finish_incremental_slice();
+            }
+            catch (...)
+            {
+                GERROR_STREAM("Exceptions happened in CmrCartesianKSpaceBinningCineGadget::close(...) ... ");
+                return GADGET_FAIL;
+            }
+        }
 
         return GADGET_OK;
     }
@@ -41,6 +41,7 @@ namespace Gadgetron {
         GADGET_PROPERTY(use_nonlinear_binning_recon, bool, "Whether to non-linear recon in the binning step", true);
         GADGET_PROPERTY(number_of_output_phases, int, "Number of output phases after binning", 30);
 
+        GADGET_PROPERTY(incremental_raw_recon, bool, "Whether to reconstruct the raw images as frames arrive; needs the upstream buffer to trigger on the N dimension, and no upstream ref preparation or coil compression", false);
         GADGET_PROPERTY(send_out_raw, bool, "Whether to set out raw images", false);
         GADGET_PROPERTY(send_out_multiple_series_by_slice, bool, "Whether to set out binning images as multiple series", false);
 
@@ -54,6 +55,9 @@ namespace Gadgetron {
         GADGET_PROPERTY(downstream_coil_compression_num_modesKept, size_t, "Number of modes kept for down stream coil compression in raw recon step", 0);
         GADGET_PROPERTY(downstream_coil_compression_thres, double, "Threshold for determining number of kept modes in the down stream coil compression", 0.01);
 
+        GADGET_PROPERTY(incremental_calibration_frames, size_t, "Minimal number of frames averaged for the first raw recon calibration, if incremental_raw_recon is true; it is calibrated again whenever the frames doubled, until a quarter of the series is left", 16);
+        GADGET_PROPERTY(incremental_provisional_binning, bool, "Whether the binning of the frames so far runs in the background, as a start for the linear recon of the binned kspace, if incremental_raw_recon is true", true);
+
         /// parameters for kspace binning
         GADGET_PROPERTY(respiratory_navigator_moco_reg_strength, double, "Regularization strength of respiratory moco", 6.0);
         GadgetProperty<std::vector<unsigned int>, GadgetPropertyLimitsNoLimits<std::vector<unsigned int> > > respiratory_navigator_moco_iters{"respiratory_navigator_moco_iters", 
@@ -130,18 +134,35 @@ namespace Gadgetron {
         // if true, every slice will be sent out as separate series
         bool send_out_multiple_series_by_slice_;
 
+        // if incremental_raw_recon is true, the series of the current slice, with room for the phases of the protocol
+        // frames are stored in the order they arrived; the first incremental_N_ are filled
+        IsmrmrdReconBit incremental_series_;
+        size_t incremental_protocol_N_;
+        size_t incremental_N_;
+        size_t incremental_slice_;
+
         // --------------------------------------------------
         // gadget functions
         // --------------------------------------------------
         // default interface function
         virtual int process_config(ACE_Message_Block* mb);
         virtual int process(Gadgetron::GadgetContainerMessage< IsmrmrdReconData >* m1);
+        virtual int close(unsigned long flags);
 
         // --------------------------------------------------
         // recon step functions
         // --------------------------------------------------
+        // perform binning on a series and send out the images
+        virtual void process_recon_bit(IsmrmrdReconBit& recon_bit, size_t encoding);
+
         virtual void perform_binning(IsmrmrdReconBit& recon_bit, size_t encoding);
 
+        // pass a frame to the incremental raw recon; a frame of a new slice first finishes the previous slice
+        void add_incremental_frame(IsmrmrdReconBit& recon_bit);
+
+        // perform binning on the series of the current slice
+        void finish_incremental_slice();
+
         // create binning image header
         void create_binning_image_headers_from_raw();
 
@@ -53,6 +53,8 @@ namespace Gadgetron {
         GADGET_PROPERTY(perform_hole_filling, bool, "Whether to perform hole filling on map", true);
         GADGET_PROPERTY(max_size_hole, int, "Maximal size for hole", 20);
 
+        GADGET_PROPERTY(batched_solver, bool, "Whether to fit with the batched Levenberg-Marquardt solver instead of the simplex solver", false);
+
         GADGET_PROPERTY(std_thres_masking, double, "Number of noise std for masking", 3.0);
         GADGET_PROPERTY(mapping_with_masking, bool, "Whether to compute and apply a mask for mapping", true);
 
@@ -98,6 +98,7 @@ namespace Gadgetron {
 
             t1_sr.fill_holes_in_maps_ = perform_hole_filling.value();
             t1_sr.max_size_of_holes_ = max_size_hole.value();
+            t1_sr.use_batched_solver_ = batched_solver.value();
             t1_sr.compute_SD_maps_ = need_sd_map;
 
             t1_sr.ti_.resize(N, 0);
@@ -116,6 +116,7 @@ namespace Gadgetron {
 
             t2_mapper.fill_holes_in_maps_ = perform_hole_filling.value();
             t2_mapper.max_size_of_holes_ = max_size_hole.value();
+            t2_mapper.use_batched_solver_ = batched_solver.value();
             t2_mapper.compute_SD_maps_ = need_sd_map;
 
             t2_mapper.ti_.resize(N, 0);
@@ -1,6 +1,6 @@
 #include "CplxDumpGadget.h"
 #include "hoNDArray_fileio.h"
-#include "hoNDArray_utils.h"
+#include "hoNDArrayStridedView.h"
 
 namespace Gadgetron{
 
@@ -23,27 +23,18 @@ namespace Gadgetron{
     if (buffer.empty()) return;
 
     const auto& [header, data, traj] = buffer.back();
-    auto dims = data.dimensions();
-    auto dims_profile = data.dimensions();
-    dims.push_back(buffer.size());
 
-    // Allocate array for result
+    // Allocate array for result, with the coil dimension as the last
     //
 
+    std::vector<size_t> dims = { data.get_size(0), buffer.size(), data.get_size(1) };
     hoNDArray< std::complex<float> > result( dims );
 
 
     for (size_t i = 0; i < buffer.size(); i++){
-        using namespace Gadgetron::Indexing;
-        result(slice,slice, i) = std::get<1>(buffer[i]);
+        strided_view(result).slice(1, i) = std::get<1>(buffer[i]);
     }
 
-    // Reshape to get the coil dimension as the last
-    //
-  
-    std::vector<size_t> order= {0, 2, 1};
-    result = permute( result, order);
-
     // Write out the result
 
     write_nd_array< std::complex<float> >( &result, filename.c_str() );
@@ -152,19 +152,18 @@ namespace Gadgetron {
             }
 
         // Apply the correction
-// We use the armadillo notation that loops over all the columns
+        // The B0 and odd-even phases are combined once per readout, and applied to every channel in one pass
+        arma::cx_fvec corr = pow(corrB0_, epiEchoNumber_ + RefNav_to_Echo0_time_ES_);
         if (hdr.isFlagSet(ISMRMRD::ISMRMRD_ACQ_IS_REVERSE)) {
                 // Negative readout
-                for (int p = 0; p < adata.n_cols; p++) {
-                    adata.col(p) %= (pow(corrB0_, epiEchoNumber_ + RefNav_to_Echo0_time_ES_) % corrneg_);
-                }
+                corr %= corrneg_;
+                adata.each_col() %= corr;
                 // Now that we have corrected we set the readout direction to positive
                 hdr.clearFlag(ISMRMRD::ISMRMRD_ACQ_IS_REVERSE);
             } else {
                 // Positive readout
-                for (int p = 0; p < adata.n_cols; p++) {
-                    adata.col(p) %= (pow(corrB0_, epiEchoNumber_ + RefNav_to_Echo0_time_ES_) % corrpos_);
-                }
+                corr %= corrpos_;
+                adata.each_col() %= corr;
             }
     }
 
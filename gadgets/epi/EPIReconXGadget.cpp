@@ -1,10 +1,6 @@
 #include "EPIReconXGadget.h"
 #include "ismrmrd/xml.h"
 
-#ifdef USE_OMP
-#include "omp.h"
-#endif // USE_OMP
-
 namespace Gadgetron{
 
   EPIReconXGadget::EPIReconXGadget() {}
@@ -94,10 +90,6 @@ int EPIReconXGadget::process_config(ACE_Message_Block* mb)
     reconx_other.computeTrajectory();
   }
 
-#ifdef USE_OMP
-  omp_set_num_threads(1);
-#endif // USE_OMP
-
   return 0;
 }
 
@@ -107,37 +99,52 @@ int EPIReconXGadget::process(
 {
 
   ISMRMRD::AcquisitionHeader hdr_in = *(m1->getObjectPtr());
+
+  // Readouts of the primary encoding space are regridded in batches
+  if (hdr_in.encoding_space_ref == 0) {
+    batch_.push_back(m1);
+
+    bool end_of_slice = hdr_in.isFlagSet(ISMRMRD::ISMRMRD_ACQ_LAST_IN_SLICE)
+                     || hdr_in.isFlagSet(ISMRMRD::ISMRMRD_ACQ_LAST_IN_REPETITION)
+                     || hdr_in.isFlagSet(ISMRMRD::ISMRMRD_ACQ_LAST_IN_MEASUREMENT);
+
+    if (end_of_slice || batch_.size() >= batchSize.value()) {
+      return process_batch();
+    }
+    return 0;
+  }
+
+  // Readouts are passed on in order; send the batch ahead of this one
+  if (process_batch() != 0) {
+    m1->release();
+    return -1;
+  }
+
   ISMRMRD::AcquisitionHeader hdr_out;
   hoNDArray<std::complex<float> > data_out;
 
-  data_out.create(reconx.reconNx_, m2->getObjectPtr()->get_size(1));
+  data_out.create(reconx_other.reconNx_, m2->getObjectPtr()->get_size(1));
 
-  // Switch the reconstruction based on the encoding space (e.g. for FLASH Calibration)
-  if (hdr_in.encoding_space_ref == 0) {
-    reconx.apply(*m1->getObjectPtr(), *m2->getObjectPtr(), hdr_out, data_out);
-  }
-  else
+  // Other encoding spaces use the even readout operator (e.g. for FLASH Calibration)
+  if(reconx_other.encodeNx_>m2->getObjectPtr()->get_size(0)/ oversamplng_ratio2_)
   {
-    if(reconx_other.encodeNx_>m2->getObjectPtr()->get_size(0)/ oversamplng_ratio2_)
-    {
-        reconx_other.encodeNx_ = (int)(m2->getObjectPtr()->get_size(0) / oversamplng_ratio2_);
-        reconx_other.computeTrajectory();
-    }
-
-    if (reconx_other.reconNx_>m2->getObjectPtr()->get_size(0) / oversamplng_ratio2_)
-    {
-        reconx_other.reconNx_ = (int)(m2->getObjectPtr()->get_size(0) / oversamplng_ratio2_);
-    }
+      reconx_other.encodeNx_ = (int)(m2->getObjectPtr()->get_size(0) / oversamplng_ratio2_);
+      reconx_other.computeTrajectory();
+  }
 
-    if(reconx_other.numSamples_>m2->getObjectPtr()->get_size(0))
-    {
-        reconx_other.numSamples_ = m2->getObjectPtr()->get_size(0);
-        reconx_other.computeTrajectory();
-    }
+  if (reconx_other.reconNx_>m2->getObjectPtr()->get_size(0) / oversamplng_ratio2_)
+  {
+      reconx_other.reconNx_ = (int)(m2->getObjectPtr()->get_size(0) / oversamplng_ratio2_);
+  }
 
-    reconx_other.apply(*m1->getObjectPtr(), *m2->getObjectPtr(), hdr_out, data_out);
+  if(reconx_other.numSamples_>m2->getObjectPtr()->get_size(0))
+  {
+      reconx_other.numSamples_ = m2->getObjectPtr()->get_size(0);
+      reconx_other.computeTrajectory();
   }
 
+  reconx_other.apply(*m1->getObjectPtr(), *m2->getObjectPtr(), hdr_out, data_out);
+
   // Replace the contents of m1 with the new header and the contentes of m2 with the new data
   *m1->getObjectPtr() = hdr_out;
   *m2->getObjectPtr() = data_out;
@@ -152,6 +159,50 @@ int EPIReconXGadget::process(
   return 0;
 }
 
+int EPIReconXGadget::process_batch()
+{
+  if (batch_.empty()) return 0;
+
+  std::vector<ISMRMRD::AcquisitionHeader> hdr_in, hdr_out;
+  std::vector<hoNDArray<std::complex<float> >*> data_in;
+  std::vector<hoNDArray<std::complex<float> > > data_out;
+
+  for (auto m1 : batch_) {
+    auto m2 = AsContainerMessage<hoNDArray<std::complex<float> > >(m1->cont());
+    hdr_in.push_back(*m1->getObjectPtr());
+    data_in.push_back(m2->getObjectPtr());
+  }
+
+  // Readouts of the same polarity share an operator; every readout and channel of a polarity is one GEMM
+  reconx.applyBatch(hdr_in, data_in, hdr_out, data_out);
+
+  std::vector<GadgetContainerMessage<ISMRMRD::AcquisitionHeader>*> batch;
+  batch.swap(batch_);
+
+  for (size_t n=0; n<batch.size(); n++) {
+    // Replace the contents of m1 with the new header and the contentes of m2 with the new data
+    *batch[n]->getObjectPtr() = hdr_out[n];
+    *data_in[n] = std::move(data_out[n]);
+
+    // It is enough to put the first one, since they are linked
+    if (this->next()->putq(batch[n]) == -1) {
+      for (size_t m=n; m<batch.size(); m++) batch[m]->release();
+      GERROR("EPIReconXGadget::process_batch, passing data on to next gadget");
+      return -1;
+    }
+  }
+
+  return 0;
+}
+
+int EPIReconXGadget::close(unsigned long flags)
+{
+  if (flags != 0 && process_batch() != 0) {
+    GERROR("EPIReconXGadget::close, failed to send the last readouts on");
+  }
+  return Gadget::close(flags);
+}
+
 GADGET_FACTORY_DECLARE(EPIReconXGadget)
 }
 
@@ -8,6 +8,7 @@
 
 #include <ismrmrd/ismrmrd.h>
 #include <complex>
+#include <vector>
 
 #include "EPIReconXObjectFlat.h"
 #include "EPIReconXObjectTrapezoid.h"
@@ -23,10 +24,17 @@ namespace Gadgetron{
       
     protected:
       GADGET_PROPERTY(verboseMode, bool, "Verbose output", false);
+      GADGET_PROPERTY(batchSize, size_t,
+                      "Number of EPI readouts regridded together; readouts are also sent on at the end of every slice (1 sends each readout on as it arrives)",
+                      64);
 
       virtual int process_config(ACE_Message_Block* mb);
       virtual int process(GadgetContainerMessage<ISMRMRD::AcquisitionHeader>* m1,
 			  GadgetContainerMessage< hoNDArray< std::complex<float> > >* m2);
+      virtual int close(unsigned long flags);
+
+      // Regrids the buffered readouts of the primary encoding space, and passes them on in the order they arrived
+      int process_batch();
 
       // in verbose mode, more info is printed out
       bool verboseMode_;
@@ -38,6 +46,9 @@ namespace Gadgetron{
       // readout oversampling for reconx_other
       float oversamplng_ratio2_;
 
+      // EPI readouts waiting to be regridded
+      std::vector<GadgetContainerMessage<ISMRMRD::AcquisitionHeader>*> batch_;
+
     };
 }
 #endif //EPIRECONXGADGET_H
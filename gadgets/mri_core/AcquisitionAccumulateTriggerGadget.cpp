@@ -1,4 +1,6 @@
 #include "AcquisitionAccumulateTriggerGadget.h"
+#include "hoNDArray_memory.h"
+#include "io/spill.h"
 #include "log.h"
 #include "mri_core_data.h"
 #include <boost/algorithm/string.hpp>
@@ -120,19 +122,108 @@ namespace Gadgetron {
             return Core::visit([&](auto& var) { return var.trigger_after(acq); }, trigger);
         }
 
+        // Buckets are checked against the memory budget each time this much more data has been buffered.
+        constexpr size_t spill_check_bytes = size_t(16) << 20;
 
+        size_t bytes_of(const Core::Acquisition& acq) {
+            auto& trajectory = std::get<2>(acq);
+            return std::get<1>(acq).get_number_of_bytes() + (trajectory ? trajectory->get_number_of_bytes() : 0);
+        }
+
+        template<class T> void release(std::vector<T>& vector) {
+            std::vector<T>().swap(vector);
+        }
     }
 
+    /**
+     * Acquisitions spilled to disk while over the memory budget; those of cold buckets (every bucket but the one last
+     * added to) first. Buckets in memory hold what arrived since; spilled acquisitions are read back a bucket at a
+     * time, as the buckets are sent.
+     */
+    class AcquisitionAccumulateTriggerGadget::SpilledBuckets {
+    public:
+        explicit SpilledBuckets(std::string directory) : directory(std::move(directory)) {}
+
+        void added(std::map<unsigned short, AcquisitionBucket>& buckets, unsigned short hot, size_t bytes) {
+            buffered += bytes;
+            if (buffered < spill_check_bytes) return;
+            buffered = 0;
+
+            if (!MappedMemory::over_budget()) return;
+            for (auto& bucket : buckets) {
+                if (bucket.first != hot) spill(bucket.first, bucket.second);
+            }
+
+            // With a single bucket (or a single large one), there is nothing cold to spill.
+            if (MappedMemory::over_budget()) spill(hot, buckets[hot]);
+        }
+
+        void restore(unsigned short index, AcquisitionBucket& bucket) {
+            auto spilled = chunks.find(index);
+            if (spilled == chunks.end()) return;
+
+            std::vector<Core::Acquisition> data, ref;
+            for (auto& chunk : spilled->second) {
+                append(data, file->read<std::vector<Core::Acquisition>>(chunk.data));
+                append(ref, file->read<std::vector<Core::Acquisition>>(chunk.ref));
+            }
+            append(data, std::move(bucket.data_));
+            append(ref, std::move(bucket.ref_));
+
+            bucket.data_ = std::move(data);
+            bucket.ref_  = std::move(ref);
+            chunks.erase(spilled);
+        }
+
+        void clear() {
+            chunks.clear();
+            file.reset();
+        }
+
+    private:
+        struct Chunk {
+            size_t data, ref;
+        };
+
+        void spill(unsigned short index, AcquisitionBucket& bucket) {
+            if (bucket.data_.empty() && bucket.ref_.empty()) return;
+
+            if (!file) {
+                file = std::make_unique<Core::IO::SpillFile>(directory);
+                GINFO_STREAM("Memory budget exceeded; spilling buffered acquisitions to disk.");
+            }
+
+            auto data = file->write(bucket.data_);
+            auto ref  = file->write(bucket.ref_);
+            chunks[index].push_back(Chunk{ data, ref });
+
+            release(bucket.data_);
+            release(bucket.ref_);
+        }
+
+        static void append(std::vector<Core::Acquisition>& to, std::vector<Core::Acquisition> from) {
+            to.insert(to.end(), std::make_move_iterator(from.begin()), std::make_move_iterator(from.end()));
+        }
+
+        const std::string directory;
+        std::unique_ptr<Core::IO::SpillFile> file;
+        std::map<unsigned short, std::vector<Chunk>> chunks;
+        size_t buffered = 0;
+    };
+
     void AcquisitionAccumulateTriggerGadget::send_data(Core::OutputChannel& out, std::map<unsigned short, AcquisitionBucket>& buckets,
-                                                       std::vector<Core::Waveform>& waveforms) {
+                                                       std::vector<Core::Waveform>& waveforms, SpilledBuckets& spilled) {
         trigger_events++;
         GDEBUG("Trigger (%d) occurred, sending out %d buckets\n", trigger_events, buckets.size());
         buckets.begin()->second.waveform_ = std::move(waveforms);
         // Pass all buckets down the chain
-        for (auto& bucket : buckets)
+        for (auto& bucket : buckets) {
+            spilled.restore(bucket.first, bucket.second);
             out.push(std::move(bucket.second));
+        }
 
         buckets.clear();
+        spilled.clear();
     }
     void AcquisitionAccumulateTriggerGadget ::process(
         Core::InputChannel<Core::variant<Core::Acquisition, Core::Waveform>>& in, Core::OutputChannel& out) {
@@ -140,6 +231,7 @@ namespace Gadgetron {
         auto waveforms = std::vector<Core::Waveform>{};
         auto buckets   = std::map<unsigned short, AcquisitionBucket>{};
         auto trigger   = get_trigger(*this);
+        auto spilled   = SpilledBuckets(spill_directory.empty() ? MappedMemory::current_policy().directory : spill_directory);
 
         for (auto message : in) {
             if (Core::holds_alternative<Core::Waveform>(message)) {
@@ -153,17 +245,19 @@ namespace Gadgetron {
             auto head = std::get<ISMRMRD::AcquisitionHeader>(acq);
 
             if (trigger_before(trigger, head))
-                send_data(out, buckets, waveforms);
+                send_data(out, buckets, waveforms, spilled);
             // It is enough to put the first one, since they are linked
             unsigned short sorting_index = get_index(head, sorting_dimension);
 
+            auto bytes = bytes_of(acq);
             AcquisitionBucket& bucket = buckets[sorting_index];
             bucket.add_acquisition(std::move(acq));
+            spilled.added(buckets, sorting_index, bytes);
 
             if (trigger_after(trigger, head))
-                send_data(out, buckets, waveforms);
+                send_data(out, buckets, waveforms, spilled);
         }
-        send_data(out,buckets,waveforms);
+        send_data(out,buckets,waveforms,spilled);
     }
     GADGETRON_GADGET_EXPORT(AcquisitionAccumulateTriggerGadget);
 
@@ -44,11 +44,14 @@ namespace Gadgetron {
 
         NODE_PROPERTY(n_acquisitions_before_trigger, unsigned long, "Number of acquisition before first trigger", 40);
         NODE_PROPERTY(n_acquisitions_before_ongoing_trigger, unsigned long, "Number of acquisition before ongoing triggers", 40);
+        NODE_PROPERTY(spill_directory, std::string, "Directory buckets are spilled to while over the memory budget; empty uses the mapped memory directory, or the system temporary directory", "");
 
         size_t trigger_events = 0;
     private:
+        class SpilledBuckets;
+
         void send_data(Core::OutputChannel& out, std::map<unsigned short, AcquisitionBucket>& buckets,
-                       std::vector<Core::Waveform>& waveforms);
+                       std::vector<Core::Waveform>& waveforms, SpilledBuckets& spilled);
     };
 
     void from_string(const std::string& str, AcquisitionAccumulateTriggerGadget::TriggerDimension& val);
@@ -1,5 +1,6 @@
 #include "BucketToBufferGadget.h"
 #include "hoNDArray_elemwise.h"
+#include "hoNDArray_memory.h"
 #include "hoNDArray_reductions.h"
 #include "mri_core_data.h"
 #include <boost/algorithm/string.hpp>
@@ -45,6 +46,11 @@ namespace Gadgetron {
 
     void BucketToBufferGadget::process(Core::InputChannel<AcquisitionBucket>& input, Core::OutputChannel& out) {
 
+        auto memory_policy = MappedMemory::current_policy();
+        if (mapped_memory_threshold_MB >= 0)
+            memory_policy.threshold_bytes = size_t(mapped_memory_threshold_MB * 1024 * 1024);
+        MappedMemory::ScopedPolicy scoped_memory_policy(memory_policy);
+
         for (auto acq_bucket : input) {
             std::map<BufferKey, IsmrmrdReconData> recon_data_buffers;
             GDEBUG_STREAM("BUCKET_SIZE " << acq_bucket.data_.size() << " ESPACE " << acq_bucket.refstats_.size());
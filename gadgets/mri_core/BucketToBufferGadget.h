@@ -41,6 +41,7 @@ namespace Gadgetron {
         NODE_PROPERTY(split_slices, bool, "Split slices", false);
         NODE_PROPERTY(ignore_segment, bool, "Ignore segment", false);
         NODE_PROPERTY(verbose, bool, "Whether to print more information", false);
+        NODE_PROPERTY(mapped_memory_threshold_MB, double, "Buffers at least this large are memory-mapped; 0 disables, negative uses the server default", -1);
 
         ISMRMRD::IsmrmrdHeader header;
 
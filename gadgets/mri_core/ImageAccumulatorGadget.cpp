@@ -8,6 +8,9 @@
 #include <boost/range/iterator_range.hpp>
 #include <boost/iterator/transform_iterator.hpp>
 #include "ImageAccumulatorGadget.h"
+#include "hoNDArray_memory.h"
+#include "io/ismrmrd_types.h"
+#include "log.h"
 
 
 using namespace Gadgetron;
@@ -132,13 +135,14 @@ namespace {
         return strides;
     }
 
-    template<class RANGE, int DIMS> auto combine_arrays_along(RANGE &input_arrays,size_t combine_dim) {
+    // with_array(i, f) calls f with the i'th array; arrays are only needed one at a time, so they may be read back
+    // from disk as they are combined.
+    template<class T, int DIMS, class F> auto combine_arrays_along(const std::vector<std::vector<size_t>>& input_dims, F&& with_array, size_t combine_dim) {
 
-        using T = typename decltype(*input_arrays.begin())::value_type;
-        auto output_dims = *input_arrays.front().get_dimensions();
+        auto output_dims = input_dims.front();
         output_dims[combine_dim] = 0;
 
-        for (const auto & array : input_arrays) output_dims[combine_dim] += array.get_size(combine_dim);
+        for (const auto & dims : input_dims) output_dims[combine_dim] += dims[combine_dim];
 
         hoNDArray<T> out(output_dims);
 
@@ -146,11 +150,13 @@ namespace {
 
         T* output_data = out.get_data_ptr();
 
-        for (const auto & array : input_arrays) {
-            auto dims = *array.get_dimensions();
-            auto in_strides = calculate_strides(array);
-            combiner<T,DIMS-1>::combine_along(output_data,array.get_data_ptr(),dims,out_strides,in_strides,combine_dim);
-            output_data += out_strides[combine_dim-1]*dims[combine_dim];
+        for (size_t i = 0; i < input_dims.size(); i++) {
+            with_array(i, [&](const hoNDArray<T>& array) {
+                auto dims = *array.get_dimensions();
+                auto in_strides = calculate_strides(array);
+                combiner<T,DIMS-1>::combine_along(output_data,array.get_data_ptr(),dims,out_strides,in_strides,combine_dim);
+                output_data += out_strides[combine_dim-1]*dims[combine_dim];
+            });
         }
 
         return out;
@@ -172,21 +178,23 @@ Gadgetron::ImageAccumulatorGadget::combine_images(std::vector<Gadgetron::Ismrmrd
     size_t combine_dimension_image = image_dimension_from_string(combine_along.value());
     size_t combine_dimension_header = header_dimension_from_string(combine_along.value());
 
-    auto image_lambda = [](auto m) { return m.data_;};
-    auto header_lambda = [](auto m) { return m.headers_;};
-
-    //Using boost range and transform iterators to avoid copying from the vector
-
-    auto image_range = boost::make_iterator_range(boost::make_transform_iterator(images.begin(),image_lambda),
-            boost::make_transform_iterator(images.end(),image_lambda));
+    // Spilled data is read back one image at a time, and released as soon as it has been combined.
+    auto with_image = [&](size_t i, auto&& f) {
+        auto spilled = spilled_data.find(i);
+        if (spilled == spilled_data.end()) {
+            f(images[i].data_);
+            return;
+        }
+        f(spill_file->read<hoNDArray<std::complex<float>>>(spilled->second));
+    };
+    auto with_header = [&](size_t i, auto&& f) { f(images[i].headers_); };
 
-    auto header_range = boost::make_iterator_range(boost::make_transform_iterator(images.begin(),header_lambda),
-                                             boost::make_transform_iterator(images.end(),header_lambda));
+    std::vector<std::vector<size_t>> header_dimensions;
+    for (auto& image : images) header_dimensions.push_back(image.headers_.dimensions());
 
-    auto ninjas = images[0].data_.get_number_of_dimensions();
     Gadgetron::IsmrmrdImageArray result =
-            { combine_arrays_along<decltype(image_range), 7>(image_range,combine_dimension_image),
-              combine_arrays_along<decltype(header_range),3>(header_range,combine_dimension_header),
+            { combine_arrays_along<std::complex<float>, 7>(image_dimensions,with_image,combine_dimension_image),
+              combine_arrays_along<ISMRMRD::ImageHeader,3>(header_dimensions,with_header,combine_dimension_header),
                std::vector< ISMRMRD::MetaContainer>()};
     for (auto& im : images){
         result.meta_.insert(result.meta_.end(),im.meta_.begin(),im.meta_.end());
@@ -201,6 +209,8 @@ int Gadgetron::ImageAccumulatorGadget::process(Gadgetron::GadgetContainerMessage
     auto& image_array = *m1->getObjectPtr();
 
     images.push_back(image_array);
+    image_dimensions.push_back(image_array.data_.dimensions());
+    if (MappedMemory::over_budget()) spill_images();
 
     for (auto h : image_array.headers_)
         seen_values.emplace(extract_value(h));
@@ -211,6 +221,9 @@ int Gadgetron::ImageAccumulatorGadget::process(Gadgetron::GadgetContainerMessage
     if (done){
         auto result_array = combine_images(images);
         images.clear();
+        image_dimensions.clear();
+        spilled_data.clear();
+        spill_file.reset();
         seen_values.clear();
         auto msg = new GadgetContainerMessage<IsmrmrdImageArray>(std::move(result_array));
         this->next()->putq(msg);
@@ -219,6 +232,21 @@ int Gadgetron::ImageAccumulatorGadget::process(Gadgetron::GadgetContainerMessage
     return GADGET_OK;
 }
 
+void Gadgetron::ImageAccumulatorGadget::spill_images() {
+
+    if (!spill_file) {
+        auto directory = spill_directory.value().empty() ? MappedMemory::current_policy().directory : spill_directory.value();
+        spill_file = std::make_unique<Core::IO::SpillFile>(directory);
+        GINFO_STREAM("Memory budget exceeded; spilling accumulated images to disk.");
+    }
+
+    // Headers and meta data stay in memory; they are small, and needed to tell when the images are complete.
+    for (size_t i = 0; i < images.size(); i++) {
+        if (spilled_data.count(i)) continue;
+        spilled_data[i] = spill_file->write(images[i].data_);
+        images[i].data_.clear();
+    }
+}
 
 GADGET_FACTORY_DECLARE(ImageAccumulatorGadget)
 
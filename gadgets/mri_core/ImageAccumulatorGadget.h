@@ -10,6 +10,10 @@
 #include "Gadget.h"
 #include "hoNDArray.h"
 #include "gadgetron_mricore_export.h"
+#include "io/spill.h"
+
+#include <map>
+#include <memory>
 
 namespace Gadgetron {
 EXPORTGADGETSMRICORE class ImageAccumulatorGadget :  public Gadget1<IsmrmrdImageArray> {
@@ -26,6 +30,7 @@ EXPORTGADGETSMRICORE class ImageAccumulatorGadget :  public Gadget1<IsmrmrdImage
 
     GADGET_PROPERTY(accumulate_dimension,std::string,"Dimension over which the images will be collected","contrast");
     GADGET_PROPERTY(combine_along,std::string,"Dimension used for stacking the images","N");
+    GADGET_PROPERTY(spill_directory,std::string,"Directory images are spilled to while over the memory budget; empty uses the mapped memory directory, or the system temporary directory","");
       virtual int process(GadgetContainerMessage<IsmrmrdImageArray>* m1);
       virtual int process_config(ACE_Message_Block* mb);
 
@@ -36,9 +41,15 @@ EXPORTGADGETSMRICORE class ImageAccumulatorGadget :  public Gadget1<IsmrmrdImage
 
     IsmrmrdImageArray combine_images(std::vector<IsmrmrdImageArray>&);
 
+    void spill_images();
+
 
         size_t encoding_spaces;
         std::vector<IsmrmrdImageArray> images;
+        std::vector<std::vector<size_t>> image_dimensions;
+        // Offsets of the data of images spilled to disk while over the memory budget; read back as images are combined
+        std::map<size_t, size_t> spilled_data;
+        std::unique_ptr<Core::IO::SpillFile> spill_file;
         std::vector<uint16_t> required_values;
         std::set<uint16_t> seen_values;
 
@@ -26,9 +26,18 @@ namespace Gadgetron
         std::vector<size_t> dims;
         input_array->get_dimensions(dims);
 
-        size_t RO = dims[0];
-        size_t E1 = dims[1];
-        size_t E2 = 1;
+        if (input_array->get_number_of_dimensions() < 2)
+        {
+            GERROR_STREAM("ImageResizingGadget, only support 2D or higher input images ... ");
+
+            if (this->next()->putq(m1) < 0)
+            {
+                GERROR_STREAM("ImageResizingGadget, failed to pass images to next gadget ... ");
+                return GADGET_FAIL;
+            }
+
+            return GADGET_OK;
+        }
 
         if (this->new_RO.value() > 0)
         {
@@ -50,7 +59,6 @@ namespace Gadgetron
 
         if (input_array->get_number_of_dimensions() > 2)
         {
-            E2 = dims[2];
             if (this->new_E2.value() > 0)
             {
                 dims[2] = this->new_E2.value();
@@ -61,41 +69,13 @@ namespace Gadgetron
             }
         }
 
-        if (input_array->get_number_of_dimensions() == 2)
-        {
-            typedef hoNDImage<ValueType, 2> ImageType;
-            ImageType input_image(RO, E1, input_array->begin()), output_image;
-
-            hoNDBoundaryHandlerBorderValue<ImageType> bhBorderValue(input_image);
-            hoNDInterpolatorBSpline<ImageType, 2> interp(input_image, bhBorderValue, this->order_interpolator.value());
-
-            Gadgetron::resampleImage(input_image, interp, dims, output_image);
-
-            output_array = output_image;
-        }
-        else if (input_array->get_number_of_dimensions() == 3)
+        // resample RO, E1 and E2 separably; images stacked along further dimensions are resampled together
+        hoNDBSpline<ValueType, 3> bspline;
+        if (!bspline.resampleBSpline(*input_array, this->order_interpolator.value(), dims, output_array))
         {
-            typedef hoNDImage<ValueType, 3> ImageType;
-            ImageType input_image(RO, E1, E2, input_array->begin()), output_image;
-
-            hoNDBoundaryHandlerBorderValue<ImageType> bhBorderValue(input_image);
-            hoNDInterpolatorBSpline<ImageType, 3> interp(input_image, bhBorderValue, this->order_interpolator.value());
-
-            Gadgetron::resampleImage(input_image, interp, dims, output_image);
-
-            output_array = output_image;
-        }
-        else 
-        {
-            GERROR_STREAM("ImageResizingGadget, only support 2D or 3D input images ... ");
-
-            if (this->next()->putq(m1) < 0)
-            {
-                GERROR_STREAM("ImageResizingGadget, failed to pass images to next gadget ... ");
-                return GADGET_FAIL;
-            }
-
-            return GADGET_OK;
+            GERROR_STREAM("ImageResizingGadget, failed to resample images ... ");
+            m1->release();
+            return GADGET_FAIL;
         }
 
         *m2->getObjectPtr() = output_array;
@@ -1,5 +1,7 @@
 
 #include "GenericReconAccumulateImageTriggerGadget.h"
+#include "hoNDArray_memory.h"
+#include <boost/filesystem.hpp>
 
 namespace Gadgetron { 
 
@@ -321,6 +323,22 @@ namespace Gadgetron {
 
         process_called_times_++;
 
+        MappedMemory::Policy memory_policy = MappedMemory::current_policy();
+        if (mapped_memory_threshold_MB.value() >= 0)
+            memory_policy.threshold_bytes = (size_t)(mapped_memory_threshold_MB.value() * 1024 * 1024);
+
+        // over the memory budget, images are buffered in (unlinked) files, and paged out as they are stored; they are
+        // paged back in as they are sent on trigger
+        spilling_ = MappedMemory::over_budget();
+        if (spilling_)
+        {
+            GDEBUG_CONDITION_STREAM(verbose.value(), "Memory budget exceeded; spilling buffered images to disk");
+            memory_policy.threshold_bytes = MappedMemory::accounting_granularity;
+            if (!spill_directory.value().empty()) memory_policy.directory = spill_directory.value();
+            if (memory_policy.directory.empty()) memory_policy.directory = boost::filesystem::temp_directory_path().string();
+        }
+        MappedMemory::ScopedPolicy scoped_memory_policy(memory_policy);
+
         IsmrmrdImageArray* recon_res_ = m1->getObjectPtr();
 
         // find the data role
@@ -796,6 +814,7 @@ namespace Gadgetron {
                             storedImage.attrib_.set(GADGETRON_PASS_IMMEDIATE, (long)0);
 
                             buf(cha, slice, con, phs, rep, set, ave) = storedImage;
+                            if (spilling_) MappedMemory::advise(buf(cha, slice, con, phs, rep, set, ave).begin(), MappedMemory::Advice::page_out);
                         }
                     }
                 }
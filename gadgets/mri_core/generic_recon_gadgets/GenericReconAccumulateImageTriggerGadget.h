@@ -86,6 +86,12 @@ public:
     // whether to consider concatenation on repetition
     GADGET_PROPERTY(concatenation_on_repetition, bool, "If multiple concatenation is used, whether to enlarge the repetition limit", false);
 
+    // buffered images at least this large are memory-mapped instead of heap allocated
+    GADGET_PROPERTY(mapped_memory_threshold_MB, double, "Buffers at least this large are memory-mapped; 0 disables, negative uses the server default", -1);
+
+    // while over the memory budget, buffered images are stored in files here, and paged out to disk
+    GADGET_PROPERTY(spill_directory, std::string, "Directory images are spilled to while over the memory budget; empty uses the mapped memory directory, or the system temporary directory", "");
+
 protected:
 
     virtual int process_config(ACE_Message_Block* mb);
@@ -117,6 +123,9 @@ protected:
     /// whether to immediately pass the image to the next gadget
     bool pass_image_immediate_;
 
+    /// whether images are currently spilled to disk, as the memory budget is exceeded
+    bool spilling_ = false;
+
     // buffer for regular images whose data role is GADGETRON_IMAGE_REGULAR
     ImageBufferType imageBuffer_;
     ImageSentFlagBufferType imageSent_;
@@ -1,6 +1,7 @@
 
 #include "GenericReconBase.h"
 #include <boost/filesystem.hpp>
+#include <functional>
 
 namespace Gadgetron {
 
@@ -35,6 +36,32 @@ namespace Gadgetron {
                 GERROR("Error creating the debug folder.\n");
                 return false;
             }
+
+            std::string case_name;
+            try
+            {
+                ISMRMRD::IsmrmrdHeader h;
+                deserialize(mb->rd_ptr(), h);
+                if (h.measurementInformation && h.measurementInformation->measurementID) case_name = *h.measurementInformation->measurementID;
+            }
+            catch (...)
+            {
+                GDEBUG("Error parsing ISMRMRD Header");
+            }
+
+            // without a measurement id, name the case after its header, so that reruns of the same data reuse the name
+            if (case_name.empty()) case_name = "case_" + std::to_string(std::hash<std::string>()(std::string(mb->rd_ptr(), mb->length())));
+
+            auto to_bytes = [](double MB) { return (size_t)(MB * 1024 * 1024); };
+
+            GenericReconDebugExporter::Settings settings;
+            settings.asynchronous = debug_export_async.value();
+            settings.sampling_interval = debug_export_sampling_interval.value();
+            settings.max_array_bytes = to_bytes(debug_export_max_array_MB.value());
+            settings.max_total_bytes = to_bytes(debug_export_max_total_MB.value());
+            settings.max_queued_bytes = to_bytes(debug_export_max_queued_MB.value());
+
+            gt_exporter_.configure(debug_folder_full_path_, case_name, settings);
         }
         else
         {
@@ -50,6 +77,16 @@ namespace Gadgetron {
         return GADGET_OK;
     }
 
+    template <typename T>
+    int GenericReconBase<T>::close(unsigned long flags)
+    {
+        if (BaseClass::close(flags) != GADGET_OK) return GADGET_FAIL;
+
+        gt_exporter_.flush();
+
+        return GADGET_OK;
+    }
+
     template class EXPORTGADGETSMRICORE GenericReconBase<IsmrmrdReconData>;
     template class EXPORTGADGETSMRICORE GenericReconBase<IsmrmrdImageArray>;
     template class EXPORTGADGETSMRICORE GenericReconBase<ISMRMRD::ImageHeader>;
@@ -20,7 +20,7 @@
 #include "mri_core_data.h"
 #include "mri_core_utility.h"
 
-#include "ImageIOAnalyze.h"
+#include "GenericReconDebugExporter.h"
 
 #include "gadgetron_sha1.h"
 
@@ -43,6 +43,13 @@ namespace Gadgetron {
         GADGET_PROPERTY(debug_folder, std::string, "If set, the debug output will be written out", "");
         GADGET_PROPERTY(perform_timing, bool, "Whether to perform timing on some computational steps", false);
 
+        /// debug export
+        GADGET_PROPERTY(debug_export_async, bool, "If true, debug arrays are written by a background thread into one HDF5 file per case; otherwise as Analyze files", true);
+        GADGET_PROPERTY(debug_export_sampling_interval, size_t, "Only every Nth debug array of each kind is exported", 1);
+        GADGET_PROPERTY(debug_export_max_array_MB, double, "Debug arrays larger than this are not exported; 0 means no limit", 0);
+        GADGET_PROPERTY(debug_export_max_total_MB, double, "Maximal amount of debug data exported by this gadget; 0 means no limit", 0);
+        GADGET_PROPERTY(debug_export_max_queued_MB, double, "Maximal amount of debug data waiting to be written; further arrays are dropped", 1024);
+
         /// ms for every time tick
         GADGET_PROPERTY(time_tick, float, "Time tick in ms", 2.5);
 
@@ -66,13 +73,16 @@ namespace Gadgetron {
         std::string debug_folder_full_path_;
 
         // exporter
-        Gadgetron::ImageIOAnalyze gt_exporter_;
+        Gadgetron::GenericReconDebugExporter gt_exporter_;
 
         // --------------------------------------------------
         // gadget functions
         // --------------------------------------------------
         virtual int process_config(ACE_Message_Block* mb);
         virtual int process(GadgetContainerMessage<T>* m1);
+
+        // wait for the debug arrays still queued for export
+        virtual int close(unsigned long flags);
     };
 
     class EXPORTGADGETSMRICORE GenericReconKSpaceReadoutBase :public GenericReconBase < ISMRMRD::AcquisitionHeader >
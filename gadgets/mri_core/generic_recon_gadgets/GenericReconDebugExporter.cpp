@@ -0,0 +1,209 @@
+
+#include "GenericReconDebugExporter.h"
+
+#include <algorithm>
+#include <cctype>
+#include <condition_variable>
+#include <thread>
+
+#include "MPMCChannel.h"
+#include "log.h"
+
+namespace Gadgetron {
+
+    /// One background writer per container file. Exporters of different gadgets writing into the same debug folder
+    /// for the same case share the writer, so that the HDF5 file is only ever touched by a single thread.
+    class GenericReconDebugExporter::Writer
+    {
+    public:
+
+        explicit Writer(std::string container) : container_(std::move(container)), queued_bytes_(0), pending_(0)
+        {
+            thread_ = std::thread([this]() { this->run(); });
+        }
+
+        ~Writer()
+        {
+            jobs_.close();
+            thread_.join();
+        }
+
+        static std::shared_ptr<Writer> instance(const std::string& container)
+        {
+            static std::mutex registry_mutex;
+            static std::map<std::string, std::weak_ptr<Writer> > registry;
+
+            std::lock_guard<std::mutex> guard(registry_mutex);
+
+            auto writer = registry[container].lock();
+            if (!writer)
+            {
+                writer = std::make_shared<Writer>(container);
+                registry[container] = writer;
+            }
+
+            return writer;
+        }
+
+        bool reserve(size_t bytes, size_t max_queued_bytes)
+        {
+            std::lock_guard<std::mutex> guard(pending_mutex_);
+            if (max_queued_bytes > 0 && queued_bytes_ > 0 && queued_bytes_ + bytes > max_queued_bytes) return false;
+            queued_bytes_ += bytes;
+            pending_++;
+            return true;
+        }
+
+        /// name of the next occurrence of an array in the container; every exporter sharing the writer counts together
+        std::string variable_name(const std::string& name)
+        {
+            std::lock_guard<std::mutex> guard(pending_mutex_);
+            size_t occurrence = occurrences_[name]++;
+            return occurrence > 0 ? name + "_" + std::to_string(occurrence) : name;
+        }
+
+        void push(std::unique_ptr<Job> job)
+        {
+            jobs_.push(std::move(job));
+        }
+
+        void flush()
+        {
+            std::unique_lock<std::mutex> lock(pending_mutex_);
+            done_.wait(lock, [this]() { return pending_ == 0; });
+        }
+
+    private:
+
+        void run()
+        {
+            std::unique_ptr<ISMRMRD::Dataset> dataset;
+
+            try
+            {
+                while (true)
+                {
+                    auto job = jobs_.pop();
+
+                    try
+                    {
+                        if (!dataset) dataset = std::make_unique<ISMRMRD::Dataset>(container_.c_str(), "debug", true);
+                        job->write(*dataset);
+                    }
+                    catch (const std::exception& e)
+                    {
+                        GERROR_STREAM("Failed to write debug array to " << container_ << " : " << e.what());
+                    }
+                    catch (...)
+                    {
+                        GERROR_STREAM("Failed to write debug array to " << container_);
+                    }
+
+                    {
+                        std::lock_guard<std::mutex> guard(pending_mutex_);
+                        queued_bytes_ -= job->bytes();
+                        pending_--;
+                    }
+                    done_.notify_all();
+                }
+            }
+            catch (const Core::ChannelClosed&)
+            {
+            }
+        }
+
+        std::string container_;
+
+        std::mutex pending_mutex_;
+        std::condition_variable done_;
+        size_t queued_bytes_;
+        size_t pending_;
+        std::map<std::string, size_t> occurrences_;
+
+        Core::MPMCChannel<std::unique_ptr<Job> > jobs_;
+        std::thread thread_;
+    };
+
+    GenericReconDebugExporter::GenericReconDebugExporter() : total_bytes_(0)
+    {
+    }
+
+    GenericReconDebugExporter::~GenericReconDebugExporter()
+    {
+    }
+
+    void GenericReconDebugExporter::configure(const std::string& debug_folder, const std::string& case_name, const Settings& settings)
+    {
+        settings_ = settings;
+        if (settings_.sampling_interval == 0) settings_.sampling_interval = 1;
+
+        debug_folder_ = debug_folder;
+        writer_.reset();
+
+        if (settings_.asynchronous && !debug_folder_.empty())
+        {
+            std::string container = case_name;
+            std::replace_if(container.begin(), container.end(), [](char c) { return !std::isalnum(static_cast<unsigned char>(c)) && c != '-' && c != '_'; }, '_');
+
+            writer_ = Writer::instance(debug_folder_ + "debug_" + container + ".h5");
+        }
+    }
+
+    void GenericReconDebugExporter::flush()
+    {
+        if (writer_) writer_->flush();
+    }
+
+    bool GenericReconDebugExporter::accept(const std::string& filename, size_t bytes, std::string& name)
+    {
+        if (settings_.max_array_bytes > 0 && bytes > settings_.max_array_bytes)
+        {
+            GDEBUG_STREAM("Debug export of " << filename << " skipped; " << bytes << " bytes exceeds the array limit");
+            return false;
+        }
+
+        name = filename;
+        if (!debug_folder_.empty() && name.compare(0, debug_folder_.size(), debug_folder_) == 0) name.erase(0, debug_folder_.size());
+        std::replace(name.begin(), name.end(), '/', '_');
+        std::replace(name.begin(), name.end(), '\\', '_');
+
+        // arrays of the same kind only differ by their index suffixes, e.g. data_encoding_0_n1_s0
+        std::string kind = name;
+        kind.erase(std::remove_if(kind.begin(), kind.end(), [](char c) { return std::isdigit(static_cast<unsigned char>(c)); }), kind.end());
+
+        std::lock_guard<std::mutex> guard(counter_mutex_);
+
+        if (settings_.max_total_bytes > 0 && total_bytes_ + bytes > settings_.max_total_bytes) return false;
+
+        size_t calls = counters_[kind]++;
+        if (calls % settings_.sampling_interval != 0) return false;
+
+        // the same name may be exported repeatedly, e.g. once per repetition or by several gadgets; keep every occurrence
+        if (writer_) name = writer_->variable_name(name);
+
+        return true;
+    }
+
+    void GenericReconDebugExporter::charge(size_t bytes)
+    {
+        std::lock_guard<std::mutex> guard(counter_mutex_);
+        total_bytes_ += bytes;
+    }
+
+    bool GenericReconDebugExporter::reserve(size_t bytes)
+    {
+        if (writer_->reserve(bytes, settings_.max_queued_bytes))
+        {
+            this->charge(bytes);
+            return true;
+        }
+
+        GDEBUG_STREAM("Debug export queue is full; array of " << bytes << " bytes dropped");
+        return false;
+    }
+
+    void GenericReconDebugExporter::enqueue(std::unique_ptr<Job> job)
+    {
+        writer_->push(std::move(job));
+    }
+}
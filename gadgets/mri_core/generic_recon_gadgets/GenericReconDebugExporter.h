@@ -0,0 +1,163 @@
+/** \file   GenericReconDebugExporter.h
+    \brief  Debug array exporter for the generic recon chain.
+
+            In asynchronous mode, exported arrays are snapshotted on the calling thread and appended by a background
+            writer to one ISMRMRD HDF5 container per case (one variable per exported array).
+            In synchronous mode, arrays are written as Analyze files on the calling thread, as ImageIOAnalyze does.
+
+            Sampling and size limits allow the debug output to be left on for production cases: arrays which exceed
+            the limits, or arrays which would make the writer queue grow beyond its budget, are skipped rather than
+            stalling the reconstruction.
+*/
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+
+#include "gadgetron_mricore_export.h"
+#include "hoNDArray.h"
+#include "ImageIOAnalyze.h"
+
+#include "ismrmrd/dataset.h"
+
+namespace Gadgetron {
+
+    class EXPORTGADGETSMRICORE GenericReconDebugExporter
+    {
+    public:
+
+        struct Settings
+        {
+            /// write arrays into the per case container on a background thread
+            bool asynchronous = true;
+            /// only every Nth array of each kind is exported
+            size_t sampling_interval = 1;
+            /// arrays larger than this are skipped; 0 means no limit
+            size_t max_array_bytes = 0;
+            /// total number of bytes exported by this exporter; 0 means no limit
+            size_t max_total_bytes = 0;
+            /// maximal number of bytes waiting in the writer queue before new arrays are dropped
+            size_t max_queued_bytes = size_t(1024) * 1024 * 1024;
+        };
+
+        GenericReconDebugExporter();
+        ~GenericReconDebugExporter();
+
+        /// debug_folder: folder to write to, ending with a path separator
+        /// case_name: name of the container, typically the measurement id
+        void configure(const std::string& debug_folder, const std::string& case_name, const Settings& settings);
+
+        /// block until all queued arrays have been written; called by the generic recon gadgets on close
+        void flush();
+
+        template <typename T>
+        void export_array(const hoNDArray<T>& a, const std::string& filename)
+        {
+            std::string name;
+            if (!this->accept(filename, a.get_number_of_bytes(), name)) return;
+
+            if constexpr (is_container_type<T>::value)
+            {
+                if (writer_)
+                {
+                    if (this->reserve(a.get_number_of_bytes())) this->enqueue(make_job(a, name));
+                    return;
+                }
+            }
+
+            this->charge(a.get_number_of_bytes());
+            analyze_exporter_.export_array(a, filename);
+        }
+
+        template <typename T>
+        void export_array_complex(const hoNDArray<T>& a, const std::string& filename)
+        {
+            std::string name;
+            if (!this->accept(filename, a.get_number_of_bytes(), name)) return;
+
+            if constexpr (is_container_type<T>::value)
+            {
+                if (writer_)
+                {
+                    // complex arrays are stored as is; real/imag/mag/phase can be derived when reading the container
+                    if (this->reserve(a.get_number_of_bytes())) this->enqueue(make_job(a, name));
+                    return;
+                }
+            }
+
+            this->charge(a.get_number_of_bytes());
+            analyze_exporter_.export_array_complex(a, filename);
+        }
+
+    protected:
+
+        template <typename T>
+        struct is_container_type : std::integral_constant<bool,
+                std::is_same<T, uint16_t>::value || std::is_same<T, int16_t>::value
+                || std::is_same<T, uint32_t>::value || std::is_same<T, int32_t>::value
+                || std::is_same<T, float>::value || std::is_same<T, double>::value
+                || std::is_same<T, std::complex<float> >::value || std::is_same<T, std::complex<double> >::value> {};
+
+        class Job
+        {
+        public:
+            virtual ~Job() = default;
+            virtual void write(ISMRMRD::Dataset& dataset) = 0;
+            virtual size_t bytes() const = 0;
+        };
+
+        template <typename T>
+        class ArrayJob : public Job
+        {
+        public:
+            ArrayJob(const hoNDArray<T>& a, std::string name) : array_(a.dimensions()), name_(std::move(name))
+            {
+                std::copy(a.begin(), a.end(), array_.getDataPtr());
+            }
+
+            void write(ISMRMRD::Dataset& dataset) override
+            {
+                dataset.appendNDArray(name_, array_);
+            }
+
+            size_t bytes() const override
+            {
+                return array_.getDataSize();
+            }
+
+        private:
+            ISMRMRD::NDArray<T> array_;
+            std::string name_;
+        };
+
+        template <typename T>
+        static std::unique_ptr<Job> make_job(const hoNDArray<T>& a, const std::string& name)
+        {
+            return std::make_unique<ArrayJob<T> >(a, name);
+        }
+
+        class Writer;
+
+        /// decide whether an array is exported and compute its variable name in the container
+        bool accept(const std::string& filename, size_t bytes, std::string& name);
+        /// count an array that is written against max_total_bytes
+        void charge(size_t bytes);
+        /// reserve room in the writer queue before the array is snapshotted; charges the array if there is room
+        bool reserve(size_t bytes);
+        void enqueue(std::unique_ptr<Job> job);
+
+        Settings settings_;
+        std::string debug_folder_;
+
+        std::mutex counter_mutex_;
+        std::map<std::string, size_t> counters_;
+        size_t total_bytes_;
+
+        std::shared_ptr<Writer> writer_;
+        Gadgetron::ImageIOAnalyze analyze_exporter_;
+    };
+}
@@ -134,40 +134,13 @@ namespace Gadgetron {
         return GADGET_OK;
     }
 
-    void GenericReconFieldOfViewAdjustmentGadget::perform_fft(size_t E2, const hoNDArray< std::complex<float> >& input, hoNDArray< std::complex<float> >& output)
+    void GenericReconFieldOfViewAdjustmentGadget::crop_kspace(const hoNDArray< std::complex<float> >& input, size_t RO, size_t E1, size_t E2, hoNDArray< std::complex<float> >& output)
     {
-        if (E2>1)
-        {
-            if (&input == &output)
-                Gadgetron::hoNDFFT<float>::instance()->fft3c(output);
-            else
-                Gadgetron::hoNDFFT<float>::instance()->fft3c(input, output);
-        }
-        else
-        {
-            if (&input == &output)
-                Gadgetron::hoNDFFT<float>::instance()->fft2c(output);
-            else
-                Gadgetron::hoNDFFT<float>::instance()->fft2c(input, output);
-        }
-    }
+        // scaled as the unitary fft, crop and ifft this replaces
+        float scaling = (float)(std::sqrt((double)input.get_size(0)*input.get_size(1)*input.get_size(2) / ((double)RO*E1*E2)));
 
-    void GenericReconFieldOfViewAdjustmentGadget::perform_ifft(size_t E2, const hoNDArray< std::complex<float> >& input, hoNDArray< std::complex<float> >& output)
-    {
-        if (E2>1)
-        {
-            if (&input == &output)
-                Gadgetron::hoNDFFT<float>::instance()->ifft3c(output);
-            else
-                Gadgetron::hoNDFFT<float>::instance()->ifft3c(input, output);
-        }
-        else
-        {
-            if (&input == &output)
-                Gadgetron::hoNDFFT<float>::instance()->ifft2c(output);
-            else
-                Gadgetron::hoNDFFT<float>::instance()->ifft2c(input, output);
-        }
+        output = Gadgetron::FFT::resample(input, { RO, E1, E2 });
+        Gadgetron::scal(scaling, output);
     }
 
     int GenericReconFieldOfViewAdjustmentGadget::adjust_FOV(IsmrmrdImageArray& recon_res)
@@ -208,9 +181,7 @@ namespace Gadgetron {
                 }
                 else if (RO >= reconSizeRO && E1 >= reconSizeE1 && E2 >= reconSizeE2)
                 {
-                    this->perform_fft(E2, recon_res.data_, kspace_buf_);
-                    Gadgetron::crop(reconSizeRO, reconSizeE1, reconSizeE2, kspace_buf_, res_);
-                    this->perform_ifft(E2, res_, recon_res.data_);
+                    this->crop_kspace(recon_res.data_, reconSizeRO, reconSizeE1, reconSizeE2, recon_res.data_);
                 }
                 else
                 {
@@ -246,9 +217,7 @@ namespace Gadgetron {
                 }
                 else if (encodingE1 <= E1 - 1)
                 {
-                    this->perform_fft(E2, *pSrc, kspace_buf_);
-                    Gadgetron::crop(RO, encodingE1, E2, kspace_buf_, *pDst);
-                    this->perform_ifft(E2, *pDst, *pDst);
+                    this->crop_kspace(*pSrc, RO, encodingE1, E2, *pDst);
 
                     pTmp = pSrc; pSrc = pDst; pDst = pTmp;
                 }
@@ -261,9 +230,7 @@ namespace Gadgetron {
                 }
                 else if (encodingE2 <= E2 - 1)
                 {
-                    this->perform_fft(E2, *pSrc, kspace_buf_);
-                    Gadgetron::crop(RO, pSrc->get_size(1), encodingE2, kspace_buf_, *pDst);
-                    this->perform_ifft(E2, *pDst, *pDst);
+                    this->crop_kspace(*pSrc, RO, pSrc->get_size(1), encodingE2, *pDst);
 
                     pTmp = pSrc; pSrc = pDst; pDst = pTmp;
                 }
@@ -276,9 +243,7 @@ namespace Gadgetron {
                 }
                 else if (RO > reconSizeRO)
                 {
-                    this->perform_fft(E2, *pSrc, kspace_buf_);
-                    Gadgetron::crop(reconSizeRO, pSrc->get_size(1), pSrc->get_size(2), kspace_buf_, *pDst);
-                    this->perform_ifft(E2, *pDst, *pDst);
+                    this->crop_kspace(*pSrc, reconSizeRO, pSrc->get_size(1), pSrc->get_size(2), *pDst);
 
                     pTmp = pSrc; pSrc = pDst; pDst = pTmp;
                 }
@@ -44,9 +44,6 @@ namespace Gadgetron {
         hoNDArray< std::complex<float> > filter_E1_;
         hoNDArray< std::complex<float> > filter_E2_;
 
-        // kspace buffer
-        hoNDArray< std::complex<float> > kspace_buf_;
-
         // results of filtering
         hoNDArray< std::complex<float> > res_;
 
@@ -66,8 +63,7 @@ namespace Gadgetron {
         // adjust FOV
         int adjust_FOV(IsmrmrdImageArray& data);
 
-        // perform fft or ifft
-        void perform_fft(size_t E2, const hoNDArray< std::complex<float> >& input, hoNDArray< std::complex<float> >& output);
-        void perform_ifft(size_t E2, const hoNDArray< std::complex<float> >& input, hoNDArray< std::complex<float> >& output);
+        // crop the kspace of images to [RO E1 E2]; kspace cropped away is never computed
+        void crop_kspace(const hoNDArray< std::complex<float> >& input, size_t RO, size_t E1, size_t E2, hoNDArray< std::complex<float> >& output);
     };
 }
@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+
+#include "EPIReconXObjectTrapezoid.h"
+
+#include <complex>
+#include <random>
+
+using namespace Gadgetron;
+using namespace Gadgetron::EPI;
+
+namespace {
+    using T = std::complex<float>;
+
+    void configure(EPIReconXObjectTrapezoid<T> &reconx) {
+        reconx.encodeNx_ = 64;
+        reconx.encodeFOV_ = 220.0;
+        reconx.reconNx_ = 64;
+        reconx.reconFOV_ = 220.0;
+        reconx.rampUpTime_ = 100;
+        reconx.rampDownTime_ = 100;
+        reconx.flatTopTime_ = 220;
+        reconx.acqDelayTime_ = 0;
+        reconx.numSamples_ = 128;
+        reconx.dwellTime_ = 3.2;
+        reconx.computeTrajectory();
+    }
+
+    ISMRMRD::AcquisitionHeader readout(bool reverse, float offcenter) {
+        ISMRMRD::AcquisitionHeader hdr;
+        hdr.number_of_samples = 128;
+        hdr.read_dir[0] = 1.0;
+        hdr.position[0] = offcenter;
+        if (reverse) hdr.setFlag(ISMRMRD::ISMRMRD_ACQ_IS_REVERSE);
+        return hdr;
+    }
+
+    hoNDArray<T> random_readout(size_t samples, size_t channels, std::mt19937 &rng) {
+        std::normal_distribution<float> normal;
+        hoNDArray<T> data(samples, channels);
+        for (auto &x : data) x = T(normal(rng), normal(rng));
+        return data;
+    }
+}
+
+TEST(EPIReconXObject, batch_matches_single_readouts) {
+    EPIReconXObjectTrapezoid<T> batched, single;
+    configure(batched);
+    configure(single);
+
+    std::mt19937 rng(42);
+    std::vector<ISMRMRD::AcquisitionHeader> hdr_in, hdr_out;
+    std::vector<hoNDArray<T>> data;
+    std::vector<hoNDArray<T>*> data_in;
+    std::vector<hoNDArray<T>> data_out;
+
+    // Alternating polarities, and a second slice at a different off-center.
+    for (size_t n = 0; n < 24; n++) {
+        hdr_in.push_back(readout(n % 2, n < 16 ? 0.0f : 12.5f));
+        data.push_back(random_readout(128, 8, rng));
+    }
+    for (auto &d : data) data_in.push_back(&d);
+
+    batched.applyBatch(hdr_in, data_in, hdr_out, data_out);
+
+    ASSERT_EQ(data_out.size(), data.size());
+    for (size_t n = 0; n < data.size(); n++) {
+        ISMRMRD::AcquisitionHeader expected_hdr;
+        hoNDArray<T> expected(64, 8);
+        single.apply(hdr_in[n], data[n], expected_hdr, expected);
+
+        EXPECT_EQ(hdr_out[n].number_of_samples, expected_hdr.number_of_samples);
+        EXPECT_EQ(hdr_out[n].center_sample, expected_hdr.center_sample);
+        ASSERT_EQ(data_out[n].get_number_of_elements(), expected.get_number_of_elements());
+        for (size_t i = 0; i < expected.get_number_of_elements(); i++) {
+            EXPECT_NEAR(std::abs(data_out[n][i] - expected[i]), 0.0, 1e-4 * std::abs(expected[i]) + 1e-5);
+        }
+    }
+}
+
+TEST(EPIReconXObject, operators_are_shared) {
+    hoNDArray<float> pos(4), neg(4);
+    for (size_t i = 0; i < 4; i++) {
+        pos[i] = float(i) - 1.5f;
+        neg[i] = 1.5f - float(i);
+    }
+
+    auto first = regriddingOperator(trajectoryKey(pos, neg, 4, 4));
+    auto second = regriddingOperator(trajectoryKey(pos, neg, 4, 4));
+    EXPECT_EQ(first.get(), second.get());
+
+    auto other = regriddingOperator(trajectoryKey(pos, neg, 4, 8));
+    EXPECT_NE(first.get(), other.get());
+    EXPECT_EQ(other->Mp.n_rows, 8u);
+}
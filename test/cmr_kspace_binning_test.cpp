@@ -0,0 +1,302 @@
+#include "gtest/gtest.h"
+#include "hoNDArray_reductions.h"
+#include "hoNDArray_elemwise.h"
+#include "hoNDFFT.h"
+#include "cmr_kspace_binning.h"
+
+#include <chrono>
+#include <thread>
+
+using namespace Gadgetron;
+using testing::Types;
+
+namespace {
+
+    /// exposes the incremental recon, and calibrates the raw data recon of process_binning_recon() on its leading frames only
+    template <typename T>
+    class CmrKSpaceBinningUnderTest : public CmrKSpaceBinning<T>
+    {
+    public:
+        typedef CmrKSpaceBinning<T> BaseClass;
+        typedef typename BaseClass::ArrayType ArrayType;
+
+        CmrKSpaceBinningUnderTest() : BaseClass(), calibration_frames_(0), initial_kspace_used_(false) {}
+
+        /// batch recon, with the eigen channels calibrated on the first eigen_channel_frames and the raw data recon on the first calibration_frames
+        void process_batch(size_t eigen_channel_frames, size_t calibration_frames)
+        {
+            ArrayType& data = this->binning_obj_.data_;
+
+            ArrayType leading;
+            this->leading_frames(data, eigen_channel_frames, leading);
+            this->calibrate_eigen_channels(leading);
+            this->apply_eigen_channels(data, 0, data.get_size(3));
+
+            calibration_frames_ = calibration_frames;
+            this->process_binning_recon();
+        }
+
+        /// add the frames one by one, waiting for every binning of the frames so far to complete
+        void add_frames(ArrayType& frames, const ArrayType& data, const hoNDArray< ISMRMRD::AcquisitionHeader >& headers, bool wait_for_binning)
+        {
+            size_t N = data.get_size(3);
+            size_t S = data.get_size(4);
+            size_t frame_size = data.get_size(0)*data.get_size(1)*data.get_size(2);
+
+            for (size_t n=0; n<N; n++)
+            {
+                for (size_t s=0; s<S; s++)
+                {
+                    std::copy(&data(0, 0, 0, n, s), &data(0, 0, 0, n, s) + frame_size, &frames(0, 0, 0, n, s));
+                }
+
+                this->add_incremental_frame(frames, headers, n);
+
+                while (wait_for_binning && this->provisional_binning_running())
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                }
+            }
+        }
+
+        size_t calibrated_frames() const { return this->incremental_calibrated_frames_; }
+
+        bool initial_kspace_used() const { return initial_kspace_used_; }
+
+    protected:
+
+        void calibrate_raw_data_recon(const ArrayType& data) override
+        {
+            if(calibration_frames_==0 || calibration_frames_>=data.get_size(3))
+            {
+                BaseClass::calibrate_raw_data_recon(data);
+                return;
+            }
+
+            ArrayType leading;
+            this->leading_frames(data, calibration_frames_, leading);
+            BaseClass::calibrate_raw_data_recon(leading);
+        }
+
+        void perform_recon_binned_kspace(const std::vector<size_t>& slices_not_processing) override
+        {
+            initial_kspace_used_ = (this->binning_obj_.kspace_binning_initial_.dimensions()==this->binning_obj_.kspace_binning_.dimensions());
+            BaseClass::perform_recon_binned_kspace(slices_not_processing);
+        }
+
+        size_t calibration_frames_;
+        bool initial_kspace_used_;
+    };
+}
+
+template<typename Real>
+class cmr_kspace_binning_test : public ::testing::Test
+{
+protected:
+    typedef hoNDArray< std::complex<Real> > ArrayType;
+
+    virtual void SetUp()
+    {
+        // a real-time cine, 4 times undersampled with interleaved lines, of a disk beating over a static background
+        // a heart beat is 20 frames, so every frame of a cardiac phase has the same lines
+        RO_ = 48;
+        E1_ = 48;
+        CHA_ = 6;
+        N_ = 200;
+        accel_factor_ = 4;
+        output_N_ = 20;
+
+        Real TR = 3;
+        Real RR = 720;
+        Real time_tick = 2.5;
+
+        data_.create(RO_, E1_, CHA_, N_, 1);
+        Gadgetron::clear(data_);
+
+        headers_.create(E1_, N_, 1);
+
+        ArrayType coil_map(RO_, E1_, CHA_);
+        size_t ro, e1, cha, n;
+        for (cha=0; cha<CHA_; cha++)
+        {
+            Real angle = (Real)(2*M_PI*cha/CHA_);
+            Real cx = RO_/2 + RO_/3*std::cos(angle);
+            Real cy = E1_/2 + E1_/3*std::sin(angle);
+
+            for (e1=0; e1<E1_; e1++)
+            {
+                for (ro=0; ro<RO_; ro++)
+                {
+                    Real d2 = (ro-cx)*(ro-cx) + (e1-cy)*(e1-cy);
+                    coil_map(ro, e1, cha) = std::polar( std::exp(-d2/(2*RO_*RO_/4)), angle + (Real)0.02*ro );
+                }
+            }
+        }
+
+        ArrayType image(RO_, E1_, CHA_), kspace(RO_, E1_, CHA_);
+
+        for (n=0; n<N_; n++)
+        {
+            Real t = n * (E1_/accel_factor_) * TR;
+            Real radius = RO_/6 + RO_/12 * std::cos( (Real)(2*M_PI*std::fmod(t, RR)/RR) );
+
+            for (cha=0; cha<CHA_; cha++)
+            {
+                for (e1=0; e1<E1_; e1++)
+                {
+                    for (ro=0; ro<RO_; ro++)
+                    {
+                        Real x = (Real)ro - RO_/2;
+                        Real y = (Real)e1 - E1_/2;
+
+                        Real v = 0;
+                        if (x*x/(RO_*RO_/5) + y*y/(E1_*E1_/6) < 1) v += 0.5;
+                        if (x*x + y*y < radius*radius) v += 1;
+
+                        image(ro, e1, cha) = v * coil_map(ro, e1, cha);
+                    }
+                }
+            }
+
+            Gadgetron::hoNDFFT<Real>::instance()->fft2c(image, kspace);
+
+            size_t line = 0;
+            for (e1=n%accel_factor_; e1<E1_; e1+=accel_factor_, line++)
+            {
+                for (cha=0; cha<CHA_; cha++)
+                {
+                    std::copy(&kspace(0, e1, cha), &kspace(0, e1, cha)+RO_, &data_(0, e1, cha, n, 0));
+                }
+
+                Real line_time = t + line*TR;
+
+                ISMRMRD::AcquisitionHeader& header = headers_(e1, n, 0);
+                header.number_of_samples = (uint16_t)RO_;
+                header.acquisition_time_stamp = (uint32_t)(line_time/time_tick);
+                header.physiology_time_stamp[0] = (uint32_t)(std::fmod(line_time, RR)/time_tick);
+            }
+        }
+    }
+
+    void prepare(CmrKSpaceBinningUnderTest<Real>& binning, bool provisional_binning)
+    {
+        binning.use_multiple_channel_recon_ = true;
+        binning.use_paralell_imaging_binning_recon_ = true;
+        binning.use_nonlinear_binning_recon_ = false;
+        binning.estimate_respiratory_navigator_ = false;
+        // bin the lines of about one frame of every heart beat, so the binned kspace is undersampled and the linear recon runs
+        binning.kspace_binning_max_temporal_window_ = 1.0;
+        binning.kspace_binning_minimal_cardiac_phase_width_ = 25.0;
+        binning.incremental_calibration_frames_ = 16;
+        binning.incremental_provisional_binning_ = provisional_binning;
+
+        binning.binning_obj_.output_N_ = output_N_;
+        binning.binning_obj_.accel_factor_E1_ = (float)accel_factor_;
+        binning.binning_obj_.random_sampling_ = false;
+
+        binning.binning_obj_.sampling_.sampling_limits_[0].min_ = 0;
+        binning.binning_obj_.sampling_.sampling_limits_[0].center_ = (uint16_t)(RO_/2);
+        binning.binning_obj_.sampling_.sampling_limits_[0].max_ = (uint16_t)(RO_-1);
+        binning.binning_obj_.sampling_.sampling_limits_[1].min_ = 0;
+        binning.binning_obj_.sampling_.sampling_limits_[1].center_ = (uint16_t)(E1_/2);
+        binning.binning_obj_.sampling_.sampling_limits_[1].max_ = (uint16_t)(E1_-1);
+
+        binning.binning_obj_.headers_ = headers_;
+        binning.begin_incremental_recon();
+    }
+
+    Real relative_difference(const ArrayType& a, const ArrayType& b)
+    {
+        EXPECT_EQ(a.dimensions(), b.dimensions());
+
+        ArrayType diff;
+        Gadgetron::subtract(a, b, diff);
+        return Gadgetron::nrm2(diff) / Gadgetron::nrm2(b);
+    }
+
+    size_t RO_, E1_, CHA_, N_, accel_factor_, output_N_;
+
+    ArrayType data_;
+    hoNDArray< ISMRMRD::AcquisitionHeader > headers_;
+};
+
+typedef Types<float> realImplementations;
+
+TYPED_TEST_SUITE(cmr_kspace_binning_test, realImplementations);
+
+TYPED_TEST(cmr_kspace_binning_test, incremental_recon_matches_batch_recon_calibrated_on_the_same_frames)
+{
+    typedef TypeParam T;
+    typedef hoNDArray< std::complex<T> > ArrayType;
+
+    CmrKSpaceBinningUnderTest<T> incremental;
+    this->prepare(incremental, false);
+
+    ArrayType& frames = incremental.binning_obj_.data_;
+    frames.create(this->data_.dimensions());
+    Gadgetron::clear(frames);
+
+    incremental.add_frames(frames, this->data_, this->headers_, false);
+
+    // calibrated on 16, 32, 64 and 128 frames; not on 256, as fewer than a quarter of the 200 frames was left
+    EXPECT_EQ(incremental.calibrated_frames(), 128);
+
+    incremental.process_binning_recon();
+
+    CmrKSpaceBinningUnderTest<T> batch;
+    this->prepare(batch, false);
+    batch.binning_obj_.data_ = this->data_;
+    batch.process_batch(16, 128);
+
+    EXPECT_LT(this->relative_difference(incremental.binning_obj_.complex_image_raw_, batch.binning_obj_.complex_image_raw_), 1e-5);
+    EXPECT_LT(this->relative_difference(incremental.binning_obj_.coil_map_raw_, batch.binning_obj_.coil_map_raw_), 1e-5);
+    EXPECT_LT(this->relative_difference(incremental.binning_obj_.complex_image_binning_, batch.binning_obj_.complex_image_binning_), 1e-5);
+}
+
+TYPED_TEST(cmr_kspace_binning_test, binning_of_the_frames_so_far_starts_the_linear_recon)
+{
+    typedef TypeParam T;
+    typedef hoNDArray< std::complex<T> > ArrayType;
+
+    CmrKSpaceBinningUnderTest<T> incremental;
+    this->prepare(incremental, true);
+
+    ArrayType& frames = incremental.binning_obj_.data_;
+    frames.create(this->data_.dimensions());
+    Gadgetron::clear(frames);
+
+    incremental.add_frames(frames, this->data_, this->headers_, true);
+    EXPECT_EQ(incremental.calibrated_frames(), 128);
+
+    incremental.process_binning_recon();
+    EXPECT_TRUE(incremental.initial_kspace_used());
+
+    CmrKSpaceBinningUnderTest<T> batch;
+    this->prepare(batch, false);
+    batch.binning_obj_.data_ = this->data_;
+    batch.process_batch(16, 128);
+    EXPECT_FALSE(batch.initial_kspace_used());
+
+    // the same raw images; the linear recon of the binned kspace stops at its threshold from another start
+    EXPECT_LT(this->relative_difference(incremental.binning_obj_.complex_image_raw_, batch.binning_obj_.complex_image_raw_), 1e-5);
+    EXPECT_LT(this->relative_difference(incremental.binning_obj_.complex_image_binning_, batch.binning_obj_.complex_image_binning_), 1e-3);
+}
+
+TYPED_TEST(cmr_kspace_binning_test, binning_of_the_frames_so_far_is_cancelled_by_the_recon)
+{
+    typedef TypeParam T;
+    typedef hoNDArray< std::complex<T> > ArrayType;
+
+    CmrKSpaceBinningUnderTest<T> incremental;
+    this->prepare(incremental, true);
+
+    ArrayType& frames = incremental.binning_obj_.data_;
+    frames.create(this->data_.dimensions());
+    Gadgetron::clear(frames);
+
+    incremental.add_frames(frames, this->data_, this->headers_, false);
+    incremental.process_binning_recon();
+
+    EXPECT_EQ(incremental.binning_obj_.complex_image_binning_.get_size(3), this->output_N_);
+    EXPECT_GT(Gadgetron::nrm2(incremental.binning_obj_.complex_image_binning_), 0);
+}
@@ -4,6 +4,7 @@
 #include "hoMRImage.h"
 #include "hoNDArray_elemwise.h"
 #include "io/primitives.h"
+#include "io/spill.h"
 
 TEST(TypeTests, readWritehoNDImageTest) {
 
@@ -236,3 +237,29 @@ TEST(TypeTests, readWriteManyTest) {
         EXPECT_STREQ(attrib_content.c_str(), attrib_content_readed.c_str());
     }
 }
+
+TEST(TypeTests, spillFileTest) {
+
+    Gadgetron::Core::IO::SpillFile file;
+
+    Gadgetron::hoNDArray<float> array(64, 32);
+    for (size_t i = 0; i < array.size(); i++) array[i] = float(i);
+    std::vector<std::vector<float>> values{{1.0f, 2.0f}, {3.0f}};
+
+    auto array_offset = file.write(array);
+    auto values_offset = file.write(values);
+    EXPECT_EQ(array_offset, 0u);
+    EXPECT_GT(file.size(), array.get_number_of_bytes());
+
+    // Values are read back by offset, in any order.
+    EXPECT_EQ(file.read<std::vector<std::vector<float>>>(values_offset), values);
+
+    auto read_array = file.read<Gadgetron::hoNDArray<float>>(array_offset);
+    ASSERT_EQ(read_array.dimensions(), array.dimensions());
+    EXPECT_TRUE(std::equal(array.begin(), array.end(), read_array.begin()));
+
+    // Writes after reads append.
+    auto more = file.write(array);
+    EXPECT_GT(more, values_offset);
+    EXPECT_EQ(file.read<Gadgetron::hoNDArray<float>>(more)[2047], 2047.0f);
+}
@@ -13,6 +13,7 @@
 #include "twoParaExpDecayOperator.h"
 #include "twoParaExpRecoveryOperator.h"
 #include "curveFittingCostFunction.h"
+#include "BatchedLM.h"
 #include "cmr_t1_mapping.h"
 #include <gtest/gtest.h>
 #include <boost/random.hpp>
@@ -231,3 +232,185 @@ TYPED_TEST(curveFitting_test, T1SRMapping)
     // test hole filling
     EXPECT_NEAR(t1_sr.map_(12, 23, 0, 0), 1122.36963, 1.0);
 }
+
+TYPED_TEST(curveFitting_test, BatchedT2SE)
+{
+    std::vector<TypeParam> te = { 10, 20, 30, 40, 60, 80, 120, 160 };
+    std::vector<TypeParam> y = { 606.248226950355, 598.40425531914, 589.368794326241, 580.815602836879, 563.170212765957, 545.893617021277, 512.31914893617, 480.723404255319 };
+
+    Gadgetron::Solver::BatchedLMSolver< Gadgetron::Solver::Models::ExpDecay<TypeParam> > solver(te);
+
+    // more curves than lanes, with the last group partially filled
+    size_t num = 2 * solver.lanes + 3;
+
+    std::vector< std::array<TypeParam, 2> > b(num);
+    std::vector<Gadgetron::Solver::BatchedLMStatus> status(num);
+
+    Gadgetron::Solver::fit_batched(solver, num,
+        [&](size_t i, TypeParam* yi, std::array<TypeParam, 2>& guess)
+        {
+            std::copy(y.begin(), y.end(), yi);
+            guess[0] = y[0];
+            guess[1] = 640 + 10 * i;
+        },
+        [&](size_t i, const std::array<TypeParam, 2>& bi, Gadgetron::Solver::BatchedLMStatus s)
+        {
+            b[i] = bi;
+            status[i] = s;
+        });
+
+    for (size_t i = 0; i < num; i++)
+    {
+        EXPECT_EQ(status[i], Gadgetron::Solver::BatchedLMStatus::SUCCESS);
+        EXPECT_NEAR(b[i][0], 617.259, 0.01);
+        EXPECT_NEAR(b[i][1], 644.423, 0.01);
+    }
+}
+
+TYPED_TEST(curveFitting_test, BatchedT1SR)
+{
+    std::vector<TypeParam> ts(11, 545);
+    ts[10] = 10000;
+
+    std::vector<TypeParam> y = { 178, 185, 182, 189, 178, 180, 187, 179, 177, 177, 471 };
+
+    Gadgetron::Solver::BatchedLMSolver< Gadgetron::Solver::Models::ExpRecovery<TypeParam> > solver(ts);
+    solver.max_iterations_ = 150;
+
+    const TypeParam* yi = y.data();
+    std::array<TypeParam, 2> b = { *std::max_element(y.begin(), y.end()), ts[ts.size() / 2] };
+    Gadgetron::Solver::BatchedLMStatus status;
+
+    solver.solve(&yi, &b, &status, 1);
+
+    // least squares solution, computed in double precision
+    EXPECT_EQ(status, Gadgetron::Solver::BatchedLMStatus::SUCCESS);
+    EXPECT_NEAR(b[0], 471.063623, 0.003);
+    EXPECT_NEAR(b[1], 1122.363073, 0.003);
+}
+
+TYPED_TEST(curveFitting_test, BatchedInversionRecovery)
+{
+    std::vector<TypeParam> ti = { 100, 180, 260, 1000, 1100, 1200, 2000, 3000 };
+    std::vector<TypeParam> y2(ti.size()), y3(ti.size());
+    for (size_t n = 0; n < ti.size(); n++)
+    {
+        y2[n] = 450 * (1 - 2 * std::exp(-ti[n] / 1100));
+        y3[n] = 500 - 900 * std::exp(-ti[n] / 850);
+    }
+
+    Gadgetron::Solver::BatchedLMStatus status;
+
+    Gadgetron::Solver::BatchedLMSolver< Gadgetron::Solver::Models::InversionRecovery<TypeParam> > solver2(ti);
+    const TypeParam* yi = y2.data();
+    std::array<TypeParam, 2> b2 = { 800, 600 };
+    solver2.solve(&yi, &b2, &status, 1);
+
+    EXPECT_EQ(status, Gadgetron::Solver::BatchedLMStatus::SUCCESS);
+    EXPECT_NEAR(b2[0], 1100, 0.01);
+    EXPECT_NEAR(b2[1], 450, 0.01);
+
+    Gadgetron::Solver::BatchedLMSolver< Gadgetron::Solver::Models::ThreeParamInversionRecovery<TypeParam> > solver3(ti);
+    yi = y3.data();
+    std::array<TypeParam, 3> b3 = { 800, 500, 700 };
+    solver3.solve(&yi, &b3, &status, 1);
+
+    EXPECT_EQ(status, Gadgetron::Solver::BatchedLMStatus::SUCCESS);
+    EXPECT_NEAR(b3[0], 850, 0.01);
+    EXPECT_NEAR(b3[1], 500, 0.01);
+    EXPECT_NEAR(b3[2], 900, 0.01);
+}
+
+TYPED_TEST(curveFitting_test, T1SRMappingBatched)
+{
+    Gadgetron::CmrT1SRMapping<float> t1_sr;
+
+    t1_sr.fill_holes_in_maps_ = true;
+    t1_sr.max_size_of_holes_ = 20;
+    t1_sr.hole_marking_value_ = 0;
+    t1_sr.compute_SD_maps_ = true;
+
+    t1_sr.ti_.resize(11, 545);
+    t1_sr.ti_[10] = 10000;
+
+    t1_sr.max_iter_ = 150;
+    t1_sr.max_map_value_ = 4000;
+    t1_sr.use_batched_solver_ = true;
+
+    std::vector<float> y = { 178, 185, 182, 189, 178, 180, 187, 179, 177, 177, 471 };
+
+    // several S and SLC, fitted together
+    size_t RO = 64;
+    size_t E1 = 48;
+    size_t N = t1_sr.ti_.size();
+    size_t S = 2;
+    size_t SLC = 3;
+
+    t1_sr.data_.create(RO, E1, N, S, SLC);
+    for (size_t slc = 0; slc < SLC; slc++)
+        for (size_t s = 0; s < S; s++)
+            for (size_t n = 0; n < N; n++)
+                for (size_t e1 = 0; e1 < E1; e1++)
+                    for (size_t ro = 0; ro < RO; ro++)
+                        t1_sr.data_(ro, e1, n, s, slc) = y[n];
+
+    t1_sr.mask_for_mapping_.create(RO, E1, SLC);
+    Gadgetron::fill(t1_sr.mask_for_mapping_, (float)1);
+    t1_sr.mask_for_mapping_(12, 23, 1) = 0;
+
+    t1_sr.perform_parametric_mapping();
+
+    for (size_t slc = 0; slc < SLC; slc++)
+    {
+        for (size_t s = 0; s < S; s++)
+        {
+            EXPECT_NEAR(t1_sr.para_(0, 0, 0, s, slc), 471.063623, 0.003);
+            EXPECT_NEAR(t1_sr.map_(0, 0, s, slc), 1122.363073, 0.003);
+            EXPECT_NEAR(t1_sr.map_(RO - 1, E1 - 1, s, slc), 1122.363073, 0.003);
+            EXPECT_GT(t1_sr.sd_map_(RO / 2, E1 / 2, s, slc), 0);
+        }
+    }
+
+    // masked pixel is filled as a hole
+    EXPECT_NEAR(t1_sr.map_(12, 23, 0, 1), 1122.363073, 1.0);
+    EXPECT_NEAR(t1_sr.map_(12, 23, 1, 1), 1122.363073, 1.0);
+}
+
+TYPED_TEST(curveFitting_test, T1SRMappingBatchedFailedFit)
+{
+    Gadgetron::CmrT1SRMapping<float> t1_sr;
+
+    t1_sr.fill_holes_in_maps_ = false;
+    t1_sr.compute_SD_maps_ = false;
+
+    t1_sr.ti_.resize(11, 545);
+    t1_sr.ti_[10] = 10000;
+
+    t1_sr.max_iter_ = 150;
+    t1_sr.max_map_value_ = 4000;
+    t1_sr.use_batched_solver_ = true;
+
+    std::vector<float> y = { 178, 185, 182, 189, 178, 180, 187, 179, 177, 177, 471 };
+
+    size_t RO = 16;
+    size_t E1 = 16;
+    size_t N = t1_sr.ti_.size();
+
+    t1_sr.data_.create(RO, E1, N, 1, 1);
+    for (size_t n = 0; n < N; n++)
+        for (size_t e1 = 0; e1 < E1; e1++)
+            for (size_t ro = 0; ro < RO; ro++)
+                t1_sr.data_(ro, e1, n, 0, 0) = y[n];
+
+    // the normal equations of this pixel overflow, so the solver fails from a valid initial guess
+    for (size_t n = 0; n < N; n++) t1_sr.data_(3, 5, n, 0, 0) = 1e30f;
+
+    t1_sr.mask_for_mapping_.create(RO, E1, 1);
+    Gadgetron::fill(t1_sr.mask_for_mapping_, (float)1);
+
+    t1_sr.perform_parametric_mapping();
+
+    EXPECT_EQ(t1_sr.map_(3, 5, 0, 0), 0);
+    EXPECT_EQ(t1_sr.para_(3, 5, 0, 0, 0), 0);
+    EXPECT_NEAR(t1_sr.map_(4, 5, 0, 0), 1122.363073, 0.003);
+}
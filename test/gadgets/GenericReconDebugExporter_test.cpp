@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+
+#include <boost/filesystem.hpp>
+
+#include "../../gadgets/mri_core/generic_recon_gadgets/GenericReconDebugExporter.h"
+
+using namespace Gadgetron;
+
+namespace {
+
+class GenericReconDebugExporterTest : public ::testing::Test {
+  protected:
+    GenericReconDebugExporterTest()
+        : directory(boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()) {
+        boost::filesystem::create_directories(directory);
+        folder = directory.string() + "/";
+    }
+
+    ~GenericReconDebugExporterTest() override { boost::filesystem::remove_all(directory); }
+
+    hoNDArray<std::complex<float>> array_of(float value) {
+        hoNDArray<std::complex<float>> a(4, 3);
+        a.fill(std::complex<float>(value, -value));
+        return a;
+    }
+
+    void expect_array(ISMRMRD::Dataset& dataset, const std::string& name, float value) {
+        ISMRMRD::NDArray<std::complex<float>> read;
+        dataset.readNDArray(name, 0, read);
+
+        ASSERT_EQ(read.getDims()[0], 4u);
+        ASSERT_EQ(read.getDims()[1], 3u);
+        for (size_t i = 0; i < read.getNumberOfElements(); i++)
+            EXPECT_EQ(read.getDataPtr()[i], std::complex<float>(value, -value));
+    }
+
+    boost::filesystem::path directory;
+    std::string folder;
+};
+} // namespace
+
+TEST_F(GenericReconDebugExporterTest, arrays_exported_twice_are_both_kept) {
+    {
+        GenericReconDebugExporter exporter;
+        exporter.configure(folder, "case", GenericReconDebugExporter::Settings{});
+
+        exporter.export_array_complex(array_of(1), folder + "data_encoding_0");
+        exporter.export_array_complex(array_of(2), folder + "data_encoding_0");
+        exporter.flush();
+    }
+
+    ISMRMRD::Dataset dataset((folder + "debug_case.h5").c_str(), "debug", false);
+    expect_array(dataset, "data_encoding_0", 1);
+    expect_array(dataset, "data_encoding_0_1", 2);
+}
+
+TEST_F(GenericReconDebugExporterTest, gadgets_exporting_the_same_name_do_not_overwrite_each_other) {
+    {
+        GenericReconDebugExporter first, second;
+        first.configure(folder, "case", GenericReconDebugExporter::Settings{});
+        second.configure(folder, "case", GenericReconDebugExporter::Settings{});
+
+        first.export_array_complex(array_of(1), folder + "coil_map");
+        second.export_array_complex(array_of(2), folder + "coil_map");
+        first.flush();
+        second.flush();
+    }
+
+    ISMRMRD::Dataset dataset((folder + "debug_case.h5").c_str(), "debug", false);
+    expect_array(dataset, "coil_map", 1);
+    expect_array(dataset, "coil_map_1", 2);
+}
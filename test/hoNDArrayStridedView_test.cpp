@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+
+#include "hoNDArrayStridedView.h"
+#include "hoNDArrayStridedView_math.h"
+#include "hoNDArray_math.h"
+
+#include <complex>
+#include <numeric>
+#include <random>
+
+using namespace Gadgetron;
+
+namespace {
+    template <class T> hoNDArray<T> random_array(std::vector<size_t> dimensions) {
+        hoNDArray<T> array(dimensions);
+        std::mt19937 rng(42);
+        std::normal_distribution<float> normal;
+        for (auto& x : array) {
+            if constexpr (is_complex_type_v<T>) x = T(normal(rng), normal(rng));
+            else x = T(normal(rng));
+        }
+        return array;
+    }
+}
+
+TEST(hoNDArrayStridedView, slice_range_and_permute_address_the_same_elements) {
+    auto array = random_array<float>({ 7, 5, 4, 3 });
+
+    auto view = strided_view(array).slice(3, 2).range(1, 1, 2, 2).permute({ 2, 0, 1 });
+    ASSERT_EQ(view.dimensions(), (std::vector<size_t>{ 4, 7, 2 }));
+    ASSERT_FALSE(view.is_contiguous());
+
+    for (size_t e2 = 0; e2 < 4; e2++)
+        for (size_t ro = 0; ro < 7; ro++)
+            for (size_t e1 = 0; e1 < 2; e1++) EXPECT_EQ(view(e2, ro, e1), array(ro, 1 + 2 * e1, e2, 2));
+
+    auto copy = view.copy();
+    ASSERT_EQ(copy.dimensions(), view.dimensions());
+    EXPECT_EQ(copy(3, 6, 1), array(6, 3, 3, 2));
+}
+
+TEST(hoNDArrayStridedView, assignment_writes_through) {
+    auto array = random_array<float>({ 6, 5, 4 });
+    hoNDArray<float> plane(5, 6);
+    plane.fill(2.0f);
+
+    strided_view(array).slice(2, 1).permute({ 1, 0 }) = plane;
+
+    for (size_t e1 = 0; e1 < 5; e1++)
+        for (size_t ro = 0; ro < 6; ro++) EXPECT_EQ(array(ro, e1, 1), 2.0f);
+    EXPECT_NE(array(0, 0, 0), 2.0f);
+
+    fill(strided_view(array).range(0, 0, 3, 2), 0.0f);
+    EXPECT_EQ(array(4, 2, 3), 0.0f);
+    EXPECT_NE(array(5, 2, 3), 0.0f);
+}
+
+TEST(hoNDArrayStridedView, contiguous_views_share_data) {
+    auto array = random_array<float>({ 6, 5, 4 });
+    auto view = strided_view(array).slice(2, 3);
+    ASSERT_TRUE(view.is_contiguous());
+
+    auto shared = view.as_array();
+    EXPECT_EQ(shared.data(), &array(0, 0, 3));
+    EXPECT_THROW(strided_view(array).permute({ 1, 0, 2 }).as_array(), std::runtime_error);
+}
+
+TEST(hoNDArrayStridedView, reductions_match_dense_arrays) {
+    auto array = random_array<std::complex<float>>({ 8, 6, 5 });
+    auto other = random_array<std::complex<float>>({ 6, 8, 5 });
+
+    auto view = strided_view(array).permute({ 1, 0, 2 }).range(2, 1, 3);
+    auto dense = view.copy();
+    auto other_view = strided_view(other).range(2, 2, 3);
+    auto other_dense = other_view.copy();
+
+    EXPECT_NEAR(asum(view), asum(dense), 1e-3);
+    EXPECT_NEAR(nrm2(view), nrm2(dense), 1e-3);
+    EXPECT_NEAR(std::abs(dot(view, other_view) - dot(dense, other_dense)), 0, 1e-3);
+    EXPECT_NEAR(std::abs(sum(view) - std::accumulate(dense.begin(), dense.end(), std::complex<float>(0))), 0, 1e-3);
+}
+
+TEST(hoNDArrayStridedView, elementwise_operations_write_through) {
+    auto array = random_array<float>({ 8, 6 });
+    auto original = array;
+    hoNDArray<float> ones(6, 8);
+    ones.fill(1.0f);
+
+    auto view = strided_view(array).permute({ 1, 0 });
+    add(strided_view(ones), view);
+    axpy(2.0f, strided_view(ones), view);
+    scal(0.5f, view);
+    multiply(strided_view(ones), view);
+
+    for (size_t i = 0; i < array.size(); i++) EXPECT_FLOAT_EQ(array[i], (original[i] + 3.0f) * 0.5f);
+}
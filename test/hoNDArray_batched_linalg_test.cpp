@@ -0,0 +1,168 @@
+#include <gtest/gtest.h>
+
+#include "hoNDArray_batched_linalg.h"
+
+#include <complex>
+#include <random>
+
+using namespace Gadgetron;
+using testing::Types;
+
+namespace {
+    template <class T> hoNDArray<T> random_stack(size_t count, size_t rows, size_t cols, unsigned seed = 42) {
+        hoNDArray<T> array(count, rows, cols);
+        std::mt19937 rng(seed);
+        std::normal_distribution<double> normal;
+        for (auto& x : array) {
+            if constexpr (is_complex_type_v<T>) x = T(normal(rng), normal(rng));
+            else x = T(normal(rng));
+        }
+        return array;
+    }
+
+    template <class T> T conj_of(const T& x) {
+        if constexpr (is_complex_type_v<T>) return std::conj(x);
+        else return x;
+    }
+
+    /** A^H A + n I, which is positive definite and well conditioned. */
+    template <class T> hoNDArray<T> hermitian_stack(size_t count, size_t n) {
+        auto A = random_stack<T>(count, n, n, 7);
+        hoNDArray<T> H(count, n, n);
+        for (size_t b = 0; b < count; b++)
+            for (size_t i = 0; i < n; i++)
+                for (size_t j = 0; j < n; j++) {
+                    T value = i == j ? T(n) : T(0);
+                    for (size_t k = 0; k < n; k++) value += conj_of(A(b, k, i)) * A(b, k, j);
+                    H(b, i, j) = value;
+                }
+        return H;
+    }
+
+    template <class T> double tolerance() { return std::is_same_v<typename realType<T>::Type, float> ? 1e-3 : 1e-9; }
+}
+
+template <class T> class Batched_linalg_Test : public ::testing::Test {};
+
+typedef Types<float, double, std::complex<float>, std::complex<double>> Implementations;
+TYPED_TEST_SUITE(Batched_linalg_Test, Implementations);
+
+TYPED_TEST(Batched_linalg_Test, gemm_matches_reference) {
+    using T = TypeParam;
+    const size_t count = 77, M = 5, K = 3, N = 4;
+    auto A = random_stack<T>(count, K, M, 1);
+    auto B = random_stack<T>(count, N, K, 2);
+    hoNDArray<T> C(count, M, N);
+
+    // C = A^H B^H
+    Batched::gemm(Batched::MatrixStack<T>(C), A, true, B, true);
+
+    for (size_t b = 0; b < count; b++)
+        for (size_t i = 0; i < M; i++)
+            for (size_t j = 0; j < N; j++) {
+                T expected = 0;
+                for (size_t k = 0; k < K; k++) expected += conj_of(A(b, k, i)) * conj_of(B(b, j, k));
+                EXPECT_NEAR(std::abs(C(b, i, j) - expected), 0, tolerance<T>());
+            }
+}
+
+TYPED_TEST(Batched_linalg_Test, herk_matches_gemm) {
+    using T = TypeParam;
+    const size_t count = 70, K = 9, N = 5;
+    auto A = random_stack<T>(count, K, N, 8);
+    hoNDArray<T> expected(count, N, N), C(count, N, N);
+
+    Batched::gemm(Batched::MatrixStack<T>(expected), A, true, A, false);
+    Batched::herk(Batched::MatrixStack<T>(C), A);
+    for (size_t i = 0; i < C.size(); i++) EXPECT_NEAR(std::abs(C[i] - expected[i]), 0, tolerance<T>());
+}
+
+TYPED_TEST(Batched_linalg_Test, posv_solves_hermitian_systems) {
+    using T = TypeParam;
+    const size_t count = 45, n = 6;
+    auto A = hermitian_stack<T>(count, n);
+    auto X = random_stack<T>(count, n, 2, 3);
+
+    hoNDArray<T> B(count, n, 2);
+    Batched::gemm(Batched::MatrixStack<T>(B), A, false, X, false);
+
+    auto factor = A;
+    ASSERT_EQ(Batched::posv(Batched::MatrixStack<T>(factor), Batched::MatrixStack<T>(B)), 0u);
+    for (size_t i = 0; i < B.size(); i++) EXPECT_NEAR(std::abs(B[i] - X[i]), 0, tolerance<T>());
+}
+
+TYPED_TEST(Batched_linalg_Test, potrf_reports_indefinite_matrices) {
+    using T = TypeParam;
+    auto A = hermitian_stack<T>(3, 4);
+    A(1, 2, 2) = T(-1);
+    ASSERT_EQ(Batched::potrf(Batched::MatrixStack<T>(A)), 1u);
+}
+
+TYPED_TEST(Batched_linalg_Test, gels_solves_least_squares) {
+    using T = TypeParam;
+    const size_t count = 40, m = 9, n = 4;
+    auto A = random_stack<T>(count, m, n, 4);
+    auto X = random_stack<T>(count, n, 1, 5);
+
+    hoNDArray<T> B(count, m, 1);
+    Batched::gemm(Batched::MatrixStack<T>(B), A, false, X, false);
+
+    // A consistent system is solved exactly.
+    auto QR = A;
+    Batched::gels(Batched::MatrixStack<T>(QR), Batched::MatrixStack<T>(B));
+    for (size_t b = 0; b < count; b++)
+        for (size_t i = 0; i < n; i++) EXPECT_NEAR(std::abs(B(b, i, 0) - X(b, i, 0)), 0, tolerance<T>());
+
+    // Otherwise the residual is orthogonal to the columns of A.
+    auto Y = random_stack<T>(count, m, 1, 6);
+    auto solution = Y;
+    QR = A;
+    Batched::gels(Batched::MatrixStack<T>(QR), Batched::MatrixStack<T>(solution));
+    for (size_t b = 0; b < count; b++) {
+        std::vector<T> residual(m);
+        for (size_t i = 0; i < m; i++) {
+            residual[i] = Y(b, i, 0);
+            for (size_t k = 0; k < n; k++) residual[i] -= A(b, i, k) * solution(b, k, 0);
+        }
+        for (size_t k = 0; k < n; k++) {
+            T projection = 0;
+            for (size_t i = 0; i < m; i++) projection += conj_of(A(b, i, k)) * residual[i];
+            EXPECT_NEAR(std::abs(projection), 0, 10 * tolerance<T>());
+        }
+    }
+}
+
+TYPED_TEST(Batched_linalg_Test, heev_decomposes_hermitian_matrices) {
+    using T = TypeParam;
+    using R = typename realType<T>::Type;
+    const size_t count = 33, n = 7;
+    auto A = hermitian_stack<T>(count, n);
+
+    auto V = A;
+    hoNDArray<R> w(count, n);
+    Batched::heev(Batched::MatrixStack<T>(V), Batched::MatrixStack<R>(w));
+
+    for (size_t b = 0; b < count; b++) {
+        for (size_t j = 0; j < n; j++) {
+            if (j > 0) {
+                EXPECT_LE(w(b, j - 1), w(b, j));
+            }
+            // A v = w v
+            for (size_t i = 0; i < n; i++) {
+                T av = 0;
+                for (size_t k = 0; k < n; k++) av += A(b, i, k) * V(b, k, j);
+                EXPECT_NEAR(std::abs(av - w(b, j) * V(b, i, j)), 0, 10 * n * tolerance<T>());
+            }
+        }
+    }
+
+    // The dominant eigenvector from power iteration matches, up to phase.
+    hoNDArray<T> v(count, n, 1);
+    v.fill(T(1));
+    Batched::power_iteration(A, Batched::MatrixStack<T>(v), 200);
+    for (size_t b = 0; b < count; b++) {
+        T overlap = 0;
+        for (size_t i = 0; i < n; i++) overlap += conj_of(V(b, i, n - 1)) * v(b, i, 0);
+        EXPECT_NEAR(std::abs(overlap), 1, 100 * tolerance<T>());
+    }
+}
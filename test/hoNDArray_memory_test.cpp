@@ -0,0 +1,213 @@
+#include <gtest/gtest.h>
+
+#include "hoNDArray.h"
+#include "hoNDArray_fileio.h"
+#include "hoNDArray_memory.h"
+
+#include <boost/filesystem.hpp>
+#include <complex>
+#include <memory>
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using namespace Gadgetron;
+
+TEST(hoNDArray_memory, small_arrays_stay_on_heap) {
+    MappedMemory::Policy policy;
+    policy.threshold_bytes = 1024 * 1024;
+    MappedMemory::ScopedPolicy scoped(policy);
+
+    hoNDArray<float> x(16, 16);
+    EXPECT_FALSE(MappedMemory::is_mapped(x.data()));
+}
+
+TEST(hoNDArray_memory, large_arrays_are_mapped) {
+    MappedMemory::Policy policy;
+    policy.threshold_bytes = 1024;
+    MappedMemory::ScopedPolicy scoped(policy);
+
+    hoNDArray<std::complex<float>> x(128, 64);
+    ASSERT_TRUE(MappedMemory::is_mapped(x.data()));
+    std::fill(x.begin(), x.end(), std::complex<float>(1, 2));
+
+    hoNDArray<std::complex<float>> y(x);
+    ASSERT_TRUE(MappedMemory::is_mapped(y.data()));
+    EXPECT_EQ(y(127, 63), std::complex<float>(1, 2));
+
+    hoNDArray<std::complex<float>> z(std::move(x));
+    EXPECT_TRUE(MappedMemory::is_mapped(z.data()));
+    EXPECT_EQ(z(5, 5), std::complex<float>(1, 2));
+}
+
+TEST(hoNDArray_memory, file_backed_mapping) {
+    MappedMemory::Policy policy;
+    policy.threshold_bytes = 1;
+    policy.directory = boost::filesystem::temp_directory_path().string();
+    MappedMemory::ScopedPolicy scoped(policy);
+
+    hoNDArray<float> x(1000, 10);
+    ASSERT_TRUE(MappedMemory::is_mapped(x.data()));
+    std::fill(x.begin(), x.end(), 3.0f);
+    EXPECT_EQ(x(999, 9), 3.0f);
+}
+
+TEST(hoNDArray_memory, read_mapped_file) {
+    hoNDArray<float> x(37, 11);
+    for (size_t i = 0; i < x.size(); i++) x[i] = float(i);
+
+    auto filename = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string();
+    ASSERT_EQ(write_nd_array(&x, filename.c_str()), 0);
+
+    auto y = read_nd_array_mapped<float>(filename.c_str());
+    boost::filesystem::remove(filename);
+
+    ASSERT_TRUE(y);
+    EXPECT_TRUE(MappedMemory::is_mapped(y->data()));
+    ASSERT_EQ(y->dimensions(), x.dimensions());
+    for (size_t i = 0; i < x.size(); i++) EXPECT_EQ((*y)[i], x[i]);
+
+    // Mapping is private; writes stay in memory.
+    (*y)[0] = -1.0f;
+    EXPECT_EQ((*y)[0], -1.0f);
+}
+
+TEST(hoNDArray_memory, read_mapped_file_checks_size) {
+    hoNDArray<float> x(37, 11);
+    std::fill(x.begin(), x.end(), 1.0f);
+
+    auto filename = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string();
+    ASSERT_EQ(write_nd_array(&x, filename.c_str()), 0);
+
+    boost::filesystem::resize_file(filename, boost::filesystem::file_size(filename) - 100);
+    EXPECT_THROW(read_nd_array_mapped<float>(filename.c_str()), std::runtime_error);
+    EXPECT_EQ(MappedMemory::map_file(filename, 12, x.get_number_of_bytes()), nullptr);
+
+    {
+        std::ofstream f(filename, std::ios::binary | std::ios::trunc);
+        int header[2] = { -3, 5 };
+        f.write(reinterpret_cast<const char*>(header), sizeof(header));
+    }
+    EXPECT_FALSE(read_nd_array_mapped<float>(filename.c_str()));
+
+    boost::filesystem::remove(filename);
+}
+
+namespace {
+    // Accounting starts with the first budget set; a budget no test comes near turns it on.
+    void start_accounting() {
+        auto budget = MappedMemory::budget();
+        if (!budget.connection_bytes && !budget.server_bytes) {
+            budget.server_bytes = size_t(1) << 50;
+            MappedMemory::set_budget(budget);
+        }
+    }
+}
+
+TEST(hoNDArray_memory, large_arrays_are_accounted) {
+    start_accounting();
+
+    auto before = MappedMemory::allocated_bytes();
+    {
+        hoNDArray<float> x(1024, 64);
+        hoNDArray<float> small(16);
+        EXPECT_EQ(MappedMemory::allocated_bytes(), before + x.get_number_of_bytes());
+        EXPECT_GE(MappedMemory::server_allocated_bytes(), MappedMemory::allocated_bytes());
+
+        hoNDArray<float> y(std::move(x));
+        EXPECT_EQ(MappedMemory::allocated_bytes(), before + y.get_number_of_bytes());
+    }
+    EXPECT_EQ(MappedMemory::allocated_bytes(), before);
+}
+
+TEST(hoNDArray_memory, adopted_storage_is_not_unaccounted) {
+    start_accounting();
+
+    auto before = MappedMemory::allocated_bytes();
+    {
+        hoNDArray<float> x;
+        x.create({ 1024, 64 }, new float[1024 * 64], true);
+        EXPECT_EQ(MappedMemory::allocated_bytes(), before);
+
+        hoNDArray<float> y(std::move(x));
+        y.create({ 1024, 32 });
+        EXPECT_EQ(MappedMemory::allocated_bytes(), before + y.get_number_of_bytes());
+    }
+    EXPECT_EQ(MappedMemory::allocated_bytes(), before);
+}
+
+#ifndef _WIN32
+TEST(hoNDArray_memory, arrays_inherited_across_fork_stay_accounted_to_the_parent) {
+    start_accounting();
+
+    auto before = MappedMemory::allocated_bytes();
+    auto x = std::make_unique<hoNDArray<float>>(1024, 64);
+
+    auto pid = fork();
+    if (pid == 0) {
+        x.reset();
+        bool other = MappedMemory::allocated_bytes() == 0;
+        hoNDArray<float> y(1024, 16);
+        bool own = MappedMemory::allocated_bytes() == y.get_number_of_bytes();
+        _exit(other && own ? 0 : 1);
+    }
+
+    int status = 0;
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    EXPECT_EQ(MappedMemory::allocated_bytes(), before + x->get_number_of_bytes());
+    x.reset();
+    EXPECT_EQ(MappedMemory::allocated_bytes(), before);
+}
+#endif
+
+TEST(hoNDArray_memory, anonymous_mappings_are_accounted) {
+    MappedMemory::Policy policy;
+    policy.threshold_bytes = 1024;
+    MappedMemory::ScopedPolicy scoped(policy);
+    start_accounting();
+
+    auto before = MappedMemory::allocated_bytes();
+    {
+        hoNDArray<std::complex<float>> x(128, 64);
+        ASSERT_TRUE(MappedMemory::is_mapped(x.data()));
+        EXPECT_GE(MappedMemory::allocated_bytes(), before + x.get_number_of_bytes());
+    }
+    EXPECT_EQ(MappedMemory::allocated_bytes(), before);
+}
+
+TEST(hoNDArray_memory, file_backed_mappings_are_not_accounted) {
+    MappedMemory::Policy policy;
+    policy.threshold_bytes = 1024;
+    policy.directory = boost::filesystem::temp_directory_path().string();
+    MappedMemory::ScopedPolicy scoped(policy);
+    start_accounting();
+
+    auto before = MappedMemory::allocated_bytes();
+    {
+        hoNDArray<float> x(1024, 64);
+        ASSERT_TRUE(MappedMemory::is_mapped(x.data()));
+        EXPECT_EQ(MappedMemory::allocated_bytes(), before);
+    }
+    EXPECT_EQ(MappedMemory::allocated_bytes(), before);
+}
+
+TEST(hoNDArray_memory, over_budget) {
+    auto previous = MappedMemory::budget();
+
+    MappedMemory::Budget budget;
+    budget.connection_bytes = MappedMemory::allocated_bytes() + 1024 * 1024;
+    MappedMemory::set_budget(budget);
+    EXPECT_FALSE(MappedMemory::over_budget());
+    {
+        hoNDArray<float> x(1024, 1024);
+        EXPECT_TRUE(MappedMemory::over_budget());
+        EXPECT_FALSE(MappedMemory::server_over_budget());
+    }
+    EXPECT_FALSE(MappedMemory::over_budget());
+
+    MappedMemory::set_budget(previous);
+}
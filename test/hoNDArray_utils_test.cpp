@@ -325,3 +325,62 @@ TEST(hoNDArray_utils_Test,concat_along_test_non_contigious){
     EXPECT_EQ(concatenated(7,6,0),3.0f);
 
 }
+
+namespace {
+    template<class T> hoNDArray<T> reference_permute(const hoNDArray<T>& in, const std::vector<size_t>& order){
+        std::vector<size_t> dims;
+        for (auto d : order) dims.push_back(in.get_size(d));
+        hoNDArray<T> out(dims);
+
+        std::vector<size_t> in_index(in.get_number_of_dimensions()), out_index(dims.size());
+        for (size_t i = 0; i < out.size(); i++){
+            out.calculate_index(i, out_index);
+            for (size_t d = 0; d < order.size(); d++) in_index[order[d]] = out_index[d];
+            out[i] = in[in.calculate_offset(in_index)];
+        }
+        return out;
+    }
+
+    template<class T> hoNDArray<T> counting_array(const std::vector<size_t>& dims){
+        hoNDArray<T> array(dims);
+        for (size_t i = 0; i < array.size(); i++) array[i] = T(float(i));
+        return array;
+    }
+}
+
+template <typename T> class hoNDArray_permute_Test : public ::testing::Test {};
+typedef Types<float, double, std::complex<float>, std::complex<double>> permuteImplementations;
+TYPED_TEST_SUITE(hoNDArray_permute_Test, permuteImplementations);
+
+TYPED_TEST(hoNDArray_permute_Test, matches_reference){
+    auto array = counting_array<TypeParam>({37, 49, 1, 23, 3});
+
+    std::vector<size_t> order = {0, 1, 2, 3, 4};
+    do {
+        EXPECT_EQ(permute(array, order), reference_permute(array, order));
+    } while (std::next_permutation(order.begin(), order.end()));
+}
+
+TYPED_TEST(hoNDArray_permute_Test, partial_order_is_padded){
+    auto array = counting_array<TypeParam>({5, 7, 11});
+    std::vector<size_t> order = {2, 0};
+
+    hoNDArray<TypeParam> out(11, 5, 7);
+    permute(array, out, order);
+    EXPECT_EQ(out, reference_permute(array, {2, 0, 1}));
+}
+
+TEST(hoNDArray_permute_Test, recon_layouts){
+    // [RO E1 E2 CHA N S SLC] reorderings of the recon gadgets; test/performance/benchmark_permute times them.
+    auto array = counting_array<std::complex<float>>({64, 48, 1, 8, 4, 1, 2});
+    std::vector<std::vector<size_t>> orders = {
+        {3, 0, 1, 2, 4, 5, 6},  // CHA first, for coil combination
+        {1, 0, 2, 3, 4, 5, 6},  // E1 first, for the FFT along phase encoding
+        {0, 1, 2, 4, 3, 5, 6},  // swap CHA and N
+        {4, 3, 0, 1, 2, 5, 6},
+    };
+
+    for (auto const& order : orders){
+        EXPECT_EQ(permute(array, order), reference_permute(array, order));
+    }
+}
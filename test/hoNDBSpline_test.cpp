@@ -0,0 +1,132 @@
+#include "hoNDImage_util.h"
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <complex>
+
+using namespace Gadgetron;
+using testing::Types;
+
+template<typename T> class hoNDBSpline_test : public ::testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+    }
+
+    /// a smooth image with structure along every dimension
+    template <unsigned int D> void fill(hoNDImage<T, D>& im)
+    {
+        std::vector<size_t> ind(D);
+        for (size_t n = 0; n < im.get_number_of_elements(); n++)
+        {
+            im.calculate_index(n, ind);
+
+            double v = 1;
+            for (unsigned int d = 0; d < D; d++) v += std::sin(0.3 * (d + 1) * ind[d]) + 0.01 * ind[d] * ind[d];
+            im(n) = T(v);
+        }
+    }
+
+    /// compares the separable resampling with the per pixel BSpline interpolator, away from the last sample
+    /// along each dimension, where the interpolator falls back to its boundary handler
+    template <unsigned int D> void compare(const std::vector<size_t>& dim, const std::vector<size_t>& dim_out, unsigned int order)
+    {
+        typedef hoNDImage<T, D> ImageType;
+
+        ImageType in(dim);
+        fill(in);
+
+        hoNDBoundaryHandlerBorderValue<ImageType> bh(in);
+        hoNDInterpolatorBSpline<ImageType, D> interp(in, bh, order);
+
+        ImageType expected, result;
+        ASSERT_TRUE(Gadgetron::resampleImage(in, interp, dim_out, expected));
+        ASSERT_TRUE(Gadgetron::resampleImageBSpline(in, order, dim_out, result));
+
+        std::vector<size_t> dim_result;
+        result.get_dimensions(dim_result);
+        EXPECT_EQ(dim_result, dim_out);
+
+        std::vector<size_t> ind(D);
+        size_t compared = 0;
+        for (size_t n = 0; n < result.get_number_of_elements(); n++)
+        {
+            result.calculate_index(n, ind);
+
+            bool interior = true;
+            for (unsigned int d = 0; d < D; d++)
+            {
+                if (dim_out[d] > 1 && ind[d] + 1 >= dim_out[d]) interior = false;
+            }
+            if (!interior) continue;
+
+            EXPECT_NEAR(std::abs(result(n) - expected(n)), 0, 1e-3 * std::abs(expected(n)));
+            compared++;
+        }
+        EXPECT_GT(compared, 0);
+    }
+};
+
+typedef Types<float, double, std::complex<float> > implementations;
+TYPED_TEST_SUITE(hoNDBSpline_test, implementations);
+
+TYPED_TEST(hoNDBSpline_test, resample2D)
+{
+    this->template compare<2>({ 64, 48 }, { 101, 30 }, 5);
+    this->template compare<2>({ 64, 48 }, { 32, 96 }, 3);
+}
+
+TYPED_TEST(hoNDBSpline_test, resample3D)
+{
+    this->template compare<3>({ 32, 24, 12 }, { 48, 24, 20 }, 5);
+    this->template compare<3>({ 32, 24, 12 }, { 17, 50, 6 }, 4);
+}
+
+TYPED_TEST(hoNDBSpline_test, knots_are_kept)
+{
+    // upsampling by an integer factor puts every input sample on an output sample
+    hoNDImage<TypeParam, 2> in(std::vector<size_t>{ 40, 30 });
+    this->fill(in);
+
+    hoNDImage<TypeParam, 2> out;
+    ASSERT_TRUE(Gadgetron::resampleImageBSpline(in, 5, { 79, 59 }, out));
+
+    for (size_t y = 0; y < 30; y++)
+    {
+        for (size_t x = 0; x < 40; x++)
+        {
+            EXPECT_NEAR(std::abs(out(2 * x, 2 * y) - in(x, y)), 0, 1e-4 * std::abs(in(x, y)));
+        }
+    }
+}
+
+TYPED_TEST(hoNDBSpline_test, further_dimensions_are_kept)
+{
+    // a stack of images is resampled image by image
+    hoNDArray<TypeParam> stack(40, 30, 3);
+    hoNDImage<TypeParam, 2> image(std::vector<size_t>{ 40, 30 });
+    this->fill(image);
+    for (size_t n = 0; n < 3; n++)
+    {
+        for (size_t i = 0; i < image.get_number_of_elements(); i++) stack(i + n * image.get_number_of_elements()) = image(i) * TypeParam(n + 1);
+    }
+
+    hoNDBSpline<TypeParam, 2> bspline;
+    hoNDArray<TypeParam> resampled, expected;
+    ASSERT_TRUE(bspline.resampleBSpline(stack, 5, { 64, 20 }, resampled));
+    ASSERT_TRUE(bspline.resampleBSpline(image, 5, { 64, 20 }, expected));
+
+    ASSERT_EQ(resampled.get_size(0), 64);
+    ASSERT_EQ(resampled.get_size(1), 20);
+    ASSERT_EQ(resampled.get_size(2), 3);
+
+    for (size_t n = 0; n < 3; n++)
+    {
+        for (size_t i = 0; i < expected.get_number_of_elements(); i++)
+        {
+            TypeParam e = expected(i) * TypeParam(n + 1);
+            EXPECT_NEAR(std::abs(resampled(i + n * expected.get_number_of_elements()) - e), 0, 1e-4 * std::abs(e));
+        }
+    }
+}
@@ -1,5 +1,6 @@
 #include "hoNDFFT.h"
 #include "hoNDArray_math.h"
+#include "hoNDArray_utils.h"
 #include "complext.h"
 #include <gtest/gtest.h>
 #include <boost/random.hpp>
@@ -168,3 +169,75 @@ TEST(FFTshiftTest, shift3d_random){
 }
 
 
+
+TEST(FFTStridedViewTest,fft_of_view_matches_fft_of_copy){
+    hoNDArray<std::complex<float>> data(16, 12, 6);
+    std::mt19937 rng(7);
+    std::normal_distribution<float> normal;
+    for (auto& x : data) x = std::complex<float>(normal(rng), normal(rng));
+    auto original = data;
+
+    // E1 of channel 3 as the first dimension of the view
+    hoNDArray<std::complex<float>> expected(12, 16);
+    for (size_t e1 = 0; e1 < 12; e1++)
+        for (size_t ro = 0; ro < 16; ro++) expected(e1, ro) = data(ro, e1, 3);
+    FFT::fft(expected, 0);
+
+    auto view = strided_view(data).slice(2, 3).permute({ 1, 0 });
+    FFT::fft(view, 0);
+
+    for (size_t e1 = 0; e1 < 12; e1++)
+        for (size_t ro = 0; ro < 16; ro++) EXPECT_NEAR(std::abs(view(e1, ro) - expected(e1, ro)), 0, 1e-4);
+
+    FFT::ifft(view, 0);
+    for (size_t i = 0; i < data.size(); i++) EXPECT_NEAR(std::abs(data[i] - original[i]), 0, 1e-4);
+}
+
+TEST(FFTResampleTest,fftc_matches_fft2c_then_crop){
+    auto data = make_random_array(16, 12, 2);
+
+    hoNDArray<std::complex<float>> kspace, expected;
+    hoNDFFT<float>::instance()->fft2c(data, kspace);
+    crop(10, 8, kspace, expected);
+
+    auto cropped = FFT::fftc(FFT::fftc(data, 0, 10), 1, 8);
+
+    ASSERT_EQ(cropped.dimensions(), expected.dimensions());
+    for (size_t i = 0; i < expected.size(); i++) EXPECT_NEAR(std::abs(cropped[i] - expected[i]), 0, 1e-4);
+}
+
+TEST(FFTResampleTest,ifftc_matches_pad_then_ifft2c){
+    auto kspace = make_random_array(16, 12, 2);
+
+    hoNDArray<std::complex<float>> padded(24, 20, 2), expected;
+    padded.fill(0.0f);
+    for (size_t n = 0; n < 2; n++)
+        for (size_t e1 = 0; e1 < 12; e1++)
+            for (size_t ro = 0; ro < 16; ro++) padded(ro + 4, e1 + 4, n) = kspace(ro, e1, n);
+    hoNDFFT<float>::instance()->ifft2c(padded, expected);
+
+    auto images = FFT::ifftc(FFT::ifftc(kspace, 0, 24), 1, 20);
+
+    ASSERT_EQ(images.dimensions(), expected.dimensions());
+    for (size_t i = 0; i < expected.size(); i++) EXPECT_NEAR(std::abs(images[i] - expected[i]), 0, 1e-4);
+}
+
+TEST(FFTResampleTest,resample_up_then_down_is_identity){
+    auto data = make_random_array(16, 11, 6, 2);
+
+    auto resampled = FFT::resample(FFT::resample(data, { 32, 22, 6 }), { 16, 11, 6 });
+
+    ASSERT_EQ(resampled.dimensions(), data.dimensions());
+    for (size_t i = 0; i < data.size(); i++) EXPECT_NEAR(std::abs(resampled[i] - data[i]), 0, 1e-4);
+}
+
+TEST(FFTResampleTest,resample_preserves_values){
+    hoNDArray<std::complex<float>> data(12, 10);
+    data.fill(std::complex<float>(2, -1));
+
+    auto resampled = FFT::resample(data, { 20, 6 });
+
+    ASSERT_EQ(resampled.get_size(0), 20u);
+    ASSERT_EQ(resampled.get_size(1), 6u);
+    for (auto& val : resampled) EXPECT_NEAR(std::abs(val - std::complex<float>(2, -1)), 0, 1e-4);
+}
@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+
+#include "Channel.h"
+#include "Metrics.h"
+
+#include <sstream>
+
+#if !(_WIN32)
+#include <csignal>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using namespace Gadgetron::Core;
+
+namespace {
+    std::string metrics() {
+        std::stringstream stream;
+        Metrics::write_prometheus(stream);
+        return stream.str();
+    }
+
+    bool contains(const std::string& haystack, const std::string& needle) {
+        return haystack.find(needle) != std::string::npos;
+    }
+}
+
+TEST(Metrics, disabled_metrics_are_not_recorded) {
+    Metrics::enable(false);
+
+    Metrics::counter("test_disabled_total", "Not recorded.").increment();
+    {
+        auto channel = make_channel<MessageChannel>("disabled_node");
+        channel.output.push(1);
+        channel.input.pop();
+    }
+
+    Metrics::enable();
+
+    auto text = metrics();
+    EXPECT_FALSE(contains(text, "test_disabled_total"));
+    EXPECT_FALSE(contains(text, "disabled_node"));
+}
+
+TEST(Metrics, counters_and_gauges) {
+    Metrics::enable();
+    auto counter = Metrics::counter("test_counter_total", "A test counter.", {{"kind", "a\"b"}});
+    counter.increment();
+    counter.increment(2);
+
+    auto gauge = Metrics::gauge("test_gauge", "A test gauge.");
+    gauge.set(10);
+    gauge.add(-3);
+
+    // Registering the same metric again returns the same series.
+    Metrics::counter("test_counter_total", "A test counter.", {{"kind", "a\"b"}}).increment();
+
+    auto text = metrics();
+    EXPECT_TRUE(contains(text, "# TYPE test_counter_total counter\n"));
+    EXPECT_TRUE(contains(text, "test_counter_total{kind=\"a\\\"b\"} 4\n"));
+    EXPECT_TRUE(contains(text, "test_gauge 7\n"));
+}
+
+TEST(Metrics, histogram) {
+    Metrics::enable();
+    auto histogram = Metrics::histogram("test_seconds", "A test histogram.", {{"node", "x"}});
+    histogram.observe(0.002);
+    histogram.observe(0.2);
+    histogram.observe(100);
+
+    auto text = metrics();
+    EXPECT_TRUE(contains(text, "test_seconds_bucket{node=\"x\",le=\"0.001\"} 0\n"));
+    EXPECT_TRUE(contains(text, "test_seconds_bucket{node=\"x\",le=\"0.005\"} 1\n"));
+    EXPECT_TRUE(contains(text, "test_seconds_bucket{node=\"x\",le=\"10\"} 2\n"));
+    EXPECT_TRUE(contains(text, "test_seconds_bucket{node=\"x\",le=\"+Inf\"} 3\n"));
+    EXPECT_TRUE(contains(text, "test_seconds_count{node=\"x\"} 3\n"));
+}
+
+TEST(Metrics, named_channels_report_depth) {
+    Metrics::enable();
+    auto channel = make_channel<MessageChannel>("test_node");
+    channel.output.push(1);
+    channel.output.push(2);
+    channel.input.pop();
+
+    auto text = metrics();
+    EXPECT_TRUE(contains(text, "gadgetron_node_queue_depth{node=\"test_node\"} 1\n"));
+    EXPECT_TRUE(contains(text, "gadgetron_node_messages_total{node=\"test_node\"} 1\n"));
+}
+
+TEST(Metrics, destroyed_channels_leave_no_depth) {
+    Metrics::enable();
+    {
+        auto channel = make_channel<MessageChannel>("dropped_node");
+        channel.output.push(1);
+        channel.output.push(2);
+    }
+
+    EXPECT_TRUE(contains(metrics(), "gadgetron_node_queue_depth{node=\"dropped_node\"} 0\n"));
+}
+
+#if !(_WIN32)
+TEST(Metrics, visible_across_fork) {
+    Metrics::enable();
+    auto counter = Metrics::counter("test_forked_total", "Incremented by a child process.");
+
+    auto pid = fork();
+    if (pid == 0) {
+        counter.increment(5);
+        Metrics::counter("test_child_total", "Registered by a child process.").increment();
+        _exit(0);
+    }
+    int status;
+    waitpid(pid, &status, 0);
+
+    auto text = metrics();
+    EXPECT_TRUE(contains(text, "test_forked_total 5\n"));
+    EXPECT_TRUE(contains(text, "test_child_total 1\n"));
+}
+
+TEST(Metrics, registration_survives_a_process_dying_with_the_table_locked) {
+    Metrics::enable();
+
+    // The child registers metrics until it is killed, most likely while holding the table lock at some point.
+    auto pid = fork();
+    if (pid == 0) {
+        for (size_t i = 0;; i++) Metrics::counter("test_dying_total", "Registered by a dying process.", {{"i", std::to_string(i % 256)}});
+    }
+    usleep(20000);
+    kill(pid, SIGKILL);
+    int status;
+    waitpid(pid, &status, 0);
+
+    Metrics::counter("test_survivor_total", "Registered after the child died.").increment();
+    EXPECT_TRUE(contains(metrics(), "test_survivor_total 1\n"));
+}
+#endif
@@ -11,6 +11,7 @@
 #include "twoParaExpDecayOperator.h"
 #include "twoParaExpRecoveryOperator.h"
 #include "curveFittingCostFunction.h"
+#include "BatchedLM.h"
 #include "cmr_t1_mapping.h"
 #include <gtest/gtest.h>
 #include <boost/random.hpp>
@@ -247,9 +248,35 @@ void time_gadgetron(){
     std::cout << "Fitting tookz " << std::chrono::duration_cast<std::chrono::milliseconds>(end-start).count() << std::endl;
     std::cout << "Best cost " << best_cost << " " << b[0] << " " << b[1] <<  std::endl;
 }
+void time_batched(){
+
+    std::vector<float> y = {178, 185, 182, 189, 178, 180, 187, 179, 177, 177, 471};
+    auto x = std::vector<float>(11, 545);
+    x[10] = 10000;
+
+    // all ITERATIONS curves are fitted in one call, as the pixels of a map are
+    Gadgetron::Solver::BatchedLMSolver<Gadgetron::Solver::Models::ExpRecovery<float>> solver(x);
+    solver.max_iterations_ = 150;
+
+    std::vector<std::array<float, 2>> b(ITERATIONS);
+
+    auto start = std::chrono::system_clock::now();
+    Gadgetron::Solver::fit_batched(solver, ITERATIONS,
+        [&](size_t i, float* yi, std::array<float, 2>& guess) {
+            std::copy(y.begin(), y.end(), yi);
+            guess = {*std::max_element(y.begin(), y.end()), x[x.size() / 2]};
+        },
+        [&](size_t i, const std::array<float, 2>& bi, Gadgetron::Solver::BatchedLMStatus) { b[i] = bi; });
+    auto end = std::chrono::system_clock::now();
+
+    std::cout << "Fitting tookz " << std::chrono::duration_cast<std::chrono::milliseconds>(end-start).count() << std::endl;
+    std::cout << "B " << b.back()[0] << " " << b.back()[1] << std::endl;
+}
+
 using namespace Gadgetron;
 int main(){
     time_gadgetron();
+    time_batched();
     time_dlib();
     time_ceres();
 }
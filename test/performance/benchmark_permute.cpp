@@ -0,0 +1,40 @@
+//
+// Throughput of hoNDArray permute for the [RO E1 E2 CHA N S SLC] reorderings of the recon gadgets.
+//
+
+#include "hoNDArray_utils.h"
+
+#include <chrono>
+#include <complex>
+#include <iostream>
+#include <vector>
+
+#define ITERATIONS 20
+
+using namespace Gadgetron;
+
+int main() {
+    hoNDArray<std::complex<float>> array(std::vector<size_t>{256, 192, 1, 32, 4, 1, 2});
+    for (size_t i = 0; i < array.size(); i++) array[i] = std::complex<float>(float(i));
+
+    std::vector<std::vector<size_t>> orders = {
+        {3, 0, 1, 2, 4, 5, 6},  // CHA first, for coil combination
+        {1, 0, 2, 3, 4, 5, 6},  // E1 first, for the FFT along phase encoding
+        {0, 1, 2, 4, 3, 5, 6},  // swap CHA and N
+        {4, 3, 0, 1, 2, 5, 6},
+    };
+
+    for (auto const& order : orders) {
+        auto result = permute(array, order);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < ITERATIONS; i++) permute(array, result, order);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        std::cout << "permute ";
+        for (auto d : order) std::cout << d;
+        std::cout << ": " << elapsed.count() / ITERATIONS * 1e3 << " ms, "
+                  << array.get_number_of_bytes() * ITERATIONS / elapsed.count() / 1e9 << " GB/s" << std::endl;
+    }
+    return 0;
+}
@@ -13,6 +13,7 @@
 #include "writers/GadgetIsmrmrdWriter.h"
 #include "writers/ImageWriter.h"
 #include "writers/IsmrmrdImageArrayWriter.h"
+#include "writers/ImageArraySplitWriter.h"
 #include "writers/AcquisitionBucketWriter.h"
 #include <gtest/gtest.h>
 #include <mri_core_acquisition_bucket.h>
@@ -161,6 +162,46 @@ TEST(ReadWriteTest, ImageTest) {
     ASSERT_EQ(data, std::get<hoNDArray<int>>(value));
 }
 
+TEST(ReadWriteTest, ImageArraySplitTest) {
+    using namespace Gadgetron;
+    using namespace Gadgetron::Core;
+
+    IsmrmrdImageArray img_array;
+    img_array.data_ = hoNDArray<std::complex<float>>(8, 6, 1, 2, 3, 2, 1);
+    img_array.headers_ = hoNDArray<ISMRMRD::ImageHeader>(3, 2, 1);
+    img_array.meta_.resize(6);
+
+    std::default_random_engine engine(4242);
+    std::uniform_real_distribution<float> dist(-100, 100);
+    for (auto& d : img_array.data_) d = { dist(engine), dist(engine) };
+
+    for (size_t frame = 0; frame < 6; frame++) {
+        auto& header = img_array.headers_[frame];
+        header = ISMRMRD::ImageHeader{};
+        header.image_index = frame;
+        img_array.meta_[frame].set("GADGETRON_DataRole", "Image");
+        img_array.meta_[frame].set("GADGETRON_ImageNumber", long(frame / 2));
+    }
+
+    auto expected = std::stringstream();
+    auto image_writer = Core::Writers::ImageWriter();
+    for (size_t frame = 0; frame < 6; frame++) {
+        auto data = hoNDArray<std::complex<float>>(8, 6, 1, 2);
+        std::copy_n(img_array.data_.begin() + frame * data.size(), data.size(), data.begin());
+        image_writer.write(expected, Core::Message(img_array.headers_[frame], data, img_array.meta_[frame]));
+    }
+
+    auto stream  = std::stringstream();
+    auto message = Core::Message(img_array);
+    auto writer  = Core::Writers::ImageArraySplitWriter();
+
+    ASSERT_TRUE(writer.accepts(message));
+
+    writer.write(stream, std::move(message));
+
+    ASSERT_EQ(expected.str(), stream.str());
+}
+
 TEST(ReadWriteTest, BucketTest) {
     using namespace Gadgetron;
     using namespace Gadgetron::Core;
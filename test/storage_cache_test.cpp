@@ -0,0 +1,146 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <boost/filesystem.hpp>
+
+#include "StorageCache.h"
+
+using namespace Gadgetron;
+using namespace Gadgetron::Storage;
+using namespace testing;
+
+namespace {
+
+class MockUpstream : public StorageClient {
+  public:
+    MockUpstream() : StorageClient("address") {}
+
+    MOCK_METHOD(std::shared_ptr<std::istream>, get_latest_item, (StorageItemTags const& tags), (override));
+
+    MOCK_METHOD(StorageItem, store_item,
+                (StorageItemTags const& tags, std::istream& data, std::optional<std::chrono::seconds> time_to_live),
+                (override));
+};
+
+std::string read_all(std::istream& stream) { return std::string(std::istreambuf_iterator<char>(stream), {}); }
+
+std::shared_ptr<std::istream> stream_of(std::string const& s) {
+    return std::make_shared<BufferStream>(std::make_shared<const std::string>(s));
+}
+
+class StorageCacheTest : public ::testing::Test {
+  protected:
+    StorageCacheTest()
+        : directory(boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()),
+          tags(StorageItemTags::Builder("subject").with_session("session").with_name("noise_covariance").build()) {}
+
+    ~StorageCacheTest() override { boost::filesystem::remove_all(directory); }
+
+    std::shared_ptr<StorageCache> make_cache(size_t memory_capacity = 1 << 20,
+                                             std::string server = "http://localhost:9112") {
+        return std::make_shared<StorageCache>(directory, 1 << 20, memory_capacity, std::chrono::hours(1), server);
+    }
+
+    boost::filesystem::path directory;
+    StorageItemTags tags;
+};
+} // namespace
+
+TEST_F(StorageCacheTest, repeated_reads_are_served_from_the_cache) {
+    auto upstream = std::make_shared<MockUpstream>();
+    EXPECT_CALL(*upstream, get_latest_item(_)).Times(1).WillOnce(Return(stream_of("covariance")));
+
+    CachingStorageClient client(upstream, make_cache());
+    ASSERT_EQ(read_all(*client.get_latest_item(tags)), "covariance");
+    ASSERT_EQ(read_all(*client.get_latest_item(tags)), "covariance");
+}
+
+TEST_F(StorageCacheTest, missing_items_are_not_cached) {
+    auto upstream = std::make_shared<MockUpstream>();
+    EXPECT_CALL(*upstream, get_latest_item(_)).Times(2).WillRepeatedly(Return(nullptr));
+
+    CachingStorageClient client(upstream, make_cache());
+    ASSERT_FALSE(client.get_latest_item(tags));
+    ASSERT_FALSE(client.get_latest_item(tags));
+}
+
+TEST_F(StorageCacheTest, stores_are_written_through_and_retried) {
+    auto upstream = std::make_shared<MockUpstream>();
+    EXPECT_CALL(*upstream, get_latest_item(_)).Times(0);
+
+    std::string uploaded;
+    EXPECT_CALL(*upstream, store_item(_, _, Eq(std::chrono::seconds(60))))
+        .WillOnce(Throw(std::runtime_error("unavailable")))
+        .WillOnce(DoAll(Invoke([&](auto const&, std::istream& data, auto) { uploaded = read_all(data); }),
+                        Return(StorageItem{})));
+
+    CachingStorageClient client(upstream, make_cache());
+    std::stringstream data("calibration");
+    client.store_item(tags, data, std::chrono::seconds(60));
+
+    ASSERT_EQ(read_all(*client.get_latest_item(tags)), "calibration");
+
+    client.flush();
+    ASSERT_EQ(uploaded, "calibration");
+}
+
+TEST_F(StorageCacheTest, failed_uploads_are_reported_once) {
+    auto upstream = std::make_shared<MockUpstream>();
+    EXPECT_CALL(*upstream, store_item(_, _, _)).WillRepeatedly(Throw(std::runtime_error("unavailable")));
+
+    CachingStorageClient client(upstream, make_cache(), 0);
+    std::stringstream data("calibration");
+    client.store_item(tags, data);
+
+    ASSERT_THROW(client.flush(), std::runtime_error);
+    ASSERT_NO_THROW(client.flush());
+    ASSERT_EQ(read_all(*client.get_latest_item(tags)), "calibration");
+}
+
+TEST_F(StorageCacheTest, stored_buffers_are_not_copied) {
+    auto upstream = std::make_shared<MockUpstream>();
+    EXPECT_CALL(*upstream, store_item(_, _, _)).WillOnce(Return(StorageItem{}));
+
+    CachingStorageClient client(upstream, make_cache());
+    auto buffer = std::make_shared<const std::string>("coil maps");
+    BufferStream data(buffer);
+    client.store_item(tags, data);
+
+    auto cached = std::dynamic_pointer_cast<BufferStream>(client.get_latest_item(tags));
+    ASSERT_TRUE(cached);
+    ASSERT_EQ(cached->buffer(), buffer);
+    client.flush();
+}
+
+TEST_F(StorageCacheTest, disk_entries_are_shared_between_caches) {
+    auto writer = std::make_shared<MockUpstream>();
+    EXPECT_CALL(*writer, store_item(_, _, _)).WillOnce(Return(StorageItem{}));
+    {
+        CachingStorageClient client(writer, make_cache());
+        std::stringstream data("coil maps");
+        client.store_item(tags, data);
+    }
+
+    auto reader = std::make_shared<MockUpstream>();
+    EXPECT_CALL(*reader, get_latest_item(_)).Times(0);
+
+    CachingStorageClient client(reader, make_cache(0));
+    ASSERT_EQ(read_all(*client.get_latest_item(tags)), "coil maps");
+}
+
+TEST_F(StorageCacheTest, entries_are_scoped_to_their_server) {
+    make_cache()->insert(tags, std::make_shared<const std::string>("a"));
+
+    ASSERT_FALSE(make_cache(0, "http://localhost:9113")->find(tags));
+    ASSERT_TRUE(make_cache(0)->find(tags));
+}
+
+TEST_F(StorageCacheTest, tags_are_matched_exactly) {
+    auto cache = make_cache();
+    cache->insert(tags, std::make_shared<const std::string>("a"));
+
+    auto other = tags;
+    other.custom_tags.insert({"measurement", "other"});
+    ASSERT_FALSE(cache->find(other));
+    ASSERT_TRUE(cache->find(tags));
+}
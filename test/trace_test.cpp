@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+
+#include "Channel.h"
+#include "GadgetronTimer.h"
+#include "trace.h"
+
+#include <sstream>
+#include <thread>
+
+using namespace Gadgetron;
+
+namespace {
+    std::string trace_of(uint32_t session) {
+        std::stringstream stream;
+        Trace::write_chrome_trace(stream, session);
+        return stream.str();
+    }
+
+    size_t count(const std::string& haystack, const std::string& needle) {
+        size_t n = 0;
+        for (auto pos = haystack.find(needle); pos != std::string::npos; pos = haystack.find(needle, pos + 1)) n++;
+        return n;
+    }
+}
+
+TEST(Trace, disabled_records_nothing) {
+    Trace::enable(false);
+    auto session = Trace::new_session();
+    Trace::set_session(session);
+
+    { GADGETRON_TRACE_SCOPE("untraced"); }
+
+    EXPECT_EQ(count(trace_of(session), "untraced"), 0);
+    Trace::set_session(0);
+}
+
+TEST(Trace, scopes_are_grouped_by_session) {
+    Trace::enable();
+    auto first = Trace::new_session();
+    auto second = Trace::new_session();
+
+    std::thread([=]() {
+        Trace::set_session(first);
+        Trace::set_thread_name("first \"node\"");
+        GADGETRON_TRACE_SCOPE("first_scope");
+    }).join();
+
+    std::thread([=]() {
+        Trace::set_session(second);
+        GADGETRON_TRACE_SCOPE("second_scope");
+    }).join();
+
+    Trace::enable(false);
+
+    auto trace = trace_of(first);
+    EXPECT_EQ(count(trace, "\"first_scope\""), 1);
+    EXPECT_EQ(count(trace, "second_scope"), 0);
+    EXPECT_EQ(count(trace, "first \\\"node\\\""), 1);
+    EXPECT_EQ(trace.front(), '{');
+    EXPECT_EQ(count(trace_of(second), "\"second_scope\""), 1);
+}
+
+TEST(Trace, channels_record_queue_time) {
+    Trace::enable();
+    auto session = Trace::new_session();
+    Trace::set_session(session);
+
+    auto channel = Core::make_channel<Core::MessageChannel>();
+    channel.output.push(1);
+    channel.output.push(2);
+    channel.input.pop();
+    channel.input.pop();
+
+    Trace::enable(false);
+    Trace::set_session(0);
+
+    auto trace = trace_of(session);
+    EXPECT_EQ(count(trace, "\"dequeue\""), 2);
+    EXPECT_EQ(count(trace, "\"queued_us\""), 2);
+    EXPECT_EQ(count(trace, "\"process\""), 1);
+}
+
+TEST(Trace, timers_record_sections_under_their_current_name) {
+    Trace::enable();
+    auto session = Trace::new_session();
+    Trace::set_session(session);
+
+    GadgetronTimer timer(false);
+    timer.start("first_section");
+    timer.stop();
+    timer.start("first_section");
+    timer.stop();
+    timer.start("second_section");
+    timer.stop();
+
+    Trace::enable(false);
+    Trace::set_session(0);
+
+    auto trace = trace_of(session);
+    EXPECT_EQ(count(trace, "\"first_section\""), 2);
+    EXPECT_EQ(count(trace, "\"second_section\""), 1);
+}
@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+
+#include "WriterDispatch.h"
+
+#include <sstream>
+
+using namespace Gadgetron::Core;
+
+namespace {
+
+    template<class... ARGS>
+    class CountingWriter : public TypedWriter<ARGS...> {
+    public:
+        bool accepts(const Message &message) override {
+            probes++;
+            return TypedWriter<ARGS...>::accepts(message);
+        }
+
+        size_t probes = 0;
+        size_t written = 0;
+
+    protected:
+        void serialize(std::ostream &, const ARGS &...) override { written++; }
+    };
+}
+
+TEST(WriterDispatch, picks_first_accepting_writer) {
+    std::vector<std::unique_ptr<Writer>> writers;
+    writers.push_back(std::make_unique<CountingWriter<int, float>>());
+    writers.push_back(std::make_unique<CountingWriter<int>>());
+    writers.push_back(std::make_unique<CountingWriter<std::string>>());
+
+    WriterDispatch dispatch{writers};
+
+    EXPECT_EQ(dispatch.find(Message(1, 2.0f)), 0u);
+    EXPECT_EQ(dispatch.find(Message(1)), 1u);
+    EXPECT_EQ(dispatch.find(Message(std::string("text"))), 2u);
+    EXPECT_EQ(dispatch.find(Message(2.0)), WriterDispatch::none);
+    EXPECT_FALSE(dispatch.accepts(Message(2.0)));
+}
+
+TEST(WriterDispatch, probes_writers_once_per_signature) {
+    std::vector<std::unique_ptr<Writer>> writers;
+    writers.push_back(std::make_unique<CountingWriter<std::string>>());
+    writers.push_back(std::make_unique<CountingWriter<int>>());
+
+    WriterDispatch dispatch{writers};
+    std::stringstream stream;
+
+    for (int i = 0; i < 100; i++) {
+        Message message(i);
+        auto index = dispatch.find(message);
+        ASSERT_EQ(index, 1u);
+        dispatch[index].write(stream, std::move(message));
+    }
+
+    auto &first = static_cast<CountingWriter<std::string> &>(*writers[0]);
+    auto &second = static_cast<CountingWriter<int> &>(*writers[1]);
+    EXPECT_EQ(first.probes, 1u);
+    EXPECT_EQ(second.probes, 1u);
+    EXPECT_EQ(second.written, 100u);
+}
+
+TEST(WriterDispatch, writers_looking_at_values_are_asked_every_time) {
+    class EvenWriter : public CountingWriter<int> {
+    public:
+        bool accepts(const Message &message) override {
+            probes++;
+            if (!convertible_to<int>(message)) return false;
+            return static_cast<const TypedMessageChunk<int> &>(*message.messages().front()).data % 2 == 0;
+        }
+        bool accepts_by_type() const override { return false; }
+    };
+
+    std::vector<std::unique_ptr<Writer>> writers;
+    writers.push_back(std::make_unique<EvenWriter>());
+    writers.push_back(std::make_unique<CountingWriter<int>>());
+
+    WriterDispatch dispatch{writers};
+
+    for (int i = 0; i < 10; i++) EXPECT_EQ(dispatch.find(Message(i)), i % 2 ? 1u : 0u);
+
+    auto &even = static_cast<EvenWriter &>(*writers[0]);
+    auto &any = static_cast<CountingWriter<int> &>(*writers[1]);
+    EXPECT_EQ(even.probes, 10u);
+    EXPECT_EQ(any.probes, 1u);
+}
@@ -1,5 +1,5 @@
 #include "t1fit.h"
-#include "HybridLM.h"
+#include "BatchedLM.h"
 #include "hoArmadillo.h"
 #include "hoNDArray_math.h"
 #include <vector>
@@ -13,43 +13,6 @@ namespace {
 using namespace Gadgetron;
 using namespace Gadgetron::T1;
 
-template <class T> struct T1starResidual_2param {
-    const std::vector<T>& TI;
-    const std::vector<T>& measurement;
-
-    void operator()(const arma::Col<T>& params, arma::Col<T>& residual, arma::Mat<T>& jacobian) const {
-        const auto& T1 = params[0];
-        const auto& A = params[1];
-
-        for (int i = 0; i < residual.n_elem; i++) {
-            T coeff = T(2) * std::exp(-TI[i] / T1);
-            residual(i) = measurement[i] - A * (T(1) - coeff);
-            jacobian(i, 0) = A*TI[i] * coeff / (T1*T1);
-            jacobian(i, 1) = coeff-1;
-        }
-    }
-};
-
-template <class T> struct T1starResidual_3param {
-    const std::vector<T>& TI;
-    const std::vector<T>& measurement;
-
-    void operator()(const arma::Col<T>& params, arma::Col<T>& residual, arma::Mat<T>& jacobian) const {
-        const auto& T1s = params[0];
-        const auto& A = params[1];
-        const auto& B = params[2];
-
-        for (int i = 0; i < residual.n_elem; i++) {
-            T coeff = std::exp(-TI[i] / T1s);
-            residual(i) = measurement[i] - (A - B * coeff );
-            jacobian(i, 0) = B*TI[i]*coeff/(T1s*T1s);
-            jacobian(i, 1) = -1;
-            jacobian(i, 2) = coeff;
-        }
-
-    }
-};
-
 template <class T> struct T1Residual_3param {
     const std::vector<T>& TI;
     const std::vector<T>& measurement;
@@ -77,52 +40,47 @@ struct T1_2param_value {
     float A;
 };
 
-template <class T> T1_2param_value fit_T1_2param_single(const std::vector<T>& TI, const std::vector<T>& data) {
+struct T1_3param_value {
+    float T1;
+    float A;
+    float B;
+};
+
+constexpr size_t max_iterations = 1000;
 
-    T A = *std::max_element(data.begin(), data.end()) - *std::min_element(data.begin(), data.end());
-    T T1 = 800;
+using T1_2param_solver = Solver::BatchedLMSolver<Solver::Models::InversionRecovery<float>>;
+using T1_3param_solver = Solver::BatchedLMSolver<Solver::Models::ThreeParamInversionRecovery<float>>;
 
-    T1starResidual_2param<T> f{TI, data};
+std::array<float, 2> initial_guess_2param(const float* data, size_t length) {
+    auto [min, max] = std::minmax_element(data, data + length);
+    return {800, *max - *min};
+}
+
+std::array<float, 3> initial_guess_3param(const float* data, size_t length) {
+    auto [min, max] = std::minmax_element(data, data + length);
+    return {800, *max, *max - *min};
+}
 
-    Solver::HybridLMSolver<T> solver(data.size(), 2);
-    arma::Col<T> params{T1, A};
-    auto status = solver.solve(f, params);
+T1_2param_value to_value(const std::array<float, 2>& params, Solver::BatchedLMStatus status) {
     switch (status) {
-    case Solver::ReturnStatus::LINEAR_SOLVER_FAILED:
-        return {std::numeric_limits<T>::quiet_NaN(), std::numeric_limits<T>::quiet_NaN()};
-    case Solver::ReturnStatus::MAX_ITERATIONS_REACHED:
+    case Solver::BatchedLMStatus::LINEAR_SOLVER_FAILED:
+        return {std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::quiet_NaN()};
+    case Solver::BatchedLMStatus::MAX_ITERATIONS_REACHED:
         return {0, 0};
-    case Solver::ReturnStatus::SUCCESS:
+    case Solver::BatchedLMStatus::SUCCESS:
         break;
     }
-
     return {params[0], params[1]};
 }
 
-struct T1_3param_value {
-    float T1;
-    float A;
-    float B;
-};
-
-template <class T> T1_3param_value fit_T1_3param_single(const std::vector<T>& TI, const std::vector<T>& data) {
-
-    T A = *std::max_element(data.begin(), data.end());
-    T B = A - *std::min_element(data.begin(), data.end());
-    T T1 = 800;
-
-    T1starResidual_3param<T> f{TI, data};
-
-    Solver::HybridLMSolver<T> solver(data.size(), 3);
-    arma::Col<T> params{T1, A, B};
-    auto status = solver.solve(f, params);
+T1_3param_value to_value(const std::array<float, 3>& params, Solver::BatchedLMStatus status) {
     switch (status) {
-    case Solver::ReturnStatus::LINEAR_SOLVER_FAILED:
-        return {std::numeric_limits<T>::quiet_NaN(), std::numeric_limits<T>::quiet_NaN(),
-                std::numeric_limits<T>::quiet_NaN()};
-    case Solver::ReturnStatus::MAX_ITERATIONS_REACHED:
-        return {0,0,0};
-    case Solver::ReturnStatus::SUCCESS:
+    case Solver::BatchedLMStatus::LINEAR_SOLVER_FAILED:
+        return {std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::quiet_NaN(),
+                std::numeric_limits<float>::quiet_NaN()};
+    case Solver::BatchedLMStatus::MAX_ITERATIONS_REACHED:
+        return {0, 0, 0};
+    case Solver::BatchedLMStatus::SUCCESS:
         break;
     }
     return {params[0], params[1], params[2]};
@@ -238,29 +196,29 @@ T1_2param Gadgetron::T1::fit_T1_2param(const hoNDArray<float>& data, const std::
     auto A = hoNDArray<float>({data.get_size(0), data.get_size(1)});
     auto T1 = A;
 
-#pragma omp parallel
-    {
-        std::vector<float> data_view(TI.size());
-#pragma omp for
-        for (int y = 0; y < (int)data.get_size(1); y++) {
-            for (int x = 0; x < (int)data.get_size(0); x++) {
-                for (int t = 0; t < (int)TI.size(); t++) {
-                    data_view[t] = data(x, y, t);
-                }
+    const size_t pixels = A.size();
 
-                auto result = fit_T1_2param_single<float>(TI, data_view);
+    T1_2param_solver solver(TI);
+    solver.max_iterations_ = max_iterations;
+
+    Solver::fit_batched(
+        solver, pixels,
+        [&](size_t i, float* y, auto& params) {
+            for (size_t t = 0; t < TI.size(); t++) y[t] = data[i + t * pixels];
+            params = initial_guess_2param(y, TI.size());
+        },
+        [&](size_t i, const auto& params, auto status) {
+            auto result = to_value(params, status);
+            A[i] = result.A;
+            T1[i] = result.T1;
+        });
 
-                A(x, y) = result.A;
-                T1(x, y) = result.T1;
-            }
-        }
-    }
     return {A, T1};
 }
 
 namespace {
 
-float calculate_residual(const T1_2param_value vals, const std::vector<float>& TI, const std::vector<float>& data) {
+float calculate_residual(const T1_2param_value vals, const std::vector<float>& TI, const float* data) {
     float result = 0;
     for (int i = 0; i < (int)TI.size(); i++) {
         auto diff = data[i] - vals.A * (1 - 2 * std::exp(-TI[i] / vals.T1));
@@ -269,7 +227,7 @@ float calculate_residual(const T1_2param_value vals, const std::vector<float>& T
     return std::sqrt(result);
 }
 
-float calculate_residual(const T1_3param_value vals, const std::vector<float>& TI, const std::vector<float>& data) {
+float calculate_residual(const T1_3param_value vals, const std::vector<float>& TI, const float* data) {
     float result = 0;
     for (int i = 0; i < (int)TI.size(); i++) {
         auto diff = data[i] - (vals.A - vals.B * std::exp(-TI[i] / vals.T1));
@@ -278,6 +236,49 @@ float calculate_residual(const T1_3param_value vals, const std::vector<float>& T
     return std::sqrt(result);
 }
 
+/**
+ * Magnitude of pixel i with the signs of the first 'flipped' samples inverted. Fitting every number of flipped
+ * samples and keeping the best fit recovers the sign of the inversion recovery curve.
+ */
+void load_sign_flipped(const hoNDArray<std::complex<float>>& data, size_t pixels, size_t length, size_t i,
+                       size_t flipped, float* y) {
+    for (size_t t = 0; t < length; t++) {
+        y[t] = std::abs(data[i + t * pixels]);
+        if (t < flipped)
+            y[t] = -y[t];
+    }
+}
+
+/**
+ * Calls store(i, best) with the fit of pixel i that has the smallest residual over all sign flips; values holds
+ * the fits of every pixel and sign flip, as produced for load_sign_flipped.
+ */
+template <class VALUE, class STORE>
+void select_best_sign(const hoNDArray<std::complex<float>>& data, const std::vector<float>& TI,
+                      const std::vector<VALUE>& values, STORE&& store) {
+    const size_t length = TI.size();
+    const size_t pixels = values.size() / length;
+
+#pragma omp parallel
+    {
+        std::vector<float> y(length);
+#pragma omp for
+        for (long long i = 0; i < (long long)pixels; i++) {
+            size_t best = 0;
+            float best_residual = 0;
+            for (size_t flipped = 0; flipped < length; flipped++) {
+                load_sign_flipped(data, pixels, length, i, flipped, y.data());
+                float residual = calculate_residual(values[i * length + flipped], TI, y.data());
+                if (flipped == 0 || residual < best_residual) {
+                    best = flipped;
+                    best_residual = residual;
+                }
+            }
+            store(i, values[i * length + best]);
+        }
+    }
+}
+
 } // namespace
 
 T1_2param Gadgetron::T1::fit_T1_2param(const hoNDArray<std::complex<float>>& data, const std::vector<float>& TI) {
@@ -289,36 +290,27 @@ T1_2param Gadgetron::T1::fit_T1_2param(const hoNDArray<std::complex<float>>& dat
     auto A = hoNDArray<float>(data.get_size(0), data.get_size(1));
     auto T1 = A;
 
-#pragma omp parallel
-    {
-        std::vector<float> data_view(TI.size());
-        std::vector<float> residual(TI.size());
-        std::vector<float> A_values(TI.size());
-        std::vector<float> T1_values(TI.size());
+    const size_t pixels = A.size();
+    const size_t length = TI.size();
 
-#pragma omp for
-        for (int y = 0; y < (int)data.get_size(1); y++) {
-            for (int x = 0; x < (int)data.get_size(0); x++) {
-                for (int t = 0; t < (int)TI.size(); t++) {
-                    data_view[t] = std::abs(data(x, y, t));
-                }
+    // One curve for every pixel and sign flip; curve c is pixel c / length with c % length flipped samples.
+    std::vector<T1_2param_value> values(pixels * length);
 
-                for (int t = 0; t < (int)TI.size(); t++) {
-                    for (int k = 0; k < t; k++) {
-                        data_view[k] = -std::abs(data_view[k]);
-                    }
-                    auto result = fit_T1_2param_single<float>(TI, data_view);
-                    A_values[t] = result.A;
-                    T1_values[t] = result.T1;
-                    residual[t] = calculate_residual(result, TI, data_view);
-                }
+    T1_2param_solver solver(TI);
+    solver.max_iterations_ = max_iterations;
 
-                auto smallest_residual_index = std::min_element(residual.begin(), residual.end()) - residual.begin();
-                A(x, y) = A_values[smallest_residual_index];
-                T1(x, y) = T1_values[smallest_residual_index];
-            }
-        }
-    }
+    Solver::fit_batched(
+        solver, pixels * length,
+        [&](size_t c, float* y, auto& params) {
+            load_sign_flipped(data, pixels, length, c / length, c % length, y);
+            params = initial_guess_2param(y, length);
+        },
+        [&](size_t c, const auto& params, auto status) { values[c] = to_value(params, status); });
+
+    select_best_sign(data, TI, values, [&](size_t i, const T1_2param_value& best) {
+        A[i] = best.A;
+        T1[i] = best.T1;
+    });
     return {A, T1};
 }
 
@@ -332,24 +324,24 @@ T1_3param Gadgetron::T1::fit_T1_3param(const hoNDArray<float>& data, const std::
     auto B = hoNDArray<float>({data.get_size(0), data.get_size(1)});
     auto T1 = hoNDArray<float>({data.get_size(0), data.get_size(1)});
 
-#pragma omp parallel
-    {
-        std::vector<float> data_view(TI.size());
-#pragma omp for
-        for (int y = 0; y < (int)data.get_size(1); y++) {
-            for (int x = 0; x < (int)data.get_size(0); x++) {
-                for (int t = 0; t < (int)TI.size(); t++) {
-                    data_view[t] = data(x, y, t);
-                }
+    const size_t pixels = A.size();
 
-                auto result = fit_T1_3param_single<float>(TI, data_view);
+    T1_3param_solver solver(TI);
+    solver.max_iterations_ = max_iterations;
+
+    Solver::fit_batched(
+        solver, pixels,
+        [&](size_t i, float* y, auto& params) {
+            for (size_t t = 0; t < TI.size(); t++) y[t] = data[i + t * pixels];
+            params = initial_guess_3param(y, TI.size());
+        },
+        [&](size_t i, const auto& params, auto status) {
+            auto result = to_value(params, status);
+            A[i] = result.A;
+            B[i] = result.B;
+            T1[i] = result.T1;
+        });
 
-                A(x, y) = result.A;
-                B(x, y) = result.B;
-                T1(x, y) = result.T1;
-            }
-        }
-    }
     return {A, B, T1};
 }
 T1_3param Gadgetron::T1::fit_T1_3param(const hoNDArray<std::complex<float>>& data, const std::vector<float>& TI) {
@@ -362,39 +354,27 @@ T1_3param Gadgetron::T1::fit_T1_3param(const hoNDArray<std::complex<float>>& dat
     auto B = A;
     auto T1 = A;
 
-#pragma omp parallel
-    {
-        std::vector<float> data_view(TI.size());
-        std::vector<float> residual(TI.size());
-        std::vector<float> A_values(TI.size());
-        std::vector<float> B_values(TI.size());
-        std::vector<float> T1_values(TI.size());
+    const size_t pixels = A.size();
+    const size_t length = TI.size();
 
-#pragma omp for
-        for (int y = 0; y < (int)data.get_size(1); y++) {
-            for (int x = 0; x < (int)data.get_size(0); x++) {
-                for (int t = 0; t < (int)TI.size(); t++) {
-                    data_view[t] = std::abs(data(x, y, t));
-                }
+    std::vector<T1_3param_value> values(pixels * length);
 
-                for (int t = 0; t < (int)TI.size(); t++) {
-                    for (int k = 0; k < t; k++) {
-                        data_view[k] = -std::abs(data_view[k]);
-                    }
-                    auto result = fit_T1_3param_single<float>(TI, data_view);
-                    A_values[t] = result.A;
-                    B_values[t] = result.B;
-                    T1_values[t] = result.T1;
-                    residual[t] = calculate_residual(result, TI, data_view);
-                }
+    T1_3param_solver solver(TI);
+    solver.max_iterations_ = max_iterations;
 
-                auto smallest_residual_index = std::min_element(residual.begin(), residual.end()) - residual.begin();
-                A(x, y) = A_values[smallest_residual_index];
-                B(x, y) = B_values[smallest_residual_index];
-                T1(x, y) = T1_values[smallest_residual_index];
-            }
-        }
-    }
+    Solver::fit_batched(
+        solver, pixels * length,
+        [&](size_t c, float* y, auto& params) {
+            load_sign_flipped(data, pixels, length, c / length, c % length, y);
+            params = initial_guess_3param(y, length);
+        },
+        [&](size_t c, const auto& params, auto status) { values[c] = to_value(params, status); });
+
+    select_best_sign(data, TI, values, [&](size_t i, const T1_3param_value& best) {
+        A[i] = best.A;
+        B[i] = best.B;
+        T1[i] = best.T1;
+    });
     return {A, B, T1};
 }
 hoNDArray<float> Gadgetron::T1::phase_correct(const hoNDArray<std::complex<float>>& data,
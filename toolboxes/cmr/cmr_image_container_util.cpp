@@ -32,15 +32,9 @@ namespace Gadgetron
 
                     if (Gadgetron::nrm2(a_image) > 0.1 && a_image.get_number_of_elements() > 0)
                     {
-                        hoNDBoundaryHandlerBorderValue< hoMRImage<T, D> > bhBorderValue(a_image);
-
-                        hoNDInterpolatorBSpline< hoMRImage<T, D>, D > interp(5);
-                        interp.setArray(a_image);
-
-                        hoMRImage<T, D> input_image(a_image);
                         hoMRImage<T, D> output_image;
 
-                        Gadgetron::resampleImage(input_image, interp, dim_out, output_image);
+                        Gadgetron::resampleImageBSpline(a_image, 5, dim_out, output_image);
                         output(slc, phs) = output_image;
 
                         output(slc, phs).header_ = input(slc, phs).header_;
@@ -112,15 +106,9 @@ namespace Gadgetron
 
                     if (Gadgetron::nrm2(a_image) > 0.1 && a_image.get_number_of_elements() > 0)
                     {
-                        hoNDBoundaryHandlerBorderValue< hoMRImage<T, D> > bhBorderValue(a_image);
-
-                        hoNDInterpolatorBSpline< hoMRImage<T, D>, D > interp(5);
-                        interp.setArray(a_image);
-
-                        hoMRImage<T, D> input_image(a_image);
                         hoMRImage<T, D> output_image;
 
-                        Gadgetron::resampleImage(input_image, interp, dim_out, output_image);
+                        Gadgetron::resampleImageBSpline(a_image, 5, dim_out, output_image);
                         output(slc, phs) = output_image;
                     }
                     else
@@ -17,6 +17,8 @@
 #include "cmr_motion_correction.h"
 #include "cmr_spirit_recon.h"
 #include <boost/math/special_functions/sign.hpp>
+#include <chrono>
+#include <future>
 
 namespace Gadgetron { 
 
@@ -132,6 +134,11 @@ CmrKSpaceBinning<T>::CmrKSpaceBinning()
     kspace_binning_nonlinear_reg_with_approx_coeff_ = false;
     kspace_binning_nonlinear_reg_wav_name_ = "db1";
 
+    incremental_calibration_frames_ = 16;
+    incremental_provisional_binning_ = true;
+    binning_cancelled_ = NULL;
+    this->begin_incremental_recon();
+
     verbose_ = false;
     perform_timing_ = false;
 
@@ -142,8 +149,17 @@ CmrKSpaceBinning<T>::CmrKSpaceBinning()
 template <typename T> 
 CmrKSpaceBinning<T>::~CmrKSpaceBinning()
 {
+    this->finish_provisional_binning(true);
 }
 
+template <typename T> 
+struct CmrKSpaceBinning<T>::ProvisionalBinning
+{
+    Self binning;
+    std::atomic<bool> cancelled;
+    std::future<void> done;
+};
+
 template <typename T> 
 void CmrKSpaceBinning<T>::process_binning_recon()
 {
@@ -165,7 +181,36 @@ void CmrKSpaceBinning<T>::process_binning_recon()
         // -----------------------------------------------------
         if ( this->perform_timing_ ) { gt_timer_.start("raw data recon ... "); }
 
-        this->perform_raw_data_recon();
+        GADGET_CHECK_THROW(binning_obj_.headers_.get_size(0)==E1);
+        GADGET_CHECK_THROW(binning_obj_.headers_.get_size(1)==N);
+        GADGET_CHECK_THROW(binning_obj_.headers_.get_size(2)==S);
+
+        // frames added incrementally are binning_obj_.data_, and are partly in eigen channels already
+        GADGET_CHECK_THROW(incremental_frames_==0 || incremental_frames_==N);
+
+        // the binning of the frames so far is of use only if it completes
+        this->finish_provisional_binning(true);
+
+        if(incremental_calibrated_frames_>0)
+        {
+            // the frames were already unwrapped as they arrived
+            resize_dimension(incremental_full_kspace_, 3, N);
+            resize_dimension(incremental_complex_image_, 3, N);
+            binning_obj_.full_kspace_raw_ = std::move(incremental_full_kspace_);
+            binning_obj_.complex_image_raw_ = std::move(incremental_complex_image_);
+        }
+        else
+        {
+            if(incremental_frames_>0)
+            {
+                GWARN_STREAM("Incremental raw data recon not calibrated on " << N << " frames, the whole series is reconstructed ... ");
+
+                this->calibrate_eigen_channels(kspace);
+                this->apply_eigen_channels(kspace, 0, N);
+            }
+
+            this->perform_raw_data_recon();
+        }
 
         if ( this->perform_timing_ ) { gt_timer_.stop(); }
 
@@ -173,6 +218,26 @@ void CmrKSpaceBinning<T>::process_binning_recon()
         if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(binning_obj_.complex_image_raw_, debug_folder_ + "complex_image_raw" + suffix_);
         if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(binning_obj_.coil_map_raw_, debug_folder_ + "coil_map_raw" + suffix_);
 
+        this->perform_binning();
+
+        this->begin_incremental_recon();
+    }
+    catch(...)
+    {
+        GADGET_THROW("Exceptions happened in CmrKSpaceBinning<T>::process_binning_recon() ... ");
+    }
+}
+
+template <typename T> 
+void CmrKSpaceBinning<T>::perform_binning()
+{
+    try
+    {
+        hoNDArray< ISMRMRD::AcquisitionHeader >& headers = binning_obj_.headers_;
+        size_t E1 = headers.get_size(0);
+        size_t N = headers.get_size(1);
+        size_t S = headers.get_size(2);
+
         // -----------------------------------------------------
         // estimate acquisition time stamp and cardiac phase time ratio for all acuqired kspace lines
         // count the heart beats and when it starts
@@ -191,6 +256,8 @@ void CmrKSpaceBinning<T>::process_binning_recon()
         if ( !debug_folder_.empty() ) gt_exporter_.export_array(binning_obj_.phs_time_stamp_, debug_folder_ + "phs_time_stamp" + suffix_);
         if ( !debug_folder_.empty() ) gt_exporter_.export_array(binning_obj_.phs_cpt_time_stamp_, debug_folder_ + "phs_cpt_time_stamp" + suffix_);
 
+        if ( binning_cancelled_ && *binning_cancelled_ ) return;
+
         // -----------------------------------------------------
         // estimate respiratory nativagor signal
         // -----------------------------------------------------
@@ -213,6 +280,8 @@ void CmrKSpaceBinning<T>::process_binning_recon()
 
         if ( !debug_folder_.empty() ) gt_exporter_.export_array(binning_obj_.navigator_, debug_folder_ + "respiratory_navigator" + suffix_);
 
+        if ( binning_cancelled_ && *binning_cancelled_ ) return;
+
         // -----------------------------------------------------
         // find the best heart beat from the respiratory navigator
         // -----------------------------------------------------
@@ -238,6 +307,8 @@ void CmrKSpaceBinning<T>::process_binning_recon()
         this->compute_kspace_binning(bestHB, slices_not_processing);
         if(binning_obj_.full_kspace_raw_.delete_data_on_destruct()) binning_obj_.full_kspace_raw_.clear();
 
+        if ( binning_cancelled_ && *binning_cancelled_ ) return;
+
         // -----------------------------------------------------
         // perform recon on the binned kspace 
         // -----------------------------------------------------
@@ -245,12 +316,35 @@ void CmrKSpaceBinning<T>::process_binning_recon()
     }
     catch(...)
     {
-        GADGET_THROW("Exceptions happened in CmrKSpaceBinning<T>::process_binning_recon() ... ");
+        GADGET_THROW("Exceptions happened in CmrKSpaceBinning<T>::perform_binning() ... ");
     }
 }
 
 template <typename T> 
 void CmrKSpaceBinning<T>::perform_raw_data_recon()
+{
+    try
+    {
+        ArrayType& data = this->binning_obj_.data_;
+        // if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(data, debug_folder_ + "raw_data_recon_data" + suffix_);
+
+        ArrayType& full_kspace = this->binning_obj_.full_kspace_raw_;
+        ArrayType& complex_image = this->binning_obj_.complex_image_raw_;
+
+        this->calibrate_raw_data_recon(data);
+        this->unwrap_raw_data(data, full_kspace, complex_image);
+
+        if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(complex_image, debug_folder_ + "raw_data_recon_Result_complex_image" + suffix_);
+        if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(full_kspace, debug_folder_ + "raw_data_recon_Result_full_kspace" + suffix_);
+    }
+    catch(...)
+    {
+        GADGET_THROW("Exceptions happened in CmrKSpaceBinning<T>::perform_raw_data_recon() ... ");
+    }
+}
+
+template <typename T> 
+void CmrKSpaceBinning<T>::calibrate_raw_data_recon(const ArrayType& data)
 {
     try
     {
@@ -260,11 +354,6 @@ void CmrKSpaceBinning<T>::perform_raw_data_recon()
             GADGET_THROW("To be implemented, random sampling binning ... ");
         }
 
-        ArrayType& data = this->binning_obj_.data_;
-        // if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(data, debug_folder_ + "raw_data_recon_data" + suffix_);
-
-        ArrayType& full_kspace = this->binning_obj_.full_kspace_raw_;
-        ArrayType& complex_image = this->binning_obj_.complex_image_raw_;
         ArrayType& coil_map = this->binning_obj_.coil_map_raw_;
 
         size_t RO = data.get_size(0);
@@ -280,9 +369,9 @@ void CmrKSpaceBinning<T>::perform_raw_data_recon()
         bool average_all_ref_N = true;
         bool average_all_ref_S = true;
 
-        ArrayType data_for_ref(RO, E1, 1, CHA, N, S, 1, data.begin()), ref;
+        ArrayType data_for_ref(RO, E1, 1, CHA, N, S, 1, const_cast< std::complex<T>* >(data.begin())), ref;
 
-        if ( this->perform_timing_ ) { gt_timer_.start("--> perform_raw_data_recon, prepare ref"); }
+        if ( this->perform_timing_ ) { gt_timer_.start("--> calibrate_raw_data_recon, prepare ref"); }
 
         Gadgetron::compute_averaged_data_N_S(data_for_ref, average_all_ref_N, average_all_ref_S, count_sampling_freq, ref);
 
@@ -324,7 +413,7 @@ void CmrKSpaceBinning<T>::perform_raw_data_recon()
             dstCHA = cha;
         }
 
-        GDEBUG_STREAM("--> perform_raw_data_recon, determine number of dst channels : " << dstCHA);
+        GDEBUG_STREAM("--> calibrate_raw_data_recon, determine number of dst channels : " << dstCHA);
 
         ArrayType ref_src(RO, E1, CHA, ref.begin());
         ArrayType ref_dst(RO, E1, dstCHA, ref.begin());
@@ -348,8 +437,8 @@ void CmrKSpaceBinning<T>::perform_raw_data_recon()
             lenRO = (end_RO - start_RO + 1);
         }
 
-        GDEBUG_STREAM("--> perform_raw_data_recon, RO sampling : [" << start_RO << " " << end_RO << "] out of " << RO);
-        GDEBUG_STREAM("--> perform_raw_data_recon, RO sampling : [" << start_E1 << " " << end_E1 << "] out of " << E1);
+        GDEBUG_STREAM("--> calibrate_raw_data_recon, RO sampling : [" << start_RO << " " << end_RO << "] out of " << RO);
+        GDEBUG_STREAM("--> calibrate_raw_data_recon, RO sampling : [" << start_E1 << " " << end_E1 << "] out of " << E1);
 
         // compute ref coil map filter
         ArrayType filter_RO_ref_coi_map;
@@ -374,7 +463,7 @@ void CmrKSpaceBinning<T>::perform_raw_data_recon()
         size_t ks = 7;
         size_t power = 3;
 
-        if ( this->perform_timing_ ) { gt_timer_.start("--> perform_raw_data_recon, compute coil map"); }
+        if ( this->perform_timing_ ) { gt_timer_.start("--> calibrate_raw_data_recon, compute coil map"); }
 
         Gadgetron::coil_map_2d_Inati(complex_im_coil_map, coil_map, ks, power);
 
@@ -393,12 +482,13 @@ void CmrKSpaceBinning<T>::perform_raw_data_recon()
         Gadgetron::grappa2d_kerPattern(kE1, oE1, convKRO, convKE1, (size_t)binning_obj_.accel_factor_E1_, grappa_kSize_RO_, grappa_kSize_E1_, fitItself);
 
         ArrayType convKer(convKRO, convKE1, CHA, dstCHA);
-        ArrayType kernelIm(RO, E1, CHA, dstCHA);
+        ArrayType& kernelIm = this->raw_recon_kernelIm_;
+        kernelIm.create(RO, E1, CHA, dstCHA);
 
         Gadgetron::clear(convKer);
         Gadgetron::clear(kernelIm);
 
-        if ( this->perform_timing_ ) { gt_timer_.start("--> perform_raw_data_recon, estimate grappa kernel"); }
+        if ( this->perform_timing_ ) { gt_timer_.start("--> calibrate_raw_data_recon, estimate grappa kernel"); }
         Gadgetron::grappa2d_calib_convolution_kernel(ref_src, ref_dst, (size_t)binning_obj_.accel_factor_E1_, grappa_reg_lamda_, grappa_kSize_RO_, grappa_kSize_E1_, convKer);
         Gadgetron::grappa2d_image_domain_kernel(convKer, RO, E1, kernelIm);
         if ( this->perform_timing_ ) { gt_timer_.stop(); }
@@ -407,40 +497,50 @@ void CmrKSpaceBinning<T>::perform_raw_data_recon()
         if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(kernelIm, debug_folder_ + "raw_data_recon_kernelIm" + suffix_);
 
         // compute unmixing coefficient
-        ArrayType unmixing_coeff;
+        ArrayType& unmixing_coeff = this->raw_recon_unmixing_coeff_;
         hoNDArray<T> gFactor;
         Gadgetron::grappa2d_unmixing_coeff(kernelIm, coil_map, (size_t)binning_obj_.accel_factor_E1_, unmixing_coeff, gFactor);
 
         if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(unmixing_coeff, debug_folder_ + "raw_data_recon_unmixing_coeff" + suffix_);
         if ( !debug_folder_.empty() ) gt_exporter_.export_array(gFactor, debug_folder_ + "raw_data_recon_gFactor" + suffix_);
 
-        // ------------------------------------------------
-        // perform reconstruction
-        // ------------------------------------------------
-
-        // compute aliased images
-        ArrayType aliased_im(data);
-        Gadgetron::hoNDFFT<T>::instance()->ifft2c(data, aliased_im);
-        if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(aliased_im, debug_folder_ + "raw_data_recon_aliased_im" + suffix_);
-
         // snr scaling
         float ROScalingFactor = (float)RO / (float)lenRO;
         float snr_scaling_ratio = (float)(std::sqrt(ROScalingFactor*binning_obj_.accel_factor_E1_));
 
         double grappaKernelCompensationFactor = 1.0 / (binning_obj_.accel_factor_E1_);
-        Gadgetron::scal((T)(grappaKernelCompensationFactor*snr_scaling_ratio), aliased_im);
+        this->raw_recon_scaling_ = (T)(grappaKernelCompensationFactor*snr_scaling_ratio);
 
-        GDEBUG_STREAM("--> perform_raw_data_recon, snr scaling factor : " << grappaKernelCompensationFactor*snr_scaling_ratio);
+        GDEBUG_STREAM("--> calibrate_raw_data_recon, snr scaling factor : " << this->raw_recon_scaling_);
+    }
+    catch(...)
+    {
+        GADGET_THROW("Exceptions happened in CmrKSpaceBinning<T>::calibrate_raw_data_recon(...) ... ");
+    }
+}
+
+template <typename T> 
+void CmrKSpaceBinning<T>::unwrap_raw_data(const ArrayType& data, ArrayType& full_kspace, ArrayType& complex_image)
+{
+    try
+    {
+        // data: [RO E1 CHA N S]
+        // compute aliased images
+        ArrayType aliased_im(data);
+        Gadgetron::hoNDFFT<T>::instance()->ifft2c(data, aliased_im);
+        if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(aliased_im, debug_folder_ + "raw_data_recon_aliased_im" + suffix_);
+
+        Gadgetron::scal(this->raw_recon_scaling_, aliased_im);
 
         // unwrapping
-        if ( this->perform_timing_ ) { gt_timer_.start("--> perform_raw_data_recon, apply grappa kernel"); }
+        if ( this->perform_timing_ ) { gt_timer_.start("--> unwrap_raw_data, apply grappa kernel"); }
 
-        Gadgetron::apply_unmix_coeff_aliased_image(aliased_im, unmixing_coeff, complex_image);
+        Gadgetron::apply_unmix_coeff_aliased_image(aliased_im, this->raw_recon_unmixing_coeff_, complex_image);
 
         if(this->use_multiple_channel_recon_)
         {
             // compute multi-channel full kspace
-            Gadgetron::grappa2d_image_domain_unwrapping_aliased_image(aliased_im, kernelIm, full_kspace);
+            Gadgetron::grappa2d_image_domain_unwrapping_aliased_image(aliased_im, this->raw_recon_kernelIm_, full_kspace);
             Gadgetron::hoNDFFT<T>::instance()->fft2c(full_kspace);
         }
         else
@@ -450,13 +550,373 @@ void CmrKSpaceBinning<T>::perform_raw_data_recon()
         }
 
         if ( this->perform_timing_ ) { gt_timer_.stop(); }
+    }
+    catch(...)
+    {
+        GADGET_THROW("Exceptions happened in CmrKSpaceBinning<T>::unwrap_raw_data(...) ... ");
+    }
+}
 
-        if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(complex_image, debug_folder_ + "raw_data_recon_Result_complex_image" + suffix_);
-        if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(full_kspace, debug_folder_ + "raw_data_recon_Result_full_kspace" + suffix_);
+template <typename T> 
+void CmrKSpaceBinning<T>::calibrate_eigen_channels(const ArrayType& data)
+{
+    try
+    {
+        // data: [RO E1 CHA N S]
+        size_t RO = data.get_size(0);
+        size_t E1 = data.get_size(1);
+        size_t CHA = data.get_size(2);
+        size_t N = data.get_size(3);
+        size_t S = data.get_size(4);
+
+        ArrayType data_for_ref(RO, E1, 1, CHA, N, S, 1, const_cast< std::complex<T>* >(data.begin())), ref;
+        Gadgetron::compute_averaged_data_N_S(data_for_ref, true, true, true, ref);
+
+        ArrayType ref_cha(RO, E1, CHA, ref.begin());
+        eigen_channels_.prepare(ref_cha, 2, (size_t)0);
     }
     catch(...)
     {
-        GADGET_THROW("Exceptions happened in CmrKSpaceBinning<T>::perform_raw_data_recon() ... ");
+        GADGET_THROW("Exceptions happened in CmrKSpaceBinning<T>::calibrate_eigen_channels(...) ... ");
+    }
+}
+
+template <typename T> 
+void CmrKSpaceBinning<T>::apply_eigen_channels(ArrayType& data, size_t start, size_t num)
+{
+    try
+    {
+        // data: [RO E1 CHA N S]
+        size_t RO = data.get_size(0);
+        size_t E1 = data.get_size(1);
+        size_t CHA = data.get_size(2);
+        size_t N = data.get_size(3);
+        size_t S = data.get_size(4);
+
+        GADGET_CHECK_THROW(start+num<=N);
+        GADGET_CHECK_THROW(eigen_channels_.output_length()==CHA);
+
+        ArrayType transformed;
+
+        size_t n, s;
+        for (s=0; s<S; s++)
+        {
+            for (n=start; n<start+num; n++)
+            {
+                ArrayType frame(RO, E1, CHA, &data(0, 0, 0, n, s));
+                eigen_channels_.transform(frame, transformed, 2);
+                memcpy(frame.begin(), transformed.begin(), frame.get_number_of_bytes());
+            }
+        }
+    }
+    catch(...)
+    {
+        GADGET_THROW("Exceptions happened in CmrKSpaceBinning<T>::apply_eigen_channels(...) ... ");
+    }
+}
+
+template <typename T> 
+void CmrKSpaceBinning<T>::begin_incremental_recon()
+{
+    this->finish_provisional_binning(true);
+
+    incremental_frames_ = 0;
+    incremental_calibrated_frames_ = 0;
+    incremental_sampled_lines_.clear();
+    incremental_full_kspace_.clear();
+    incremental_complex_image_.clear();
+    binning_obj_.kspace_binning_initial_.clear();
+}
+
+template <typename T> 
+void CmrKSpaceBinning<T>::add_incremental_frame(ArrayType& frames, const hoNDArray< ISMRMRD::AcquisitionHeader >& headers, size_t n)
+{
+    try
+    {
+        // frames: [RO E1 CHA N S], headers: [E1 N S]
+        size_t E1 = frames.get_size(1);
+        size_t N = frames.get_size(3);
+        size_t S = frames.get_size(4);
+
+        GADGET_CHECK_THROW(headers.get_size(0)==E1);
+        GADGET_CHECK_THROW(headers.get_size(1)==N);
+        GADGET_CHECK_THROW(headers.get_size(2)==S);
+        GADGET_CHECK_THROW(n==incremental_frames_ && n<N);
+
+        incremental_frames_++;
+
+        if(incremental_calibrated_frames_>0)
+        {
+            this->apply_eigen_channels(frames, n, 1);
+
+            // calibrate again once the frames doubled, unless it is too late to unwrap them all again, or the binning of the frames so far reads them
+            if( (incremental_frames_ < 2*incremental_calibrated_frames_) || (4*incremental_frames_ > 3*N) || this->provisional_binning_running() )
+            {
+                this->unwrap_incremental_frames(frames, n, 1);
+                return;
+            }
+        }
+        else
+        {
+            // the random sampling has no calibration; leave it to the recon on the whole series
+            if(binning_obj_.random_sampling_) return;
+
+            // calibrate once every line within the sampling limits was acquired, for every S
+            if(incremental_sampled_lines_.size()!=E1*S) incremental_sampled_lines_.assign(E1*S, false);
+
+            size_t e1, s;
+            for (s=0; s<S; s++)
+            {
+                for (e1=0; e1<E1; e1++)
+                {
+                    if(headers(e1, n, s).number_of_samples>0) incremental_sampled_lines_[e1+s*E1] = true;
+                }
+            }
+
+            if(incremental_frames_<incremental_calibration_frames_) return;
+
+            size_t startE1 = binning_obj_.sampling_.sampling_limits_[1].min_;
+            size_t endE1 = binning_obj_.sampling_.sampling_limits_[1].max_;
+            if(endE1>=E1) endE1 = E1-1;
+
+            for (s=0; s<S; s++)
+            {
+                for (e1=startE1; e1<=endE1; e1++)
+                {
+                    if(!incremental_sampled_lines_[e1+s*E1]) return;
+                }
+            }
+        }
+
+        // calibrate on the frames so far and unwrap them
+        GDEBUG_STREAM("--> add_incremental_frame, calibrate raw data recon on " << incremental_frames_ << " frames");
+
+        if ( this->perform_timing_ ) { gt_timer_local_.start("--> add_incremental_frame, calibrate raw data recon"); }
+
+        ArrayType calibration_frames;
+        if(incremental_calibrated_frames_==0)
+        {
+            this->leading_frames(frames, incremental_frames_, calibration_frames);
+            this->calibrate_eigen_channels(calibration_frames);
+            this->apply_eigen_channels(frames, 0, incremental_frames_);
+        }
+
+        this->leading_frames(frames, incremental_frames_, calibration_frames);
+        this->calibrate_raw_data_recon(calibration_frames);
+
+        if ( this->perform_timing_ ) { gt_timer_local_.stop(); }
+
+        this->unwrap_incremental_frames(frames, 0, incremental_frames_);
+
+        incremental_calibrated_frames_ = incremental_frames_;
+
+        if(incremental_provisional_binning_ && use_multiple_channel_recon_ && (4*incremental_frames_ >= N))
+        {
+            this->start_provisional_binning(headers, incremental_frames_);
+        }
+    }
+    catch(...)
+    {
+        GADGET_THROW("Exceptions happened in CmrKSpaceBinning<T>::add_incremental_frame(...) ... ");
+    }
+}
+
+template <typename T> 
+size_t CmrKSpaceBinning<T>::incremental_frames() const
+{
+    return incremental_frames_;
+}
+
+template <typename T> 
+void CmrKSpaceBinning<T>::unwrap_incremental_frames(const ArrayType& frames, size_t start, size_t num)
+{
+    try
+    {
+        // frames: [RO E1 CHA N S]
+        size_t RO = frames.get_size(0);
+        size_t E1 = frames.get_size(1);
+        size_t CHA = frames.get_size(2);
+        size_t N = frames.get_size(3);
+        size_t S = frames.get_size(4);
+
+        size_t dstCHA = this->use_multiple_channel_recon_ ? raw_recon_kernelIm_.get_size(3) : 1;
+
+        // the unwrapped frames have as much room as the frames
+        if(incremental_full_kspace_.get_size(2)!=dstCHA || incremental_full_kspace_.get_size(3)!=N)
+        {
+            // the binning of the frames so far reads the unwrapped frames
+            this->finish_provisional_binning(false);
+
+            if(incremental_full_kspace_.get_size(2)!=dstCHA)
+            {
+                incremental_full_kspace_.create(RO, E1, dstCHA, N, S);
+                incremental_complex_image_.create(RO, E1, 1, N, S);
+            }
+
+            resize_dimension(incremental_full_kspace_, 3, N);
+            resize_dimension(incremental_complex_image_, 3, N);
+        }
+
+        size_t s;
+        for (s=0; s<S; s++)
+        {
+            ArrayType data(RO, E1, CHA, num, 1, const_cast< std::complex<T>* >(&frames(0, 0, 0, start, s)));
+            ArrayType full_kspace(RO, E1, dstCHA, num, 1, &incremental_full_kspace_(0, 0, 0, start, s));
+            ArrayType complex_image(RO, E1, 1, num, 1, &incremental_complex_image_(0, 0, 0, start, s));
+
+            this->unwrap_raw_data(data, full_kspace, complex_image);
+        }
+    }
+    catch(...)
+    {
+        GADGET_THROW("Exceptions happened in CmrKSpaceBinning<T>::unwrap_incremental_frames(...) ... ");
+    }
+}
+
+template <typename T> 
+void CmrKSpaceBinning<T>::start_provisional_binning(const hoNDArray< ISMRMRD::AcquisitionHeader >& headers, size_t num)
+{
+    try
+    {
+        // headers: [E1 N S]
+        size_t E1 = headers.get_size(0);
+        size_t N = headers.get_size(1);
+        size_t S = headers.get_size(2);
+
+        GADGET_CHECK_THROW(num<=N);
+        GADGET_CHECK_THROW(!this->provisional_binning_running());
+
+        GDEBUG_STREAM("--> add_incremental_frame, start binning of " << num << " frames");
+
+        provisional_binning_ = std::make_shared<ProvisionalBinning>();
+        provisional_binning_->cancelled = false;
+
+        Self& binning = provisional_binning_->binning;
+        binning.binning_cancelled_ = &provisional_binning_->cancelled;
+
+        // only the linear recon of the binned kspace is of use
+        binning.use_multiple_channel_recon_ = use_multiple_channel_recon_;
+        binning.use_paralell_imaging_binning_recon_ = use_paralell_imaging_binning_recon_;
+        binning.use_nonlinear_binning_recon_ = false;
+        binning.estimate_respiratory_navigator_ = estimate_respiratory_navigator_;
+
+        binning.respiratory_navigator_moco_reg_strength_ = respiratory_navigator_moco_reg_strength_;
+        binning.respiratory_navigator_moco_iters_ = respiratory_navigator_moco_iters_;
+        binning.respiratory_navigator_patch_size_RO_ = respiratory_navigator_patch_size_RO_;
+        binning.respiratory_navigator_patch_size_E1_ = respiratory_navigator_patch_size_E1_;
+        binning.respiratory_navigator_patch_step_size_RO_ = respiratory_navigator_patch_step_size_RO_;
+        binning.respiratory_navigator_patch_step_size_E1_ = respiratory_navigator_patch_step_size_E1_;
+
+        binning.time_tick_ = time_tick_;
+        binning.trigger_time_index_ = trigger_time_index_;
+        binning.arrhythmia_rejector_factor_ = arrhythmia_rejector_factor_;
+
+        binning.kspace_binning_interpolate_heart_beat_images_ = kspace_binning_interpolate_heart_beat_images_;
+        binning.kspace_binning_navigator_acceptance_window_ = kspace_binning_navigator_acceptance_window_;
+        binning.kspace_binning_moco_reg_strength_ = kspace_binning_moco_reg_strength_;
+        binning.kspace_binning_moco_iters_ = kspace_binning_moco_iters_;
+        binning.kspace_binning_max_temporal_window_ = kspace_binning_max_temporal_window_;
+        binning.kspace_binning_minimal_cardiac_phase_width_ = kspace_binning_minimal_cardiac_phase_width_;
+
+        binning.kspace_binning_kSize_RO_ = kspace_binning_kSize_RO_;
+        binning.kspace_binning_kSize_E1_ = kspace_binning_kSize_E1_;
+        binning.kspace_binning_reg_lamda_ = kspace_binning_reg_lamda_;
+        binning.kspace_binning_linear_iter_max_ = kspace_binning_linear_iter_max_;
+        binning.kspace_binning_linear_iter_thres_ = kspace_binning_linear_iter_thres_;
+
+        binning.suffix_ = suffix_ + "_provisional";
+        binning.verbose_ = verbose_;
+        binning.debug_folder_ = debug_folder_;
+        binning.perform_timing_ = perform_timing_;
+
+        // the frames so far; the unwrapped ones are not changed while the binning runs
+        KSpaceBinningObj<T>& obj = binning.binning_obj_;
+        obj.output_N_ = binning_obj_.output_N_;
+        obj.accel_factor_E1_ = binning_obj_.accel_factor_E1_;
+        obj.random_sampling_ = binning_obj_.random_sampling_;
+        obj.sampling_ = binning_obj_.sampling_;
+
+        obj.headers_.create(E1, num, S);
+        size_t s;
+        for (s=0; s<S; s++)
+        {
+            std::copy(&headers(0, 0, s), &headers(0, 0, s) + E1*num, &obj.headers_(0, 0, s));
+        }
+
+        this->leading_frames(incremental_full_kspace_, num, obj.full_kspace_raw_);
+        this->leading_frames(incremental_complex_image_, num, obj.complex_image_raw_);
+        obj.coil_map_raw_ = binning_obj_.coil_map_raw_;
+
+        provisional_binning_->done = std::async(std::launch::async, [&binning]() { binning.perform_binning(); });
+    }
+    catch(...)
+    {
+        GADGET_THROW("Exceptions happened in CmrKSpaceBinning<T>::start_provisional_binning(...) ... ");
+    }
+}
+
+template <typename T> 
+bool CmrKSpaceBinning<T>::provisional_binning_running() const
+{
+    return provisional_binning_ && (provisional_binning_->done.wait_for(std::chrono::seconds(0))!=std::future_status::ready);
+}
+
+template <typename T> 
+void CmrKSpaceBinning<T>::finish_provisional_binning(bool cancel)
+{
+    if(!provisional_binning_) return;
+
+    if(cancel && this->provisional_binning_running()) GDEBUG_STREAM("--> binning of the frames so far is cancelled");
+
+    std::shared_ptr<ProvisionalBinning> provisional = std::move(provisional_binning_);
+    provisional_binning_.reset();
+
+    if(cancel) provisional->cancelled = true;
+
+    try
+    {
+        provisional->done.get();
+    }
+    catch(...)
+    {
+        GWARN_STREAM("Binning of the frames so far failed; the linear recon of the binned kspace starts from the binned kspace ... ");
+        return;
+    }
+
+    ArrayType& kspace_binning_linear = provisional->binning.binning_obj_.kspace_binning_linear_;
+    if(kspace_binning_linear.get_number_of_elements()>0) binning_obj_.kspace_binning_initial_ = std::move(kspace_binning_linear);
+}
+
+template <typename T> 
+void CmrKSpaceBinning<T>::leading_frames(const ArrayType& frames, size_t num, ArrayType& res)
+{
+    try
+    {
+        // frames: [RO E1 CHA N S]
+        size_t RO = frames.get_size(0);
+        size_t E1 = frames.get_size(1);
+        size_t CHA = frames.get_size(2);
+        size_t S = frames.get_size(4);
+
+        GADGET_CHECK_THROW(num<=frames.get_size(3));
+
+        if(S==1)
+        {
+            res.create(RO, E1, CHA, num, S, const_cast< std::complex<T>* >(frames.begin()));
+            return;
+        }
+
+        res.create(RO, E1, CHA, num, S);
+
+        size_t s;
+        for (s=0; s<S; s++)
+        {
+            memcpy(&res(0, 0, 0, 0, s), &frames(0, 0, 0, 0, s), sizeof(std::complex<T>)*RO*E1*CHA*num);
+        }
+    }
+    catch(...)
+    {
+        GADGET_THROW("Exceptions happened in CmrKSpaceBinning<T>::leading_frames(...) ... ");
     }
 }
 
@@ -465,12 +925,11 @@ void CmrKSpaceBinning<T>::estimate_time_stamps()
 {
     try
     {
-        hoNDArray< std::complex<T> >& kspace = binning_obj_.data_;
-        size_t RO = kspace.get_size(0);
-        size_t E1 = kspace.get_size(1);
-        size_t CHA = kspace.get_size(2);
-        size_t N = kspace.get_size(3);
-        size_t S = kspace.get_size(4);
+        // the binning of the frames so far has the headers, but not the kspace, of its frames
+        hoNDArray< ISMRMRD::AcquisitionHeader >& header = binning_obj_.headers_;
+        size_t E1 = header.get_size(0);
+        size_t N = header.get_size(1);
+        size_t S = header.get_size(2);
 
         size_t startE1, endE1;
         startE1 = this->binning_obj_.sampling_.sampling_limits_[1].min_;
@@ -478,11 +937,6 @@ void CmrKSpaceBinning<T>::estimate_time_stamps()
 
         size_t rE1 = endE1-startE1+1;
 
-        hoNDArray< ISMRMRD::AcquisitionHeader >& header = binning_obj_.headers_;
-        GADGET_CHECK_THROW(header.get_size(0)==E1);
-        GADGET_CHECK_THROW(header.get_size(1)==N);
-        GADGET_CHECK_THROW(header.get_size(2)==S);
-
         // initialize output arrays
         binning_obj_.ind_heart_beat_.create(E1, N, S);
         Gadgetron::clear(binning_obj_.ind_heart_beat_);
@@ -2307,6 +2761,13 @@ void CmrKSpaceBinning<T>::perform_recon_binned_kspace(const std::vector<size_t>&
         complex_image_binning.create(RO, E1, 1, N, S);
         Gadgetron::clear(complex_image_binning);
 
+        // the linear recon starts from the linear recon of the binning of the frames so far, if there is one
+        ArrayType& kspace_binning_initial = binning_obj_.kspace_binning_initial_;
+        bool use_initial = (kspace_binning_initial.dimensions()==kspace_binning.dimensions());
+
+        ArrayType& kspace_binning_linear = binning_obj_.kspace_binning_linear_;
+        kspace_binning_linear.clear();
+
         size_t e1, cha, n, s;
 
         if(CHA==1)
@@ -2399,6 +2860,9 @@ void CmrKSpaceBinning<T>::perform_recon_binned_kspace(const std::vector<size_t>&
         }
         else
         {
+            kspace_binning_linear.create(RO, E1, CHA, N, S);
+            Gadgetron::clear(kspace_binning_linear);
+
             for (s=0; s<S; s++)
             {
                 bool not_processing = false;
@@ -2425,6 +2889,9 @@ void CmrKSpaceBinning<T>::perform_recon_binned_kspace(const std::vector<size_t>&
                 ArrayType kspaceRef(RO, E1, CHA, N, 1, kspace_binning_image_domain_average.begin()+s*RO*E1*CHA*N);
                 ArrayType coilMap(RO, E1, CHA, coil_map.begin());
 
+                ArrayType kspaceInitial;
+                if(use_initial) kspaceInitial.create(RO, E1, CHA, N, 1, kspace_binning_initial.begin()+s*RO*E1*CHA*N);
+
                 if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(kspace, debug_folder_ + "kspace_binning_linear_recon_kspace" + os.str() + suffix_);
                 if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(kspace_wider, debug_folder_ + "kspace_binning_linear_recon_kspace_wider" + os.str() + suffix_);
                 if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(kspaceRef, debug_folder_ + "kspace_binning_linear_recon_kspaceRef" + os.str() + suffix_);
@@ -2437,14 +2904,16 @@ void CmrKSpaceBinning<T>::perform_recon_binned_kspace(const std::vector<size_t>&
 
                 if(this->use_nonlinear_binning_recon_)
                 {
-                    this->perform_linear_recon_on_kspace_binning(kspace_wider, kspaceRef, coilMap, resKSpace, resIm, kernel, kernelIm);
+                    this->perform_linear_recon_on_kspace_binning(kspace_wider, kspaceRef, kspaceInitial, coilMap, resKSpace, resIm, kernel, kernelIm);
                 }
                 else
                 {
-                    this->perform_linear_recon_on_kspace_binning(kspace, kspaceRef, coilMap, resKSpace, resIm, kernel, kernelIm);
+                    this->perform_linear_recon_on_kspace_binning(kspace, kspaceRef, kspaceInitial, coilMap, resKSpace, resIm, kernel, kernelIm);
                 }
                 if ( this->perform_timing_ ) { gt_timer_local_.stop(); }
 
+                memcpy(kspace_binning_linear.begin()+s*RO*E1*CHA*N, resKSpace.begin(), resKSpace.get_number_of_bytes());
+
                 if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(resKSpace, debug_folder_ + "kspace_binning_linear_recon_resKSpace" + os.str() + suffix_);
                 if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(resIm, debug_folder_ + "kspace_binning_linear_recon_resIm" + os.str() + suffix_);
                 if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(kernel, debug_folder_ + "kspace_binning_linear_recon_kernel" + os.str() + suffix_);
@@ -2478,7 +2947,7 @@ void CmrKSpaceBinning<T>::perform_recon_binned_kspace(const std::vector<size_t>&
 }
 
 template <typename T> 
-void CmrKSpaceBinning<T>::perform_linear_recon_on_kspace_binning(const ArrayType& kspace, const ArrayType& kspaceInitial, const ArrayType& coilMap, ArrayType& resKSpace, ArrayType& resIm, ArrayType& kernel, ArrayType& kernelIm)
+void CmrKSpaceBinning<T>::perform_linear_recon_on_kspace_binning(const ArrayType& kspace, const ArrayType& kspaceRef, const ArrayType& kspaceInitial, const ArrayType& coilMap, ArrayType& resKSpace, ArrayType& resIm, ArrayType& kernel, ArrayType& kernelIm)
 {
     try
     {
@@ -2496,7 +2965,7 @@ void CmrKSpaceBinning<T>::perform_linear_recon_on_kspace_binning(const ArrayType
 
         // average all N
         ArrayType acs;
-        Gadgetron::sum_over_dimension(kspaceInitial, acs, 3);
+        Gadgetron::sum_over_dimension(kspaceRef, acs, 3);
 
         // estimate kernel
         size_t kRO = kspace_binning_kSize_RO_;
@@ -2527,9 +2996,8 @@ void CmrKSpaceBinning<T>::perform_linear_recon_on_kspace_binning(const ArrayType
         double iter_thres = kspace_binning_linear_iter_thres_;
         bool print_iter = true;
 
-        ArrayType emptyInitial;
         if ( this->perform_timing_ ) { timer.start("spirit linear recon ... "); }
-        Gadgetron::perform_spirit_recon_linear_2DT(kspace, startE1, endE1, kernelIm, emptyInitial, resKSpace, iter_max, iter_thres, print_iter);
+        Gadgetron::perform_spirit_recon_linear_2DT(kspace, startE1, endE1, kernelIm, kspaceInitial, resKSpace, iter_max, iter_thres, print_iter);
         if ( this->perform_timing_ ) { timer.stop(); }
 
         if ( this->perform_timing_ ) { timer.start("coil combination ... "); }
@@ -16,6 +16,8 @@
 #endif // min
 
 #include <algorithm>
+#include <atomic>
+#include <memory>
 #include "hoMatrix.h"
 
 #include "ismrmrd/ismrmrd.h"
@@ -31,6 +33,33 @@
 
 namespace Gadgetron { 
 
+    /// resize dimension dim of a to length, keeping the leading entries along it
+    template <typename E> 
+    void resize_dimension(hoNDArray<E>& a, size_t dim, size_t length)
+    {
+        std::vector<size_t> dims;
+        a.get_dimensions(dims);
+        if (dims[dim] == length) return;
+
+        size_t inner = 1, outer = 1, d;
+        for (d = 0; d < dim; d++) inner *= dims[d];
+        for (d = dim + 1; d < dims.size(); d++) outer *= dims[d];
+
+        size_t kept = inner * std::min(dims[dim], length);
+        size_t len_a = inner * dims[dim];
+        size_t len_res = inner * length;
+
+        dims[dim] = length;
+        hoNDArray<E> res(dims);
+
+        for (size_t o = 0; o < outer; o++)
+        {
+            std::copy(a.begin() + o*len_a, a.begin() + o*len_a + kept, res.begin() + o*len_res);
+        }
+
+        a = std::move(res);
+    }
+
     template <typename T>
     class EXPORTCMR KSpaceBinningObj
     {
@@ -54,6 +83,9 @@ namespace Gadgetron {
         /// coil map, [RO E1 dstCHA S]
         hoNDArray< std::complex<T> > coil_map_raw_;
 
+        /// linear recon of the binned kspace, [RO E1 dstCHA output_N_ S]
+        hoNDArray< std::complex<T> > kspace_binning_linear_;
+
         /// mean RR interval in ms
         float mean_RR_;
 
@@ -81,6 +113,10 @@ namespace Gadgetron {
         /// [E1 N S]
         hoNDArray< ISMRMRD::AcquisitionHeader > headers_;
 
+        /// initial kspace for the linear recon of the binned kspace, [RO E1 dstCHA output_N_ S]
+        /// if empty or of another size, the linear recon starts from the binned kspace
+        hoNDArray< std::complex<T> > kspace_binning_initial_;
+
         // ------------------------------------
         /// buffer for recon
         // ------------------------------------
@@ -160,6 +196,27 @@ namespace Gadgetron {
         // ======================================================================================
         virtual void process_binning_recon();
 
+        // ======================================================================================
+        // incremental raw data recon, for frames fed as they are acquired
+        // ======================================================================================
+        /// starts a new series; binning_obj_.sampling_, accel_factor_E1_ and random_sampling_ must be set before frames are added
+        void begin_incremental_recon();
+
+        /// frame n of the series was stored in frames [RO E1 CHA N S] and headers [E1 N S], N being the number of frames expected
+        /// frames are added in order, and are not copied; they are changed in place to eigen channels
+        /// once every line within the sampling limits was acquired and at least incremental_calibration_frames_ frames were added,
+        /// the eigen channels and the raw data recon are calibrated on the frames so far, and every frame added after is unwrapped right away
+        /// the frames have no upstream reference preparation or coil compression; the eigen channels stand in for the latter
+        /// the raw data recon, but not the eigen channels, is calibrated again on all frames so far whenever they doubled,
+        /// as long as a quarter of the N frames is still to come; the frames so far are then unwrapped again
+        /// if incremental_provisional_binning_ is true, a calibration on at least a quarter of the N frames starts the binning of the frames so far
+        /// in the background; its linear recon of the binned kspace is the initial kspace for the one of process_binning_recon()
+        /// if all N frames of binning_obj_.data_ were unwrapped this way, process_binning_recon() skips the raw data recon
+        virtual void add_incremental_frame(ArrayType& frames, const hoNDArray< ISMRMRD::AcquisitionHeader >& headers, size_t n);
+
+        /// number of frames added since begin_incremental_recon()
+        size_t incremental_frames() const;
+
         // ------------------------------------
         /// binning object, storing the kspace data and results
         // ------------------------------------
@@ -228,6 +285,12 @@ namespace Gadgetron {
         size_t downstream_coil_compression_num_modesKept_;
         double downstream_coil_compression_thres_;
 
+        // minimal number of frames averaged for the calibration of the incremental raw data recon
+        size_t incremental_calibration_frames_;
+
+        // whether the incremental raw data recon starts the binning of the frames so far in the background
+        bool incremental_provisional_binning_;
+
         // ----------------------
         // spirit raw data reconstruction, if random sampling was used
         // ----------------------
@@ -311,6 +374,18 @@ namespace Gadgetron {
         // fill the binning_obj_.full_kspace_raw_, binning_obj_.complex_image_raw_, binning_obj_.coil_map_raw_
         virtual void perform_raw_data_recon();
 
+        /// compute the coil map, grappa kernel and unmixing coefficients from the average of data [RO E1 CHA N S]
+        virtual void calibrate_raw_data_recon(const ArrayType& data);
+
+        /// unwrap data [RO E1 CHA N S] with the calibrated kernel, giving full_kspace [RO E1 dstCHA N S] and complex_image [RO E1 1 N S]
+        virtual void unwrap_raw_data(const ArrayType& data, ArrayType& full_kspace, ArrayType& complex_image);
+
+        /// compute the eigen channels, keeping all of them, from the average of data [RO E1 CHA N S]
+        virtual void calibrate_eigen_channels(const ArrayType& data);
+
+        /// change frames [start, start+num) of data [RO E1 CHA N S] to eigen channels, in place
+        virtual void apply_eigen_channels(ArrayType& data, size_t start, size_t num);
+
         /// this function parses all recorded time stamps and computes cpt time stamps
         /// first, all time stamps are converted into the unit of ms
         /// second, a linear fit is performed to reduce then quantization error
@@ -336,9 +411,58 @@ namespace Gadgetron {
         /// perform recon on the binned kspace
         virtual void perform_recon_binned_kspace(const std::vector<size_t>& slices_not_processing);
 
+        /// from the raw data recon, estimate the time stamps and respiratory navigator, bin the kspace and perform recon on it
+        /// stops after the current step if binning_cancelled_ is set
+        virtual void perform_binning();
+
+        // ======================================================================================
+        // raw data recon calibration and incremental recon state
+        // ======================================================================================
+        /// image domain grappa kernel, [RO E1 CHA dstCHA]
+        ArrayType raw_recon_kernelIm_;
+        /// unmixing coefficients, [RO E1 CHA]
+        ArrayType raw_recon_unmixing_coeff_;
+        /// scaling of the aliased images
+        T raw_recon_scaling_;
+
+        /// eigen channels of the incremental recon
+        hoNDKLT< std::complex<T> > eigen_channels_;
+
+        size_t incremental_frames_;
+        /// number of frames the raw data recon was last calibrated on; 0 if it was not calibrated yet
+        size_t incremental_calibrated_frames_;
+        /// whether a line was acquired in any frame so far, [E1 S]
+        std::vector<bool> incremental_sampled_lines_;
+        /// unwrapped frames, with the same room for frames as the frames added, [RO E1 dstCHA N S] and [RO E1 1 N S]
+        ArrayType incremental_full_kspace_;
+        ArrayType incremental_complex_image_;
+
+        /// binning of the frames so far, running in the background; it reads the unwrapped frames so far
+        struct ProvisionalBinning;
+        std::shared_ptr<ProvisionalBinning> provisional_binning_;
+
+        /// set for the binning of the frames so far, when it is no longer of use
+        const std::atomic<bool>* binning_cancelled_;
+
         // ======================================================================================
         // implementation functions
         // ======================================================================================
+        /// unwrap frames [start, start+num) of frames [RO E1 CHA N S] into incremental_full_kspace_ and incremental_complex_image_
+        void unwrap_incremental_frames(const ArrayType& frames, size_t start, size_t num);
+
+        /// the first num frames of frames [RO E1 CHA N S]; res points into frames if S is 1, and is a copy otherwise
+        void leading_frames(const ArrayType& frames, size_t num, ArrayType& res);
+
+        /// start the binning of the first num frames in the background, with headers [E1 N S]
+        void start_provisional_binning(const hoNDArray< ISMRMRD::AcquisitionHeader >& headers, size_t num);
+
+        /// whether the binning of the frames so far is still running
+        bool provisional_binning_running() const;
+
+        /// wait for the binning of the frames so far, stopping it after its current step if cancel is true
+        /// if it completed, its linear recon of the binned kspace becomes binning_obj_.kspace_binning_initial_
+        void finish_provisional_binning(bool cancel);
+
         /// if the alternativing acqusition is used, detect and flip the time stamps
         void detect_and_flip_alternating_order(const hoNDArray<float>& time_stamp, const hoNDArray<float>& cpt_time_stamp, hoNDArray<float>& cpt_time_stamp_flipped, std::vector<bool>& ascending);
 
@@ -374,7 +498,8 @@ namespace Gadgetron {
         void fill_binned_kspace(size_t s, size_t dst_n, const std::vector<size_t>& selected_images, const ArrayType& warpped_kspace, ArrayType& kspace_filled, hoNDArray<float>& hit_count);
 
         /// perform linear recon on binning
-        void perform_linear_recon_on_kspace_binning(const ArrayType& underSampledKspace, const ArrayType& kspaceInitial, const ArrayType& coilMap, ArrayType& resKSpace, ArrayType& resIm, ArrayType& kernel, ArrayType& kernelIm);
+        /// the kernel is calibrated on kspaceRef; the recon starts from kspaceInitial, if it has the size of underSampledKspace
+        void perform_linear_recon_on_kspace_binning(const ArrayType& underSampledKspace, const ArrayType& kspaceRef, const ArrayType& kspaceInitial, const ArrayType& coilMap, ArrayType& resKSpace, ArrayType& resIm, ArrayType& kernel, ArrayType& kernelIm);
         /// perform nonlinear recon for binning
         void perform_non_linear_recon_on_kspace_binning(const ArrayType& underSampledKspace, const ArrayType& kspaceLinear, const ArrayType& coilMap, const ArrayType& kernel, const ArrayType& kernelIm, ArrayType& resKSpace, ArrayType& resIm);
     };
@@ -192,6 +192,8 @@ CmrParametricMapping<T>::CmrParametricMapping()
     max_map_value_ = -1;
     min_map_value_ = 0;
 
+    use_batched_solver_ = false;
+
     verbose_ = false;
     perform_timing_ = false;
 
@@ -260,98 +262,109 @@ void CmrParametricMapping<T>::perform_parametric_mapping()
 
         if (this->perform_timing_) { gt_timer_.start("perform pixel-wise mapping ... "); }
 
-        long long ro, e1;
+        // pixels to fit, as offsets into map_, over all S and SLC
+        size_t plane = RO*E1;
 
+        std::vector<size_t> pixels;
+        pixels.reserve(map_.get_number_of_elements());
         for (slc = 0; slc < SLC; slc++)
         {
             for (s = 0; s < S; s++)
             {
-                T* pData = &data_(0, 0, 0, s, slc);
-
-                T* pMap = &map_(0, 0, s, slc);
-                T* pPara = &para_(0, 0, 0, s, slc);
-
-                T* pMapSD = NULL;
-                T* pParaSD = NULL;
-                if (this->compute_SD_maps_)
+                for (size_t i = 0; i < plane; i++)
                 {
-                    pMapSD = &sd_map_(0, 0, s, slc);
-                    pParaSD = &sd_para_(0, 0, 0, s, slc);
+                    if (pMask != NULL && pMask[i + slc*plane] <= 0) continue;
+                    pixels.push_back(i + (s + slc*S)*plane);
                 }
+            }
+        }
+
+        long long num_pixels = (long long)pixels.size();
+        long long ind;
 
-                T* pMaskCurr = NULL;
-                if (pMask != NULL)
+        if (!this->use_batched_solver_ || !this->perform_batched_mapping(pixels))
+        {
+#pragma omp parallel private(ind, n) shared(pixels, num_pixels, num_ti, NUM)
+            {
+                std::vector<T> yi(num_ti, 0);
+                std::vector<T> guess(NUM + 1, 0);
+                std::vector<T> bi(NUM + 1, 0);
+
+                T map_v(0);
+
+#pragma omp for schedule(dynamic, 64)
+                for (ind = 0; ind < num_pixels; ind++)
                 {
-                    pMaskCurr = pMask + s*RO*E1 + slc*S*RO*E1;
+                    size_t q = pixels[ind];
+
+                    // get data vector
+                    for (n = 0; n < num_ti; n++)
+                    {
+                        yi[n] = data_[this->offset_of_pixel(q, n, N)];
+                    }
+
+                    // estimate initial para
+                    this->get_initial_guess(ti_, yi, guess);
+
+                    // perform mapping
+                    this->compute_map(ti_, yi, guess, bi, map_v);
+
+                    map_[q] = map_v;
+                    for (n = 0; n < NUM; n++)
+                    {
+                        para_[this->offset_of_pixel(q, n, NUM)] = bi[n];
+                    }
                 }
+            } // openmp
+        }
 
-#pragma omp parallel private(e1, ro, n) shared(RO, E1, pMask, pMaskCurr, pData, pMap, pMapSD, pPara, pParaSD, num_ti, NUM)
+        // compute SD if needed
+        if (this->compute_SD_maps_)
+        {
+#pragma omp parallel private(ind, n) shared(pixels, num_pixels, num_ti, NUM)
+            {
+                std::vector<T> yi(num_ti, 0);
+                std::vector<T> bi(NUM, 0);
+                std::vector<T> sd(NUM + 1, 0);
+
+                T map_sd(0);
+
+#pragma omp for schedule(dynamic, 64)
+                for (ind = 0; ind < num_pixels; ind++)
                 {
-                    std::vector<T> yi(num_ti, 0);
-                    std::vector<T> guess(NUM + 1, 0);
-                    std::vector<T> bi(NUM + 1, 0);
-                    std::vector<T> sd(NUM + 1, 0);
+                    size_t q = pixels[ind];
+
+                    for (n = 0; n < num_ti; n++)
+                    {
+                        yi[n] = data_[this->offset_of_pixel(q, n, N)];
+                    }
 
-                    T map_v(0), map_sd(0);
+                    for (n = 0; n < NUM; n++)
+                    {
+                        bi[n] = para_[this->offset_of_pixel(q, n, NUM)];
+                    }
 
-#pragma omp for 
-                    for (e1 = 0; e1 < E1; e1++)
+                    try
+                    {
+                        this->compute_sd(ti_, yi, bi, sd, map_sd);
+                    }
+                    catch(...)
                     {
-                        for (ro = 0; ro < RO; ro++)
+                        for (n = 0; n < NUM; n++)
                         {
-                            long long offset = ro + e1*RO;
-
-                            if (pMask != NULL)
-                            {
-                                if (pMaskCurr[offset] <= 0)
-                                    continue;
-                            }
-
-                            // get data vector
-                            for (n = 0; n < num_ti; n++)
-                            {
-                                yi[n] = pData[offset + n*RO*E1];
-                            }
-
-                            // estimate initial para
-                            this->get_initial_guess(ti_, yi, guess);
-
-                            // perform mapping
-                            this->compute_map(ti_, yi, guess, bi, map_v);
-
-                            pMap[offset] = map_v;
-                            for (n = 0; n < NUM; n++)
-                            {
-                                pPara[offset + n*RO*E1] = bi[n];
-                            }
-
-                            // compute SD if needed
-                            if (this->compute_SD_maps_)
-                            {
-                                try
-                                {
-                                    this->compute_sd(ti_, yi, bi, sd, map_sd);
-                                }
-                                catch(...)
-                                {
-                                    for (n = 0; n < NUM; n++)
-                                    {
-                                        sd[n] = 0;
-                                    }
-
-                                    map_sd = 0;
-                                }
-
-                                pMapSD[offset] = map_sd;
-                                for (n = 0; n < NUM; n++)
-                                {
-                                    pParaSD[offset + n*RO*E1] = sd[n];
-                                }
-                            }
+                            sd[n] = 0;
                         }
+
+                        map_sd = 0;
                     }
-                } // openmp
-            }
+
+                    sd_map_[q] = map_sd;
+                    for (n = 0; n < NUM; n++)
+                    {
+                        sd_para_[this->offset_of_pixel(q, n, NUM)] = sd[n];
+                    }
+                }
+            } // openmp
         }
 
         if (this->perform_timing_) { gt_timer_.stop(); }
@@ -421,6 +434,12 @@ void CmrParametricMapping<T>::perform_parametric_mapping()
     }
 }
 
+template <typename T>
+bool CmrParametricMapping<T>::perform_batched_mapping(const std::vector<size_t>& pixels)
+{
+    return false;
+}
+
 template <typename T>
 void CmrParametricMapping<T>::get_initial_guess(const std::vector<T>& ti, const std::vector<T>& yi, std::vector<T>& guess)
 {
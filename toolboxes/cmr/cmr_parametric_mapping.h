@@ -106,6 +106,11 @@ namespace Gadgetron {
         T max_map_value_;
         T min_map_value_;
 
+        /// whether to fit all pixels together with a batched solver (see perform_batched_mapping)
+        /// the batched solver converges to the least squares minimum, so its maps differ slightly from the simplex ones
+        /// models without a batched implementation are fitted pixel by pixel with compute_map
+        bool use_batched_solver_;
+
         // ======================================================================================
         /// parameter for debugging
         // ======================================================================================
@@ -128,6 +133,10 @@ namespace Gadgetron {
         // perform every steps
         // ======================================================================================
 
+        /// fit the given pixels and fill map_ and para_; pixels are offsets into map_, over all S and SLC
+        /// return false if the model has no batched solver
+        virtual bool perform_batched_mapping(const std::vector<size_t>& pixels);
+
         /// provide initial guess for the mapping
         virtual void get_initial_guess(const VectorType& ti, const VectorType& yi, VectorType& guess);
 
@@ -142,5 +151,12 @@ namespace Gadgetron {
 
         /// return number of parameters, including the map itself
         virtual size_t get_num_of_paras() const;
+
+        /// offset of entry n of pixel q in an array of [RO E1 len S SLC], e.g. data_ or para_; q is an offset into map_
+        size_t offset_of_pixel(size_t q, size_t n, size_t len) const
+        {
+            size_t plane = data_.get_size(0)*data_.get_size(1);
+            return q % plane + ((q / plane)*len + n)*plane;
+        }
     };
 }
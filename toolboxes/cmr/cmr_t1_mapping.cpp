@@ -13,6 +13,7 @@
 #include "simplexLagariaSolver.h"
 #include "twoParaExpRecoveryOperator.h"
 #include "curveFittingCostFunction.h"
+#include "BatchedLM.h"
 
 #include <boost/math/special_functions/sign.hpp>
 
@@ -34,6 +35,60 @@ CmrT1SRMapping<T>::~CmrT1SRMapping()
 {
 }
 
+template <typename T>
+bool CmrT1SRMapping<T>::perform_batched_mapping(const std::vector<size_t>& pixels)
+{
+    try
+    {
+        typedef Solver::BatchedLMSolver< Solver::Models::ExpRecovery<T> > SolverType;
+        typedef typename SolverType::Parameters Parameters;
+
+        GADGET_CHECK_THROW(!ti_.empty());
+
+        SolverType solver(ti_);
+        solver.max_iterations_ = max_iter_;
+
+        size_t N = data_.get_size(2);
+        size_t num_ti = ti_.size();
+
+        Solver::fit_batched(solver, pixels.size(),
+            [&](size_t i, T* yi, Parameters& guess)
+            {
+                for (size_t n = 0; n < num_ti; n++) yi[n] = data_[this->offset_of_pixel(pixels[i], n, N)];
+
+                // same initial guess as get_initial_guess
+                guess[0] = *std::max_element(yi, yi + num_ti);
+                guess[1] = ti_[num_ti / 2];
+            },
+            [&](size_t i, const Parameters& bi, Solver::BatchedLMStatus status)
+            {
+                size_t q = pixels[i];
+
+                // a failed fit gets the map value of an invalid simplex fit; like the simplex, a fit stopped at
+                // max_iter_ keeps its last estimate
+                bool failed = (status == Solver::BatchedLMStatus::LINEAR_SOLVER_FAILED);
+
+                T map_v = 0;
+                if (!failed && bi[0] > 0 && bi[1] > 0)
+                {
+                    map_v = bi[1];
+                    if (map_v >= max_map_value_) map_v = hole_marking_value_;
+                    if (map_v <= min_map_value_) map_v = hole_marking_value_;
+                }
+
+                map_[q] = map_v;
+                para_[this->offset_of_pixel(q, 0, 2)] = failed ? T(0) : bi[0];
+                para_[this->offset_of_pixel(q, 1, 2)] = failed ? T(0) : bi[1];
+            });
+    }
+    catch (...)
+    {
+        GADGET_THROW("Exceptions happened in CmrT1SRMapping<T>::perform_batched_mapping(...) ... ");
+    }
+
+    return true;
+}
+
 template <typename T>
 void CmrT1SRMapping<T>::get_initial_guess(const VectorType& ti, const VectorType& yi, VectorType& guess)
 {
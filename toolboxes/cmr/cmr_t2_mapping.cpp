@@ -14,11 +14,45 @@
 #include "simplexLagariaSolver.h"
 #include "twoParaExpDecayOperator.h"
 #include "curveFittingCostFunction.h"
+#include "BatchedLM.h"
 
 #include <boost/math/special_functions/sign.hpp>
 
 namespace Gadgetron { 
 
+namespace
+{
+    /// fit log(yi) = log(A) - ti/T2 as a straight line; returns false if yi has non-positive values or T2 comes out negative
+    template <typename T>
+    bool log_linear_guess(const std::vector<T>& ti, const T* yi, T& A, T& T2)
+    {
+        size_t num = ti.size();
+
+        double sx(0), sy(0), sxx(0), sxy(0);
+        for (size_t n = 0; n < num; n++)
+        {
+            if (yi[n] <= 0) return false;
+
+            double x = ti[n];
+            double y = std::log((double)yi[n]);
+            sx += x;
+            sy += y;
+            sxx += x*x;
+            sxy += x*y;
+        }
+
+        double det = num*sxx - sx*sx;
+        if (det == 0) return false;
+
+        double a = (num*sxy - sx*sy) / det;
+        double b = (sy - a*sx) / num;
+
+        A = (T)std::exp(b);
+        T2 = (T)(-1.0 / a);
+        return std::isfinite(A) && std::isfinite(T2) && T2 >= 0;
+    }
+}
+
 template <typename T> 
 CmrT2Mapping<T>::CmrT2Mapping() : BaseClass()
 {
@@ -34,6 +68,63 @@ CmrT2Mapping<T>::~CmrT2Mapping()
 {
 }
 
+template <typename T>
+bool CmrT2Mapping<T>::perform_batched_mapping(const std::vector<size_t>& pixels)
+{
+    try
+    {
+        typedef Solver::BatchedLMSolver< Solver::Models::ExpDecay<T> > SolverType;
+        typedef typename SolverType::Parameters Parameters;
+
+        GADGET_CHECK_THROW(!ti_.empty());
+
+        SolverType solver(ti_);
+        solver.max_iterations_ = max_iter_;
+
+        size_t N = data_.get_size(2);
+        size_t num_ti = ti_.size();
+
+        Solver::fit_batched(solver, pixels.size(),
+            [&](size_t i, T* yi, Parameters& guess)
+            {
+                for (size_t n = 0; n < num_ti; n++) yi[n] = data_[this->offset_of_pixel(pixels[i], n, N)];
+
+                // same initial guess as get_initial_guess
+                if (!log_linear_guess(ti_, yi, guess[0], guess[1]))
+                {
+                    guess[0] = *std::max_element(yi, yi + num_ti);
+                    guess[1] = ti_[num_ti / 2];
+                }
+            },
+            [&](size_t i, const Parameters& bi, Solver::BatchedLMStatus status)
+            {
+                size_t q = pixels[i];
+
+                // a failed fit gets the map value of an invalid simplex fit; like the simplex, a fit stopped at
+                // max_iter_ keeps its last estimate
+                bool failed = (status == Solver::BatchedLMStatus::LINEAR_SOLVER_FAILED);
+
+                T map_v = 0;
+                if (!failed && bi[0] > 0 && bi[1] > 0)
+                {
+                    map_v = bi[1];
+                    if (map_v >= max_map_value_) map_v = hole_marking_value_;
+                    if (map_v <= min_map_value_) map_v = hole_marking_value_;
+                }
+
+                map_[q] = map_v;
+                para_[this->offset_of_pixel(q, 0, 2)] = failed ? T(0) : bi[0];
+                para_[this->offset_of_pixel(q, 1, 2)] = failed ? T(0) : bi[1];
+            });
+    }
+    catch (...)
+    {
+        GADGET_THROW("Exceptions happened in CmrT2Mapping<T>::perform_batched_mapping(...) ... ");
+    }
+
+    return true;
+}
+
 template <typename T>
 void CmrT2Mapping<T>::get_initial_guess(const VectorType& ti, const VectorType& yi, VectorType& guess)
 {
@@ -40,6 +40,9 @@ public:
     // perform every steps
     // ======================================================================================
 
+    /// fit all pixels with the batched Levenberg-Marquardt solver
+    virtual bool perform_batched_mapping(const std::vector<size_t>& pixels);
+
     /// provide initial guess for the mapping
     virtual void get_initial_guess(const VectorType& ti, const VectorType& yi, VectorType& guess);
 
@@ -72,6 +75,7 @@ public:
     using BaseClass::thres_fun_;
     using BaseClass::max_map_value_;
     using BaseClass::min_map_value_;
+    using BaseClass::use_batched_solver_;
 
     using BaseClass::verbose_;
     using BaseClass::debug_folder_;
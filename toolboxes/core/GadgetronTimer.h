@@ -15,6 +15,7 @@
 
 #include <string>
 #include "log.h"
+#include "trace.h"
 
 namespace Gadgetron{
 
@@ -60,6 +61,13 @@ namespace Gadgetron{
 
     virtual void start()
     {
+        trace_start_ = 0;
+        if (Trace::enabled())
+        {
+            // interning takes a process wide lock; only do it once per name, not on every stop
+            if (!trace_name_) trace_name_ = Trace::intern(name_);
+            trace_start_ = Trace::now();
+        }
 #ifdef WIN32
         QueryPerformanceFrequency(&frequency_);
         QueryPerformanceCounter(&start_);
@@ -70,7 +78,11 @@ namespace Gadgetron{
 
     void start(const char* name)
     {
-        name_ = name;
+        if (name_ != name)
+        {
+            name_ = name;
+            trace_name_ = nullptr;
+        }
         start();
     }
 
@@ -85,6 +97,11 @@ namespace Gadgetron{
         time_in_us = ((end_.tv_sec * 1e6) + end_.tv_usec) - ((start_.tv_sec * 1e6) + start_.tv_usec);
 #endif
 	GDEBUG("%s:%f ms\n", name_.c_str(), time_in_us/1000.0);
+
+        // Timed sections also show up as toolbox scopes in connection traces
+        if (trace_start_ && Trace::enabled())
+            Trace::record(trace_name_, "toolbox", trace_start_, Trace::now());
+
         return time_in_us;
     }
 
@@ -104,6 +121,9 @@ namespace Gadgetron{
     std::string name_;
 
     bool timing_in_destruction_;
+
+    uint64_t trace_start_ = 0;
+    const char* trace_name_ = nullptr;
   };
 }
 
@@ -18,6 +18,8 @@
 #include "hoNDArray.h"
 #include "hoNDImage.h"
 
+#include <algorithm>
+
 namespace Gadgetron
 {
     template <typename T, unsigned int D, typename coord_type = double>
@@ -131,6 +133,17 @@ namespace Gadgetron
         /// deriv: N x 1 array, evaluation results
         bool computeBSplineDerivativePoints(const hoNDArray<T>& pts, const hoNDArray<T>& coeff, unsigned int SplineDegree, const std::vector<unsigned int>& derivative, hoNDArray<T>& deriv);
 
+        /// resample an array with separable BSpline interpolation
+        /// dimension i is sampled at dim_out[i] points evenly spread from its first to its last sample, as resampleImage does; dimensions beyond dim_out are kept
+        /// every resampled dimension is prefiltered and interpolated in one pass, using a weight table computed once for the dimension
+        /// the mirror boundary condition is folded into the table, so samples near the border need no checks
+        bool resampleBSpline(const hoNDArray<T>& data, unsigned int SplineDegree, const std::vector<size_t>& dim_out, hoNDArray<T>& res);
+
+        /// compute the BSpline weights and the mirrored coefficient indexes for every position along a line of len coefficients
+        /// weight and index hold SplineDegree+1 entries per position
+        void computeBSplineWeightTable(size_t len, unsigned int SplineDegree, const std::vector<coord_type>& pos, 
+                                    std::vector<bspline_float_type>& weight, std::vector<long long>& index);
+
         /// print out the image information
         void print(std::ostream& os) const;
 
@@ -145,6 +158,12 @@ namespace Gadgetron
                                                         bspline_float_type          Tolerance       /* admissible relative error */ 
                                                       );
 
+        /// the same, for Lines interleaved lines; sample n of line l is c[n*Lines + l], so every step runs over contiguous memory
+        static void ConvertToInterpolationCoefficients(T c[], size_t DataLength, size_t Lines, bspline_float_type z[], long NbPoles, bspline_float_type Tolerance);
+
+        /// resample dimension dim of an array from dimension[dim] to len_out samples
+        void resampleBSplineDimension(const T* data, const std::vector<size_t>& dimension, size_t dim, size_t len_out, unsigned int SplineDegree, T* res);
+
         static T InitialCausalCoefficient(
                                             T           c[],                /* coefficients */
                                             size_t      DataLength,         /* number of coefficients */
@@ -1725,6 +1725,178 @@ template <typename T, unsigned int D, typename coord_type>
         return true;
     }
 
+    template <typename T, unsigned int D, typename coord_type>
+    bool hoNDBSpline<T, D, coord_type>::resampleBSpline(const hoNDArray<T>& data, unsigned int SplineDegree, const std::vector<size_t>& dim_out, hoNDArray<T>& res)
+    {
+        try
+        {
+            if (SplineDegree < 2 || SplineDegree > 9)
+            {
+                GERROR_STREAM("Only 2 - 9 order BSpline is supported ... ");
+                return false;
+            }
+
+            if (&res == &data)
+            {
+                hoNDArray<T> resampled;
+                if (!this->resampleBSpline(data, SplineDegree, dim_out, resampled)) return false;
+                res = std::move(resampled);
+                return true;
+            }
+
+            std::vector<size_t> dimension;
+            data.get_dimensions(dimension);
+
+            if (dim_out.size() > dimension.size())
+            {
+                GERROR_STREAM("hoNDBSpline<T, D, coord_type>::resampleBSpline(...), " << dim_out.size() << " output sizes given for an array of " << dimension.size() << " dimensions ... ");
+                return false;
+            }
+
+            // dimensions shrinking the most go first, so the passes after touch fewer samples
+            std::vector<size_t> dims;
+            size_t d;
+            for (d = 0; d < dim_out.size(); d++)
+            {
+                if (dim_out[d] != dimension[d]) dims.push_back(d);
+            }
+
+            std::stable_sort(dims.begin(), dims.end(), [&](size_t a, size_t b) {
+                return double(dim_out[a]) / dimension[a] < double(dim_out[b]) / dimension[b];
+            });
+
+            if (dims.empty())
+            {
+                res = data;
+                return true;
+            }
+
+            hoNDArray<T> buffer[2];
+            const T* pData = data.begin();
+
+            for (d = 0; d < dims.size(); d++)
+            {
+                std::vector<size_t> dimension_next(dimension);
+                dimension_next[dims[d]] = dim_out[dims[d]];
+
+                hoNDArray<T>& next = (d + 1 == dims.size()) ? res : buffer[d % 2];
+
+                std::vector<size_t> dimension_res;
+                next.get_dimensions(dimension_res);
+                if (dimension_res != dimension_next) next.create(dimension_next);
+
+                this->resampleBSplineDimension(pData, dimension, dims[d], dim_out[dims[d]], SplineDegree, next.begin());
+
+                pData = next.begin();
+                dimension = dimension_next;
+            }
+        }
+        catch (...)
+        {
+            GERROR_STREAM("Errors happened in hoNDBSpline<T, D, coord_type>::resampleBSpline(const hoNDArray<T>& data, unsigned int SplineDegree, const std::vector<size_t>& dim_out, hoNDArray<T>& res) ... ");
+            return false;
+        }
+
+        return true;
+    }
+
+    template <typename T, unsigned int D, typename coord_type>
+    void hoNDBSpline<T, D, coord_type>::computeBSplineWeightTable(size_t len, unsigned int SplineDegree, const std::vector<coord_type>& pos, 
+                                                                std::vector<bspline_float_type>& weight, std::vector<long long>& index)
+    {
+        size_t K = SplineDegree + 1;
+
+        weight.resize(pos.size() * K);
+        index.resize(pos.size() * K);
+
+        for (size_t n = 0; n < pos.size(); n++)
+        {
+            computeBSplineInterpolationLocationsAndWeights(len, SplineDegree, 0, pos[n], &weight[n * K], &index[n * K]);
+        }
+    }
+
+    template <typename T, unsigned int D, typename coord_type>
+    void hoNDBSpline<T, D, coord_type>::resampleBSplineDimension(const T* data, const std::vector<size_t>& dimension, size_t dim, size_t len_out, unsigned int SplineDegree, T* res)
+    {
+        size_t len = dimension[dim];
+
+        size_t stride = 1, outer = 1, d;
+        for (d = 0; d < dim; d++) stride *= dimension[d];
+        for (d = dim + 1; d < dimension.size(); d++) outer *= dimension[d];
+
+        std::vector<coord_type> pos(len_out, 0);
+        if (len_out > 1)
+        {
+            for (size_t n = 0; n < len_out; n++) pos[n] = (coord_type)(n * (len - 1)) / (coord_type)(len_out - 1);
+        }
+
+        size_t K = SplineDegree + 1;
+        std::vector<bspline_float_type> weight;
+        std::vector<long long> index;
+        this->computeBSplineWeightTable(len, SplineDegree, pos, weight, index);
+
+        unsigned int NbPoles;
+        bspline_float_type pole[4];
+        this->Pole(pole, SplineDegree, NbPoles);
+
+        // lines along dim that are neighbours in memory are filtered together, a block of them at a time
+        size_t block = std::min(stride, (size_t)64);
+        size_t num_blocks = (stride + block - 1) / block;
+        long long num = (long long)(outer * num_blocks);
+
+        long long n;
+#pragma omp parallel default(none) private(n) shared(data, res, len, len_out, stride, block, num_blocks, num, K, weight, index, pole, NbPoles)
+        {
+            std::vector<T> buf(len * block);
+
+#pragma omp for 
+            for (n = 0; n < num; n++)
+            {
+                size_t o = n / num_blocks;
+                size_t first = (n % num_blocks) * block;
+                size_t lines = std::min(block, stride - first);
+
+                const T* pIn = data + o * len * stride + first;
+                T* pOut = res + o * len_out * stride + first;
+
+                size_t i, k, l;
+                for (i = 0; i < len; i++)
+                {
+                    memcpy(&buf[i * lines], pIn + i * stride, sizeof(T) * lines);
+                }
+
+                ConvertToInterpolationCoefficients(buf.data(), len, lines, pole, NbPoles, DBL_EPSILON);
+
+                for (i = 0; i < len_out; i++)
+                {
+                    const bspline_float_type* w = &weight[i * K];
+                    const long long* ind = &index[i * K];
+                    T* r = pOut + i * stride;
+
+                    if (lines == 1)
+                    {
+                        T v = buf[ind[0]] * w[0];
+                        for (k = 1; k < K; k++) v += buf[ind[k]] * w[k];
+                        *r = v;
+                        continue;
+                    }
+
+                    const T* c = &buf[ind[0] * lines];
+#pragma omp simd
+                    for (l = 0; l < lines; l++) r[l] = c[l] * w[0];
+
+                    for (k = 1; k < K; k++)
+                    {
+                        c = &buf[ind[k] * lines];
+                        bspline_float_type wk = w[k];
+#pragma omp simd
+                        for (l = 0; l < lines; l++) r[l] += c[l] * wk;
+                    }
+                }
+            }
+        }
+    }
+
     template <typename T, unsigned int D, typename coord_type>
     void hoNDBSpline<T, D, coord_type>::print(std::ostream& os) const
     {
@@ -1784,6 +1956,111 @@ template <typename T, unsigned int D, typename coord_type>
         }
     } /* end ConvertToInterpolationCoefficients */
 
+    template <typename T, unsigned int D, typename coord_type>
+    void hoNDBSpline<T, D, coord_type>::ConvertToInterpolationCoefficients(T c[], size_t DataLength, size_t Lines, bspline_float_type z[], long NbPoles, bspline_float_type Tolerance)
+    {
+        double Lambda = 1.0;
+        long k;
+        size_t n, l;
+
+        /* special case required by mirror boundaries */
+        if (DataLength == 1L)
+        {
+            return;
+        }
+
+        /* compute the overall gain */
+        for (k = 0L; k < NbPoles; k++)
+        {
+            Lambda = Lambda * (1.0 - z[k]) * (1.0 - 1.0 / z[k]);
+        }
+
+        /* apply the gain */
+        bspline_float_type gain = (bspline_float_type)Lambda;
+        size_t N = DataLength * Lines;
+#pragma omp simd
+        for (n = 0; n < N; n++)
+        {
+            c[n] *= gain;
+        }
+
+        T* first = c;
+        T* last = c + (DataLength - 1) * Lines;
+
+        /* loop over all poles */
+        for (k = 0L; k < NbPoles; k++)
+        {
+            bspline_float_type zk = z[k];
+
+            /* causal initialization, as InitialCausalCoefficient, accumulated in the first sample of every line */
+            size_t Horizon = DataLength;
+            if (Tolerance > 0.0)
+            {
+                Horizon = (size_t)std::ceil(log(Tolerance) / log(fabs(zk)));
+            }
+
+            if (Horizon < DataLength)
+            {
+                bspline_float_type zn = zk;
+                for (n = 1; n < Horizon; n++)
+                {
+                    const T* cn = c + n * Lines;
+#pragma omp simd
+                    for (l = 0; l < Lines; l++) first[l] += zn * cn[l];
+                    zn *= zk;
+                }
+            }
+            else
+            {
+                bspline_float_type zn = zk;
+                bspline_float_type iz = (bspline_float_type)(1.0) / zk;
+                bspline_float_type z2n = std::pow(zk, (bspline_float_type)(DataLength - 1L));
+
+#pragma omp simd
+                for (l = 0; l < Lines; l++) first[l] += z2n * last[l];
+                z2n *= z2n * iz;
+
+                for (n = 1; n + 1 < DataLength; n++)
+                {
+                    const T* cn = c + n * Lines;
+                    bspline_float_type zw = zn + z2n;
+#pragma omp simd
+                    for (l = 0; l < Lines; l++) first[l] += zw * cn[l];
+                    zn *= zk;
+                    z2n *= iz;
+                }
+
+                bspline_float_type scale = (bspline_float_type)(1.0) / (bspline_float_type)(1.0 - zn * zn);
+#pragma omp simd
+                for (l = 0; l < Lines; l++) first[l] *= scale;
+            }
+
+            /* causal recursion */
+            for (n = 1; n < DataLength; n++)
+            {
+                T* cn = c + n * Lines;
+                const T* cp = cn - Lines;
+#pragma omp simd
+                for (l = 0; l < Lines; l++) cn[l] += zk * cp[l];
+            }
+
+            /* anticausal initialization, as InitialAntiCausalCoefficient */
+            const T* before_last = last - Lines;
+            bspline_float_type za = zk / (zk * zk - (bspline_float_type)1.0);
+#pragma omp simd
+            for (l = 0; l < Lines; l++) last[l] = za * (zk * before_last[l] + last[l]);
+
+            /* anticausal recursion */
+            for (n = DataLength - 1; n-- > 0; )
+            {
+                T* cn = c + n * Lines;
+                const T* cx = cn + Lines;
+#pragma omp simd
+                for (l = 0; l < Lines; l++) cn[l] = zk * (cx[l] - cn[l]);
+            }
+        }
+    }
+
     template <typename T, unsigned int D, typename coord_type>
     T hoNDBSpline<T, D, coord_type>::InitialCausalCoefficient(T c[], size_t DataLength, bspline_float_type z, bspline_float_type Tolerance)
     { /* begin InitialCausalCoefficient */
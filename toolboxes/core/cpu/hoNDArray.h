@@ -11,6 +11,7 @@
 #include <boost/shared_ptr.hpp>
 #include <stdexcept>
 #include "TypeTraits.h"
+#include "hoNDArray_memory.h"
 
 namespace Gadgetron{
 
@@ -311,18 +312,38 @@ namespace Gadgetron{
     virtual void deallocate_memory();
 
     // Generic allocator / deallocator
+    // Large arrays of trivial types may be memory-mapped, depending on the MappedMemory policy in effect.
+    // Large arrays are accounted against the memory budget; adopted storage is not, and accounted_ tells which.
     //
 
     template<class X> void _allocate_memory( size_t size, X** data )
     {
+      if constexpr (std::is_trivially_copyable<X>::value && std::is_trivially_destructible<X>::value)
+      {
+        void* mapped = MappedMemory::allocate(size*sizeof(X));
+        if (mapped)
+        {
+          *data = reinterpret_cast<X*>(mapped);
+          return;
+        }
+      }
+
       *data = new X[size];
+      if (size*sizeof(X) >= MappedMemory::accounting_granularity) accounted_ = MappedMemory::account(size*sizeof(X));
     }
 
-    template<class X> void _deallocate_memory( X* data )
+    template<class X> void _deallocate_memory( X* data, size_t size )
     {
+      auto accounted = accounted_;
+      accounted_ = 0;
+      if (MappedMemory::release(data)) return;
+      if (accounted) MappedMemory::unaccount(size*sizeof(X), accounted);
       delete [] data;
     }
 
+    // Process the heap storage is accounted to, as returned by MappedMemory::account; 0 if not accounted
+    int64_t accounted_ = 0;
+
 
   };
 
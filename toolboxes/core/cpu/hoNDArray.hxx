@@ -6,6 +6,7 @@
 #include "vector_td_utilities.h"
 #include <cstring>
 #include <numeric>
+#include <utility>
 
 namespace Gadgetron {
     template<typename T>
@@ -257,6 +258,7 @@ namespace Gadgetron {
         a.data_ = nullptr;
         this->offsetFactors_ = a.offsetFactors_;
         this->delete_data_on_destruct_ = a.delete_data_on_destruct_;
+        this->accounted_ = std::exchange(a.accounted_, 0);
     }
 
 
@@ -301,6 +303,7 @@ namespace Gadgetron {
         data_ = rhs.data_;
         rhs.data_ = nullptr;
         this->delete_data_on_destruct_ = rhs.delete_data_on_destruct_;
+        this->accounted_ = std::exchange(rhs.accounted_, 0);
         return *this;
     }
 
@@ -802,7 +805,7 @@ namespace Gadgetron {
         }
 
         if (this->data_) {
-            this->_deallocate_memory(this->data_);
+            this->_deallocate_memory(this->data_, this->elements_);
             this->data_ = 0x0;
         }
     }
@@ -0,0 +1,250 @@
+/** \file hoNDArrayStridedView.h
+    \brief Non-owning view of a CPU array with arbitrary strides.
+*/
+
+#pragma once
+
+#include "hoNDArray.h"
+
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Gadgetron {
+
+    /**
+     * Non-owning view of elements of a hoNDArray (or any buffer), with a stride per dimension. Slicing, taking ranges
+     * and reordering dimensions produce new views of the same data, so sub-volumes and transposed layouts can be
+     * handed to the math, BLAS and FFT wrappers without copying. Use a view of const T for read only access.
+     *
+     * The view does not keep the data alive; it is invalidated with the array it was taken from.
+     */
+    template <class T> class hoNDArrayStridedView {
+    public:
+        using value_type = std::remove_const_t<T>;
+
+        hoNDArrayStridedView(T* data, std::vector<size_t> dimensions, std::vector<size_t> strides)
+            : data_(data), dimensions_(std::move(dimensions)), strides_(std::move(strides)) {
+            if (dimensions_.size() != strides_.size())
+                throw std::runtime_error("hoNDArrayStridedView: dimensions and strides must have the same length");
+        }
+
+        template <class ARRAY, class = std::enable_if_t<std::is_same_v<std::remove_const_t<ARRAY>, hoNDArray<value_type>>>>
+        hoNDArrayStridedView(ARRAY& array) : data_(array.data()), dimensions_(array.dimensions()), strides_(array.dimensions().size()) {
+            size_t stride = 1;
+            for (size_t d = 0; d < dimensions_.size(); d++) {
+                strides_[d] = stride;
+                stride *= dimensions_[d];
+            }
+        }
+
+        /** Read only view of a view. */
+        template <class U, class = std::enable_if_t<std::is_same_v<const U, T> && !std::is_same_v<U, T>>>
+        hoNDArrayStridedView(const hoNDArrayStridedView<U>& other)
+            : data_(other.data()), dimensions_(other.dimensions()), strides_(other.strides()) {}
+
+        T* data() const { return data_; }
+        const std::vector<size_t>& dimensions() const { return dimensions_; }
+        const std::vector<size_t>& strides() const { return strides_; }
+        size_t get_number_of_dimensions() const { return dimensions_.size(); }
+        size_t get_size(size_t dimension) const { return dimensions_.at(dimension); }
+        size_t get_stride(size_t dimension) const { return strides_.at(dimension); }
+
+        size_t size() const {
+            return std::accumulate(dimensions_.begin(), dimensions_.end(), size_t(1), std::multiplies<>());
+        }
+
+        /** View with 'dimension' fixed at 'index'; the dimension is removed. */
+        hoNDArrayStridedView slice(size_t dimension, size_t index) const {
+            check_dimension(dimension, index, 1);
+            auto dimensions = dimensions_;
+            auto strides = strides_;
+            dimensions.erase(dimensions.begin() + dimension);
+            strides.erase(strides.begin() + dimension);
+            return { data_ + index * strides_[dimension], std::move(dimensions), std::move(strides) };
+        }
+
+        /** View of 'count' indices along 'dimension', starting at 'start' and 'step' apart. */
+        hoNDArrayStridedView range(size_t dimension, size_t start, size_t count, size_t step = 1) const {
+            if (step == 0) throw std::runtime_error("hoNDArrayStridedView::range: step must be positive");
+            check_dimension(dimension, start, count == 0 ? 0 : (count - 1) * step + 1);
+            auto dimensions = dimensions_;
+            auto strides = strides_;
+            dimensions[dimension] = count;
+            strides[dimension] *= step;
+            return { data_ + start * strides_[dimension], std::move(dimensions), std::move(strides) };
+        }
+
+        /** View where dimension i is dimension order[i] of this view. */
+        hoNDArrayStridedView permute(const std::vector<size_t>& order) const {
+            if (order.size() != dimensions_.size())
+                throw std::runtime_error("hoNDArrayStridedView::permute: order must name every dimension");
+
+            std::vector<size_t> dimensions, strides;
+            std::vector<bool> seen(order.size(), false);
+            for (auto d : order) {
+                if (d >= order.size() || seen[d])
+                    throw std::runtime_error("hoNDArrayStridedView::permute: invalid dimension order");
+                seen[d] = true;
+                dimensions.push_back(dimensions_[d]);
+                strides.push_back(strides_[d]);
+            }
+            return { data_, std::move(dimensions), std::move(strides) };
+        }
+
+        T& operator()(const std::vector<size_t>& index) const {
+            size_t offset = 0;
+            for (size_t d = 0; d < index.size(); d++) offset += index[d] * strides_[d];
+            return data_[offset];
+        }
+
+        template <class... INDICES, class = std::enable_if_t<Core::all_of_v<Core::is_convertible_v<INDICES, size_t>...>>>
+        T& operator()(INDICES... indices) const {
+            size_t offset = 0, d = 0;
+            ((offset += size_t(indices) * strides_[d++]), ...);
+            return data_[offset];
+        }
+
+        /** True if the view covers a dense block in the usual (first dimension fastest) order. */
+        bool is_contiguous() const {
+            size_t stride = 1;
+            for (size_t d = 0; d < dimensions_.size(); d++) {
+                if (dimensions_[d] != 1 && strides_[d] != stride) return false;
+                stride *= dimensions_[d];
+            }
+            return true;
+        }
+
+        /** Array sharing the view's data. Only available for contiguous views. */
+        hoNDArray<value_type> as_array() const {
+            if (!is_contiguous())
+                throw std::runtime_error("hoNDArrayStridedView::as_array: view is not contiguous; use copy()");
+            return hoNDArray<value_type>(dimensions_, const_cast<value_type*>(data_));
+        }
+
+        /** Dense copy of the viewed elements. */
+        hoNDArray<value_type> copy() const;
+
+        /** Copies the elements of 'other', which must have the same dimensions, into the view. */
+        template <class U> const hoNDArrayStridedView& operator=(const hoNDArrayStridedView<U>& other) const;
+        const hoNDArrayStridedView& operator=(const hoNDArrayStridedView& other) const {
+            return this->operator=<T>(other);
+        }
+        const hoNDArrayStridedView& operator=(const hoNDArray<value_type>& other) const {
+            return *this = hoNDArrayStridedView<const value_type>(other);
+        }
+
+        hoNDArrayStridedView(const hoNDArrayStridedView&) = default;
+
+    private:
+        void check_dimension(size_t dimension, size_t start, size_t extent) const {
+            if (dimension >= dimensions_.size())
+                throw std::runtime_error("hoNDArrayStridedView: dimension out of range");
+            if (start + extent > dimensions_[dimension])
+                throw std::runtime_error("hoNDArrayStridedView: index out of range");
+        }
+
+        T* data_;
+        std::vector<size_t> dimensions_;
+        std::vector<size_t> strides_;
+    };
+
+    template <class T> hoNDArrayStridedView<T> strided_view(hoNDArray<T>& array) { return { array }; }
+    template <class T> hoNDArrayStridedView<const T> strided_view(const hoNDArray<T>& array) { return { array }; }
+
+    namespace strided_view_detail {
+        /** The dimension with the smallest stride, ignoring dimensions of size one. */
+        inline size_t innermost(const std::vector<size_t>& dimensions, const std::vector<size_t>& strides) {
+            size_t inner = 0;
+            for (size_t d = 1; d < dimensions.size(); d++) {
+                if (dimensions[d] > 1 && (dimensions[inner] == 1 || strides[d] < strides[inner])) inner = d;
+            }
+            return inner;
+        }
+
+        template <class F, size_t... I, class... VIEWS>
+        void for_each_run(F&& f, std::index_sequence<I...>, const VIEWS&... views) {
+            constexpr size_t N = sizeof...(VIEWS);
+            const auto& dimensions = std::get<0>(std::tie(views...)).dimensions();
+            if (!((views.dimensions() == dimensions) && ...))
+                throw std::runtime_error("hoNDArrayStridedView: views must have the same dimensions");
+            if (std::accumulate(dimensions.begin(), dimensions.end(), size_t(1), std::multiplies<>()) == 0) return;
+
+            std::array<const std::vector<size_t>*, N> strides{ &views.strides()... };
+            if (dimensions.empty()) {
+                f(views.data()..., ((void)I, size_t(1))..., size_t(1));
+                return;
+            }
+
+            auto inner = innermost(dimensions, *strides[0]);
+            auto length = dimensions[inner];
+            std::array<size_t, N> offsets{};
+            std::vector<size_t> counter(dimensions.size(), 0);
+
+            while (true) {
+                f((views.data() + offsets[I])..., (*strides[I])[inner]..., length);
+
+                size_t d = 0;
+                for (; d < dimensions.size(); d++) {
+                    if (d == inner) continue;
+                    if (++counter[d] < dimensions[d]) {
+                        for (size_t v = 0; v < N; v++) offsets[v] += (*strides[v])[d];
+                        break;
+                    }
+                    for (size_t v = 0; v < N; v++) offsets[v] -= (counter[d] - 1) * (*strides[v])[d];
+                    counter[d] = 0;
+                }
+                if (d == dimensions.size()) return;
+            }
+        }
+    }
+
+    /**
+     * Calls f(pointers..., strides..., length) for every one dimensional run of elements of the views, which must
+     * have the same dimensions. Runs follow the dimension with the smallest stride in the first view, so operations
+     * on views map onto the strided BLAS routines or simple loops.
+     */
+    template <class F, class... VIEWS> void for_each_run(F&& f, const VIEWS&... views) {
+        strided_view_detail::for_each_run(std::forward<F>(f), std::index_sequence_for<VIEWS...>{}, views...);
+    }
+
+    /** Applies f to every element, in the view's memory order. */
+    template <class T, class F> void for_each(const hoNDArrayStridedView<T>& view, F&& f) {
+        for_each_run(
+            [&](T* data, size_t stride, size_t length) {
+                for (size_t i = 0; i < length; i++) f(data[i * stride]);
+            },
+            view);
+    }
+
+    template <class T> void fill(const hoNDArrayStridedView<T>& view, const std::remove_const_t<T>& value) {
+        for_each(view, [&](auto& x) { x = value; });
+    }
+
+    template <class T> hoNDArray<std::remove_const_t<T>> hoNDArrayStridedView<T>::copy() const {
+        hoNDArray<value_type> result(dimensions_);
+        strided_view(result) = *this;
+        return result;
+    }
+
+    template <class T>
+    template <class U>
+    const hoNDArrayStridedView<T>& hoNDArrayStridedView<T>::operator=(const hoNDArrayStridedView<U>& other) const {
+        static_assert(!std::is_const_v<T>, "Cannot assign to a view of const elements");
+        for_each_run(
+            [](T* out, const U* in, size_t out_stride, size_t in_stride, size_t length) {
+                if (out_stride == 1 && in_stride == 1) {
+                    std::copy_n(in, length, out);
+                    return;
+                }
+                for (size_t i = 0; i < length; i++) out[i * out_stride] = in[i * in_stride];
+            },
+            *this, other);
+        return *this;
+    }
+}
@@ -3,10 +3,13 @@
 #pragma once
 
 #include "hoNDArray.h"
+#include "hoNDArray_memory.h"
 
 #include <iostream>
 #include <fstream>
 #include <vector>
+#include <limits>
+#include <stdexcept>
 #include <string.h>
 #include <boost/shared_ptr.hpp>
 
@@ -62,5 +65,61 @@ template <class T> boost::shared_ptr< hoNDArray<T> > read_nd_array(const char* f
   
   return out;
 }
+
+/**
+ * Reads an array written by write_nd_array without copying: the file is mapped privately (copy-on-write),
+ * so the data is only paged in when accessed and changes to the array never reach the file.
+ * Falls back to read_nd_array if the file cannot be mapped; throws if the file is shorter than its header says.
+ */
+template <class T> boost::shared_ptr< hoNDArray<T> > read_nd_array_mapped(const char* filename)
+{
+  int dimensions,tmp;
+  std::vector<size_t> dim_array;
+  std::fstream f(filename,std::ios::in | std::ios::binary);
+
+  if( !f.is_open() ){
+    GDEBUG_STREAM("ERROR: Cannot open file " << filename << std::endl);
+    return boost::shared_ptr< hoNDArray<T> >();
+  }
+
+  f.seekg(0, std::ios::end);
+  size_t file_size = static_cast<size_t>(f.tellg());
+  f.seekg(0, std::ios::beg);
+
+  // dimensions beyond what hoNDArray handles, or an element count that overflows, mean a corrupt header
+  const int max_dimensions = 64;
+  f.read(reinterpret_cast<char*>(&dimensions),sizeof(int));
+  if( !f || dimensions < 0 || dimensions > max_dimensions ){
+    GDEBUG_STREAM("ERROR: Invalid header in file " << filename << std::endl);
+    return boost::shared_ptr< hoNDArray<T> >();
+  }
+
+  size_t elements = 1;
+  for (int i = 0; i < dimensions; i++)
+  {
+    f.read(reinterpret_cast<char*>(&tmp),sizeof(int));
+    if( !f || tmp < 0 || (tmp > 0 && elements > std::numeric_limits<size_t>::max() / sizeof(T) / static_cast<size_t>(tmp)) ){
+      GDEBUG_STREAM("ERROR: Invalid header in file " << filename << std::endl);
+      return boost::shared_ptr< hoNDArray<T> >();
+    }
+    dim_array.push_back(static_cast<size_t>(tmp));
+    elements *= static_cast<size_t>(tmp);
+  }
+  f.close();
+
+  size_t offset = sizeof(int)*(dimensions+1);
+  if ( offset + sizeof(T)*elements > file_size )
+    throw std::runtime_error("File " + std::string(filename) + " is shorter than the array in its header");
+
+  if ( dimensions == 0 || elements == 0 || offset % alignof(T) != 0 ) return read_nd_array<T>(filename);
+
+  T* data = static_cast<T*>(MappedMemory::map_file(filename, offset, sizeof(T)*elements));
+  if ( !data ) return read_nd_array<T>(filename);
+
+  MappedMemory::advise(data, MappedMemory::Advice::sequential);
+
+  // The array owns the mapping; it is unmapped by the regular deallocation path.
+  return boost::make_shared< hoNDArray<T> >(dim_array, data, true);
+}
 }
 #endif
@@ -0,0 +1,485 @@
+#include "hoNDArray_memory.h"
+
+#include "log.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace Gadgetron { namespace MappedMemory {
+
+    namespace {
+
+        struct Mapping
+        {
+            void* base;
+            size_t length;
+            /// anonymous mappings are held in memory, and accounted; see account
+            int64_t accounted;
+        };
+
+        Policy policy_from_environment()
+        {
+            Policy policy;
+
+            if (auto threshold = std::getenv("GADGETRON_MAPPED_MEMORY_THRESHOLD_MB"))
+                policy.threshold_bytes = size_t(std::atof(threshold) * 1024 * 1024);
+            if (auto directory = std::getenv("GADGETRON_MAPPED_MEMORY_DIR"))
+                policy.directory = directory;
+            if (auto hugepages = std::getenv("GADGETRON_MAPPED_MEMORY_HUGEPAGES"))
+                policy.hugepages = std::string(hugepages) == "1";
+
+            return policy;
+        }
+
+        std::mutex& policy_mutex()
+        {
+            static std::mutex m;
+            return m;
+        }
+
+        Policy& global_policy()
+        {
+            static Policy policy = policy_from_environment();
+            return policy;
+        }
+
+        // Threshold of the global policy, so that allocations below it neither lock nor copy the policy.
+        std::atomic<size_t>& global_threshold()
+        {
+            static std::atomic<size_t> threshold{ []() {
+                std::lock_guard<std::mutex> guard(policy_mutex());
+                return global_policy().threshold_bytes;
+            }() };
+            return threshold;
+        }
+
+        thread_local const Policy* thread_policy = nullptr;
+
+        // Mapped arrays are rare; the counter lets release() skip the registry entirely for heap memory.
+        std::atomic<size_t> live_mappings{0};
+
+        std::mutex& registry_mutex()
+        {
+            static std::mutex m;
+            return m;
+        }
+
+        std::unordered_map<const void*, Mapping>& registry()
+        {
+            static std::unordered_map<const void*, Mapping> mappings;
+            return mappings;
+        }
+
+        void add_mapping(const void* ptr, Mapping mapping)
+        {
+            std::lock_guard<std::mutex> guard(registry_mutex());
+            registry()[ptr] = mapping;
+            live_mappings++;
+        }
+
+        Budget budget_from_environment()
+        {
+            Budget budget;
+
+            if (auto bytes = std::getenv("GADGETRON_MEMORY_BUDGET_MB"))
+                budget.connection_bytes = size_t(std::atof(bytes) * 1024 * 1024);
+            if (auto bytes = std::getenv("GADGETRON_SERVER_MEMORY_BUDGET_MB"))
+                budget.server_bytes = size_t(std::atof(bytes) * 1024 * 1024);
+
+            return budget;
+        }
+
+        Budget& global_budget()
+        {
+            static Budget budget = budget_from_environment();
+            return budget;
+        }
+
+        // Nothing is accounted until a budget is set, so that allocations neither count nor share a cache line
+        // when no one is looking. Once on, accounting stays on; memory accounted is unaccounted when freed, and
+        // memory allocated before is not.
+        std::atomic<bool>& accounting_enabled()
+        {
+            static std::atomic<bool> enabled{ []() {
+                std::lock_guard<std::mutex> guard(policy_mutex());
+                return global_budget().connection_bytes != 0 || global_budget().server_bytes != 0;
+            }() };
+            return enabled;
+        }
+
+        // Bytes held by one process. The slots live in memory shared with forked processes, so the server sees
+        // what each of its connections holds.
+        struct Slot
+        {
+            std::atomic<int64_t> pid;
+            std::atomic<int64_t> bytes;
+        };
+
+        constexpr size_t max_processes = 1024;
+
+        struct Accounting
+        {
+            Slot slots[max_processes];
+            std::atomic<size_t> used;
+        };
+
+        std::mutex& accounting_mutex()
+        {
+            static std::mutex m;
+            return m;
+        }
+
+        std::atomic<Slot*> own_slot{nullptr};
+        std::atomic<int64_t> own_pid{0};
+        Slot private_slot;
+
+        bool alive(int64_t pid)
+        {
+#ifdef _WIN32
+            return true;
+#else
+            return kill(pid_t(pid), 0) == 0 || errno != ESRCH;
+#endif
+        }
+
+        int64_t current_pid()
+        {
+#ifdef _WIN32
+            return 1;
+#else
+            return getpid();
+#endif
+        }
+
+        Accounting& shared_accounting()
+        {
+            static Accounting* accounting = []() {
+#ifndef _WIN32
+                // A forked process starts over with a slot of its own; what it inherited is accounted by its parent.
+                pthread_atfork(
+                    []() { accounting_mutex().lock(); },
+                    []() { accounting_mutex().unlock(); },
+                    []() {
+                        own_slot.store(nullptr, std::memory_order_relaxed);
+                        own_pid.store(0, std::memory_order_relaxed);
+                        accounting_mutex().unlock();
+                    });
+
+                void* ptr = mmap(nullptr, sizeof(Accounting), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+                if (ptr != MAP_FAILED) return new (ptr) Accounting();
+#endif
+                return new Accounting();
+            }();
+            return *accounting;
+        }
+
+        Slot& slot()
+        {
+            if (auto own = own_slot.load(std::memory_order_acquire)) return *own;
+
+            // Only claiming a slot, once per process, locks.
+            std::lock_guard<std::mutex> guard(accounting_mutex());
+            if (auto own = own_slot.load(std::memory_order_relaxed)) return *own;
+
+            auto& accounting = shared_accounting();
+            const auto pid = current_pid();
+            own_pid.store(pid, std::memory_order_relaxed);
+
+            for (size_t i = 0; i < max_processes; i++)
+            {
+                auto& candidate = accounting.slots[i];
+                auto holder = candidate.pid.load();
+                if (holder != 0 && alive(holder)) continue;
+                if (!candidate.pid.compare_exchange_strong(holder, pid)) continue;
+
+                candidate.bytes = 0;
+                size_t used = accounting.used.load();
+                while (used < i + 1 && !accounting.used.compare_exchange_weak(used, i + 1));
+
+                own_slot.store(&candidate, std::memory_order_release);
+                return candidate;
+            }
+
+            // Every slot is taken; this process holds memory the server does not see.
+            own_slot.store(&private_slot, std::memory_order_release);
+            return private_slot;
+        }
+
+#ifndef _WIN32
+        size_t page_size()
+        {
+            static const size_t size = size_t(sysconf(_SC_PAGESIZE));
+            return size;
+        }
+
+        void* map_anonymous(size_t bytes, bool hugepages)
+        {
+#ifdef MAP_HUGETLB
+            if (hugepages)
+            {
+                void* ptr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+                if (ptr != MAP_FAILED) return ptr;
+            }
+#endif
+            void* ptr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+            if (ptr == MAP_FAILED) return nullptr;
+
+#ifdef MADV_HUGEPAGE
+            // Fall back to transparent hugepages if none are reserved.
+            if (hugepages) madvise(ptr, bytes, MADV_HUGEPAGE);
+#endif
+            return ptr;
+        }
+
+        void* map_temporary_file(size_t bytes, const std::string& directory)
+        {
+            std::string pattern = directory + "/gadgetron_array_XXXXXX";
+            int fd = mkstemp(&pattern[0]);
+            if (fd < 0)
+            {
+                GWARN_STREAM("Could not create temporary file in " << directory << " for mapped array");
+                return nullptr;
+            }
+
+            // The file only lives as long as the mapping.
+            unlink(pattern.c_str());
+
+            void* ptr = MAP_FAILED;
+            if (ftruncate(fd, off_t(bytes)) == 0)
+                ptr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+            close(fd);
+            return ptr == MAP_FAILED ? nullptr : ptr;
+        }
+#endif
+    }
+
+    Policy default_policy()
+    {
+        std::lock_guard<std::mutex> guard(policy_mutex());
+        return global_policy();
+    }
+
+    void set_default_policy(const Policy& policy)
+    {
+        global_threshold();
+
+        std::lock_guard<std::mutex> guard(policy_mutex());
+        global_policy() = policy;
+        global_threshold().store(policy.threshold_bytes, std::memory_order_relaxed);
+    }
+
+    Policy current_policy()
+    {
+        if (thread_policy) return *thread_policy;
+        return default_policy();
+    }
+
+    ScopedPolicy::ScopedPolicy(const Policy& policy) : previous(thread_policy), policy(policy)
+    {
+        thread_policy = &this->policy;
+    }
+
+    ScopedPolicy::~ScopedPolicy()
+    {
+        thread_policy = previous;
+    }
+
+    void* allocate(size_t bytes)
+    {
+#ifdef _WIN32
+        return nullptr;
+#else
+        if (bytes == 0) return nullptr;
+
+        const size_t threshold = thread_policy ? thread_policy->threshold_bytes
+                                               : global_threshold().load(std::memory_order_relaxed);
+        if (threshold == 0 || bytes < threshold) return nullptr;
+
+        const Policy policy = current_policy();
+        if (policy.threshold_bytes == 0 || bytes < policy.threshold_bytes) return nullptr;
+
+        // Hugepage mappings have to be a multiple of the (2 MiB) hugepage size.
+        const size_t granularity = policy.hugepages ? size_t(2) * 1024 * 1024 : page_size();
+        size_t length = ((bytes + granularity - 1) / granularity) * granularity;
+
+        void* ptr = policy.directory.empty() ? map_anonymous(length, policy.hugepages)
+                                             : map_temporary_file(length, policy.directory);
+        if (!ptr) return nullptr;
+
+        const bool in_memory = policy.directory.empty();
+        add_mapping(ptr, Mapping{ ptr, length, in_memory ? account(length) : 0 });
+        return ptr;
+#endif
+    }
+
+    bool release(void* ptr)
+    {
+        if (!ptr || live_mappings.load(std::memory_order_relaxed) == 0) return false;
+
+        Mapping mapping;
+        {
+            std::lock_guard<std::mutex> guard(registry_mutex());
+            auto it = registry().find(ptr);
+            if (it == registry().end()) return false;
+            mapping = it->second;
+            registry().erase(it);
+            live_mappings--;
+        }
+
+#ifndef _WIN32
+        munmap(mapping.base, mapping.length);
+#endif
+        unaccount(mapping.length, mapping.accounted);
+        return true;
+    }
+
+    bool is_mapped(const void* ptr)
+    {
+        if (!ptr || live_mappings.load(std::memory_order_relaxed) == 0) return false;
+
+        std::lock_guard<std::mutex> guard(registry_mutex());
+        return registry().count(ptr) > 0;
+    }
+
+    void* map_file(const std::string& filename, size_t offset, size_t bytes)
+    {
+#ifdef _WIN32
+        return nullptr;
+#else
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return nullptr;
+
+        // Pages past the end of the file would raise SIGBUS on access.
+        size_t length = offset + bytes;
+        struct stat status;
+        if (bytes == 0 || length < offset || fstat(fd, &status) != 0 || status.st_size < 0 || size_t(status.st_size) < length)
+        {
+            close(fd);
+            return nullptr;
+        }
+
+        void* base = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        close(fd);
+
+        if (base == MAP_FAILED) return nullptr;
+
+        void* ptr = static_cast<char*>(base) + offset;
+        add_mapping(ptr, Mapping{ base, length, false });
+        return ptr;
+#endif
+    }
+
+    void advise(const void* ptr, Advice advice)
+    {
+#ifndef _WIN32
+        if (!ptr || live_mappings.load(std::memory_order_relaxed) == 0) return;
+
+        Mapping mapping;
+        {
+            std::lock_guard<std::mutex> guard(registry_mutex());
+            auto it = registry().find(ptr);
+            if (it == registry().end()) return;
+            mapping = it->second;
+        }
+
+        int flag = MADV_NORMAL;
+        switch (advice)
+        {
+            case Advice::normal: flag = MADV_NORMAL; break;
+            case Advice::sequential: flag = MADV_SEQUENTIAL; break;
+            case Advice::random: flag = MADV_RANDOM; break;
+            case Advice::will_need: flag = MADV_WILLNEED; break;
+            case Advice::page_out:
+#ifdef MADV_PAGEOUT
+                flag = MADV_PAGEOUT;
+                break;
+#else
+                return;
+#endif
+        }
+
+        madvise(mapping.base, mapping.length, flag);
+#endif
+    }
+
+    int64_t account(size_t bytes)
+    {
+        if (bytes < accounting_granularity || !accounting_enabled().load(std::memory_order_relaxed)) return 0;
+        slot().bytes.fetch_add(int64_t(bytes), std::memory_order_relaxed);
+        return own_pid.load(std::memory_order_relaxed);
+    }
+
+    void unaccount(size_t bytes, int64_t accounted)
+    {
+        // The process is recorded rather than a flag, as a forked process inherits the arrays of its parent.
+        if (accounted == 0 || accounted != own_pid.load(std::memory_order_relaxed)) return;
+        slot().bytes.fetch_sub(int64_t(bytes), std::memory_order_relaxed);
+    }
+
+    size_t allocated_bytes()
+    {
+        return size_t(std::max<int64_t>(slot().bytes.load(std::memory_order_relaxed), 0));
+    }
+
+    size_t server_allocated_bytes()
+    {
+        auto& accounting = shared_accounting();
+
+        size_t total = 0;
+        for (size_t i = 0; i < accounting.used.load(); i++)
+        {
+            auto& entry = accounting.slots[i];
+            auto pid = entry.pid.load();
+            if (pid == 0 || !alive(pid)) continue;
+            total += size_t(std::max<int64_t>(entry.bytes, 0));
+        }
+        return total;
+    }
+
+    Budget budget()
+    {
+        std::lock_guard<std::mutex> guard(policy_mutex());
+        return global_budget();
+    }
+
+    void set_budget(const Budget& budget)
+    {
+        // Processes forked from here on share the accounting with this one.
+        shared_accounting();
+
+        accounting_enabled();
+
+        std::lock_guard<std::mutex> guard(policy_mutex());
+        global_budget() = budget;
+        if (budget.connection_bytes || budget.server_bytes) accounting_enabled().store(true);
+    }
+
+    bool over_budget()
+    {
+        auto limits = budget();
+        if (limits.connection_bytes && allocated_bytes() > limits.connection_bytes) return true;
+        return limits.server_bytes && server_allocated_bytes() > limits.server_bytes;
+    }
+
+    bool server_over_budget()
+    {
+        auto limits = budget();
+        return limits.server_bytes && server_allocated_bytes() > limits.server_bytes;
+    }
+}}
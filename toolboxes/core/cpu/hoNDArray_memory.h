@@ -0,0 +1,125 @@
+/** \file hoNDArray_memory.h
+    \brief Memory-mapped storage for large hoNDArrays.
+
+    By default hoNDArray storage comes from the heap. Arrays whose size exceeds the threshold of the active
+    policy are instead backed by a memory mapping: either an anonymous (optionally hugepage) mapping, or an
+    unlinked temporary file in a given directory, which lets the kernel page buffered data out to disk instead
+    of exhausting memory when several large connections run concurrently.
+
+    The process wide policy is read from the environment on first use:
+        GADGETRON_MAPPED_MEMORY_THRESHOLD_MB    arrays at least this large are mapped (unset or 0 disables mapping)
+        GADGETRON_MAPPED_MEMORY_DIR             if set, mappings are backed by temporary files in this directory
+        GADGETRON_MAPPED_MEMORY_HUGEPAGES       if set to 1, anonymous mappings use hugepages where available
+
+    Individual threads, e.g. the thread of a buffering gadget, can override the policy with a ScopedPolicy.
+
+    Array storage held in memory (heap, and anonymous mappings; file backed mappings can always be paged out) is
+    accounted per process, which is per connection when connections are handled in forked processes. The processes
+    of a server share the accounting, so the total held by all connections is known as well. Accounting starts once a
+    budget is set, and costs nothing before. Budgets are read from the environment on first use, and may be set by
+    the server:
+        GADGETRON_MEMORY_BUDGET_MB              memory a connection (process) may hold (unset or 0 for no budget)
+        GADGETRON_SERVER_MEMORY_BUDGET_MB       memory all connections together may hold (unset or 0 for no budget)
+    Buffering gadgets spill what they hold to disk while over budget, and the server delays new connections.
+*/
+
+#pragma once
+
+#include "cpucore_export.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Gadgetron { namespace MappedMemory {
+
+    struct Policy
+    {
+        /// arrays of at least this many bytes are mapped; 0 disables mapping
+        size_t threshold_bytes = 0;
+        /// if not empty, mappings are backed by unlinked temporary files in this directory
+        std::string directory;
+        /// use hugepages for anonymous mappings if possible
+        bool hugepages = false;
+    };
+
+    EXPORTCPUCORE Policy default_policy();
+    EXPORTCPUCORE void set_default_policy(const Policy& policy);
+
+    /// Policy currently in effect for the calling thread
+    EXPORTCPUCORE Policy current_policy();
+
+    /// Overrides the policy for allocations made by the current thread, for the lifetime of the object
+    class EXPORTCPUCORE ScopedPolicy
+    {
+    public:
+        explicit ScopedPolicy(const Policy& policy);
+        ~ScopedPolicy();
+
+        ScopedPolicy(const ScopedPolicy&) = delete;
+        ScopedPolicy& operator=(const ScopedPolicy&) = delete;
+
+    private:
+        const Policy* previous;
+        Policy policy;
+    };
+
+    /// Returns mapped, zero initialized memory if the current policy asks for it, nullptr otherwise
+    EXPORTCPUCORE void* allocate(size_t bytes);
+
+    /// Releases memory obtained from allocate or map_file; returns false if ptr is not a mapping
+    EXPORTCPUCORE bool release(void* ptr);
+
+    EXPORTCPUCORE bool is_mapped(const void* ptr);
+
+    /// Maps bytes [offset, offset+bytes) of a file privately (copy-on-write), so the content is only read on access
+    /// Returns nullptr on failure, or if the file is shorter than offset+bytes
+    EXPORTCPUCORE void* map_file(const std::string& filename, size_t offset, size_t bytes);
+
+    enum class Advice
+    {
+        normal,
+        sequential,
+        random,
+        will_need,
+        /// the content is not needed for a while; pages may be written back and reclaimed, but are never lost
+        page_out
+    };
+
+    /// Passes an access pattern hint for the mapping containing ptr to the kernel; a no-op for heap memory
+    EXPORTCPUCORE void advise(const void* ptr, Advice advice);
+
+    /// Allocations smaller than a page are not accounted; there are many, and they add up to little.
+    constexpr size_t accounting_granularity = size_t(4) * 1024;
+
+    /// Accounts bytes of heap memory allocated to the calling process; a no-op until a budget is set
+    /// Returns what to pass to unaccount when the memory is freed; 0 if nothing was accounted
+    EXPORTCPUCORE int64_t account(size_t bytes);
+
+    /// Stops accounting bytes of heap memory freed, given what account returned for them. Memory accounted to
+    /// another process, e.g. inherited across a fork, stays accounted to that process.
+    EXPORTCPUCORE void unaccount(size_t bytes, int64_t accounted);
+
+    /// Bytes of array storage held in memory by this process
+    EXPORTCPUCORE size_t allocated_bytes();
+
+    /// Bytes of array storage held in memory by every process sharing the accounting, i.e. the whole server
+    EXPORTCPUCORE size_t server_allocated_bytes();
+
+    struct Budget
+    {
+        /// bytes a connection (process) may hold; 0 for no budget
+        size_t connection_bytes = 0;
+        /// bytes the server (every process sharing the accounting) may hold; 0 for no budget
+        size_t server_bytes = 0;
+    };
+
+    EXPORTCPUCORE Budget budget();
+    EXPORTCPUCORE void set_budget(const Budget& budget);
+
+    /// True if this connection, or the server as a whole, holds more than its budget
+    EXPORTCPUCORE bool over_budget();
+
+    /// True if the server as a whole holds more than its budget
+    EXPORTCPUCORE bool server_over_budget();
+}}
@@ -0,0 +1,207 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#include <xmmintrin.h>
+#define GADGETRON_PERMUTE_SSE2 1
+#endif
+
+namespace Gadgetron::Permute {
+
+    /**
+     * Strided description of a permutation: for every output dimension, its size and the stride of the matching input
+     * dimension. Output strides are dense. Dimensions of size one are dropped, and output dimensions that are also
+     * adjacent and in order in the input are merged, so [RO E1 E2 CHA] -> [RO E1 CHA E2] has two dimensions fewer to
+     * walk.
+     */
+    struct Layout {
+        std::vector<size_t> sizes;
+        std::vector<size_t> in_strides;
+        std::vector<size_t> out_strides;
+    };
+
+    inline Layout simplify(const std::vector<size_t>& in_dims, const std::vector<size_t>& order) {
+        std::vector<size_t> in_strides(in_dims.size(), 1);
+        for (size_t i = 1; i < in_dims.size(); i++) in_strides[i] = in_strides[i - 1] * in_dims[i - 1];
+
+        Layout layout;
+        for (auto dim : order) {
+            auto size = in_dims[dim];
+            auto stride = in_strides[dim];
+            if (size == 1) continue;
+
+            if (!layout.sizes.empty() && layout.in_strides.back() * layout.sizes.back() == stride) {
+                layout.sizes.back() *= size;
+                continue;
+            }
+            layout.sizes.push_back(size);
+            layout.in_strides.push_back(stride);
+        }
+
+        size_t stride = 1;
+        for (auto size : layout.sizes) {
+            layout.out_strides.push_back(stride);
+            stride *= size;
+        }
+        return layout;
+    }
+
+    /** Element offsets of a linear index over a subset of the layout's dimensions. */
+    struct Walker {
+        std::vector<size_t> sizes, in_strides, out_strides;
+
+        void offsets(size_t index, size_t& in, size_t& out) const {
+            in = out = 0;
+            for (size_t d = 0; d < sizes.size(); d++) {
+                auto i = index % sizes[d];
+                index /= sizes[d];
+                in += i * in_strides[d];
+                out += i * out_strides[d];
+            }
+        }
+
+        size_t count() const {
+            size_t count = 1;
+            for (auto size : sizes) count *= size;
+            return count;
+        }
+    };
+
+    /**
+     * Transposes a rows x cols tile: out[r + c * out_stride] = in[r * in_stride + c]. Reads run along c, writes along
+     * r; at the tile sizes used both sides stay in L1.
+     */
+    template <class T>
+    void transpose_tile(const T* in, size_t in_stride, T* out, size_t out_stride, size_t rows, size_t cols) {
+        size_t r = 0, c = 0;
+
+#if GADGETRON_PERMUTE_SSE2
+        if constexpr (std::is_trivially_copyable_v<T> && sizeof(T) == 8) {
+            // 2x2 blocks of 64 bit elements (complex float, double) transposed in register.
+            for (; r + 2 <= rows; r += 2) {
+                for (c = 0; c + 2 <= cols; c += 2) {
+                    auto a = _mm_loadu_pd(reinterpret_cast<const double*>(in + r * in_stride + c));
+                    auto b = _mm_loadu_pd(reinterpret_cast<const double*>(in + (r + 1) * in_stride + c));
+                    _mm_storeu_pd(reinterpret_cast<double*>(out + r + c * out_stride), _mm_unpacklo_pd(a, b));
+                    _mm_storeu_pd(reinterpret_cast<double*>(out + r + (c + 1) * out_stride), _mm_unpackhi_pd(a, b));
+                }
+                for (; c < cols; c++) {
+                    out[r + c * out_stride] = in[r * in_stride + c];
+                    out[r + 1 + c * out_stride] = in[(r + 1) * in_stride + c];
+                }
+            }
+        } else if constexpr (std::is_trivially_copyable_v<T> && sizeof(T) == 4) {
+            // 4x4 blocks of 32 bit elements (float).
+            for (; r + 4 <= rows; r += 4) {
+                for (c = 0; c + 4 <= cols; c += 4) {
+                    auto a = _mm_loadu_ps(reinterpret_cast<const float*>(in + r * in_stride + c));
+                    auto b = _mm_loadu_ps(reinterpret_cast<const float*>(in + (r + 1) * in_stride + c));
+                    auto d = _mm_loadu_ps(reinterpret_cast<const float*>(in + (r + 2) * in_stride + c));
+                    auto e = _mm_loadu_ps(reinterpret_cast<const float*>(in + (r + 3) * in_stride + c));
+                    _MM_TRANSPOSE4_PS(a, b, d, e);
+                    _mm_storeu_ps(reinterpret_cast<float*>(out + r + c * out_stride), a);
+                    _mm_storeu_ps(reinterpret_cast<float*>(out + r + (c + 1) * out_stride), b);
+                    _mm_storeu_ps(reinterpret_cast<float*>(out + r + (c + 2) * out_stride), d);
+                    _mm_storeu_ps(reinterpret_cast<float*>(out + r + (c + 3) * out_stride), e);
+                }
+                for (; c < cols; c++)
+                    for (size_t k = 0; k < 4; k++) out[r + k + c * out_stride] = in[(r + k) * in_stride + c];
+            }
+        }
+#endif
+
+        for (c = 0; c < cols; c++)
+            for (size_t k = r; k < rows; k++) out[k + c * out_stride] = in[k * in_stride + c];
+    }
+
+    /**
+     * Permutes the dimensions of the dense array 'in' (dimensions in_dims) into 'out', so that output dimension i is
+     * input dimension order[i].
+     *
+     * Runs of dimensions that keep their relative order are copied as contiguous blocks. Otherwise the output's
+     * fastest dimension is paired with the input's fastest dimension, and the two are transposed in square tiles;
+     * tiles and the remaining dimensions are distributed over threads.
+     */
+    template <class T>
+    void permute(const T* in, T* out, const std::vector<size_t>& in_dims, const std::vector<size_t>& order) {
+        size_t elements = 1;
+        for (auto size : in_dims) elements *= size;
+        if (elements == 0) return;
+
+        auto layout = simplify(in_dims, order);
+        if (layout.sizes.size() <= 1) {
+            std::copy_n(in, elements, out);
+            return;
+        }
+
+        constexpr size_t parallel_threshold = 1 << 16;
+
+        if (layout.in_strides[0] == 1) {
+            // The output's fastest dimension is contiguous in the input as well; copy it row by row.
+            Walker rows{ { layout.sizes.begin() + 1, layout.sizes.end() },
+                         { layout.in_strides.begin() + 1, layout.in_strides.end() },
+                         { layout.out_strides.begin() + 1, layout.out_strides.end() } };
+            auto length = layout.sizes[0];
+            auto count = (long long)rows.count();
+
+#ifdef USE_OMP
+#pragma omp parallel for schedule(static) if (elements >= parallel_threshold)
+#endif
+            for (long long row = 0; row < count; row++) {
+                size_t in_offset, out_offset;
+                rows.offsets(size_t(row), in_offset, out_offset);
+                std::copy_n(in + in_offset, length, out + out_offset);
+            }
+            return;
+        }
+
+        // Pair output dimension 0 with the dimension that is fastest in the input.
+        auto fast = size_t(std::min_element(layout.in_strides.begin() + 1, layout.in_strides.end()) -
+                           layout.in_strides.begin());
+
+        Walker batches;
+        for (size_t d = 1; d < layout.sizes.size(); d++) {
+            if (d == fast) continue;
+            batches.sizes.push_back(layout.sizes[d]);
+            batches.in_strides.push_back(layout.in_strides[d]);
+            batches.out_strides.push_back(layout.out_strides[d]);
+        }
+
+        constexpr size_t tile = sizeof(T) <= 8 ? 32 : 16;
+        auto rows = layout.sizes[0], cols = layout.sizes[fast];
+        auto row_tiles = (rows + tile - 1) / tile, col_tiles = (cols + tile - 1) / tile;
+        auto row_stride = layout.in_strides[0], col_stride = layout.in_strides[fast];
+        auto out_stride = layout.out_strides[fast];
+        auto units = (long long)(batches.count() * row_tiles * col_tiles);
+
+#ifdef USE_OMP
+#pragma omp parallel for schedule(static) if (elements >= parallel_threshold)
+#endif
+        for (long long unit = 0; unit < units; unit++) {
+            auto row_tile = size_t(unit) % row_tiles;
+            auto col_tile = size_t(unit) / row_tiles % col_tiles;
+            auto batch = size_t(unit) / row_tiles / col_tiles;
+
+            size_t in_offset, out_offset;
+            batches.offsets(batch, in_offset, out_offset);
+
+            auto r = row_tile * tile, c = col_tile * tile;
+            in_offset += r * row_stride + c * col_stride;
+            out_offset += r + c * out_stride;
+
+            auto tile_rows = std::min(tile, rows - r), tile_cols = std::min(tile, cols - c);
+            if (col_stride == 1) {
+                transpose_tile(in + in_offset, row_stride, out + out_offset, out_stride, tile_rows, tile_cols);
+            } else {
+                for (size_t j = 0; j < tile_cols; j++)
+                    for (size_t i = 0; i < tile_rows; i++)
+                        out[out_offset + i + j * out_stride] = in[in_offset + i * row_stride + j * col_stride];
+            }
+        }
+    }
+}
@@ -0,0 +1,101 @@
+/** \file hoNDArrayStridedView_math.h
+    \brief Element wise operations and BLAS reductions on strided views.
+*/
+
+#pragma once
+
+#include "cpp_blas.h"
+#include "hoNDArrayStridedView.h"
+
+#include <cmath>
+
+namespace Gadgetron {
+
+    /** Sum of absolute values (of real and imaginary parts for complex types), as BLAS asum. */
+    template <class T> typename realType<std::remove_const_t<T>>::Type asum(const hoNDArrayStridedView<T>& x) {
+        typename realType<std::remove_const_t<T>>::Type result = 0;
+        for_each_run([&](const auto* data, size_t stride, size_t length) { result += BLAS::asum(length, data, stride); },
+                     x);
+        return result;
+    }
+
+    template <class T> typename realType<std::remove_const_t<T>>::Type nrm2(const hoNDArrayStridedView<T>& x) {
+        typename realType<std::remove_const_t<T>>::Type result = 0;
+        for_each_run(
+            [&](const auto* data, size_t stride, size_t length) {
+                auto norm = BLAS::nrm2(length, data, stride);
+                result += norm * norm;
+            },
+            x);
+        return std::sqrt(result);
+    }
+
+    /** Dot product; the elements of x are conjugated if cc is set, as for hoNDArray. */
+    template <class T, class U>
+    std::remove_const_t<T> dot(const hoNDArrayStridedView<T>& x, const hoNDArrayStridedView<U>& y, bool cc = true) {
+        static_assert(std::is_same_v<std::remove_const_t<T>, std::remove_const_t<U>>, "Views must have the same type");
+        std::remove_const_t<T> result = 0;
+        for_each_run(
+            [&](const auto* a, const auto* b, size_t stride_a, size_t stride_b, size_t length) {
+                if constexpr (is_complex_type_v<std::remove_const_t<T>>) {
+                    result += cc ? BLAS::dotc(length, a, stride_a, b, stride_b)
+                                 : BLAS::dotu(length, a, stride_a, b, stride_b);
+                } else {
+                    result += BLAS::dot(length, a, stride_a, b, stride_b);
+                }
+            },
+            x, y);
+        return result;
+    }
+
+    template <class T> std::remove_const_t<T> sum(const hoNDArrayStridedView<T>& x) {
+        std::remove_const_t<T> result = 0;
+        for_each(x, [&](const auto& value) { result += value; });
+        return result;
+    }
+
+    /** y += a * x */
+    template <class S, class T, class U>
+    void axpy(S a, const hoNDArrayStridedView<T>& x, const hoNDArrayStridedView<U>& y) {
+        for_each_run(
+            [&](const auto* in, auto* out, size_t in_stride, size_t out_stride, size_t length) {
+                BLAS::axpy(length, std::remove_const_t<U>(a), in, in_stride, out, out_stride);
+            },
+            x, y);
+    }
+
+    /** x *= a */
+    template <class S, class T> void scal(S a, const hoNDArrayStridedView<T>& x) {
+        for_each_run([&](auto* data, size_t stride, size_t length) { BLAS::scal(length, a, data, stride); }, x);
+    }
+
+    namespace strided_view_detail {
+        template <class T, class U, class OP> void elementwise(const hoNDArrayStridedView<T>& x, const hoNDArrayStridedView<U>& y, OP op) {
+            for_each_run(
+                [&](const auto* in, auto* out, size_t in_stride, size_t out_stride, size_t length) {
+                    for (size_t i = 0; i < length; i++) op(out[i * out_stride], in[i * in_stride]);
+                },
+                x, y);
+        }
+    }
+
+    /** y += x */
+    template <class T, class U> void add(const hoNDArrayStridedView<T>& x, const hoNDArrayStridedView<U>& y) {
+        strided_view_detail::elementwise(x, y, [](auto& out, const auto& in) { out += in; });
+    }
+
+    /** y -= x */
+    template <class T, class U> void subtract(const hoNDArrayStridedView<T>& x, const hoNDArrayStridedView<U>& y) {
+        strided_view_detail::elementwise(x, y, [](auto& out, const auto& in) { out -= in; });
+    }
+
+    /** y *= x */
+    template <class T, class U> void multiply(const hoNDArrayStridedView<T>& x, const hoNDArrayStridedView<U>& y) {
+        strided_view_detail::elementwise(x, y, [](auto& out, const auto& in) { out *= in; });
+    }
+
+    /** y *= conj(x) */
+    template <class T, class U> void multiply_conj(const hoNDArrayStridedView<T>& x, const hoNDArrayStridedView<U>& y) {
+        strided_view_detail::elementwise(x, y, [](auto& out, const auto& in) { out *= conj(in); });
+    }
+}
@@ -0,0 +1,639 @@
+/** \file hoNDArray_batched_linalg.h
+    \brief Linear algebra on stacks of small matrices.
+
+    Per-pixel and per-location problems (coil combination, local calibration, curve fitting) solve a great number of
+    matrices of a few to a few tens of rows. Calling BLAS/LAPACK once per matrix is dominated by call overhead at those
+    sizes; the routines here instead work on a whole stack at once. The batch index is the innermost loop of every
+    kernel, so with the batch stored fastest ([batch, rows, cols]) the compiler vectorises across matrices.
+*/
+
+#pragma once
+
+#include "hoNDArray.h"
+#include "hoNDArrayStridedView.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace Gadgetron::Batched {
+
+    /**
+     * Non-owning view of 'count' matrices of rows x cols. Element (i, j) of matrix b is at
+     * data[b * batch_stride + i * row_stride + j * col_stride]. Matrices are stored column major with the batch
+     * fastest when taken from a hoNDArray of dimensions [count, rows, cols].
+     */
+    template <class T> struct MatrixStack {
+        T* data;
+        size_t count, rows, cols;
+        size_t batch_stride, row_stride, col_stride;
+
+        MatrixStack(T* data, size_t count, size_t rows, size_t cols, size_t batch_stride, size_t row_stride,
+                    size_t col_stride)
+            : data(data), count(count), rows(rows), cols(cols), batch_stride(batch_stride), row_stride(row_stride),
+              col_stride(col_stride) {}
+
+        /** Stack of an array of dimensions [count, rows] or [count, rows, cols]. */
+        template <class ARRAY, class = std::enable_if_t<std::is_same_v<std::remove_const_t<ARRAY>, hoNDArray<std::remove_const_t<T>>>>>
+        MatrixStack(ARRAY& array) : data(array.data()) {
+            auto& dims = array.dimensions();
+            if (dims.size() < 2 || dims.size() > 3)
+                throw std::runtime_error("MatrixStack: array must have dimensions [count, rows(, cols)]");
+            count = dims[0];
+            rows = dims[1];
+            cols = dims.size() == 3 ? dims[2] : 1;
+            batch_stride = 1;
+            row_stride = count;
+            col_stride = count * rows;
+        }
+
+        /** Stack of a view of dimensions [count, rows, cols]. */
+        MatrixStack(const hoNDArrayStridedView<T>& view) : data(view.data()) {
+            if (view.get_number_of_dimensions() != 3)
+                throw std::runtime_error("MatrixStack: view must have dimensions [count, rows, cols]");
+            count = view.get_size(0);
+            rows = view.get_size(1);
+            cols = view.get_size(2);
+            batch_stride = view.get_stride(0);
+            row_stride = view.get_stride(1);
+            col_stride = view.get_stride(2);
+        }
+
+        template <class U = T, class = std::enable_if_t<std::is_const_v<U>>>
+        MatrixStack(const MatrixStack<std::remove_const_t<T>>& other)
+            : MatrixStack(other.data, other.count, other.rows, other.cols, other.batch_stride, other.row_stride,
+                          other.col_stride) {}
+
+        T& operator()(size_t b, size_t i, size_t j) const {
+            return data[b * batch_stride + i * row_stride + j * col_stride];
+        }
+
+        /** Matrices first to first + n. */
+        MatrixStack block(size_t first, size_t n) const {
+            return { data + first * batch_stride, n, rows, cols, batch_stride, row_stride, col_stride };
+        }
+    };
+
+    namespace detail {
+        /** Matrices handled together by a kernel; sized so that a few columns of accumulators stay in registers/L1. */
+        constexpr size_t block_size = 32;
+        /** Stacks smaller than this are not split over threads. */
+        constexpr size_t parallel_threshold = 256;
+
+        template <class T> using real_t = typename realType<T>::Type;
+
+        /** Keeps the const stacks of the signatures below out of template argument deduction. */
+        template <class T> struct identity { using type = T; };
+        template <class T> using const_stack = MatrixStack<const typename identity<T>::type>;
+
+        // Complex arithmetic on the real and imaginary parts; std::complex's operators guard against NaN/inf in a
+        // way that prevents vectorisation.
+        template <class T> inline T mul(const T& a, const T& b) {
+            if constexpr (is_complex_type_v<T>)
+                return T(a.real() * b.real() - a.imag() * b.imag(), a.real() * b.imag() + a.imag() * b.real());
+            else
+                return a * b;
+        }
+
+        /** conj(a) * b */
+        template <class T> inline T mulc(const T& a, const T& b) {
+            if constexpr (is_complex_type_v<T>)
+                return T(a.real() * b.real() + a.imag() * b.imag(), a.real() * b.imag() - a.imag() * b.real());
+            else
+                return a * b;
+        }
+
+        template <class T> inline T conjugate(const T& a) {
+            if constexpr (is_complex_type_v<T>)
+                return T(a.real(), -a.imag());
+            else
+                return a;
+        }
+
+        template <class T> inline real_t<T> norm2(const T& a) {
+            if constexpr (is_complex_type_v<T>)
+                return a.real() * a.real() + a.imag() * a.imag();
+            else
+                return a * a;
+        }
+
+        template <class T> inline real_t<T> real_part(const T& a) {
+            if constexpr (is_complex_type_v<T>)
+                return a.real();
+            else
+                return a;
+        }
+
+        template <class T> inline T scale(const T& a, real_t<T> s) {
+            if constexpr (is_complex_type_v<T>)
+                return T(a.real() * s, a.imag() * s);
+            else
+                return a * s;
+        }
+
+        /** Calls f(first, n) for blocks of the batch, in parallel for large stacks. */
+        template <class F> void for_each_block(size_t count, F&& f) {
+            auto blocks = (long long)((count + block_size - 1) / block_size);
+#ifdef USE_OMP
+#pragma omp parallel for schedule(static) if (count >= parallel_threshold)
+#endif
+            for (long long block = 0; block < blocks; block++) {
+                auto first = size_t(block) * block_size;
+                f(first, std::min(block_size, count - first));
+            }
+        }
+
+        /**
+         * As for_each_block, with the block size a compile time constant for full blocks, so that kernels can keep
+         * their accumulators in registers. f must accept both size_t and std::integral_constant.
+         */
+        template <class F> void for_each_block_sized(size_t count, F&& f) {
+            for_each_block(count, [&](size_t first, size_t n) {
+                if (n == block_size)
+                    f(first, std::integral_constant<size_t, block_size>{});
+                else
+                    f(first, n);
+            });
+        }
+
+        inline void check(bool condition, const char* message) {
+            if (!condition) throw std::runtime_error(message);
+        }
+    }
+
+    /**
+     * C = op(A) * op(B) for every matrix of the stacks, where op conjugate transposes if the matching flag is set.
+     * C must not alias A or B.
+     */
+    template <class T>
+    void gemm(const MatrixStack<T>& C, const detail::const_stack<T>& A, bool conjA, const detail::const_stack<T>& B,
+              bool conjB) {
+        using namespace detail;
+        auto M = conjA ? A.cols : A.rows;
+        auto K = conjA ? A.rows : A.cols;
+        auto N = conjB ? B.rows : B.cols;
+        check(K == (conjB ? B.cols : B.rows), "Batched::gemm: inner dimensions do not match");
+        check(C.rows == M && C.cols == N, "Batched::gemm: C has the wrong size");
+        check(A.count == C.count && B.count == C.count, "Batched::gemm: stacks must have the same count");
+
+        for_each_block_sized(C.count, [&](size_t first, auto n) {
+            std::array<T, block_size> acc;
+            auto as = A.batch_stride, bs = B.batch_stride;
+            for (size_t j = 0; j < N; j++) {
+                for (size_t i = 0; i < M; i++) {
+                    std::fill_n(acc.begin(), size_t(n), T(0));
+                    for (size_t k = 0; k < K; k++) {
+                        auto a = conjA ? &A(first, k, i) : &A(first, i, k);
+                        auto b = conjB ? &B(first, j, k) : &B(first, k, j);
+                        if (conjA && conjB) {
+                            for (size_t p = 0; p < n; p++) acc[p] += conjugate(mul(b[p * bs], a[p * as]));
+                        } else if (conjA) {
+                            for (size_t p = 0; p < n; p++) acc[p] += mulc(a[p * as], b[p * bs]);
+                        } else if (conjB) {
+                            for (size_t p = 0; p < n; p++) acc[p] += mulc(b[p * bs], a[p * as]);
+                        } else {
+                            for (size_t p = 0; p < n; p++) acc[p] += mul(a[p * as], b[p * bs]);
+                        }
+                    }
+                    auto c = &C(first, i, j);
+                    for (size_t p = 0; p < n; p++) c[p * C.batch_stride] = acc[p];
+                }
+            }
+        });
+    }
+
+    /**
+     * C = A^H A for every matrix of the stack, as BLAS herk (syrk for real types). Only the lower triangle is
+     * computed; the upper triangle is filled in by symmetry, so C can be used as a full matrix.
+     */
+    template <class T> void herk(const MatrixStack<T>& C, const detail::const_stack<T>& A) {
+        using namespace detail;
+        auto N = A.cols, K = A.rows;
+        check(C.rows == N && C.cols == N, "Batched::herk: C has the wrong size");
+        check(A.count == C.count, "Batched::herk: stacks must have the same count");
+
+        for_each_block_sized(C.count, [&](size_t first, auto n) {
+            using R = real_t<T>;
+            constexpr size_t parts = is_complex_type_v<T> ? 2 : 1;
+            auto as = A.batch_stride, cs = C.batch_stride;
+
+            // Real and imaginary parts are split into separate arrays first, so the products below are plain real
+            // arithmetic across the batch rather than shuffles of interleaved complex numbers. The buffer is kept per
+            // thread, as it is too large to allocate for every block.
+            thread_local std::vector<R> split;
+            split.resize(parts * K * N * block_size);
+            auto re = [&](size_t k, size_t i) { return &split[(k + i * K) * parts * block_size]; };
+            auto im = [&](size_t k, size_t i) { return re(k, i) + block_size; };
+            for (size_t i = 0; i < N; i++) {
+                for (size_t k = 0; k < K; k++) {
+                    auto a = &A(first, k, i);
+                    auto r = re(k, i);
+                    for (size_t p = 0; p < n; p++) r[p] = real_part(a[p * as]);
+                    if constexpr (is_complex_type_v<T>) {
+                        auto m = im(k, i);
+                        for (size_t p = 0; p < n; p++) m[p] = a[p * as].imag();
+                    }
+                }
+            }
+
+            // Two rows of C at a time, over chunks of matrices short enough for the accumulators to stay in
+            // registers.
+            constexpr size_t width = 8;
+            for (size_t j = 0; j < N; j++) {
+                for (size_t i = j; i < N; i += 2) {
+                    auto i1 = std::min(i + 1, N - 1);
+                    for (size_t chunk = 0; chunk < n; chunk += width) {
+                        R re0[width] = {}, im0[width] = {}, re1[width] = {}, im1[width] = {};
+                        auto w = std::min(width, size_t(n) - chunk);
+
+                        for (size_t k = 0; k < K; k++) {
+                            auto br = re(k, j) + chunk, ar0 = re(k, i) + chunk, ar1 = re(k, i1) + chunk;
+                            if constexpr (is_complex_type_v<T>) {
+                                auto bi = im(k, j) + chunk, ai0 = im(k, i) + chunk, ai1 = im(k, i1) + chunk;
+                                for (size_t q = 0; q < w; q++) {
+                                    re0[q] += ar0[q] * br[q] + ai0[q] * bi[q];
+                                    im0[q] += ar0[q] * bi[q] - ai0[q] * br[q];
+                                    re1[q] += ar1[q] * br[q] + ai1[q] * bi[q];
+                                    im1[q] += ar1[q] * bi[q] - ai1[q] * br[q];
+                                }
+                            } else {
+                                for (size_t q = 0; q < w; q++) {
+                                    re0[q] += ar0[q] * br[q];
+                                    re1[q] += ar1[q] * br[q];
+                                }
+                            }
+                        }
+
+                        auto store = [&](size_t row, const R* real, const R* imag) {
+                            auto lower = &C(first + chunk, row, j), upper = &C(first + chunk, j, row);
+                            for (size_t q = 0; q < w; q++) {
+                                if constexpr (is_complex_type_v<T>) {
+                                    lower[q * cs] = T(real[q], imag[q]);
+                                    upper[q * cs] = T(real[q], -imag[q]);
+                                } else {
+                                    lower[q * cs] = upper[q * cs] = real[q];
+                                }
+                            }
+                        };
+                        store(i, re0, im0);
+                        if (i1 != i) store(i1, re1, im1);
+                    }
+                }
+            }
+        });
+    }
+
+    /**
+     * Cholesky factorisation A = L L^H of every (Hermitian positive definite) matrix; L overwrites the lower triangle
+     * and the upper triangle is left untouched, as LAPACK potrf. Matrices that are not positive definite get zero
+     * columns from the failing pivot on, so the solvers below return zero for the affected unknowns.
+     *
+     * Returns the number of matrices that were not positive definite.
+     */
+    template <class T> size_t potrf(const MatrixStack<T>& A) {
+        using namespace detail;
+        using R = real_t<T>;
+        check(A.rows == A.cols, "Batched::potrf: matrices must be square");
+        auto N = A.rows;
+        size_t failures = 0;
+
+        for_each_block(A.count, [&](size_t first, size_t n) {
+            std::array<R, block_size> inverse;
+            std::array<bool, block_size> failed{};
+            auto bs = A.batch_stride;
+
+            for (size_t j = 0; j < N; j++) {
+                auto d = &A(first, j, j);
+                std::array<R, block_size> value;
+                for (size_t p = 0; p < n; p++) value[p] = real_part(d[p * bs]);
+                for (size_t k = 0; k < j; k++) {
+                    auto l = &A(first, j, k);
+                    for (size_t p = 0; p < n; p++) value[p] -= norm2(l[p * bs]);
+                }
+
+                for (size_t p = 0; p < n; p++) {
+                    bool positive = value[p] > R(0) && !failed[p];
+                    failed[p] = !positive;
+                    auto l = positive ? std::sqrt(value[p]) : R(0);
+                    inverse[p] = positive ? R(1) / l : R(0);
+                    d[p * bs] = T(l);
+                }
+
+                for (size_t i = j + 1; i < N; i++) {
+                    auto a = &A(first, i, j);
+                    for (size_t k = 0; k < j; k++) {
+                        auto lik = &A(first, i, k);
+                        auto ljk = &A(first, j, k);
+                        for (size_t p = 0; p < n; p++) a[p * bs] -= mulc(ljk[p * bs], lik[p * bs]);
+                    }
+                    for (size_t p = 0; p < n; p++) a[p * bs] = scale(a[p * bs], inverse[p]);
+                }
+            }
+
+            auto count = size_t(std::count(failed.begin(), failed.begin() + n, true));
+            if (count) {
+#ifdef USE_OMP
+#pragma omp atomic
+#endif
+                failures += count;
+            }
+        });
+        return failures;
+    }
+
+    /** Solves L L^H X = B for every matrix, with L from potrf. X overwrites B. */
+    template <class T> void potrs(const detail::const_stack<T>& L, const MatrixStack<T>& B) {
+        using namespace detail;
+        using R = real_t<T>;
+        check(L.rows == L.cols && L.rows == B.rows, "Batched::potrs: matrix sizes do not match");
+        check(L.count == B.count, "Batched::potrs: stacks must have the same count");
+        auto N = L.rows;
+
+        for_each_block(B.count, [&](size_t first, size_t n) {
+            std::array<R, block_size> inverse;
+            auto ls = L.batch_stride, bs = B.batch_stride;
+
+            for (size_t c = 0; c < B.cols; c++) {
+                // L y = b
+                for (size_t i = 0; i < N; i++) {
+                    auto y = &B(first, i, c);
+                    for (size_t k = 0; k < i; k++) {
+                        auto l = &L(first, i, k);
+                        auto yk = &B(first, k, c);
+                        for (size_t p = 0; p < n; p++) y[p * bs] -= mul(l[p * ls], yk[p * bs]);
+                    }
+                    auto d = &L(first, i, i);
+                    for (size_t p = 0; p < n; p++) {
+                        auto l = real_part(d[p * ls]);
+                        inverse[p] = l > R(0) ? R(1) / l : R(0);
+                        y[p * bs] = scale(y[p * bs], inverse[p]);
+                    }
+                }
+                // L^H x = y
+                for (size_t i = N; i-- > 0;) {
+                    auto x = &B(first, i, c);
+                    for (size_t k = i + 1; k < N; k++) {
+                        auto l = &L(first, k, i);
+                        auto xk = &B(first, k, c);
+                        for (size_t p = 0; p < n; p++) x[p * bs] -= mulc(l[p * ls], xk[p * bs]);
+                    }
+                    auto d = &L(first, i, i);
+                    for (size_t p = 0; p < n; p++) {
+                        auto l = real_part(d[p * ls]);
+                        x[p * bs] = scale(x[p * bs], l > R(0) ? R(1) / l : R(0));
+                    }
+                }
+            }
+        });
+    }
+
+    /**
+     * Solves A X = B for every Hermitian positive definite A, as LAPACK posv. A is overwritten by its Cholesky factor
+     * and B by the solution. Returns the number of matrices that were not positive definite.
+     */
+    template <class T> size_t posv(const MatrixStack<T>& A, const MatrixStack<T>& B) {
+        auto failures = potrf(A);
+        potrs(MatrixStack<const T>(A), B);
+        return failures;
+    }
+
+    /**
+     * Least squares solution of A X = B for every matrix A of m x n, m >= n, by Householder QR, as LAPACK gels. A is
+     * overwritten by R in its upper triangle and the solution is written to the first n rows of B. Unknowns with a
+     * zero diagonal element of R (rank deficient A) are set to zero.
+     */
+    template <class T> void gels(const MatrixStack<T>& A, const MatrixStack<T>& B) {
+        using namespace detail;
+        using R = real_t<T>;
+        auto M = A.rows, N = A.cols;
+        check(M >= N, "Batched::gels: matrices must have at least as many rows as columns");
+        check(B.rows == M, "Batched::gels: B must have as many rows as A");
+        check(A.count == B.count, "Batched::gels: stacks must have the same count");
+
+        for_each_block(A.count, [&](size_t first, size_t n) {
+            std::array<T, block_size> head, dot;
+            std::array<R, block_size> factor;
+            auto as = A.batch_stride, bs = B.batch_stride;
+
+            // Reflects column 'x' of a matrix (A or B) with the current Householder vector, whose first element is
+            // in 'head' and remaining elements below the diagonal of column k of A.
+            auto reflect = [&](size_t k, auto&& column, size_t xs) {
+                auto xk = column(k);
+                for (size_t p = 0; p < n; p++) dot[p] = mulc(head[p], xk[p * xs]);
+                for (size_t i = k + 1; i < M; i++) {
+                    auto v = &A(first, i, k);
+                    auto x = column(i);
+                    for (size_t p = 0; p < n; p++) dot[p] += mulc(v[p * as], x[p * xs]);
+                }
+                for (size_t p = 0; p < n; p++) {
+                    dot[p] = scale(dot[p], factor[p]);
+                    xk[p * xs] -= mul(head[p], dot[p]);
+                }
+                for (size_t i = k + 1; i < M; i++) {
+                    auto v = &A(first, i, k);
+                    auto x = column(i);
+                    for (size_t p = 0; p < n; p++) x[p * xs] -= mul(v[p * as], dot[p]);
+                }
+            };
+
+            for (size_t k = 0; k < N; k++) {
+                auto akk = &A(first, k, k);
+                std::array<R, block_size> norm;
+                std::fill_n(norm.begin(), n, R(0));
+                for (size_t i = k; i < M; i++) {
+                    auto a = &A(first, i, k);
+                    for (size_t p = 0; p < n; p++) norm[p] += norm2(a[p * as]);
+                }
+
+                std::array<T, block_size> beta;
+                for (size_t p = 0; p < n; p++) {
+                    // beta = -sign(alpha) |x|; v = x - beta e1, H = I - 2 v v^H / v^H v.
+                    auto alpha = akk[p * as];
+                    auto magnitude = std::sqrt(norm2(alpha));
+                    auto length = std::sqrt(norm[p]);
+                    auto sign = magnitude > R(0) ? scale(alpha, R(1) / magnitude) : T(1);
+                    beta[p] = scale(sign, -length);
+                    head[p] = alpha - beta[p];
+                    auto vnorm = norm[p] - norm2(alpha) + norm2(head[p]);
+                    factor[p] = vnorm > R(0) ? R(2) / vnorm : R(0);
+                }
+
+                for (size_t j = k + 1; j < N; j++) reflect(k, [&](size_t i) { return &A(first, i, j); }, as);
+                for (size_t c = 0; c < B.cols; c++) reflect(k, [&](size_t i) { return &B(first, i, c); }, bs);
+
+                for (size_t p = 0; p < n; p++) akk[p * as] = beta[p];
+            }
+
+            // R x = (Q^H b)[0:n]
+            for (size_t c = 0; c < B.cols; c++) {
+                for (size_t i = N; i-- > 0;) {
+                    auto x = &B(first, i, c);
+                    for (size_t k = i + 1; k < N; k++) {
+                        auto r = &A(first, i, k);
+                        auto xk = &B(first, k, c);
+                        for (size_t p = 0; p < n; p++) x[p * bs] -= mul(r[p * as], xk[p * bs]);
+                    }
+                    auto d = &A(first, i, i);
+                    for (size_t p = 0; p < n; p++) {
+                        auto r = d[p * as];
+                        auto magnitude = norm2(r);
+                        x[p * bs] = magnitude > R(0) ? scale(mulc(r, x[p * bs]), R(1) / magnitude) : T(0);
+                    }
+                }
+            }
+        });
+    }
+
+    /**
+     * Eigendecomposition of every Hermitian (symmetric) matrix by cyclic Jacobi rotations, as LAPACK heev: A is
+     * overwritten by the eigenvectors, as columns, and 'eigenvalues' ([count, rows]) receives the eigenvalues in
+     * ascending order. Only the lower triangle of A is read. Intended for matrices of up to a few tens of rows.
+     */
+    template <class T> void heev(const MatrixStack<T>& A, const MatrixStack<detail::real_t<T>>& eigenvalues) {
+        using namespace detail;
+        using R = real_t<T>;
+        check(A.rows == A.cols, "Batched::heev: matrices must be square");
+        check(eigenvalues.rows == A.rows && eigenvalues.count == A.count, "Batched::heev: eigenvalues have the wrong size");
+        auto N = A.rows;
+        constexpr size_t max_sweeps = 50;
+
+        for_each_block(A.count, [&](size_t first, size_t n) {
+            // Work on a dense block with the batch fastest, whatever the layout of A.
+            std::vector<T> a(N * N * n), v(N * N * n, T(0));
+            auto at = [&](std::vector<T>& m, size_t i, size_t j) { return &m[(i + j * N) * n]; };
+            for (size_t j = 0; j < N; j++) {
+                for (size_t i = j; i < N; i++) {
+                    auto lower = at(a, i, j), upper = at(a, j, i);
+                    for (size_t p = 0; p < n; p++) {
+                        lower[p] = A(first + p, i, j);
+                        upper[p] = conjugate(lower[p]);
+                    }
+                }
+                auto d = at(a, j, j), e = at(v, j, j);
+                for (size_t p = 0; p < n; p++) {
+                    d[p] = T(real_part(d[p]));
+                    e[p] = T(1);
+                }
+            }
+
+            std::array<R, block_size> c, s;
+            std::array<T, block_size> u;
+            for (size_t sweep = 0; sweep < max_sweeps; sweep++) {
+                R off = 0, diagonal = 0;
+                for (size_t j = 0; j < N; j++) {
+                    for (size_t i = 0; i < N; i++) {
+                        auto x = at(a, i, j);
+                        for (size_t p = 0; p < n; p++) (i == j ? diagonal : off) += norm2(x[p]);
+                    }
+                }
+                if (off <= std::numeric_limits<R>::epsilon() * std::numeric_limits<R>::epsilon() * diagonal) break;
+
+                for (size_t q = 1; q < N; q++) {
+                    for (size_t k = 0; k < q; k++) {
+                        // Rotation J in the (k, q) plane, J^H A J zeroing A(k, q): the phase u of A(k, q) is moved
+                        // into column q, after which the real symmetric Jacobi rotation applies.
+                        auto apq = at(a, k, q), app = at(a, k, k), aqq = at(a, q, q);
+                        for (size_t p = 0; p < n; p++) {
+                            // Elements whose square is not a normal number are left alone; their phase would not
+                            // be accurate enough to keep the rotation unitary.
+                            auto squared = norm2(apq[p]);
+                            bool rotate = squared > std::numeric_limits<R>::min();
+                            auto magnitude = std::sqrt(squared);
+                            auto theta = rotate ? (real_part(aqq[p]) - real_part(app[p])) / (2 * magnitude) : R(0);
+                            auto t = rotate ? std::copysign(R(1), theta) / (std::abs(theta) + std::sqrt(theta * theta + 1))
+                                            : R(0);
+                            c[p] = R(1) / std::sqrt(t * t + 1);
+                            s[p] = t * c[p];
+                            u[p] = rotate ? scale(apq[p], R(1) / magnitude) : T(1);
+                        }
+
+                        auto rotate_columns = [&](std::vector<T>& m) {
+                            for (size_t i = 0; i < N; i++) {
+                                auto x = at(m, i, k), y = at(m, i, q);
+                                for (size_t p = 0; p < n; p++) {
+                                    auto yu = mulc(u[p], y[p]);
+                                    auto xk = x[p];
+                                    x[p] = scale(xk, c[p]) - scale(yu, s[p]);
+                                    y[p] = scale(xk, s[p]) + scale(yu, c[p]);
+                                }
+                            }
+                        };
+                        rotate_columns(a);
+                        rotate_columns(v);
+
+                        for (size_t j = 0; j < N; j++) {
+                            auto x = at(a, k, j), y = at(a, q, j);
+                            for (size_t p = 0; p < n; p++) {
+                                auto yu = mul(u[p], y[p]);
+                                auto xk = x[p];
+                                x[p] = scale(xk, c[p]) - scale(yu, s[p]);
+                                y[p] = scale(xk, s[p]) + scale(yu, c[p]);
+                            }
+                        }
+
+                        auto akq = at(a, k, q), aqk = at(a, q, k);
+                        for (size_t p = 0; p < n; p++) akq[p] = aqk[p] = T(0);
+                    }
+                }
+            }
+
+            // Sorting is per matrix; it is O(N log N) against the O(N^3) sweeps.
+            std::vector<size_t> order(N);
+            for (size_t p = 0; p < n; p++) {
+                std::iota(order.begin(), order.end(), size_t(0));
+                std::sort(order.begin(), order.end(), [&](size_t x, size_t y) {
+                    return real_part(at(a, x, x)[p]) < real_part(at(a, y, y)[p]);
+                });
+                for (size_t j = 0; j < N; j++) {
+                    eigenvalues(first + p, j, 0) = real_part(at(a, order[j], order[j])[p]);
+                    for (size_t i = 0; i < N; i++) A(first + p, i, j) = at(v, i, order[j])[p];
+                }
+            }
+        });
+    }
+
+    /**
+     * Power iteration for the dominant eigenvector of every matrix: v <- A v / |A v|, 'iterations' times, starting
+     * from (and overwriting) v, a stack of column vectors. Vectors that become zero stay zero.
+     */
+    template <class T> void power_iteration(const detail::const_stack<T>& A, const MatrixStack<T>& v, size_t iterations) {
+        using namespace detail;
+        using R = real_t<T>;
+        check(A.rows == A.cols && A.rows == v.rows && v.cols == 1, "Batched::power_iteration: sizes do not match");
+        check(A.count == v.count, "Batched::power_iteration: stacks must have the same count");
+        auto N = A.rows;
+
+        for_each_block(A.count, [&](size_t first, size_t n) {
+            std::vector<T> w(N * n);
+            std::array<R, block_size> norm;
+            auto as = A.batch_stride, vs = v.batch_stride;
+
+            for (size_t iteration = 0; iteration < iterations; iteration++) {
+                std::fill(w.begin(), w.end(), T(0));
+                for (size_t k = 0; k < N; k++) {
+                    auto x = &v(first, k, 0);
+                    for (size_t i = 0; i < N; i++) {
+                        auto a = &A(first, i, k);
+                        auto y = &w[i * n];
+                        for (size_t p = 0; p < n; p++) y[p] += mul(a[p * as], x[p * vs]);
+                    }
+                }
+
+                std::fill_n(norm.begin(), n, R(0));
+                for (size_t i = 0; i < N; i++)
+                    for (size_t p = 0; p < n; p++) norm[p] += norm2(w[i * n + p]);
+                for (size_t p = 0; p < n; p++) norm[p] = norm[p] > R(0) ? R(1) / std::sqrt(norm[p]) : R(0);
+
+                for (size_t i = 0; i < N; i++) {
+                    auto x = &v(first, i, 0);
+                    for (size_t p = 0; p < n; p++) x[p * vs] = scale(w[i * n + p], norm[p]);
+                }
+            }
+        });
+    }
+}
@@ -53,6 +53,15 @@ namespace Gadgetron
     template<typename ImageType, typename InterpolatorType> 
     bool resampleImage(const ImageType& in, InterpolatorType& interp, const std::vector<size_t>& dim_out, ImageType& out);
 
+    /// resample the image to specific image size with BSpline interpolation of the given order
+    /// computed separably: every dimension is prefiltered and interpolated in one pass with precomputed weights, instead of
+    /// evaluating the ND BSpline per output pixel
+    /// the output matches resampleImage with a hoNDInterpolatorBSpline, except for the last sample along each dimension:
+    /// there the interpolator falls back to its boundary handler, while this function evaluates the spline, which passes
+    /// through the last input sample
+    template<typename ImageType> 
+    bool resampleImageBSpline(const ImageType& in, unsigned int order, const std::vector<size_t>& dim_out, ImageType& out);
+
     /// reduce image size by 2 with averaging across two neighbors
     template<typename ImageType, typename BoundaryHandlerType> 
     bool downsampleImageBy2WithAveraging(const ImageType& in, BoundaryHandlerType& bh, ImageType& out);
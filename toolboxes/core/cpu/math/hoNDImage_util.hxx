@@ -282,6 +282,65 @@ namespace Gadgetron
         return true;
     }
 
+    template<typename ImageType> 
+    bool resampleImageBSpline(const ImageType& in, unsigned int order, const std::vector<size_t>& dim_out, ImageType& out)
+    {
+        unsigned int D = ImageType::NDIM;
+
+        try
+        {
+            typedef typename ImageType::coord_type coord_type;
+            typedef typename ImageType::value_type T;
+
+            std::vector<size_t> dim;
+            in.get_dimensions(dim);
+
+            std::vector<coord_type> pixelSize;
+            in.get_pixel_size(pixelSize);
+
+            std::vector<coord_type> origin;
+            in.get_origin(origin);
+
+            typename ImageType::axis_type axis;
+            in.get_axis(axis);
+
+            std::vector<coord_type> pixelSize_out(D);
+
+            unsigned int ii;
+            for ( ii=0; ii<D; ii++ )
+            {
+                if ( dim_out[ii] > 1 )
+                {
+                    pixelSize_out[ii] = (dim[ii]-1)*pixelSize[ii] / (dim_out[ii]-1);
+                }
+                else
+                {
+                    pixelSize_out[ii] = (dim[ii]-1)*pixelSize[ii];
+                }
+            }
+
+            if ( &out == &in )
+            {
+                ImageType resampled;
+                if ( !Gadgetron::resampleImageBSpline(in, order, dim_out, resampled) ) return false;
+                out = resampled;
+                return true;
+            }
+
+            out.create(dim_out, pixelSize_out, origin, axis);
+
+            hoNDBSpline<T, ImageType::NDIM, coord_type> bspline;
+            return bspline.resampleBSpline(in, order, dim_out, out);
+        }
+        catch(...)
+        {
+            GERROR_STREAM("Errors happened in resampleImageBSpline(const ImageType& in, unsigned int order, const std::vector<size_t>& dim_out, ImageType& out) ... ");
+            return false;
+        }
+
+        return true;
+    }
+
     template<typename ImageType, typename BoundaryHandlerType> 
     bool downsampleImageBy2WithAveraging(const ImageType& in, BoundaryHandlerType& bh, ImageType& out)
     {
@@ -9,7 +9,9 @@
 #include "hoMatrix.h"
 #include "hoNDArray_elemwise.h"
 #include "hoNDArray_math.h"
+#include "hoNDArrayStridedView_math.h"
 #include "hoNDFFT.h"
+#include "trace.h"
 #include <boost/container/flat_set.hpp>
 
 namespace Gadgetron {
@@ -79,6 +81,35 @@ namespace Gadgetron {
             typename fftw_types<T>::plan* plan;
         };
 
+        template <class T> class StridedFFTPlan : FFTLock {
+        public:
+            using FFTWComplex = typename fftw_types<T>::complex;
+
+            StridedFFTPlan(size_t size, size_t stride, std::complex<T>* data, bool forward) {
+                std::lock_guard<std::mutex> guard(lock);
+
+                auto fftw_dimensions = fftw_iodim64{ static_cast<ptrdiff_t>(size), static_cast<ptrdiff_t>(stride), static_cast<ptrdiff_t>(stride) };
+
+                // The plan is executed at every batch offset of the view, which need not share the alignment of data.
+                plan = fftw_types<T>::plan_guru(1, &fftw_dimensions, 0, nullptr, (FFTWComplex*)data,
+                    (FFTWComplex*)data, forward ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_ESTIMATE | FFTW_UNALIGNED);
+
+                if (plan == nullptr) throw std::runtime_error("Illegal FFT plan created");
+            }
+
+            ~StridedFFTPlan() {
+                std::lock_guard<std::mutex> guard(lock);
+                fftw_types<T>::destroy_plan(plan);
+            }
+
+            void execute(std::complex<T>* data) {
+                fftw_types<T>::execute_dft(plan, (FFTWComplex*)data, (FFTWComplex*)data);
+            }
+
+        private:
+            typename fftw_types<T>::plan* plan;
+        };
+
         template <class T> class ContigousFFTPlan : FFTLock {
         public:
             using FFTWComplex = typename fftw_types<T>::complex;
@@ -130,6 +161,7 @@ namespace Gadgetron {
         template <typename T>
         static void contigous_fftn(const hoNDArray<std::complex<T>>& input, hoNDArray<std::complex<T>>& output, int rank,
             bool forward, bool normalize) {
+            GADGETRON_TRACE_SCOPE("hoNDFFT::contigous_fftn");
 
             auto plan = ContigousFFTPlan<T>(rank, input, output, forward);
             size_t batch_size
@@ -149,6 +181,7 @@ namespace Gadgetron {
         template <typename T>
         static void single_fft(int dimension, const hoNDArray<std::complex<T>>& a, hoNDArray<std::complex<T>>& r,
             bool forward, bool normalize) {
+            GADGETRON_TRACE_SCOPE("hoNDFFT::single_fft");
             assert(dimension >= 0);
             auto plan              = SingleFFTPlan<T>(dimension, a, r, forward);
             const auto& dimensions = a.dimensions();
@@ -171,6 +204,175 @@ namespace Gadgetron {
         }
     }
 
+    namespace {
+        template <typename T>
+        void strided_fft(const hoNDArrayStridedView<std::complex<T>>& data, size_t dimension, bool forward) {
+            GADGETRON_TRACE_SCOPE("hoNDFFT::strided_fft");
+            if (dimension >= data.get_number_of_dimensions())
+                throw std::runtime_error("hoNDFFT: dimension to transform is out of range");
+            if (data.size() == 0)
+                return;
+
+            auto size = data.get_size(dimension);
+            auto plan = StridedFFTPlan<T>(size, data.get_stride(dimension), data.data(), forward);
+
+            // Every other dimension of the view is a batch of independent transforms.
+            auto batches = data.slice(dimension, 0);
+            const auto& dimensions = batches.dimensions();
+            const auto& strides = batches.strides();
+            long long count = batches.size();
+
+#pragma omp parallel for default(none) shared(plan, data, dimensions, strides, count)
+            for (long long batch = 0; batch < count; batch++) {
+                size_t offset = 0, index = batch;
+                for (size_t d = 0; d < dimensions.size(); d++) {
+                    offset += (index % dimensions[d]) * strides[d];
+                    index /= dimensions[d];
+                }
+                plan.execute(data.data() + offset);
+            }
+
+            scal(T(1) / std::sqrt<T>(size), data);
+        }
+    }
+
+    namespace {
+        /// Transforms blocks of 'lines' adjacent lines, stored with the line index fastest, as FFTW reads them.
+        template <class T> class LineBlockFFTPlan : FFTLock {
+        public:
+            using FFTWComplex = typename fftw_types<T>::complex;
+
+            LineBlockFFTPlan(size_t length, size_t lines, bool forward) {
+                std::lock_guard<std::mutex> guard(lock);
+
+                auto transform = fftw_iodim64{ static_cast<ptrdiff_t>(length), static_cast<ptrdiff_t>(lines), static_cast<ptrdiff_t>(lines) };
+                auto batch = fftw_iodim64{ static_cast<ptrdiff_t>(lines), 1, 1 };
+
+                // Planned on a scratch block; every thread executes the plan on a block of its own.
+                std::vector<std::complex<T>> scratch(length * lines);
+                plan = fftw_types<T>::plan_guru(1, &transform, 1, &batch, (FFTWComplex*)scratch.data(),
+                    (FFTWComplex*)scratch.data(), forward ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_ESTIMATE | FFTW_UNALIGNED);
+
+                if (plan == nullptr) throw std::runtime_error("Illegal FFT plan created");
+            }
+
+            ~LineBlockFFTPlan() {
+                std::lock_guard<std::mutex> guard(lock);
+                fftw_types<T>::destroy_plan(plan);
+            }
+
+            void execute(std::complex<T>* block) {
+                fftw_types<T>::execute_dft(plan, (FFTWComplex*)block, (FFTWComplex*)block);
+            }
+
+        private:
+            typename fftw_types<T>::plan* plan;
+        };
+
+        /**
+         * Centered transform of every line along 'dimension', from lines of 'in_size' samples to lines of 'out_size'
+         * samples. The forward transform has length 'in_size', and its k-space is cropped or zero padded to 'out_size'
+         * around the center. The inverse transform has length 'out_size', of the input k-space cropped or zero padded
+         * around the center. The shifts of the centered transform are folded into the copies to and from the FFT
+         * buffers, and samples outside the common k-space are never read or transformed.
+         */
+        template <typename T>
+        hoNDArray<std::complex<T>> centered_resize_fft(const hoNDArray<std::complex<T>>& in, size_t dimension,
+            size_t out_size, bool forward, T scale) {
+            GADGETRON_TRACE_SCOPE("hoNDFFT::centered_resize_fft");
+
+            auto dimensions = in.dimensions();
+            if (dimension >= dimensions.size())
+                throw std::runtime_error("hoNDFFT: dimension to transform is out of range");
+
+            size_t in_size = dimensions[dimension];
+            dimensions[dimension] = out_size;
+            hoNDArray<std::complex<T>> out(dimensions);
+            if (out.size() == 0 || in_size == 0)
+                return out;
+
+            size_t inner = std::accumulate(dimensions.begin(), dimensions.begin() + dimension, size_t(1), std::multiplies<>());
+            size_t outer = out.size() / (inner * out_size);
+
+            size_t length = forward ? in_size : out_size;
+
+            // Adjacent lines are transformed together, so reading and writing them touches whole cache lines.
+            size_t block = std::min<size_t>(inner, 16);
+            size_t blocks_per_outer = (inner + block - 1) / block;
+            size_t remainder = inner % block;
+
+            LineBlockFFTPlan<T> plan(length, block, forward);
+            std::unique_ptr<LineBlockFFTPlan<T>> remainder_plan;
+            if (remainder) remainder_plan = std::make_unique<LineBlockFFTPlan<T>>(length, remainder, forward);
+
+            // Frequencies are kept if they exist in both the input and the output.
+            long long low = -static_cast<long long>(std::min(in_size, out_size) / 2);
+            long long high = static_cast<long long>(std::min(in_size - in_size / 2, out_size - out_size / 2)) - 1;
+
+            const std::complex<T>* in_ptr = in.data();
+            std::complex<T>* out_ptr = out.data();
+            long long count = outer * blocks_per_outer;
+
+#pragma omp parallel default(none) shared(plan, remainder_plan, in_ptr, out_ptr, count, inner, block, blocks_per_outer, length, in_size, out_size, low, high, forward, scale)
+            {
+                std::vector<std::complex<T>> buffer(length * block);
+
+#pragma omp for
+                for (long long b = 0; b < count; b++) {
+                    size_t o = b / blocks_per_outer;
+                    size_t first = (b % blocks_per_outer) * block;
+                    size_t lines = std::min(block, inner - first);
+
+                    const std::complex<T>* src = in_ptr + first + o * inner * in_size;
+                    std::complex<T>* dst = out_ptr + first + o * inner * out_size;
+
+                    if (forward) {
+                        // ifftshift into the buffer
+                        for (size_t k = 0; k < in_size; k++) {
+                            const std::complex<T>* line = src + ((k + in_size / 2) % in_size) * inner;
+                            std::copy(line, line + lines, buffer.data() + k * lines);
+                        }
+                    } else {
+                        // ifftshift, cropped or padded, into the buffer
+                        for (size_t j = 0; j < out_size; j++) {
+                            long long f = j < out_size - out_size / 2 ? (long long)j : (long long)j - (long long)out_size;
+                            std::complex<T>* target = buffer.data() + j * lines;
+                            if (f < low || f > high) {
+                                std::fill(target, target + lines, std::complex<T>(0));
+                                continue;
+                            }
+                            const std::complex<T>* line = src + (f + (long long)(in_size / 2)) * inner;
+                            std::copy(line, line + lines, target);
+                        }
+                    }
+
+                    if (lines == block) plan.execute(buffer.data());
+                    else remainder_plan->execute(buffer.data());
+
+                    for (size_t q = 0; q < out_size; q++) {
+                        std::complex<T>* line = dst + q * inner;
+                        const std::complex<T>* source;
+                        if (forward) {
+                            // fftshift, cropped or padded, out of the buffer
+                            long long f = (long long)q - (long long)(out_size / 2);
+                            if (f < low || f > high) {
+                                std::fill(line, line + lines, std::complex<T>(0));
+                                continue;
+                            }
+                            source = buffer.data() + ((f + (long long)in_size) % (long long)in_size) * lines;
+                        } else {
+                            // fftshift out of the buffer
+                            source = buffer.data() + ((q + (out_size + 1) / 2) % out_size) * lines;
+                        }
+                        for (size_t l = 0; l < lines; l++) line[l] = source[l] * scale;
+                    }
+                }
+            }
+
+            return out;
+        }
+    }
+
     static inline size_t fftshiftPivot(size_t x) {
         return (x + 1) / 2;
     }
@@ -837,6 +1039,16 @@ namespace Gadgetron {
     template <class ComplexType, class ENABLER> void FFT::ifft(hoNDArray<ComplexType>& data, size_t dimension) {
         single_fft(dimension,data,data,false,true);
     }
+    template <class ComplexType, class ENABLER>
+    void FFT::fft(const hoNDArrayStridedView<ComplexType>& data, size_t dimension) {
+        strided_fft(data, dimension, true);
+    }
+
+    template <class ComplexType, class ENABLER>
+    void FFT::ifft(const hoNDArrayStridedView<ComplexType>& data, size_t dimension) {
+        strided_fft(data, dimension, false);
+    }
+
     template <class ComplexType, class ENABLER>
     hoNDArray<ComplexType> FFT::fft1c(const hoNDArray<ComplexType> &data) {
       hoNDArray<ComplexType> output(data.dimensions());
@@ -874,6 +1086,52 @@ namespace Gadgetron {
       return output;
     }
 
+    template <class ComplexType, class ENABLER>
+    hoNDArray<ComplexType> FFT::fftc(const hoNDArray<ComplexType>& data, size_t dimension, size_t size) {
+        using T = realType_t<ComplexType>;
+        return centered_resize_fft<T>(data, dimension, size, true, T(1) / std::sqrt(T(data.get_size(dimension))));
+    }
+
+    template <class ComplexType, class ENABLER>
+    hoNDArray<ComplexType> FFT::ifftc(const hoNDArray<ComplexType>& data, size_t dimension, size_t size) {
+        using T = realType_t<ComplexType>;
+        return centered_resize_fft<T>(data, dimension, size, false, T(1) / std::sqrt(T(size)));
+    }
+
+    template <class ComplexType, class ENABLER>
+    hoNDArray<ComplexType> FFT::resample(const hoNDArray<ComplexType>& data, const std::vector<size_t>& size) {
+        using T = realType_t<ComplexType>;
+        GADGETRON_TRACE_SCOPE("FFT::resample");
+
+        if (size.size() > data.get_number_of_dimensions())
+            throw std::runtime_error("FFT::resample: more sizes than dimensions");
+
+        std::vector<size_t> changed;
+        for (size_t d = 0; d < size.size(); d++) {
+            if (size[d] != data.get_size(d)) changed.push_back(d);
+        }
+        if (changed.empty()) return data;
+
+        auto ratio = [&](size_t d) { return double(size[d]) / data.get_size(d); };
+        auto smallest_ratio_first = [&](size_t a, size_t b) { return ratio(a) < ratio(b); };
+
+        // Forward: cropped dimensions first, most cropped first, so every later transform has fewer lines.
+        std::sort(changed.begin(), changed.end(), smallest_ratio_first);
+
+        hoNDArray<ComplexType> kspace = data;
+        for (auto d : changed) {
+            kspace = centered_resize_fft<T>(kspace, d, std::min(size[d], data.get_size(d)), true, T(1));
+        }
+
+        // Inverse: padded dimensions last, least padded first, so the zeros are transformed along as few dimensions
+        // as possible. Each dimension is scaled by 1/N, which preserves image values.
+        for (auto d : changed) {
+            kspace = centered_resize_fft<T>(kspace, d, size[d], false, T(1) / T(data.get_size(d)));
+        }
+
+        return kspace;
+    }
+
     // -----------------------------------------------------------------------------------------
 
     //
@@ -894,6 +1152,18 @@ namespace Gadgetron {
     template void FFT::ifft<std::complex<float>>(hoNDArray<std::complex<float>>& data, size_t dimensions);
     template void FFT::ifft<std::complex<double>>(hoNDArray<std::complex<double>>& data, size_t dimensions);
 
+    template void FFT::fft<std::complex<float>>(const hoNDArrayStridedView<std::complex<float>>& data, size_t dimension);
+    template void FFT::fft<std::complex<double>>(const hoNDArrayStridedView<std::complex<double>>& data, size_t dimension);
+    template void FFT::ifft<std::complex<float>>(const hoNDArrayStridedView<std::complex<float>>& data, size_t dimension);
+    template void FFT::ifft<std::complex<double>>(const hoNDArrayStridedView<std::complex<double>>& data, size_t dimension);
+
+    template hoNDArray<std::complex<float>> FFT::fftc(const hoNDArray<std::complex<float>> &data, size_t dimension, size_t size);
+    template hoNDArray<std::complex<double>> FFT::fftc(const hoNDArray<std::complex<double>> &data, size_t dimension, size_t size);
+    template hoNDArray<std::complex<float>> FFT::ifftc(const hoNDArray<std::complex<float>> &data, size_t dimension, size_t size);
+    template hoNDArray<std::complex<double>> FFT::ifftc(const hoNDArray<std::complex<double>> &data, size_t dimension, size_t size);
+    template hoNDArray<std::complex<float>> FFT::resample(const hoNDArray<std::complex<float>> &data, const std::vector<size_t> &size);
+    template hoNDArray<std::complex<double>> FFT::resample(const hoNDArray<std::complex<double>> &data, const std::vector<size_t> &size);
+
     template hoNDArray<std::complex<float>> FFT::fft1c(const hoNDArray<std::complex<float>> &data);
     template hoNDArray<std::complex<float>> FFT::fft2c(const hoNDArray<std::complex<float>> &data);
     template hoNDArray<std::complex<float>> FFT::fft3c(const hoNDArray<std::complex<float>> &data);
@@ -7,6 +7,7 @@
 
 #include "cpufft_export.h"
 #include "hoNDArray.h"
+#include "hoNDArrayStridedView.h"
 
 #include "complext.h"
 #include <complex>
@@ -57,6 +58,27 @@ template <class ComplexType,
           class ENABLER = std::enable_if_t<is_complex_type_v<ComplexType>>>
 void ifft(hoNDArray<ComplexType> &data, size_t dimensions);
 
+/**
+         * Performs a standard in-place FFT along one dimension of a strided view, such as a slice of a larger array
+         * or a permuted view, without copying it
+         * @tparam ComplexType Complex type, such as std::complex<float> or complex<double>
+         * @param data View of the data to be transformed
+         * @param dimension Dimension of the view along which to perform the transform
+ */
+template <class ComplexType,
+          class ENABLER = std::enable_if_t<is_complex_type_v<ComplexType>>>
+void fft(const hoNDArrayStridedView<ComplexType> &data, size_t dimension);
+
+/**
+         * Performs a standard in-place inverse FFT along one dimension of a strided view
+         * @tparam ComplexType Complex type, such as std::complex<float> or complex<double>
+         * @param data View of the data to be transformed
+         * @param dimension Dimension of the view along which to perform the transform
+ */
+template <class ComplexType,
+          class ENABLER = std::enable_if_t<is_complex_type_v<ComplexType>>>
+void ifft(const hoNDArrayStridedView<ComplexType> &data, size_t dimension);
+
 /**
      * Performs a centered FFT over the 1st dimension
      * @tparam ComplexType Complex type, such as std::complex<float> or complex<double>
@@ -107,6 +129,45 @@ template <class ComplexType,
           class ENABLER = std::enable_if_t<is_complex_type_v<ComplexType>>>
 hoNDArray<ComplexType> ifft3c(const hoNDArray<ComplexType> &data);
 
+/**
+  * Performs a centered FFT along one dimension, and returns the central 'size' samples of k-space. If 'size' is larger
+  * than the dimension, k-space is zero padded instead. Samples cropped away are never written, and padding costs
+  * nothing but the zeros.
+  * @tparam ComplexType Complex type, such as std::complex<float> or complex<double>
+  * @param data Complex input data to be transformed
+  * @param dimension Dimension along which to perform the transform
+  * @param size Size of the output along 'dimension'
+ */
+template <class ComplexType,
+          class ENABLER = std::enable_if_t<is_complex_type_v<ComplexType>>>
+hoNDArray<ComplexType> fftc(const hoNDArray<ComplexType> &data, size_t dimension, size_t size);
+
+/**
+  * Performs a centered inverse FFT along one dimension, of k-space zero padded (or cropped) to 'size' around its
+  * center. The zeros are never read; the transform has length 'size'.
+  * @tparam ComplexType Complex type, such as std::complex<float> or complex<double>
+  * @param data Complex k-space to be transformed
+  * @param dimension Dimension along which to perform the transform
+  * @param size Size of the output along 'dimension'
+ */
+template <class ComplexType,
+          class ENABLER = std::enable_if_t<is_complex_type_v<ComplexType>>>
+hoNDArray<ComplexType> ifftc(const hoNDArray<ComplexType> &data, size_t dimension, size_t size);
+
+/**
+  * Resamples images to a new size along their first dimensions, by zero padding or cropping their centered k-space;
+  * the same as a centered FFT, pad or crop, and centered inverse FFT, scaled so image values are preserved.
+  *
+  * Dimensions keeping their size are not transformed at all. Cropped dimensions are cropped as they are transformed,
+  * and padded dimensions are padded as late as possible, so lines of k-space known to be zero are never transformed.
+  * @tparam ComplexType Complex type, such as std::complex<float> or complex<double>
+  * @param data Complex images to be resampled
+  * @param size New size of each of the first size.size() dimensions
+ */
+template <class ComplexType,
+          class ENABLER = std::enable_if_t<is_complex_type_v<ComplexType>>>
+hoNDArray<ComplexType> resample(const hoNDArray<ComplexType> &data, const std::vector<size_t> &size);
+
 }
 
 
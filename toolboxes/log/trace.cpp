@@ -0,0 +1,251 @@
+#include "trace.h"
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+namespace Gadgetron { namespace Trace {
+
+    namespace detail {
+        std::atomic<bool> enabled_flag{false};
+    }
+
+    namespace {
+
+        constexpr size_t buffer_capacity = 16384;
+
+        struct Event
+        {
+            const char* name;
+            const char* category;
+            const char* arg_name;
+            uint64_t start;
+            uint64_t duration;
+            uint64_t arg_value;
+            uint32_t tid;
+            uint32_t session;
+        };
+
+        /// Ring buffer of one thread. The mutex is only ever contended while a trace is being written.
+        struct Buffer
+        {
+            std::mutex mutex;
+            std::vector<Event> events;
+            size_t next = 0;
+        };
+
+        /// Buffers are reused once their thread exits, so memory is bounded by the number of concurrent threads.
+        /// Intentionally leaked; thread exit may happen during static destruction.
+        struct Registry
+        {
+            std::mutex mutex;
+            std::vector<std::shared_ptr<Buffer>> buffers;
+            std::vector<std::shared_ptr<Buffer>> free_buffers;
+            std::map<uint32_t, const char*> thread_names;
+            std::unordered_set<std::string> names;
+        };
+
+        Registry& registry()
+        {
+            static auto registry = new Registry();
+            return *registry;
+        }
+
+        std::atomic<uint32_t> next_tid{1};
+        std::atomic<uint32_t> next_session{1};
+
+        struct ThreadState
+        {
+            uint32_t tid = next_tid++;
+            uint32_t session = 0;
+            std::shared_ptr<Buffer> buffer;
+
+            ~ThreadState()
+            {
+                if (!buffer) return;
+                auto& r = registry();
+                std::lock_guard<std::mutex> guard(r.mutex);
+                r.free_buffers.push_back(std::move(buffer));
+            }
+
+            Buffer& acquire()
+            {
+                if (buffer) return *buffer;
+
+                auto& r = registry();
+                std::lock_guard<std::mutex> guard(r.mutex);
+                if (!r.free_buffers.empty())
+                {
+                    buffer = std::move(r.free_buffers.back());
+                    r.free_buffers.pop_back();
+                }
+                else
+                {
+                    buffer = std::make_shared<Buffer>();
+                    buffer->events.reserve(buffer_capacity);
+                    r.buffers.push_back(buffer);
+                }
+                return *buffer;
+            }
+        };
+
+        thread_local ThreadState thread_state;
+
+        void write_string(std::ostream& stream, const char* str)
+        {
+            stream << '"';
+            for (; *str; ++str)
+            {
+                char c = *str;
+                switch (c)
+                {
+                    case '"': stream << "\\\""; break;
+                    case '\\': stream << "\\\\"; break;
+                    case '\n': stream << "\\n"; break;
+                    case '\t': stream << "\\t"; break;
+                    default:
+                        if (static_cast<unsigned char>(c) < 0x20) stream << ' ';
+                        else stream << c;
+                }
+            }
+            stream << '"';
+        }
+    }
+
+    void enable(bool on)
+    {
+        detail::enabled_flag.store(on);
+    }
+
+    uint64_t now()
+    {
+        using namespace std::chrono;
+        return uint64_t(duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count());
+    }
+
+    const char* intern(const std::string& name)
+    {
+        auto& r = registry();
+        std::lock_guard<std::mutex> guard(r.mutex);
+        return r.names.insert(name).first->c_str();
+    }
+
+    void record(const char* name, const char* category, uint64_t start, uint64_t end)
+    {
+        record(name, category, start, end, nullptr, 0);
+    }
+
+    void record(const char* name, const char* category, uint64_t start, uint64_t end, const char* arg_name,
+                uint64_t arg_value)
+    {
+        auto& state = thread_state;
+        auto& buffer = state.acquire();
+
+        Event event{ name, category, arg_name, start, end > start ? end - start : 0, arg_value, state.tid, state.session };
+
+        std::lock_guard<std::mutex> guard(buffer.mutex);
+        if (buffer.events.size() < buffer_capacity)
+        {
+            buffer.events.push_back(event);
+        }
+        else
+        {
+            buffer.events[buffer.next] = event;
+            buffer.next = (buffer.next + 1) % buffer_capacity;
+        }
+    }
+
+    void set_thread_name(const std::string& name)
+    {
+        auto tid = thread_state.tid;
+        auto interned = intern(name);
+
+        auto& r = registry();
+        std::lock_guard<std::mutex> guard(r.mutex);
+        r.thread_names[tid] = interned;
+    }
+
+    uint32_t new_session()
+    {
+        return next_session++;
+    }
+
+    uint32_t current_session()
+    {
+        return thread_state.session;
+    }
+
+    void set_session(uint32_t session)
+    {
+        thread_state.session = session;
+    }
+
+    void write_chrome_trace(std::ostream& stream, uint32_t session)
+    {
+        auto& r = registry();
+
+        std::vector<std::shared_ptr<Buffer>> buffers;
+        std::map<uint32_t, const char*> thread_names;
+        {
+            std::lock_guard<std::mutex> guard(r.mutex);
+            buffers = r.buffers;
+            thread_names = r.thread_names;
+        }
+
+        std::vector<Event> events;
+        for (auto& buffer : buffers)
+        {
+            std::lock_guard<std::mutex> guard(buffer->mutex);
+            for (auto& event : buffer->events)
+                if (event.session == session) events.push_back(event);
+        }
+
+        std::map<uint32_t, const char*> threads;
+        for (auto& event : events)
+        {
+            auto name = thread_names.find(event.tid);
+            threads[event.tid] = name != thread_names.end() ? name->second : nullptr;
+        }
+
+        stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+        bool first = true;
+        auto separator = [&]() {
+            if (!first) stream << ",\n";
+            first = false;
+        };
+
+        for (auto& thread : threads)
+        {
+            if (!thread.second) continue;
+            separator();
+            stream << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" << session << ",\"tid\":" << thread.first
+                   << ",\"args\":{\"name\":";
+            write_string(stream, thread.second);
+            stream << "}}";
+        }
+
+        for (auto& event : events)
+        {
+            separator();
+            stream << "{\"ph\":\"X\",\"name\":";
+            write_string(stream, event.name);
+            stream << ",\"cat\":";
+            write_string(stream, event.category);
+            stream << ",\"ts\":" << event.start << ",\"dur\":" << event.duration << ",\"pid\":" << session
+                   << ",\"tid\":" << event.tid;
+            if (event.arg_name)
+            {
+                stream << ",\"args\":{";
+                write_string(stream, event.arg_name);
+                stream << ":" << event.arg_value << "}";
+            }
+            stream << "}";
+        }
+
+        stream << "]}\n";
+    }
+}}
@@ -0,0 +1,86 @@
+/** \file trace.h
+    \brief Low overhead tracing of timed spans, written out as Chrome trace JSON.
+
+    The output can be loaded in chrome://tracing or https://ui.perfetto.dev.
+
+    Tracing is off by default, in which case a Trace::Scope costs a single relaxed atomic load. When enabled,
+    completed spans are stored in a fixed size ring buffer owned by the recording thread; once a buffer is full,
+    the oldest spans of that thread are overwritten.
+
+    Every span is tagged with the session of the recording thread. The server starts one session per connection,
+    so a trace can be written per connection even when several connections share a process.
+*/
+
+#pragma once
+
+#include "log_export.h"
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace Gadgetron { namespace Trace {
+
+    namespace detail {
+        EXPORTGADGETRONLOG extern std::atomic<bool> enabled_flag;
+    }
+
+    inline bool enabled() { return detail::enabled_flag.load(std::memory_order_relaxed); }
+
+    EXPORTGADGETRONLOG void enable(bool on = true);
+
+    /// Microseconds on a monotonic clock
+    EXPORTGADGETRONLOG uint64_t now();
+
+    /// Spans only store name pointers; intern returns a copy of name which lives as long as the process
+    EXPORTGADGETRONLOG const char* intern(const std::string& name);
+
+    /// Records the span [start, end) on the calling thread. Name and category must outlive the trace.
+    EXPORTGADGETRONLOG void record(const char* name, const char* category, uint64_t start, uint64_t end);
+
+    /// Records a span carrying one numeric argument, e.g. the time a message spent queued
+    EXPORTGADGETRONLOG void record(const char* name, const char* category, uint64_t start, uint64_t end,
+                                   const char* arg_name, uint64_t arg_value);
+
+    /// Name shown for the calling thread, e.g. the node it runs
+    EXPORTGADGETRONLOG void set_thread_name(const std::string& name);
+
+    /// Sessions group the spans of one connection; session 0 is used by threads outside of any session
+    EXPORTGADGETRONLOG uint32_t new_session();
+    EXPORTGADGETRONLOG uint32_t current_session();
+    EXPORTGADGETRONLOG void set_session(uint32_t session);
+
+    /// Writes the spans of a session still held in the ring buffers as Chrome trace JSON
+    EXPORTGADGETRONLOG void write_chrome_trace(std::ostream& stream, uint32_t session);
+
+    /// Records the lifetime of the object as a span, if tracing is enabled when it is created
+    class Scope
+    {
+    public:
+        explicit Scope(const char* name, const char* category = "toolbox")
+            : name_(name), category_(category), active_(enabled()), start_(active_ ? now() : 0)
+        {
+        }
+
+        ~Scope()
+        {
+            if (active_) record(name_, category_, start_, now());
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        const char* name_;
+        const char* category_;
+        bool active_;
+        uint64_t start_;
+    };
+}}
+
+#define GADGETRON_TRACE_CONCAT_(a, b) a##b
+#define GADGETRON_TRACE_CONCAT(a, b) GADGETRON_TRACE_CONCAT_(a, b)
+
+/// Traces the enclosing block; name must be a string literal or otherwise outlive the trace
+#define GADGETRON_TRACE_SCOPE(name) ::Gadgetron::Trace::Scope GADGETRON_TRACE_CONCAT(gadgetron_trace_scope_, __LINE__)(name)
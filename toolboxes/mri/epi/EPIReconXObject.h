@@ -6,9 +6,15 @@
 #pragma once
 
 #include "EPIExport.h"
+#include "EPIReconXOperator.h"
 
 #include "ismrmrd/ismrmrd.h"
 #include "hoNDArray.h"
+#include "hoNDArray_linalg.h"
+
+#include <cstring>
+#include <memory>
+#include <vector>
 
 namespace Gadgetron { namespace EPI {
 
@@ -43,13 +49,24 @@ template <typename T> class EPIReconXObject
   virtual int computeTrajectory()=0;
 
   virtual int apply(ISMRMRD::AcquisitionHeader &hdr_in,  hoNDArray <T> &data_in, 
-		    ISMRMRD::AcquisitionHeader &hdr_out, hoNDArray <T> &data_out)=0;
+		    ISMRMRD::AcquisitionHeader &hdr_out, hoNDArray <T> &data_out);
+
+  // Regrids a batch of readouts. Readouts sharing an operator and a polarity are stacked, and regridded
+  // together with a single GEMM.
+  virtual int applyBatch(std::vector<ISMRMRD::AcquisitionHeader> &hdr_in, std::vector<hoNDArray <T>*> &data_in,
+                         std::vector<ISMRMRD::AcquisitionHeader> &hdr_out, std::vector<hoNDArray <T> > &data_out);
+
   EPIReceiverPhaseType rcvType_;
 
  protected:
   hoNDArray <float> trajectoryPos_;
   hoNDArray <float> trajectoryNeg_;
 
+  // The operator for the readout described by the header
+  virtual std::shared_ptr<const EPIReconXOperator<T> > reconOperator(ISMRMRD::AcquisitionHeader &hdr_in, hoNDArray <T> &data_in)=0;
+
+  static const hoNDArray <T> &polarityOperator(const EPIReconXOperator<T> &op, const ISMRMRD::AcquisitionHeader &hdr);
+  static void setOutputHeader(const ISMRMRD::AcquisitionHeader &hdr_in, ISMRMRD::AcquisitionHeader &hdr_out, size_t reconNx);
 };
 
 template <typename T> EPIReconXObject<T>::EPIReconXObject()
@@ -70,4 +87,97 @@ template <typename T> hoNDArray<float> EPIReconXObject<T>::getTrajectoryNeg()
   return trajectoryNeg_;
 }
 
+template <typename T> const hoNDArray<T> &EPIReconXObject<T>::polarityOperator(const EPIReconXOperator<T> &op,
+                                                                                const ISMRMRD::AcquisitionHeader &hdr)
+{
+  return hdr.isFlagSet(ISMRMRD::ISMRMRD_ACQ_IS_REVERSE) ? op.Mneg : op.Mpos;
+}
+
+template <typename T> void EPIReconXObject<T>::setOutputHeader(const ISMRMRD::AcquisitionHeader &hdr_in,
+                                                               ISMRMRD::AcquisitionHeader &hdr_out, size_t reconNx)
+{
+  // Copy the input header to the output header and set the size and the center sample
+  hdr_out = hdr_in;
+  hdr_out.number_of_samples = reconNx;
+  hdr_out.center_sample = reconNx/2;
+}
+
+template <typename T> int EPIReconXObject<T>::apply(ISMRMRD::AcquisitionHeader &hdr_in, hoNDArray <T> &data_in,
+                                                    ISMRMRD::AcquisitionHeader &hdr_out, hoNDArray <T> &data_out)
+{
+  auto op = reconOperator(hdr_in, data_in);
+  const hoNDArray<T> &M = polarityOperator(*op, hdr_in);
+
+  Gadgetron::gemm(data_out, M, data_in);
+
+  setOutputHeader(hdr_in, hdr_out, M.get_size(0));
+  return 0;
+}
+
+template <typename T> int EPIReconXObject<T>::applyBatch(std::vector<ISMRMRD::AcquisitionHeader> &hdr_in,
+                                                         std::vector<hoNDArray <T>*> &data_in,
+                                                         std::vector<ISMRMRD::AcquisitionHeader> &hdr_out,
+                                                         std::vector<hoNDArray <T> > &data_out)
+{
+  size_t N = hdr_in.size();
+  hdr_out.resize(N);
+  data_out.resize(N);
+
+  std::vector<std::shared_ptr<const EPIReconXOperator<T> > > ops(N);
+  std::vector<const hoNDArray<T>*> M(N);
+  for (size_t n=0; n<N; n++) {
+    ops[n] = reconOperator(hdr_in[n], *data_in[n]);
+    M[n] = &polarityOperator(*ops[n], hdr_in[n]);
+  }
+
+  std::vector<bool> done(N, false);
+  std::vector<size_t> group;
+  hoNDArray<T> stacked_in, stacked_out;
+
+  for (size_t n=0; n<N; n++) {
+    if (done[n]) continue;
+
+    group.clear();
+    size_t columns = 0;
+    for (size_t m=n; m<N; m++) {
+      if (done[m] || M[m] != M[n]) continue;
+      group.push_back(m);
+      columns += data_in[m]->get_number_of_elements() / data_in[m]->get_size(0);
+      done[m] = true;
+    }
+
+    size_t numSamples = M[n]->get_size(1);
+    size_t reconNx = M[n]->get_size(0);
+
+    if (group.size() == 1) {
+      Gadgetron::gemm(data_out[n], *M[n], *data_in[n]);
+      setOutputHeader(hdr_in[n], hdr_out[n], reconNx);
+      continue;
+    }
+
+    // Every channel of every readout in the group is a column of one matrix.
+    stacked_in.create(numSamples, columns);
+    T *in = stacked_in.data();
+    for (size_t m : group) {
+      size_t elements = data_in[m]->get_number_of_elements();
+      std::memcpy(in, data_in[m]->data(), elements*sizeof(T));
+      in += elements;
+    }
+
+    Gadgetron::gemm(stacked_out, *M[n], stacked_in);
+
+    const T *out = stacked_out.data();
+    for (size_t m : group) {
+      auto dims = data_in[m]->get_dimensions();
+      (*dims)[0] = reconNx;
+      data_out[m].create(dims);
+      std::memcpy(data_out[m].data(), out, data_out[m].get_number_of_elements()*sizeof(T));
+      out += data_out[m].get_number_of_elements();
+      setOutputHeader(hdr_in[m], hdr_out[m], reconNx);
+    }
+  }
+
+  return 0;
+}
+
 }}
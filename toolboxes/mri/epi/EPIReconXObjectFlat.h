@@ -7,6 +7,7 @@
 
 #include "EPIExport.h"
 #include "EPIReconXObject.h"
+#include "EPIReconXOperator.h"
 #include "hoArmadillo.h"
 #include "hoNDArray_elemwise.h"
 #include "hoNDArray_linalg.h"
@@ -23,9 +24,6 @@ template <typename T> class EPIReconXObjectFlat : public EPIReconXObject<T>
 
   virtual int computeTrajectory();
 
-  virtual int apply(ISMRMRD::AcquisitionHeader &hdr_in, hoNDArray <T> &data_in, 
-		    ISMRMRD::AcquisitionHeader &hdr_out, hoNDArray <T> &data_out);
-
   using EPIReconXObject<T>::filterPos_;
   using EPIReconXObject<T>::filterNeg_;
   using EPIReconXObject<T>::slicePosition;
@@ -42,10 +40,12 @@ template <typename T> class EPIReconXObjectFlat : public EPIReconXObject<T>
   using EPIReconXObject<T>::trajectoryPos_;
   using EPIReconXObject<T>::trajectoryNeg_;
 
-  hoNDArray <T> Mpos_;
-  hoNDArray <T> Mneg_;
+  // The operator last used; operators are shared through the cache
+  std::shared_ptr<const EPIReconXOperator<T> > operator_;
   bool operatorComputed_;
 
+  virtual std::shared_ptr<const EPIReconXOperator<T> > reconOperator(ISMRMRD::AcquisitionHeader &hdr_in, hoNDArray <T> &data_in);
+
 };
 
 template <typename T> EPIReconXObjectFlat<T>::EPIReconXObjectFlat()
@@ -110,88 +110,41 @@ template <typename T> int EPIReconXObjectFlat<T>::computeTrajectory()
 }
 
 
-template <typename T> int EPIReconXObjectFlat<T>::apply(ISMRMRD::AcquisitionHeader &hdr_in, hoNDArray <T> &data_in, 
-		    ISMRMRD::AcquisitionHeader &hdr_out, hoNDArray <T> &data_out)
+template <typename T> std::shared_ptr<const EPIReconXOperator<T> >
+EPIReconXObjectFlat<T>::reconOperator(ISMRMRD::AcquisitionHeader &hdr_in, hoNDArray <T> &data_in)
 {
-  if (!operatorComputed_) {
-    // Compute the reconstruction operator
-    int Km = std::floor(encodeNx_ / 2.0);
-    int Ne = 2*Km + 1;
-    int p,q; // counters
-
-    if(numSamples_!=data_in.get_size(0))
-    {
-        numSamples_ = data_in.get_size(0);
-    }
-
-    // resize the reconstruction operator
-    Mpos_.create(reconNx_,numSamples_);
-    Mneg_.create(reconNx_,numSamples_);
-
-    // evenly spaced k-space locations
-    arma::vec keven = arma::linspace<arma::vec>(-Km, Km, Ne);
+  if (operatorComputed_) {
+    return operator_;
+  }
 
-    // image domain locations [-0.5,...,0.5)
-    arma::vec x = arma::linspace<arma::vec>(-0.5,(reconNx_-1.)/(2.*reconNx_),reconNx_);
+  if(numSamples_!=data_in.get_size(0))
+  {
+      numSamples_ = data_in.get_size(0);
+  }
 
-    // DFT operator
-    // Going from k space to image space, we use the IFFT sign convention
-    arma::cx_mat F(reconNx_, Ne);
-    double fftscale = 1.0 / std::sqrt((double)Ne);
-    for (p=0; p<reconNx_; p++) {
-      for (q=0; q<Ne; q++) {
-	F(p,q) = fftscale * std::exp(std::complex<double>(0.0,1.0*2*M_PI*keven(q)*x(p)));
-      }
-    }
+  auto key = trajectoryKey(trajectoryPos_, trajectoryNeg_, encodeNx_, reconNx_);
 
-    // forward operators
-    arma::mat Qp(numSamples_, Ne);
-    arma::mat Qn(numSamples_, Ne);
-    for (p=0; p<numSamples_; p++) {
-      //GDEBUG_STREAM(trajectoryPos_(p) << "    " << trajectoryNeg_(p) << std::endl);
-      for (q=0; q<Ne; q++) {
-	Qp(p,q) = sinc(trajectoryPos_(p)-keven(q));
-	Qn(p,q) = sinc(trajectoryNeg_(p)-keven(q));
-      }
-    }
+  operator_ = EPIReconXCache<EPIReconXTrajectoryKey, EPIReconXOperator<T> >::get(key, [&]() {
 
-    // recon operators
-    arma::cx_mat Mp(reconNx_,numSamples_);
-    arma::cx_mat Mn(reconNx_,numSamples_);
-    Mp = F * arma::pinv(Qp);
-    Mn = F * arma::pinv(Qn);
-    for (p=0; p<reconNx_; p++) {
-      for (q=0; q<numSamples_; q++) {
-        Mpos_(p,q) = Mp(p,q);
-        Mneg_(p,q) = Mn(p,q);
+    // Compute the reconstruction operator
+    auto regridding = regriddingOperator(key);
+
+    EPIReconXOperator<T> op;
+    op.Mpos.create(reconNx_,numSamples_);
+    op.Mneg.create(reconNx_,numSamples_);
+    for (int q=0; q<numSamples_; q++) {
+      for (int p=0; p<reconNx_; p++) {
+        op.Mpos(p,q) = regridding->Mp(p,q);
+        op.Mneg(p,q) = regridding->Mn(p,q);
       }
     }
+    return op;
+  });
 
-    // set the operator computed flag
-    operatorComputed_ = true;
-  }
-
-  // convert to armadillo representation of matrices and vectors
-  //arma::Mat<typename stdType<T>::Type> adata_in = as_arma_matrix(&data_in);
-  //arma::Mat<typename stdType<T>::Type> adata_out = as_arma_matrix(&data_out);
-
-  // Apply it
-  if (hdr_in.isFlagSet(ISMRMRD::ISMRMRD_ACQ_IS_REVERSE)) {
-    // Negative readout
-    // adata_out = as_arma_matrix(&Mneg_) * adata_in;
-      Gadgetron::gemm(data_out, Mneg_, data_in);
-  } else {
-    // Forward readout
-    //adata_out = as_arma_matrix(&Mpos_) * adata_in;
-      Gadgetron::gemm(data_out, Mpos_, data_in);
-  }
+  // set the operator computed flag
+  operatorComputed_ = true;
 
-  // Copy the input header to the output header and set the size and the center sample
-  hdr_out = hdr_in;
-  hdr_out.number_of_samples = reconNx_;
-  hdr_out.center_sample = reconNx_/2;
-  
-  return 0;
+  return operator_;
 }
 
 }}
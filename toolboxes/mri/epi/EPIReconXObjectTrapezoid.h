@@ -7,6 +7,7 @@
 
 #include "EPIExport.h"
 #include "EPIReconXObject.h"
+#include "EPIReconXOperator.h"
 #include "hoArmadillo.h"
 #include "hoNDArray_elemwise.h"
 #include "hoNDArray_linalg.h"
@@ -23,9 +24,6 @@ template <typename T> class EPIReconXObjectTrapezoid : public EPIReconXObject<T>
 
   virtual int computeTrajectory();
 
-  virtual int apply(ISMRMRD::AcquisitionHeader &hdr_in, hoNDArray <T> &data_in, 
-		    ISMRMRD::AcquisitionHeader &hdr_out, hoNDArray <T> &data_out);
-
   using EPIReconXObject<T>::filterPos_;
   using EPIReconXObject<T>::filterNeg_;
   using EPIReconXObject<T>::slicePosition;
@@ -47,10 +45,13 @@ template <typename T> class EPIReconXObjectTrapezoid : public EPIReconXObject<T>
   using EPIReconXObject<T>::trajectoryPos_;
   using EPIReconXObject<T>::trajectoryNeg_;
 
-  hoNDArray <T> Mpos_;
-  hoNDArray <T> Mneg_;
+  // The operator last used, and the off-center it was computed for; operators are shared through the cache
+  std::shared_ptr<const EPIReconXOperator<T> > operator_;
+  float operatorOffCenterDistance_;
   bool operatorComputed_;
 
+  virtual std::shared_ptr<const EPIReconXOperator<T> > reconOperator(ISMRMRD::AcquisitionHeader &hdr_in, hoNDArray <T> &data_in);
+
   float calcOffCenterDistance(ISMRMRD::AcquisitionHeader& hdr_in);
 };
 
@@ -68,6 +69,7 @@ template <typename T> EPIReconXObjectTrapezoid<T>::EPIReconXObjectTrapezoid()
   reconNx_ = 0;
   encodeFOV_ = 0.0;
   reconFOV_ = 0.0;
+  operatorOffCenterDistance_ = 0.0;
   operatorComputed_ = false;
 }
 
@@ -153,62 +155,27 @@ template <typename T> int EPIReconXObjectTrapezoid<T>::computeTrajectory()
 }
 
 
-template <typename T> int EPIReconXObjectTrapezoid<T>::apply(ISMRMRD::AcquisitionHeader &hdr_in, hoNDArray <T> &data_in, 
-		    ISMRMRD::AcquisitionHeader &hdr_out, hoNDArray <T> &data_out)
+template <typename T> std::shared_ptr<const EPIReconXOperator<T> >
+EPIReconXObjectTrapezoid<T>::reconOperator(ISMRMRD::AcquisitionHeader &hdr_in, hoNDArray <T> &data_in)
 {
-  if (!operatorComputed_) {
-    // Compute the reconstruction operator
-    int Km = std::floor(encodeNx_ / 2.0);
-    int Ne = 2*Km + 1;
-    int p,q; // counters
+  // Compute the off-center distance in the RO direction:
+  float roOffCenterDistance = calcOffCenterDistance( hdr_in );
 
-    // resize the reconstruction operator
-    Mpos_.create(reconNx_,numSamples_);
-    Mneg_.create(reconNx_,numSamples_);
-
-    // evenly spaced k-space locations
-    arma::vec keven = arma::linspace<arma::vec>(-Km, Km, Ne);
-    //keven.print("keven =");
-
-    // image domain locations [-0.5,...,0.5)
-    arma::vec x = arma::linspace<arma::vec>(-0.5,(reconNx_-1.)/(2.*reconNx_),reconNx_);
-    //x.print("x =");
-
-    // DFT operator
-    // Going from k space to image space, we use the IFFT sign convention
-    arma::cx_mat F(reconNx_, Ne);
-    double fftscale = 1.0 / std::sqrt((double)Ne);
-    for (p=0; p<reconNx_; p++) {
-      for (q=0; q<Ne; q++) {
-	F(p,q) = fftscale * std::exp(std::complex<double>(0.0,1.0*2*M_PI*keven(q)*x(p)));
-      }
-    }
-    //F.print("F =");
-
-    // forward operators
-    arma::mat Qp(numSamples_, Ne);
-    arma::mat Qn(numSamples_, Ne);
-    for (p=0; p<numSamples_; p++) {
-      //GDEBUG_STREAM(trajectoryPos_(p) << "    " << trajectoryNeg_(p) << std::endl);
-      for (q=0; q<Ne; q++) {
-	Qp(p,q) = sinc(trajectoryPos_(p)-keven(q));
-	Qn(p,q) = sinc(trajectoryNeg_(p)-keven(q));
-      }
-    }
+  if (operatorComputed_ && roOffCenterDistance == operatorOffCenterDistance_) {
+    return operator_;
+  }
 
-    //Qp.print("Qp =");
-    //Qn.print("Qn =");
+  EPIReconXOffCenterKey key{ trajectoryKey(trajectoryPos_, trajectoryNeg_, encodeNx_, reconNx_), encodeFOV_, roOffCenterDistance };
 
-    // recon operators
-    arma::cx_mat Mp(reconNx_,numSamples_);
-    arma::cx_mat Mn(reconNx_,numSamples_);
-    Mp = F * arma::pinv(Qp);
-    Mn = F * arma::pinv(Qn);
+  operator_ = EPIReconXCache<EPIReconXOffCenterKey, EPIReconXOperator<T> >::get(key, [&]() {
 
-    /////    Compute the off-center correction:     /////
+    GDEBUG_STREAM("Computing EPI recon operator for roOffCenterDistance: " << roOffCenterDistance );
 
-    // Compute the off-center distance in the RO direction:
-    float roOffCenterDistance = calcOffCenterDistance( hdr_in );
+    // Compute the reconstruction operator
+    auto regridding = regriddingOperator(key.trajectory);
+    int p,q; // counters
+
+    /////    Compute the off-center correction:     /////
 
     arma::Col<typename realType<T>::Type> my_keven = arma::linspace< arma::Col<typename realType<T>::Type> >(0, numSamples_ -1, numSamples_);
     // find the offset:
@@ -228,51 +195,27 @@ template <typename T> int EPIReconXObjectTrapezoid<T>::apply(ISMRMRD::Acquisitio
     myExponent.set_imag( 2*M_PI*roOffCenterDistance/encodeFOV_*(as_arma_col(trajectoryNeg_)+my_keven) );
     arma::Col<T> offCenterCorrP = arma::exp( myExponent );
 
-    //    GDEBUG_STREAM("roOffCenterDistance_: " << roOffCenterDistance_ << ";       encodeFOV_: " << encodeFOV_);
-    //    for (q=0; q<numSamples_; q++) {
-    //      GDEBUG_STREAM("keven(" << q << "): " << my_keven(q) << ";       trajectoryPosArma(" << q << "): " << trajectoryPosArma(q) );
-    //      GDEBUG_STREAM("offCenterCorrP(" << q << "):" << offCenterCorrP(q) );
-    //    }
-
     // Finally, combine the off-center correction with the recon operator:
-    Mp = Mp * diagmat(offCenterCorrP);
-    Mn = Mn * diagmat(offCenterCorrN);
+    arma::cx_mat Mp = regridding->Mp * diagmat(offCenterCorrP);
+    arma::cx_mat Mn = regridding->Mn * diagmat(offCenterCorrN);
+
     // and save it into the NDArray members:
-    for (p=0; p<reconNx_; p++) {
-      for (q=0; q<numSamples_; q++) {
-        Mpos_(p,q) = Mp(p,q);
-        Mneg_(p,q) = Mn(p,q);
+    EPIReconXOperator<T> op;
+    op.Mpos.create(reconNx_,numSamples_);
+    op.Mneg.create(reconNx_,numSamples_);
+    for (q=0; q<numSamples_; q++) {
+      for (p=0; p<reconNx_; p++) {
+        op.Mpos(p,q) = Mp(p,q);
+        op.Mneg(p,q) = Mn(p,q);
       }
     }
-    
-    //Mp.print("Mp =");
-    //Mn.print("Mn =");
+    return op;
+  });
 
-    // set the operator computed flag
-    operatorComputed_ = true;
-  }
+  operatorOffCenterDistance_ = roOffCenterDistance;
+  operatorComputed_ = true;
 
-  // convert to armadillo representation of matrices and vectors
-  //arma::Mat<typename stdType<T>::Type> adata_in = as_arma_matrix(&data_in);
-  //arma::Mat<typename stdType<T>::Type> adata_out = as_arma_matrix(&data_out);
-
-  // Apply it
-  if (hdr_in.isFlagSet(ISMRMRD::ISMRMRD_ACQ_IS_REVERSE)) {
-    // Negative readout
-    // adata_out = as_arma_matrix(&Mneg_) * adata_in;
-      Gadgetron::gemm(data_out, Mneg_, data_in);
-  } else {
-    // Forward readout
-    // adata_out = as_arma_matrix(&Mpos_) * adata_in;
-      Gadgetron::gemm(data_out, Mpos_, data_in);
-  }
-
-  // Copy the input header to the output header and set the size and the center sample
-  hdr_out = hdr_in;
-  hdr_out.number_of_samples = reconNx_;
-  hdr_out.center_sample = reconNx_/2;
-  
-  return 0;
+  return operator_;
 }
 
 template <typename T> float EPIReconXObjectTrapezoid<T>::calcOffCenterDistance(ISMRMRD::AcquisitionHeader& hdr_in)
@@ -287,7 +230,6 @@ template <typename T> float EPIReconXObjectTrapezoid<T>::calcOffCenterDistance(I
   }
 
   float roOffCenterDistance = dot(pos, RO_dir);
-  GDEBUG_STREAM("roOffCenterDistance: " << roOffCenterDistance );
 
   return roOffCenterDistance;
 
@@ -0,0 +1,162 @@
+/** \file   EPIReconXOperator.h
+    \brief  Regridding operators for the EPI X reconstruction, shared by every reconstruction in the process
+
+    Computing an operator takes a pseudo-inverse per readout polarity, which is by far the most expensive part of
+    the X reconstruction. Operators are cached by the trajectory (and off-center) they were computed for, so
+    slices, repetitions and connections with the same readout share them.
+*/
+
+#pragma once
+
+#include "EPIExport.h"
+#include "hoArmadillo.h"
+#include "hoNDArray.h"
+#include "gadgetronmath.h"
+
+#include <complex>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace Gadgetron { namespace EPI {
+
+/// Operators regridding positive and negative readouts onto the reconstruction grid; [reconNx numSamples]
+template <typename T> struct EPIReconXOperator
+{
+  hoNDArray <T> Mpos;
+  hoNDArray <T> Mneg;
+};
+
+/// F * pinv(Q) for either readout polarity, in double precision, before any off-center correction
+struct EPIReconXRegridding
+{
+  arma::cx_mat Mp;
+  arma::cx_mat Mn;
+};
+
+struct EPIReconXTrajectoryKey
+{
+  std::vector<float> trajectoryPos;
+  std::vector<float> trajectoryNeg;
+  int encodeNx;
+  int reconNx;
+
+  bool operator==(const EPIReconXTrajectoryKey &other) const
+  {
+    return encodeNx == other.encodeNx && reconNx == other.reconNx &&
+           trajectoryPos == other.trajectoryPos && trajectoryNeg == other.trajectoryNeg;
+  }
+};
+
+struct EPIReconXOffCenterKey
+{
+  EPIReconXTrajectoryKey trajectory;
+  float encodeFOV;
+  float roOffCenterDistance;
+
+  bool operator==(const EPIReconXOffCenterKey &other) const
+  {
+    return encodeFOV == other.encodeFOV && roOffCenterDistance == other.roOffCenterDistance &&
+           trajectory == other.trajectory;
+  }
+};
+
+/// Keeps the most recently used values; a value is computed outside the lock, so threads computing different
+/// operators do not wait for each other.
+template <typename Key, typename Value> class EPIReconXCache
+{
+ public:
+  static const size_t capacity = 64;
+
+  static std::shared_ptr<const Value> get(const Key &key, const std::function<Value()> &compute)
+  {
+    {
+      std::lock_guard<std::mutex> guard(mutex());
+      auto &cached = entries();
+      for (auto it = cached.begin(); it != cached.end(); ++it) {
+        if (it->first == key) {
+          cached.splice(cached.begin(), cached, it);
+          return cached.front().second;
+        }
+      }
+    }
+
+    auto value = std::make_shared<const Value>(compute());
+
+    std::lock_guard<std::mutex> guard(mutex());
+    auto &cached = entries();
+    cached.emplace_front(key, value);
+    if (cached.size() > capacity) cached.pop_back();
+    return value;
+  }
+
+ private:
+  static std::mutex &mutex()
+  {
+    static std::mutex instance;
+    return instance;
+  }
+
+  static std::list<std::pair<Key, std::shared_ptr<const Value>>> &entries()
+  {
+    static std::list<std::pair<Key, std::shared_ptr<const Value>>> instance;
+    return instance;
+  }
+};
+
+inline EPIReconXTrajectoryKey trajectoryKey(const hoNDArray<float> &trajectoryPos, const hoNDArray<float> &trajectoryNeg,
+                                            int encodeNx, int reconNx)
+{
+  return EPIReconXTrajectoryKey{
+      std::vector<float>(trajectoryPos.begin(), trajectoryPos.end()),
+      std::vector<float>(trajectoryNeg.begin(), trajectoryNeg.end()),
+      encodeNx,
+      reconNx
+  };
+}
+
+inline std::shared_ptr<const EPIReconXRegridding> regriddingOperator(const EPIReconXTrajectoryKey &key)
+{
+  return EPIReconXCache<EPIReconXTrajectoryKey, EPIReconXRegridding>::get(key, [&]() {
+
+    int numSamples = key.trajectoryPos.size();
+    int reconNx = key.reconNx;
+    int Km = std::floor(key.encodeNx / 2.0);
+    int Ne = 2*Km + 1;
+    int p,q; // counters
+
+    // evenly spaced k-space locations
+    arma::vec keven = arma::linspace<arma::vec>(-Km, Km, Ne);
+
+    // image domain locations [-0.5,...,0.5)
+    arma::vec x = arma::linspace<arma::vec>(-0.5,(reconNx-1.)/(2.*reconNx),reconNx);
+
+    // DFT operator
+    // Going from k space to image space, we use the IFFT sign convention
+    arma::cx_mat F(reconNx, Ne);
+    double fftscale = 1.0 / std::sqrt((double)Ne);
+    for (p=0; p<reconNx; p++) {
+      for (q=0; q<Ne; q++) {
+        F(p,q) = fftscale * std::exp(std::complex<double>(0.0,1.0*2*M_PI*keven(q)*x(p)));
+      }
+    }
+
+    // forward operators
+    arma::mat Qp(numSamples, Ne);
+    arma::mat Qn(numSamples, Ne);
+    for (p=0; p<numSamples; p++) {
+      for (q=0; q<Ne; q++) {
+        Qp(p,q) = sinc(key.trajectoryPos[p]-keven(q));
+        Qn(p,q) = sinc(key.trajectoryNeg[p]-keven(q));
+      }
+    }
+
+    // recon operators
+    return EPIReconXRegridding{ F * arma::pinv(Qp), F * arma::pinv(Qn) };
+  });
+}
+
+}}
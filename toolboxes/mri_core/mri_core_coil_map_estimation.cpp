@@ -7,6 +7,7 @@
 #include "mri_core_coil_map_estimation.h"
 #include "hoMatrix.h"
 #include "hoNDArray_linalg.h"
+#include "hoNDArray_batched_linalg.h"
 #include "hoNDArray_elemwise.h"
 #include "hoNDArray_reductions.h"
 #include "complext.h"
@@ -49,147 +50,107 @@ void coil_map_2d_Inati(const hoNDArray<T>& data, hoNDArray<T>& coilMap, size_t k
         size_t kss = ks*ks;
         long long halfKs = (long long)ks / 2;
 
-        long long e1;
+        // Pixels are processed in blocks along RO; the CHA x CHA problems of a block are solved together by the
+        // batched kernels, which vectorise across pixels.
+        const long long block = 32;
+        const long long blocksPerLine = (RO + block - 1) / block;
+        const long long numOfBlocks = blocksPerLine*E1;
 
-        #pragma omp parallel private(e1) shared(ks, RO, E1, CHA, pSen, pData, halfKs, power, kss)
-        {
-            hoNDArray<T> D(ks*ks, CHA);
-            T* pD = D.begin();
-
-            hoNDArray<T> DC(ks*ks, CHA);
-            T* pDC = DC.begin();
-
-            hoNDArray<T> DH_D(CHA, CHA);
-            Gadgetron::clear(DH_D);
+        long long n;
 
-            hoNDArray<T> U1(ks*ks, 1);
-            T* pU1 = U1.begin();
+        #pragma omp parallel private(n) shared(RO, E1, CHA, pSen, pData, halfKs, power, kss)
+        {
+            hoNDArray<T> D(block, kss, CHA);
+            hoNDArray<T> DH_D(block, CHA, CHA);
+            hoNDArray<T> V1(block, CHA, 1);
+            hoNDArray<T> U1(block, kss, 1);
 
-            hoNDArray<T> V1(CHA, 1);
+            T* pD = D.begin();
             T* pV1 = V1.begin();
+            T* pU1 = U1.begin();
 
-            hoNDArray<T> V(CHA, 1);
-
-            Gadgetron::clear(D);
-            Gadgetron::clear(DC);
-            Gadgetron::clear(DH_D);
-            Gadgetron::clear(U1);
-            Gadgetron::clear(V1);
-            Gadgetron::clear(V);
+            std::vector<value_type> norm(block);
 
-            T phaseU1;
+            #pragma omp for
+            for (n = 0; n < numOfBlocks; n++)
+            {
+                long long e1 = n / blocksPerLine;
+                long long ro0 = (n % blocksPerLine)*block;
+                long long num = std::min(block, RO - ro0);
 
-            value_type v1Norm(1), u1Norm(1);
+                Batched::MatrixStack<T> stackD = Batched::MatrixStack<T>(D).block(0, num);
+                Batched::MatrixStack<T> stackDH_D = Batched::MatrixStack<T>(DH_D).block(0, num);
+                Batched::MatrixStack<T> stackV1 = Batched::MatrixStack<T>(V1).block(0, num);
+                Batched::MatrixStack<T> stackU1 = Batched::MatrixStack<T>(U1).block(0, num);
 
-            long long cha, ro, kro, ke1, de1, dro;
-            size_t po;
+                long long cha, b, kro, ke1, de1, dro;
+                size_t po;
 
-            #pragma omp for
-            for (e1 = 0; e1<(int)E1; e1++)
-            {
-                for (ro = 0; ro<(long long)RO; ro++)
+                // fill the data matrices D, wrapping around at the edges
+                for (cha = 0; cha<CHA; cha++)
                 {
-                    // fill the data matrix D
-                    if (e1 >= halfKs && e1<E1 - halfKs && ro >= halfKs && ro<RO - halfKs)
+                    const T* pDataCurr = pData + cha*RO*E1;
+                    size_t ind = 0;
+                    for (ke1 = -halfKs; ke1 <= halfKs; ke1++)
                     {
-                        for (cha = 0; cha<CHA; cha++)
+                        de1 = e1 + ke1;
+                        if (de1 < 0) de1 += E1;
+                        if (de1 >= E1) de1 -= E1;
+
+                        for (kro = -halfKs; kro <= halfKs; kro++)
                         {
-                            const T* pDataCurr = pData + cha*RO*E1;
-                            int ind = 0;
-                            for (ke1 = -halfKs; ke1 <= halfKs; ke1++)
+                            T* pDCurr = pD + (ind + cha*kss)*block;
+                            if (ro0 + kro >= 0 && ro0 + num + kro <= RO)
                             {
-                                de1 = e1 + ke1;
-                                for (kro = -halfKs; kro <= halfKs; kro++)
-                                {
-                                    pD[ind + cha*kss] = pDataCurr[de1*RO + ro + kro];
-                                    ind++;
-                                }
+                                memcpy(pDCurr, pDataCurr + de1*RO + ro0 + kro, sizeof(T)*num);
                             }
-                        }
-                    }
-                    else
-                    {
-                        for (cha = 0; cha<CHA; cha++)
-                        {
-                            const T* pDataCurr = pData + cha*RO*E1;
-                            int ind = 0;
-                            for (ke1 = -halfKs; ke1 <= halfKs; ke1++)
+                            else
                             {
-                                de1 = e1 + ke1;
-                                if (de1 < 0) de1 += E1;
-                                if (de1 >= E1) de1 -= E1;
-
-                                for (kro = -halfKs; kro <= halfKs; kro++)
+                                for (b = 0; b < num; b++)
                                 {
-                                    dro = ro + kro;
+                                    dro = ro0 + b + kro;
                                     if (dro < 0) dro += RO;
                                     if (dro >= RO) dro -= RO;
 
-                                    pD[ind + cha*kss] = pDataCurr[de1*RO + dro];
-                                    ind++;
+                                    pDCurr[b] = pDataCurr[de1*RO + dro];
                                 }
                             }
+                            ind++;
                         }
                     }
+                }
 
-                    T* pTmp;
-                    for (cha = 0; cha<CHA; cha++)
-                    {
-                        pTmp = pD + cha*kss;
-                        pV1[cha] = pTmp[0];
-                        for (po = 1; po<kss; po++)
-                        {
-                            pV1[cha] += pTmp[po];
-                        }
-                    }
-
-                    value_type sum(0);
-                    for (cha = 0; cha<CHA; cha++)
-                    {
-                        const T& c = pV1[cha];
-                        const value_type re = c.real();
-                        const value_type im = c.imag();
-                        sum += ((re*re) + (im * im));
-                    }
-                    v1Norm = std::sqrt(sum);
-
-                    value_type v1NormInv = (value_type)1.0 / v1Norm;
-                    for (cha = 0; cha<CHA; cha++)
+                // initial V1 is the normalized sum of D over the kernel
+                std::fill(norm.begin(), norm.end(), value_type(0));
+                for (cha = 0; cha<CHA; cha++)
+                {
+                    T* pV1Curr = pV1 + cha*block;
+                    for (b = 0; b < num; b++) pV1Curr[b] = pD[(cha*kss)*block + b];
+                    for (po = 1; po<kss; po++)
                     {
-                        pV1[cha] *= v1NormInv;
+                        const T* pDCurr = pD + (po + cha*kss)*block;
+                        for (b = 0; b < num; b++) pV1Curr[b] += pDCurr[b];
                     }
+                    for (b = 0; b < num; b++) norm[b] += pV1Curr[b].real()*pV1Curr[b].real() + pV1Curr[b].imag()*pV1Curr[b].imag();
+                }
 
-                    memcpy(pDC, pD, sizeof(T)*ks*ks*CHA);
-                    gemm(DH_D, DC, true, D, false);
-
-                    for (po = 0; po<power; po++)
-                    {
-                        gemm(V, DH_D, false, V1, false);
-                        memcpy(V1.begin(), V.begin(), V.get_number_of_bytes());
-
-                        sum = 0;
-                        for (cha = 0; cha<CHA; cha++)
-                        {
-                            const T& c = pV1[cha];
-                            const value_type re = c.real();
-                            const value_type im = c.imag();
-                            sum += ((re*re) + (im * im));
-                        }
-                        v1Norm = std::sqrt(sum);
-
-                        value_type v1NormInv = (value_type)1.0 / v1Norm;
-                        for (cha = 0; cha<CHA; cha++)
-                        {
-                            pV1[cha] *= v1NormInv;
-                        }
-                    }
+                for (b = 0; b < num; b++) norm[b] = (value_type)1.0 / std::sqrt(norm[b]);
+                for (cha = 0; cha<CHA; cha++)
+                {
+                    T* pV1Curr = pV1 + cha*block;
+                    for (b = 0; b < num; b++) pV1Curr[b] *= norm[b];
+                }
 
-                    gemm(U1, D, false, V1, false);
+                Batched::herk(stackDH_D, stackD);
+                Batched::power_iteration(stackDH_D, stackV1, power);
+                Batched::gemm(stackU1, stackD, false, stackV1, false);
 
-                    phaseU1 = pU1[0];
+                for (b = 0; b < num; b++)
+                {
+                    T phaseU1 = pU1[b];
                     for (po = 1; po<kss; po++)
                     {
-                        phaseU1 += pU1[po];
+                        phaseU1 += pU1[po*block + b];
                     }
                     phaseU1 /= abs(phaseU1);
 
@@ -198,17 +159,11 @@ void coil_map_2d_Inati(const hoNDArray<T>& data, hoNDArray<T>& coilMap, size_t k
 
                     for (cha = 0; cha<CHA; cha++)
                     {
-                        const T& v = pV1[cha];
-                        const value_type a = v.real();
-                        const value_type b = v.imag();
+                        const T& v = pV1[cha*block + b];
+                        const value_type re = v.real();
+                        const value_type im = v.imag();
 
-                        reinterpret_cast< value_type(&)[2] >(pV1[cha])[0] = a*c + b*d;
-                        reinterpret_cast< value_type(&)[2] >(pV1[cha])[1] = a*d - b*c;
-                    }
-
-                    for (cha = 0; cha<CHA; cha++)
-                    {
-                        pSen[cha*RO*E1 + e1*RO + ro] = V1(cha, 0);
+                        pSen[cha*RO*E1 + e1*RO + ro0 + b] = T(re*c + im*d, re*d - im*c);
                     }
                 }
             }
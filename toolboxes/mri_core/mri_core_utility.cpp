@@ -195,9 +195,6 @@ namespace Gadgetron
     {
         try
         {
-            std::vector<size_t> dim;
-            complexIm.get_dimensions(dim);
-
             size_t RO = complexIm.get_size(0);
             size_t E1 = complexIm.get_size(1);
             size_t E2 = complexIm.get_size(2);
@@ -213,24 +210,10 @@ namespace Gadgetron
                     return;
                 }
 
-                if (complexImResized.get_size(0) != sizeRO || complexImResized.get_size(1) != sizeE1 || complexImResized.get_size(2) != sizeE2)
-                {
-                    dim[0] = sizeRO;
-                    dim[1] = sizeE1;
-                    dim[2] = sizeE2;
-                    complexImResized.create(dim);
-                }
-
-                Gadgetron::clear(&complexImResized);
-
-                hoNDArray<T> kspace(complexIm);
-                Gadgetron::hoNDFFT<typename realType<T>::Type>::instance()->fft3c(complexIm, kspace);
-
-                Gadgetron::pad(sizeRO, sizeE1, sizeE2, kspace, complexImResized);
-
-                Gadgetron::hoNDFFT<typename realType<T>::Type>::instance()->ifft3c(complexImResized);
+                // Historically scaled by sqrt(E2) more than a value preserving resize; kept for compatibility.
+                complexImResized = Gadgetron::FFT::resample(complexIm, { sizeRO, sizeE1, sizeE2 });
 
-                typename realType<T>::Type scaling = (typename realType<T>::Type)(std::sqrt((double)sizeRO*sizeE1*sizeE2) / std::sqrt((double)RO*E1));
+                typename realType<T>::Type scaling = (typename realType<T>::Type)(std::sqrt((double)E2));
                 Gadgetron::scal(scaling, complexImResized);
             }
             else
@@ -241,23 +224,7 @@ namespace Gadgetron
                     return;
                 }
 
-                if (complexImResized.get_size(0) != sizeRO || complexImResized.get_size(1) != sizeE1)
-                {
-                    dim[0] = sizeRO;
-                    dim[1] = sizeE1;
-                    complexImResized.create(dim);
-                }
-
-                Gadgetron::clear(&complexImResized);
-
-                hoNDArray<T> kspace(complexIm);
-                Gadgetron::hoNDFFT<typename realType<T>::Type>::instance()->fft2c(complexIm, kspace);
-
-                Gadgetron::pad(sizeRO, sizeE1, kspace, complexImResized);
-                Gadgetron::hoNDFFT<typename realType<T>::Type>::instance()->ifft2c(complexImResized);
-
-                typename realType<T>::Type scaling = (typename realType<T>::Type)(std::sqrt((double)sizeRO*sizeE1) / std::sqrt((double)RO*E1));
-                Gadgetron::scal(scaling, complexImResized);
+                complexImResized = Gadgetron::FFT::resample(complexIm, { sizeRO, sizeE1 });
             }
         }
         catch (...)
@@ -0,0 +1,329 @@
+/** \file   BatchedLM.h
+    \brief  Levenberg-Marquardt fitting of many small curve fitting problems at once, e.g. every pixel of a
+            parametric map.
+
+            The signal model is a compile time type with closed form derivatives, and a group of LANES curves is
+            iterated together with the curve index innermost in every loop, so the model and the normal equations
+            vectorise across curves. Nothing is allocated or dispatched per curve.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#ifdef USE_OMP
+#include <omp.h>
+#endif
+
+namespace Gadgetron { namespace Solver {
+
+    /// Signal models for BatchedLMSolver. A model evaluates the signal at sample point x and its derivatives with
+    /// respect to the parameters.
+    namespace Models {
+
+        /// y = A * exp(-x/T2); parameters {A, T2}
+        template <class T> struct ExpDecay {
+            using value_type = T;
+            static constexpr size_t num_params = 2;
+
+            T operator()(T x, const std::array<T, 2>& p, std::array<T, 2>& dy) const {
+                T e = std::exp(-x / p[1]);
+                dy[0] = e;
+                dy[1] = p[0] * e * x / (p[1] * p[1]);
+                return p[0] * e;
+            }
+        };
+
+        /// y = A * (1 - exp(-x/T1)); parameters {A, T1}
+        template <class T> struct ExpRecovery {
+            using value_type = T;
+            static constexpr size_t num_params = 2;
+
+            T operator()(T x, const std::array<T, 2>& p, std::array<T, 2>& dy) const {
+                T e = std::exp(-x / p[1]);
+                dy[0] = 1 - e;
+                dy[1] = -p[0] * e * x / (p[1] * p[1]);
+                return p[0] * (1 - e);
+            }
+        };
+
+        /// y = A * (1 - 2*exp(-x/T1)); parameters {T1, A}
+        template <class T> struct InversionRecovery {
+            using value_type = T;
+            static constexpr size_t num_params = 2;
+
+            T operator()(T x, const std::array<T, 2>& p, std::array<T, 2>& dy) const {
+                T e = 2 * std::exp(-x / p[0]);
+                dy[0] = -p[1] * e * x / (p[0] * p[0]);
+                dy[1] = 1 - e;
+                return p[1] * (1 - e);
+            }
+        };
+
+        /// y = A - B*exp(-x/T1*); parameters {T1*, A, B}
+        template <class T> struct ThreeParamInversionRecovery {
+            using value_type = T;
+            static constexpr size_t num_params = 3;
+
+            T operator()(T x, const std::array<T, 3>& p, std::array<T, 3>& dy) const {
+                T e = std::exp(-x / p[0]);
+                dy[0] = -p[2] * e * x / (p[0] * p[0]);
+                dy[1] = 1;
+                dy[2] = -e;
+                return p[1] - p[2] * e;
+            }
+        };
+    }
+
+    enum class BatchedLMStatus : unsigned char { SUCCESS, MAX_ITERATIONS_REACHED, LINEAR_SOLVER_FAILED };
+
+    /**
+     * Levenberg-Marquardt with More's diagonal scaling and Nielsen's damping update, as in HybridLMSolver, minimising
+     * 1/2 sum (model(x_n, p) - y_n)^2 for LANES curves at a time. Every curve keeps its own damping and stops on
+     * its own; a group finishes when all its curves have.
+     *
+     * The solver holds scratch buffers, so each thread needs its own copy.
+     */
+    template <class MODEL, size_t LANES = 8> class BatchedLMSolver {
+    public:
+        using T                          = typename MODEL::value_type;
+        static constexpr size_t P        = MODEL::num_params;
+        static constexpr size_t lanes    = LANES;
+        using Parameters                 = std::array<T, P>;
+
+        BatchedLMSolver(std::vector<T> x, MODEL model = MODEL())
+            : x_(std::move(x)), model_(model), y_(x_.size() * LANES) {}
+
+        /// maximal number of iterations
+        size_t max_iterations_ = 100;
+        /// a curve has converged when its step is smaller than this, relative to its parameters
+        T step_tolerance_ = T(1e-6);
+        /// ... or when an accepted step reduces its cost by less than this fraction
+        T cost_tolerance_ = T(1e-10);
+
+        const std::vector<T>& x() const { return x_; }
+
+        /**
+         * Fits 'count' (at most LANES) curves. y[l] points to the samples of curve l, one per point in x;
+         * params[l] holds the initial guess of curve l and receives the fit.
+         */
+        void solve(const T* const* y, Parameters* params, BatchedLMStatus* status, size_t count) {
+            const size_t N = x_.size();
+            count = std::min(count, LANES);
+
+            // Unused lanes repeat the first curve, so they stay finite, and are never reported.
+            for (size_t n = 0; n < N; n++)
+                for (size_t l = 0; l < LANES; l++) y_[n * LANES + l] = y[l < count ? l : 0][n];
+
+            Lanes p[P];
+            for (size_t i = 0; i < P; i++)
+                for (size_t l = 0; l < LANES; l++) p[i][l] = params[l < count ? l : 0][i];
+
+            Lanes cost, mu, nu, done;
+            Lanes jtj[P][P], g[P], dtd[P];
+            evaluate(p, cost, jtj, g);
+            for (size_t i = 0; i < P; i++)
+                for (size_t l = 0; l < LANES; l++) dtd[i][l] = std::numeric_limits<T>::min();
+            for (size_t l = 0; l < LANES; l++) {
+                mu[l] = T(1e-4);
+                nu[l] = 2;
+                done[l] = 0;
+            }
+
+            std::array<BatchedLMStatus, LANES> result;
+            result.fill(BatchedLMStatus::MAX_ITERATIONS_REACHED);
+
+            for (size_t iteration = 0; iteration < max_iterations_; iteration++) {
+                // (J^T J + mu D^T D) h = -g, by Cholesky of the P x P system of every lane. D^T D is the largest
+                // diagonal of J^T J seen so far.
+                for (size_t i = 0; i < P; i++)
+                    for (size_t l = 0; l < LANES; l++) dtd[i][l] = std::max(dtd[i][l], jtj[i][i][l]);
+
+                Lanes h[P], L[P][P], failed, singular;
+                for (size_t l = 0; l < LANES; l++) failed[l] = singular[l] = 0;
+                for (size_t i = 0; i < P; i++) {
+                    for (size_t j = 0; j <= i; j++) {
+                        for (size_t l = 0; l < LANES; l++) {
+                            T a = jtj[i][j][l];
+                            if (i == j) a += mu[l] * dtd[i][l];
+                            for (size_t k = 0; k < j; k++) a -= L[i][k][l] * L[j][k][l];
+                            if (i == j) {
+                                failed[l] = std::isfinite(a) ? failed[l] : T(1);
+                                singular[l] = a > 0 ? singular[l] : T(1);
+                                L[i][i][l] = std::sqrt(a > 0 ? a : T(1));
+                            } else {
+                                L[i][j][l] = a / L[j][j][l];
+                            }
+                        }
+                    }
+                }
+                for (size_t i = 0; i < P; i++) {
+                    for (size_t l = 0; l < LANES; l++) {
+                        T v = -g[i][l];
+                        for (size_t k = 0; k < i; k++) v -= L[i][k][l] * h[k][l];
+                        h[i][l] = v / L[i][i][l];
+                    }
+                }
+                for (size_t i = P; i-- > 0;) {
+                    for (size_t l = 0; l < LANES; l++) {
+                        T v = h[i][l];
+                        for (size_t k = i + 1; k < P; k++) v -= L[k][i][l] * h[k][l];
+                        h[i][l] = v / L[i][i][l];
+                    }
+                }
+
+                Lanes p_new[P], cost_new, jtj_new[P][P], g_new[P];
+                for (size_t i = 0; i < P; i++)
+                    for (size_t l = 0; l < LANES; l++) p_new[i][l] = p[i][l] + h[i][l];
+                evaluate(p_new, cost_new, jtj_new, g_new);
+
+                bool all_done = true;
+                for (size_t l = 0; l < LANES; l++) {
+                    if (done[l]) continue;
+
+                    if (failed[l]) {
+                        result[l] = BatchedLMStatus::LINEAR_SOLVER_FAILED;
+                        done[l] = 1;
+                        continue;
+                    }
+
+                    T step = 0, size = 0, predicted = 0;
+                    for (size_t i = 0; i < P; i++) {
+                        step += h[i][l] * h[i][l];
+                        size += p[i][l] * p[i][l];
+                        predicted += h[i][l] * (mu[l] * dtd[i][l] * h[i][l] - g[i][l]);
+                    }
+                    step = std::sqrt(step);
+                    size = std::sqrt(size);
+                    bool small_step = step <= step_tolerance_ * (size + step_tolerance_);
+
+                    if (singular[l]) {
+                        // numerically singular, as when the model degenerates; more damping makes it definite
+                        mu[l] *= nu[l];
+                        nu[l] *= 2;
+                    } else if (cost_new[l] < cost[l]) {
+                        T rho = (cost[l] - cost_new[l]) / (predicted / 2);
+                        T r = 2 * rho - 1;
+                        mu[l] *= std::max(T(1) / 3, 1 - r * r * r);
+                        nu[l] = 2;
+
+                        bool small_change = cost[l] - cost_new[l] <= cost_tolerance_ * cost[l];
+
+                        cost[l] = cost_new[l];
+                        for (size_t i = 0; i < P; i++) {
+                            p[i][l] = p_new[i][l];
+                            g[i][l] = g_new[i][l];
+                            for (size_t j = 0; j < P; j++) jtj[i][j][l] = jtj_new[i][j][l];
+                        }
+
+                        if (small_step || small_change) {
+                            result[l] = BatchedLMStatus::SUCCESS;
+                            done[l] = 1;
+                        }
+                    } else {
+                        if (small_step) {
+                            result[l] = BatchedLMStatus::SUCCESS;
+                            done[l] = 1;
+                        }
+                        mu[l] *= nu[l];
+                        nu[l] *= 2;
+                    }
+
+                    all_done = all_done && done[l];
+                }
+                if (all_done) break;
+            }
+
+            for (size_t l = 0; l < count; l++) {
+                for (size_t i = 0; i < P; i++) params[l][i] = p[i][l];
+                status[l] = result[l];
+            }
+        }
+
+    private:
+        using Lanes = T[LANES];
+
+        /// Cost, J^T J and gradient J^T r at p, for every lane.
+        void evaluate(const Lanes (&p)[P], Lanes& cost, Lanes (&jtj)[P][P], Lanes (&g)[P]) const {
+            for (size_t l = 0; l < LANES; l++) {
+                cost[l] = 0;
+                for (size_t i = 0; i < P; i++) {
+                    g[i][l] = 0;
+                    for (size_t j = 0; j < P; j++) jtj[i][j][l] = 0;
+                }
+            }
+
+            for (size_t n = 0; n < x_.size(); n++) {
+                const T x = x_[n];
+                const T* y = &y_[n * LANES];
+                for (size_t l = 0; l < LANES; l++) {
+                    Parameters params, dy;
+                    for (size_t i = 0; i < P; i++) params[i] = p[i][l];
+                    T r = model_(x, params, dy) - y[l];
+
+                    cost[l] += r * r / 2;
+                    for (size_t i = 0; i < P; i++) {
+                        g[i][l] += dy[i] * r;
+                        for (size_t j = 0; j <= i; j++) jtj[i][j][l] += dy[i] * dy[j];
+                    }
+                }
+            }
+
+            for (size_t i = 0; i < P; i++)
+                for (size_t j = i + 1; j < P; j++)
+                    for (size_t l = 0; l < LANES; l++) jtj[i][j][l] = jtj[j][i][l];
+
+            // Parameters that leave the model undefined (e.g. a time constant of zero) count as infinitely bad.
+            for (size_t l = 0; l < LANES; l++)
+                if (!std::isfinite(cost[l])) cost[l] = std::numeric_limits<T>::infinity();
+        }
+
+        std::vector<T> x_;
+        MODEL model_;
+        std::vector<T> y_;
+    };
+
+    /**
+     * Fits 'count' curves with 'solver', LANES at a time, distributing the groups over threads.
+     *
+     * load(i, y, params) fills the samples y[n] and the initial guess of curve i; store(i, params, status) receives
+     * its fit. Both are called from several threads at once, for different curves.
+     */
+    template <class MODEL, size_t LANES, class LOAD, class STORE>
+    void fit_batched(const BatchedLMSolver<MODEL, LANES>& solver, size_t count, LOAD&& load, STORE&& store) {
+        using T          = typename MODEL::value_type;
+        using Parameters = typename BatchedLMSolver<MODEL, LANES>::Parameters;
+
+        const long long groups = (long long)((count + LANES - 1) / LANES);
+        const size_t N = solver.x().size();
+
+#ifdef USE_OMP
+#pragma omp parallel if (groups > 1)
+#endif
+        {
+            auto local = solver;
+            std::vector<T> y(N * LANES);
+            std::array<const T*, LANES> y_ptr;
+            std::array<Parameters, LANES> params;
+            std::array<BatchedLMStatus, LANES> status;
+            for (size_t l = 0; l < LANES; l++) y_ptr[l] = &y[l * N];
+
+#ifdef USE_OMP
+#pragma omp for schedule(dynamic, 16)
+#endif
+            for (long long group = 0; group < groups; group++) {
+                size_t first = size_t(group) * LANES;
+                size_t n = std::min(LANES, count - first);
+
+                for (size_t l = 0; l < n; l++) load(first + l, &y[l * N], params[l]);
+                local.solve(y_ptr.data(), params.data(), status.data(), n);
+                for (size_t l = 0; l < n; l++) store(first + l, params[l], status[l]);
+            }
+        }
+    }
+}}